@@ -1,12 +1,28 @@
 #pragma once
 
+#include <array>
 #include <numeric>
 #include <cstdint>
+#include <mutex>
+#include <vector>
 #include <Utils/FixTypes.h>
+#include <Utils/FlatHashMap.h>
 
 
 namespace CORE {
 
+/** Table of the active quotes of a connection
+ *
+ * The quotes of the depth feeds are price levels, so a quote is identified by
+ * its instrument, side and price (in cpips). The quote infos are held inline
+ * in open-addressing tables (UTILS::FlatHashMap), one per shard, keyed by the
+ * side and price packed into a 64-bit key with a dense index the shard assigns
+ * to each of its instruments (currency ids of crypto currencies go beyond 1000,
+ * so the currencies themselves are not packed). The shard is chosen by the
+ * instrument, so the workers applying different instruments in parallel lock
+ * different shards, and replacing or removing a quote neither formats a string
+ * nor allocates (except when a shard's tables grow).
+ */
 class ActiveQuoteTable
 {
 public:
@@ -20,121 +36,145 @@ public:
 		int64_t oriKey; //!< original key
 		uint64_t sequenceTag;
 	};
-	
-	/** Alias for unique pointer to a QuoteInfo object */
-	using QuoteInfoPtr = std::unique_ptr<QuoteInfo>;
-	
+
+	/** Number of bits of the price in a key (prices up to 1.4e14 cpips) */
+	static constexpr unsigned PRICE_BITS = 47;
+
+	/** Number of bits of the instrument index in a key (instruments per shard) */
+	static constexpr unsigned INSTRUMENT_BITS = 16;
+
+	/** Number of shards (a power of two) */
+	static constexpr unsigned SHARD_BITS = 4;
+	static constexpr size_t SHARD_COUNT = size_t(1) << SHARD_BITS;
+
+	/** Can a quote be kept in the table (valid instrument and side, price in range)? */
+	static bool CanIdentify(UTILS::CurrencyPair cp, UTILS::QuoteType side, int64_t price)
+	{
+		return cp.Valid() && side.Valid() && price >= 0 && !(uint64_t(price) >> PRICE_BITS);
+	}
+
 	static size_t CalculateHashValue(const UTILS::BookUpdate::Entry &entry);
-	
+
 	bool Empty() const;
-	
-	/** Find a quote info assigned to a reference ID
+
+	/** Find the quote info of a quote
 	 *
-	 * @param refId ID to be looked for
+	 * @param cp Currency pair of the quote
+	 * @param side Side of the quote
+	 * @param price Price of the quote in cpips
 	 * @param quoteInfo Reference to a quote info structure to receive the assigned data
-	 * @return @a true if @a refId was found and the quote info data was copied
+	 * @return @a true if the quote was found and the quote info data was copied
 	 */
-	bool FindQuoteInfo(const std::string &refId, QuoteInfo &quoteInfo);
-	
-	/** Replaces a quote info assigned to a reference ID with a new one
+	bool FindQuoteInfo(UTILS::CurrencyPair cp, UTILS::QuoteType side, int64_t price, QuoteInfo &quoteInfo) const;
+
+	/** Assigns a quote info to a quote, replacing the one assigned before
 	 *
-	 * @param refId ID to be looked for. If empty -> create a new entry
-	 * @param newId New ID for the quote info
-	 * @param args Arguments used to construct a new QuoteInfo struct
-	 * @return Unique pointer to the previous quote info (that was replaced
-	 * by the new one)
+	 * @param cp Currency pair of the quote
+	 * @param side Side of the quote
+	 * @param price Price of the quote in cpips
+	 * @param quoteInfo New quote info (its original key is set to its key)
+	 * @param replaced If not @a nullptr, receives the previous quote info
+	 * @return @a true if a quote info was replaced, @a false if the quote was new (or cannot be identified, see @a CanIdentify)
 	 */
-	template <typename ...Args>
-	QuoteInfoPtr ReplaceQuoteInfo(const std::string &refId, const std::string &newId, Args &&...args)
-	{
-		QuoteInfoPtr newQuote { QuoteInfoPtr(new QuoteInfo { std::forward<Args>(args)..., 0 }) };
-		newQuote->oriKey = newQuote->key; // new quote -> oriKey = key
-		
-		std::unique_lock lock { m_activeQuoteMap.Mutex() };
-		return ReplaceQuoteInfoAt((!refId.empty() ? m_activeQuoteMap->find(refId) : m_activeQuoteMap->end()), newId, std::move(newQuote));
-	}
-	
-	/** Replaces a quote info assigned to a reference ID with a new one
+	bool ReplaceQuoteInfo(UTILS::CurrencyPair cp, UTILS::QuoteType side, int64_t price, QuoteInfo quoteInfo, QuoteInfo *replaced = nullptr);
+
+	/** Assigns a quote info to a quote, replacing the one assigned before
 	 *
-	 * This version replaces an existing quote info only if the hash value of
-	 * the new quote info differs from the old one.
+	 * This version keeps the original key of the replaced quote info if the
+	 * hash value of the new quote info is the same as the old one.
 	 *
 	 * @param forceKey @a true -> always store new key, @a false -> store new key only if hash value has changed
-	 * @param refId ID to be looked for. If empty -> create a new entry
-	 * @param newId New ID for the quote info
-	 * @param volume Volume of the new quote (used to calculate the hash value)
-	 * @param price Price of the new quote (used to calculate the hash value)
-	 * @param minQty Minimum qty of the new quote (used to calculate the hash value)
-	 * @param args Arguments used to construct a new QuoteInfo struct
-	 * @return Unique pointer to the previous quote info (that was replaced
-	 * by the new one)
+	 * @param cp Currency pair of the quote
+	 * @param side Side of the quote
+	 * @param price Price of the quote in cpips
+	 * @param quoteInfo New quote info, with its hash value (see @a CalculateHashValue)
+	 * @param replaced If not @a nullptr, receives the previous quote info
+	 * @return Pair of: was a quote info replaced, was the original key kept
 	 */
-	template <typename ...Args>
-	std::pair<QuoteInfoPtr, bool> ReplaceQuoteInfo(bool forceKey, const std::string &refId, const std::string &newId, size_t hashValue,
-												   uint64_t sequenceTag, Args &&...args)
-	{
-		QuoteInfoPtr newQuote { QuoteInfoPtr(new QuoteInfo { std::forward<Args>(args)..., hashValue, int64_t(0), sequenceTag }) };
-		
-		std::unique_lock lock { m_activeQuoteMap.Mutex() };
-		const auto &it { !refId.empty() ? m_activeQuoteMap->find(refId) : m_activeQuoteMap->end() };
-		
-		const bool skipKey { !forceKey && it != m_activeQuoteMap->end() && it->second->hashValue == hashValue && refId == newId };
-		newQuote->oriKey = skipKey ? it->second->oriKey : newQuote->key;
-		return { ReplaceQuoteInfoAt(it, newId, std::move(newQuote)), skipKey };
-	}
-	
-	/** Removes a quote info assigned to a reference ID
+	std::pair<bool, bool> ReplaceQuoteInfo(bool forceKey, UTILS::CurrencyPair cp, UTILS::QuoteType side, int64_t price, QuoteInfo quoteInfo,
+										   QuoteInfo *replaced = nullptr);
+
+	/** Removes the quote info of a quote
 	 *
-	 * @param refId ID of the quote to be removed
-	 * @return Unique pointer to the removed quote info
+	 * @param cp Currency pair of the quote
+	 * @param side Side of the quote
+	 * @param price Price of the quote in cpips
+	 * @param removed If not @a nullptr, receives the removed quote info
+	 * @return @a true if a quote info was removed
 	 */
-	QuoteInfoPtr RemoveQuoteInfo(const std::string &refId);
-	
+	bool RemoveQuoteInfo(UTILS::CurrencyPair cp, UTILS::QuoteType side, int64_t price, QuoteInfo *removed = nullptr);
+
 	/** Removes all active quotes older than a given key
 	 *
 	 * @param limitKey All quotes older than @a limitKey are removed
-	 * @param action Action to be executed for each reoved quote
+	 * @param action Action to be executed for each removed quote: void action(const QuoteInfo &quoteInfo)
 	 */
 	template <typename A>
 	void RemoveOldQuoteInfos(int64_t limitKey, A action)
 	{
-		std::unique_lock lock { m_activeQuoteMap.Mutex() };
-		auto it = m_activeQuoteMap->begin();
-		while (it != m_activeQuoteMap->end())
+		std::vector<uint64_t> old;
+		for (Shard &shard: m_shards)
 		{
-			if (it->second->key < limitKey)
+			std::lock_guard lock { shard.mtx };
+			old.clear();
+			shard.quotes.ForEach([limitKey, &old](uint64_t quoteKey, const QuoteInfo &quoteInfo)
 			{
-				action(it->first, std::move(it->second));
-				it = m_activeQuoteMap->erase(it);
-			}
-			else
+				if (quoteInfo.key < limitKey)
+				{
+					old.push_back(quoteKey);
+				}
+			});
+			for (uint64_t quoteKey: old)
 			{
-				++it;
+				action(*shard.quotes.Find(quoteKey));
+				shard.quotes.Erase(quoteKey);
 			}
 		}
 	}
 
 
 protected:
-	
-	using QuoteMap = std::map<std::string, QuoteInfoPtr>; //!< Type alias for the quote map
-	
-	/** Shared lockable map (ID -> QuoteInfo struct) */
-	UTILS::SharedLockable<QuoteMap> m_activeQuoteMap;
-	
-	/** Replaces a quote info pointed to by an iterator
+	using QuoteMap = UTILS::FlatHashMap<uint64_t, QuoteInfo>; //!< Type alias for the quote map
+
+	/** Quote infos of the instruments mapped to a shard, on a cache line of their own */
+	struct alignas(64) Shard
+	{
+		mutable std::mutex mtx;
+		QuoteMap quotes; //!< Key (see @a FindKey) -> quote info
+		UTILS::FlatHashMap<uint64_t, uint64_t> instruments; //!< Currency ids -> index of the instrument in the keys
+	};
+
+	/** Base and quote currency ids of an instrument */
+	static uint64_t InstrumentId(UTILS::CurrencyPair cp)
+	{
+		return (uint64_t(cp.BaseCCY()) << 32u) | uint64_t(cp.QuoteCCY());
+	}
+
+	/** Shard of an instrument (Fibonacci hashing of the currency ids) */
+	Shard &ShardOf(UTILS::CurrencyPair cp)
+	{
+		return m_shards[(InstrumentId(cp) * 0x9E3779B97F4A7C15ull) >> (64u - SHARD_BITS)];
+	}
+
+	const Shard &ShardOf(UTILS::CurrencyPair cp) const
+	{
+		return m_shards[(InstrumentId(cp) * 0x9E3779B97F4A7C15ull) >> (64u - SHARD_BITS)];
+	}
+
+	/** Key of a quote in its shard (the caller holds the shard's lock)
 	 *
-	 * This function DOES NOT LOCK the quote info map (@a m_activeQuoteMap).
-	 * Locking must be handled by the calling function.
+	 * Layout: instrument index (16 bits), side (1 bit), price (47 bits).
 	 *
-	 * @param it Iterator pointing to the quote info to be replaced. If the
-	 * iterator is not valid, the new quote is inserted with @a emplace.
-	 * @param newId New ID for the quote info
-	 * @param newQuote R-Value reference to the new quote info pointer
-	 * @return Unique pointer to the previous quote info (that was replaced
-	 * with the new one)
+	 * @return The key, or @a NO_KEY if the quote cannot be identified or its instrument has no index in the shard
 	 */
-	QuoteInfoPtr ReplaceQuoteInfoAt(QuoteMap::iterator it, const std::string &newId, QuoteInfoPtr &&newQuote);
+	static uint64_t FindKey(const Shard &shard, UTILS::CurrencyPair cp, UTILS::QuoteType side, int64_t price);
+
+	/** Key of a quote in its shard, assigning an index to an instrument seen for the first time (see @a FindKey) */
+	static uint64_t AddKey(Shard &shard, UTILS::CurrencyPair cp, UTILS::QuoteType side, int64_t price);
+
+	static constexpr uint64_t NO_KEY = ~0ull; //!< Key of a quote that cannot be identified
+
+	std::array<Shard, SHARD_COUNT> m_shards;
 };
 
-}
\ No newline at end of file
+}
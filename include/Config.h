@@ -31,6 +31,20 @@ const std::string ATTR_DEPTH = "depth";
 const std::string ATTR_PROTOCOL = "protocol";
 const std::string ATTR_PASSPHRASE = "passphrase";
 const std::string ATTR_SCHEMA = "schema";
+const std::string PARAM_ATTR_BookMode = "book_mode"; // "levels" (default) or "quotes"
+const std::string PARAM_ATTR_ReadMode = "read_mode"; // how the readers access the book of the venue: "locking" (default) or "snapshot"
+const std::string PARAM_ATTR_MaxQuoteCount = "max_quote_count"; // levels kept per side in book mode "levels" (default 0: unbounded)
+const std::string PARAM_ATTR_SignalDepth = "signal_depth"; // best levels per side summed into the published depth imbalance (default 5)
+const std::string PARAM_ATTR_MaxQuoteAge = "max_quote_age"; // quotes/levels unchanged for longer are evicted from the book (default "1m", "0": never)
+const std::string PARAM_ATTR_CleanupInterval = "cleanup_interval"; // interval between two evictions of stale quotes (default "10s")
+const std::string PARAM_ATTR_WorkerThreads = "worker_threads"; // threads handling market data messages, in parallel per instrument (default 1)
+const std::string PARAM_ATTR_CheckpointPath = "checkpoint_path"; // file of the book checkpoints restored at startup, qualified by the session name (default empty: no checkpoints)
+const std::string PARAM_ATTR_CheckpointInterval = "checkpoint_interval"; // interval between two book checkpoints (default "10s")
+const std::string PARAM_ATTR_FrameSlabs = "frame_slabs"; // slabs the frames of a market data session are received into (default 8, 0: frames are copied)
+const std::string PARAM_ATTR_FrameSlabSize = "frame_slab_size"; // bytes per slab, at least the largest frame of the venue (default 10000000)
+const std::string PARAM_ATTR_ShmRingPath = "shm_ring_path"; // ring file publishing the L2 books to other processes, qualified by the session name (default empty: not published)
+const std::string PARAM_ATTR_ShmRingCapacity = "shm_ring_capacity"; // records held by the ring, a power of 2 (default 65536)
+const std::string PARAM_ATTR_ShmSnapshotInterval = "shm_snapshot_interval"; // records between two snapshots written to the ring (default 16384)
 
 
 const int ATTR_RECVWINDOW_DEFAULT = 5000;
@@ -5,6 +5,7 @@
 #include "Utils/Logging.h"
 #include "Utils/MessageData.h"
 #include "Utils/ErrorHandler.h"
+#include "Utils/FrameSlabPool.h"
 #include "Utils/Result.h"
 
 #include <Poco/DOM/Node.h>
@@ -33,6 +34,8 @@ namespace CORE {
 
 namespace CRYPTO {
 const size_t MAX_BUFF = 10000000;  // 10MB buffer for large WebSocket messages (e.g., level2 snapshots)
+// Default number of slabs the frames of a market data session are received into; a frame holds its slab until it has been handled
+const size_t FRAME_SLABS = 8;
 const std::string JSON_ERROR_NOT_IMPLEMENTED = CreateJSONMessageWithCode("Not implemented");
 // If connection thread has more exceptions in a row than this, connection breaks:
 const int MAX_NUMBER_OF_EXCEPTIONS_IN_CONNECTION_THREAD = 100;
@@ -112,6 +115,35 @@ public:
 
 protected:
 	
+	/*! \brief Number of threads of the message processor (see MessageProcessor::Start)
+	*
+	* Handlers share the state of the connection, so messages are handled by one
+	* thread unless a derived class keeps its state per sequence tag.
+	* */
+	virtual size_t GetWorkerThreads() const
+	{
+		return 1;
+	}
+	
+	/*! \brief Number of slabs received frames are handed to the message processor in (see UTILS::FrameSlabPool)
+	*
+	* 0 -> no slabs: frames are received into the own buffer and copied, which
+	* suits the sessions receiving few frames (e.g. order sessions).
+	* */
+	virtual size_t GetFrameSlabs() const
+	{
+		return 0;
+	}
+	
+	/*! \brief Size of a slab, the largest frame received without a copy
+	*
+	* Frames are read in one piece, so a slab must hold the largest frame of the venue.
+	* */
+	virtual size_t GetFrameSlabSize() const
+	{
+		return MAX_BUFF;
+	}
+	
 	/*! \brief Creates internal websocket */
 	virtual void CreateWebSocket();
 	
@@ -153,7 +185,11 @@ private:
 	using MessageQueue = std::queue<std::shared_ptr<JSONDocument>>;
 	MessageQueue m_messageQueue;
 	
-	char m_buffer[MAX_BUFF] { };
+	/*! \brief Slabs received frames are handed to the message processor in, without copying
+	 * (created on the first connect, see GetFrameSlabs) */
+	std::shared_ptr<UTILS::FrameSlabPool> m_framePool;
+	
+	std::unique_ptr<char[]> m_buffer; // Receives frames while all slabs are being handled (allocated on the first connect)
 	std::string m_fragmentedMessage; // Accumulator for fragmented WebSocket messages
 
 	std::unique_ptr<std::thread> m_listenerThread;
@@ -2,6 +2,8 @@
 
 #include "ConnectionBase.h"
 #include "ActiveQuoteTable.h"
+#include "OrderBook/ConsolidatedBook.h"
+#include "OrderBook/ShmPublisher.h"
 
 namespace CORE {
 
@@ -31,19 +33,159 @@ public:
 		return GetSettings().m_depth;
 	}
 	
-	/*! \brief Subscribe to a specific instrument for market data */
-	UTILS::BoolResult SubscribeInstrument(const std::string &symbol);
+	/*! \brief Subscribe to a specific instrument for market data
+	 *
+	 * @return Handle of the instrument's order book shard, valid for the lifetime of the order book
+	 * */
+	UTILS::Result<BOOK::InstrumentBook::Ptr> SubscribeInstrument(const std::string &symbol);
 	
 	/*! \brief Unsubscribe from a specific instrument */
 	UTILS::BoolResult UnsubscribeInstrument(const std::string &symbol);
 	
-	/*! \brief Parse quote from price levels */
-	UTILS::BookUpdate::Ptr ParseQuote(PriceMessage::Levels &levels, const char side, const std::string &instrument);
+	/*! \brief Venue of this connection (the exchange part of the schema, e.g. 'Binance' of 'Binance:MD') */
+	const std::string &GetVenue() const
+	{
+		return m_venue;
+	}
+	
+	/*! \brief Order book of the venue of this connection */
+	const BOOK::ConsolidatedBook::VenueBookPtr &GetOrderBook() const
+	{
+		return m_orderBook;
+	}
+	
+	/*! \brief Book mode of the instruments of this connection
+	 *
+	 * The depth channels of the supported venues send price levels, so the
+	 * instruments are kept as compact L2 levels unless the session parameter
+	 * 'book_mode' is set to 'quotes' (order-level data). The parameter is read
+	 * once, when the connection is created.
+	 * */
+	BOOK::InstrumentBook::Mode GetBookMode() const
+	{
+		return m_bookMode;
+	}
+	
+	/*! \brief Maximum number of price levels kept per side of an instrument (0 -> unbounded)
+	 *
+	 * Set by the session parameter 'max_quote_count'; the grid only needs the
+	 * first few levels, so deep snapshots (e.g. Binance limit=1000) need not
+	 * be kept beyond them.
+	 * */
+	virtual size_t GetMaxLevels() const
+	{
+		return size_t(std::max(0L, std::strtol(GetSettings().GetParameter(PARAM_ATTR_MaxQuoteCount, "0").c_str(), nullptr, 10)));
+	}
+	
+	/*! \brief Number of best levels per side whose volume is published with the top of book
+	 *
+	 * Set by the session parameter 'signal_depth' (see BOOK::OrderBook::SetSignalDepth).
+	 * */
+	virtual size_t GetSignalDepth() const
+	{
+		return size_t(std::max(1L, std::strtol(GetSettings().GetParameter(PARAM_ATTR_SignalDepth, "5").c_str(), nullptr, 10)));
+	}
+	
+	/*! \brief Maximum age of a quote in nanoseconds, 0 -> quotes are never evicted (session parameter 'max_quote_age')
+	 *
+	 * A feed that stops sending leaves its quotes in the book; quotes unchanged
+	 * for longer are evicted (see BOOK::OrderBook::SetQuoteExpiry).
+	 * */
+	int64_t GetMaxQuoteAge() const
+	{
+		return UTILS::StringToNanoseconds(GetSettings().GetParameter(PARAM_ATTR_MaxQuoteAge, DFLT_MAX_QUOTE_AGE));
+	}
+	
+	/*! \brief Interval between two evictions of stale quotes in nanoseconds (session parameter 'cleanup_interval') */
+	int64_t GetCleanupInterval() const
+	{
+		return UTILS::StringToNanoseconds(GetSettings().GetParameter(PARAM_ATTR_CleanupInterval, DFLT_CLEANUP_INTERVAL));
+	}
+	
+	/*! \brief Number of threads handling the market data messages
+	 *
+	 * Set by the session parameter 'worker_threads'. Messages are tagged by
+	 * instrument (see MessageProcessor::RegisterSequenceTagDetector), so the
+	 * updates of one instrument stay in order while different instruments are
+	 * applied in parallel.
+	 * */
+	size_t GetWorkerThreads() const override
+	{
+		return size_t(std::max(1L, std::strtol(GetSettings().GetParameter(PARAM_ATTR_WorkerThreads, "1").c_str(), nullptr, 10)));
+	}
+	
+	/*! \brief Number of slabs the frames are received into (session parameter 'frame_slabs') */
+	size_t GetFrameSlabs() const override
+	{
+		return size_t(std::max(0L, std::strtol(GetSettings().GetParameter(PARAM_ATTR_FrameSlabs, std::to_string(FRAME_SLABS)).c_str(), nullptr, 10)));
+	}
+	
+	/*! \brief Size of a slab (session parameter 'frame_slab_size')
+	 *
+	 * The level2 snapshots of Coinbase take several MB; venues sending small
+	 * frames only (depth updates) can reserve much smaller slabs.
+	 * */
+	size_t GetFrameSlabSize() const override
+	{
+		const long size { std::strtol(GetSettings().GetParameter(PARAM_ATTR_FrameSlabSize, std::to_string(MAX_BUFF)).c_str(), nullptr, 10) };
+		return size > 0 ? std::min(size_t(size), MAX_BUFF) : MAX_BUFF;
+	}
+	
+	/*! \brief File of the book checkpoints (session parameter 'checkpoint_path', empty -> no checkpoints)
+	 *
+	 * The session name is appended to the configured path ('<path>.<session>'),
+	 * so sessions configured with the same path never restore each other's books.
+	 * */
+	std::string GetCheckpointPath() const
+	{
+		const std::string path { GetSettings().GetParameter(PARAM_ATTR_CheckpointPath, "") };
+		return path.empty() ? path : path + "." + GetSettings().m_name;
+	}
+	
+	/*! \brief Interval between two book checkpoints in nanoseconds (session parameter 'checkpoint_interval') */
+	int64_t GetCheckpointInterval() const
+	{
+		return UTILS::StringToNanoseconds(GetSettings().GetParameter(PARAM_ATTR_CheckpointInterval, "10s"));
+	}
+	
+	/*! \brief Ring file publishing the books of this session to other processes (session parameter 'shm_ring_path', empty -> not published)
+	 *
+	 * Like the checkpoint file, it is qualified by the session name ('<path>.<session>').
+	 * */
+	std::string GetShmRingPath() const
+	{
+		const std::string path { GetSettings().GetParameter(PARAM_ATTR_ShmRingPath, "") };
+		return path.empty() ? path : path + "." + GetSettings().m_name;
+	}
+	
+	/*! \brief Appends the entries of the price levels of one side to a book update
+	 *
+	 * All levels of a message go into one update, so that PublishQuotes applies
+	 * the message to the book at once and readers never see one side applied
+	 * without the other.
+	 * */
+	void ParseQuote(UTILS::BookUpdate &nmd, const LevelView *levels, size_t levelCount, const char side, UTILS::CurrencyPair cp);
+	
+	/*! \brief Parse quote from both sides of a message into one book update */
+	UTILS::BookUpdate::Ptr ParseQuote(const PriceMessage &msg, const std::string &instrument)
+	{
+		UTILS::BookUpdate::Ptr nmd { std::make_unique<UTILS::BookUpdate>() };
+		const UTILS::CurrencyPair cp { GetCurrencyPair(instrument) };
+		nmd->entries.reserve(msg.Bids.size() + msg.Asks.size());
+		ParseQuote(*nmd, msg.Bids.data(), msg.Bids.size(), UTILS::QuoteType::BID, cp);
+		ParseQuote(*nmd, msg.Asks.data(), msg.Asks.size(), UTILS::QuoteType::OFFER, cp);
+		return nmd;
+	}
 	
 	/*! \brief Start market data connection - subscribes to instruments */
 	void Start() override
 	{
 		const auto instruments = GetInstruments();
+		for (const auto &instrument: instruments)
+		{
+			AddInstrumentBook(GetCurrencyPair(TranslateSymbol(instrument)));
+		}
+		RestoreCheckpoint(instruments);
 		Snapshot(instruments);
 		Subscribe(instruments);
 	}
@@ -59,22 +201,19 @@ public:
 	/*! \brief Unsubscribe from market data for instruments */
 	virtual void Unsubscribe(const TInstruments &instruments) { };
 	
-	/*! \brief Helper to translate side of order book from JSON */
+	/*! \brief Helper to translate side of order book from JSON (the levels refer to the frame of \a jd) */
 	virtual void SideTranslator(const char *side, PriceMessage::Levels &depth, const std::shared_ptr<JSONDocument> jd) const
 	{
-		if (auto levels = jd->GetArray(side))
+		jd->Get(side).ForEachElement([&depth](const UTILS::JsonValue &level, bool &)
 		{
-			Poco::Dynamic::Array da = *levels;
-			for (size_t i = 0; i < levels->size(); ++i)
-			{
-				depth.emplace_back(std::make_shared<Level>());
-				depth.back()->price = da[i][0].toString();
-				depth.back()->size = da[i][1].toString();
-			}
-		}
+			depth.push_back({ level.At(0).Raw(), level.At(1).Raw() });
+		});
 	}
 	
-	/*! \brief Parse market data message from JSON */
+	/*! \brief Parse market data message from JSON
+	 *
+	 * The message refers to the frame of \a jd and must not outlive it.
+	 * */
 	virtual std::unique_ptr<PriceMessage> ParseMessage(const std::shared_ptr<JSONDocument> jd, 
 	                                                     const std::string &bidName, const std::string &askName) const
 	{
@@ -85,13 +224,54 @@ public:
 	}
 
 protected:
+	/*! \brief Warm start: restores the books of the instruments from the last checkpoint, then saves checkpoints periodically
+	 *
+	 * Called before the instruments are subscribed. The restored levels are
+	 * provisional (see BOOK::OrderBook::RestoreLevels) until the feed has
+	 * reconciled them; feeds that cannot reconcile them (see ReconcilesCheckpoint)
+	 * only save checkpoints.
+	 * */
+	void RestoreCheckpoint(const TInstruments &instruments);
+	
+	/*! \brief Can the feed reconcile levels restored from a checkpoint with its live updates or replace them by a snapshot? */
+	virtual bool ReconcilesCheckpoint() const { return false; }
+	
+	/*! \brief Called for each instrument restored from the checkpoint, before the instrument is subscribed
+	 * @param cp: currency pair
+	 * @param updateId: venue update ID of the last message applied to the restored levels
+	 * */
+	virtual void OnCheckpointRestored(UTILS::CurrencyPair cp, int64_t updateId) { }
+	
+	/*! \brief Returns the order book shard of a subscribed instrument, or nullptr */
+	BOOK::InstrumentBook::Ptr FindInstrumentBook(UTILS::CurrencyPair cp) const;
+	
+	/*! \brief Obtains the order book shard of an instrument and adds it to the shard handles */
+	BOOK::InstrumentBook::Ptr AddInstrumentBook(UTILS::CurrencyPair cp);
+	
 	/*! \brief Publish individual quote entry */
 	UTILS::BoolResult PublishQuote(int64_t key, int64_t refKey, int64_t timestamp,
 	                                int64_t receiveTime, UTILS::CurrencyPair cp, const UTILS::BookUpdate::Entry &entry);
+	
+	/*! \brief Publish individual quote entry to the shard of its instrument */
+	UTILS::BoolResult PublishQuote(BOOK::InstrumentBook &book, int64_t key, int64_t refKey, int64_t timestamp,
+	                                int64_t receiveTime, const UTILS::BookUpdate::Entry &entry);
 
 private:
+	/*! \brief Map of order book shards of the subscribed instruments */
+	using InstrumentBookMap = std::map<UTILS::CurrencyPair, BOOK::InstrumentBook::Ptr>;
+	
 	CORE::ActiveQuoteTable m_activeQuoteTable;
 	
+	const std::string m_venue; //!< Venue of this connection, tagging its quotes (originator)
+	const BOOK::ConsolidatedBook::VenueBookPtr m_orderBook; //!< Order book of the venue, fed by this connection only
+	const BOOK::InstrumentBook::Mode m_bookMode; //!< Book mode of the instruments (see GetBookMode)
+	std::unique_ptr<ORDERBOOK::ShmPublisher> m_shmPublisher; //!< Publishes the instruments' books to other processes (see GetShmRingPath)
+	
+	/*! \brief Shard handles, replaced as a whole (copy on write) when an instrument is added, so that
+	 * publishing quotes only reads an immutable map owned by this connection */
+	std::shared_ptr<const InstrumentBookMap> m_instrumentBooks { std::make_shared<InstrumentBookMap>() };
+	std::mutex m_instrumentBooksMutex; //!< Serializes writers of m_instrumentBooks
+	
 	// Number of published quotes
 	std::atomic<unsigned long> m_publishedQuotesCounter { 0 };
 	mutable std::atomic<unsigned long> m_publishedQuotesOld { 0 }; // to calculate delta
@@ -8,7 +8,7 @@
 #include "Utils/Logging.h"
 #include "ConnectionBase.h"
 #include "RestConnectionBase.h"
-#include "OrderBook/OrderBook.h"
+#include "OrderBook/ConsolidatedBook.h"
 #include "Utils/ErrorHandler.h"
 
 namespace CORE {
@@ -20,7 +20,7 @@ namespace CORE {
 class ConnectionManager final : UTILS::Logging, public UTILS::ErrorHandler
 {
 public:
-	ConnectionManager(const std::string& configPath, const std::string& loggingPropsPath, std::shared_ptr<BOOK::OrderBook> orderBook);
+	ConnectionManager(const std::string& configPath, const std::string& loggingPropsPath, BOOK::ConsolidatedBook::Ptr books);
 
 	~ConnectionManager() {
 		Disconnect();
@@ -53,8 +53,15 @@ public:
 		return m_settingsCollection;
 	}
 
-	std::shared_ptr<BOOK::OrderBook> GetOrderBook() const {
-		return m_orderBook;
+	/*! \brief Returns the order book of a venue (created on first call, with the given read mode) */
+	BOOK::ConsolidatedBook::VenueBookPtr GetOrderBook(const std::string &venue,
+													  BOOK::OrderBook::ReadMode readMode = BOOK::OrderBook::ReadMode::Locking) const {
+		return m_books->AddVenue(venue, readMode);
+	}
+
+	/*! \brief Returns the consolidated book holding the order books of all venues */
+	BOOK::ConsolidatedBook::Ptr GetBooks() const {
+		return m_books;
 	}
 
 	// Load sessions settings..
@@ -94,7 +101,7 @@ private:
 	TSessionsInstruments m_sessionsInstruments;
 
 	std::map<std::string, std::shared_ptr<CRYPTO::IConnection>> m_connections;
-	std::shared_ptr<BOOK::OrderBook> m_orderBook;
+	BOOK::ConsolidatedBook::Ptr m_books; // order books per venue
 	std::string m_orderConnection; //Name of order connection
 	std::shared_ptr<OrderManager> m_orderManager; // Reference to OrderManager for WebSocket order updates
 }; // ConnectionManager
@@ -4,28 +4,46 @@
 //
 #pragma once
 
+#include <string_view>
+
 #include "JSONDocument.h"
+#include "Utils/Arena.h"
 
 namespace CORE {
 namespace CRYPTO {
-struct Level
+/*! \brief Price level of a depth message: the price and size as written in the frame
+ *
+ * The views refer to the bytes of the received frame, so a level must not
+ * outlive the JSONDocument it was read from.
+ */
+struct LevelView
 {
-	Level() { }
-	
-	Level(std::string &p, std::string &s)
-			: price(p), size(s) { }
-	
-	std::string price;
-	std::string size;
+	std::string_view price;
+	std::string_view size;
 };
 
-// Price msg, can be snapshot or incremental update
+/*! \brief Price msg, can be snapshot or incremental update
+ *
+ * The levels of both sides are filled straight from the frame into an arena
+ * owned by the message: the first levels fit into the message itself, deeper
+ * snapshots take a few blocks from the heap, and none of them owns a copy of
+ * its price or size.
+ */
 class PriceMessage
 {
 public:
-	using Levels = std::vector<std::shared_ptr<Level>>;
-	Levels Bids;
-	Levels Asks;
+	using Levels = UTILS::ArenaArray<LevelView>;
+	
+	/*! \brief Size of the buffer held by the message (room for 128 levels) */
+	static constexpr size_t INLINE_SIZE = 4096;
+
+private:
+	alignas(std::max_align_t) char m_buffer[INLINE_SIZE];
+	UTILS::Arena m_arena { m_buffer, sizeof(m_buffer) };
+
+public:
+	Levels Bids { m_arena };
+	Levels Asks { m_arena };
 };
 
 typedef const std::tuple<std::string, std::string, std::string, std::string> AuthHeader;
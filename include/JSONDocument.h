@@ -5,11 +5,17 @@
 #pragma once
 
 #include <iostream>
+#include <limits>
+#include <mutex>
 #include <string>
+#include <string_view>
+#include <type_traits>
 #include <Poco/JSON/JSON.h>
 #include <Poco/JSON/Object.h>
 #include <Poco/JSON/Parser.h>
 #include <Poco/Dynamic/Var.h>
+#include <Utils/FrameSlabPool.h>
+#include <Utils/JsonReader.h>
 #include <Utils/Result.h>
 
 namespace CORE {
@@ -28,48 +34,152 @@ struct JSONError
 	long code;
 };
 
+/*! \brief This class holds a JSON document (a received frame) and reads it on demand.
+ *
+ * The document is not parsed when it is created: \a Root, \a Get, \a GetValue
+ * and \a Has navigate the frame's bytes with \a UTILS::JsonValue, which scans
+ * only up to the requested field and allocates nothing but the returned
+ * strings. The Poco tree is built on the first call of \a GetArray,
+ * \a GetSubObject or \a GetJsonObject (and for the conversions \a GetValue does
+ * not handle itself), for the code paths that still walk it.
+ *
+ * A frame received into a slab (see \a FromSlab) is not copied: the document
+ * views the slab's bytes and lives in the slab's header.
+ */
 class JSONDocument
 {
+	/*! \brief passkey of the constructor used by FromSlab */
+	struct SlabKey
+	{
+		explicit SlabKey() = default;
+	};
+
 public:
-	explicit JSONDocument(const std::string &document)
+	explicit JSONDocument(std::string document)
+			: m_document(std::move(document)), m_text(m_document), m_root(UTILS::JsonValue::Parse(m_text))
+	{
+	}
+	
+	/*! \brief constructor of a document viewing a frame it does not own (see FromSlab) */
+	JSONDocument(std::string_view frame, SlabKey) noexcept
+			: m_text(frame), m_root(UTILS::JsonValue::Parse(m_text))
+	{
+	}
+	
+	/*! \brief creates a document viewing the frame received into a slab
+	* The document and its control block are placed in the slab's header, and the
+	* slab goes back to its pool when the last reference to the document is dropped.
+	* @param slab: slab holding the frame (see UTILS::FrameSlab::SetSize)
+	* @return: the document (never nullptr)
+	* */
+	static std::shared_ptr<JSONDocument> FromSlab(UTILS::FrameSlabPool::SlabPtr slab)
 	{
-		m_parser.parse(document);
-		auto result = m_parser.result();
-		m_jsonObject = result.extract<Poco::JSON::Object::Ptr>();
+		UTILS::FrameSlab *frame { slab.get() };
+		auto document = std::allocate_shared<JSONDocument>(UTILS::FrameSlabAllocator<JSONDocument>(frame), frame->View(), SlabKey());
+		slab.release(); // the control block returns the slab from now on
+		return document;
 	}
 	
+	JSONDocument(const JSONDocument &) = delete;
+	
+	JSONDocument &operator=(const JSONDocument &) = delete;
+	
+	/*! \brief returns the text of the document (valid as long as the document) */
+	std::string_view Text() const
+	{
+		return m_text;
+	}
+	
+	/*! \brief returns the on-demand view of the root value (valid as long as the document) */
+	const UTILS::JsonValue &Root() const
+	{
+		return m_root;
+	}
+	
+	/*! \brief returns the on-demand view of a member of the root object */
+	UTILS::JsonValue Get(std::string_view name) const
+	{
+		return m_root[name];
+	}
+	
+	/*! \brief returns the value of a member converted as Poco::Dynamic::Var::convert<T> does,
+	* or T() if the member is missing or null */
 	template <typename T>
 	T GetValue(const std::string &name) const
 	{
-		Poco::Dynamic::Var var = m_jsonObject->get(name); // Get the member Variable
+		const UTILS::JsonValue value { m_root[name] };
+		if (T result; Convert(value, result))
+		{
+			return result;
+		}
+		if (value.IsNull() || (!value.Valid() && m_root.IsObject()))
+		{
+			return T(); // missing member
+		}
+		// other conversions (and documents that are not an object) take the Poco path
+		Poco::Dynamic::Var var = GetJsonObject()->get(name); // Get the member Variable
 		return var.isEmpty() ? T() : var.convert<T>();
 	}
 	
 	Poco::JSON::Array::Ptr GetArray(const std::string &name) const
 	{
-		return m_jsonObject->getArray(name); // Get the member Variable;
+		return GetJsonObject()->getArray(name); // Get the member Variable;
 	}
 	
 	/*! \brief returns subobject by name */
 	Poco::JSON::Object::Ptr GetSubObject(const std::string &name) const
 	{
-		return m_jsonObject->get(name).extract<Poco::JSON::Object::Ptr>();
+		return GetJsonObject()->get(name).extract<Poco::JSON::Object::Ptr>();
 	}
 	
 	/*! \brief returns true if field exists */
 	bool Has(const std::string &name) const
 	{
-		return m_jsonObject->has(name);
+		return m_root[name].Valid();
 	}
 	
+	/*! \brief returns the Poco tree of the document (parsed on the first call) */
 	Poco::JSON::Object::Ptr GetJsonObject() const
 	{
+		std::call_once(m_parsed, [this]()
+		{
+			Poco::JSON::Parser parser;
+			m_jsonObject = parser.parse(m_document.empty() ? std::string(m_text) : m_document).extract<Poco::JSON::Object::Ptr>();
+		});
 		return m_jsonObject;
 	}
 
 private:
-	Poco::JSON::Parser m_parser;
-	Poco::JSON::Object::Ptr m_jsonObject;
+	/*! \brief converts the values the on-demand reader handles; false for any other value or type */
+	template <typename T>
+	static bool Convert(const UTILS::JsonValue &value, T &result)
+	{
+		if constexpr (std::is_same_v<T, std::string> || std::is_same_v<T, bool> || std::is_same_v<T, double>)
+		{
+			return value.Get(result);
+		}
+		else if constexpr (std::is_integral_v<T>)
+		{
+			int64_t i { 0 };
+			if (value.Get(i) && i >= int64_t(std::numeric_limits<T>::min())
+				&& (i < 0 || uint64_t(i) <= uint64_t(std::numeric_limits<T>::max())))
+			{
+				result = T(i);
+				return true;
+			}
+			return false;
+		}
+		else
+		{
+			return false;
+		}
+	}
+	
+	std::string m_document; //!< Text of a document that owns it (empty for a frame in a slab)
+	std::string_view m_text; //!< Text of the document (m_document or the slab's bytes)
+	UTILS::JsonValue m_root; //!< Refers to m_text
+	mutable std::once_flag m_parsed;
+	mutable Poco::JSON::Object::Ptr m_jsonObject;
 };
 
 
@@ -82,7 +192,9 @@ inline std::shared_ptr<JSONDocument> ParseJson(const std::string &json)
 {
 	try
 	{
-		return std::make_shared<JSONDocument>(json);
+		auto document = std::make_shared<JSONDocument>(json);
+		document->GetJsonObject(); // validates the document
+		return document;
 	}
 	catch (std::exception &e)
 	{
@@ -6,6 +6,7 @@
 
 #include <memory>
 #include <algorithm>
+#include <string_view>
 
 #include "Poco/Logger.h"
 #include "Poco/FileChannel.h"
@@ -94,6 +95,15 @@ public:
 		m_logger.information("\"in\":%s", msg);
 	}
 	
+	/*! \brief Logs a received frame, copying it only if the level is enabled */
+	void Incoming(std::string_view msg) const
+	{
+		if (m_logger.information())
+		{
+			Incoming(std::string(msg));
+		}
+	}
+	
 	void Outging(const std::string &msg) const
 	{
 		m_logger.information("\"out\":%s", msg);
@@ -13,8 +13,17 @@ namespace CRYPTO {
 
 using TMessageTypeDetector = std::function<std::string(const std::shared_ptr<JSONDocument> message)>;
 using TMessageHandler = std::function<void(const std::shared_ptr<CRYPTO::JSONDocument>)>;
+using TSequenceTagDetector = std::function<std::string(const std::shared_ptr<JSONDocument> message)>;
 
-/*! \brief Message processor for JSON messages */
+/*! \brief Message processor for JSON messages
+ *
+ * Messages are handled by a pool of worker threads. Each message is tagged
+ * with its sequence tag (e.g. the instrument it refers to, see
+ * @a RegisterSequenceTagDetector): messages of the same tag are handled one
+ * after the other, in order of arrival, while messages of different tags are
+ * handled in parallel. Without a sequence tag detector, all messages share
+ * the empty tag and are handled serially, whatever the number of workers.
+ * */
 class MessageProcessor final : UTILS::Logging, UTILS::ErrorHandler
 {
 public:
@@ -34,6 +43,18 @@ public:
 	
 	void Register(TMessageTypeDetector messageTypeDetector);
 	
+	/*! \brief Registers the detector of the sequence tag of a message
+	* Handlers of messages with different tags may run in parallel, so the
+	* state they share must be synchronized or be kept per tag.
+	* */
+	void RegisterSequenceTagDetector(TSequenceTagDetector sequenceTagDetector);
+	
+	/*! \brief detects the sequence tag of a JSON message
+	* @param message: JSON document
+	* @return: sequence tag, empty if no detector is registered or the message refers to no instrument
+	* */
+	std::string GetSequenceTag(const std::shared_ptr<CRYPTO::JSONDocument> message) const;
+	
 	UTILS::BoolResult Register(const std::string &msgType, const TMessageHandler handler);
 	
 	/*! \brief This method should be called to process incoming messages
@@ -51,8 +72,10 @@ public:
 	/*! \brief Returns a number of registered message handlers */
 	size_t Size() const;
 	
-	/*! \brief Starts message processor. It must be started before processing any messages */
-	void Start();
+	/*! \brief Starts message processor. It must be started before processing any messages
+	* @param workerThreads: number of threads handling the messages (default: 1)
+	* */
+	void Start(size_t workerThreads = 1);
 	
 	/*! \brief Stops message processor */
 	void Stop();
@@ -64,12 +87,22 @@ public:
 	* @return: true in success, error if message or handler is nullptr
 	* */
 	UTILS::BoolResult Enqueue(const std::shared_ptr<JSONDocument> message, const TMessageHandler handler);
+	
+	/*! \brief Explicitly enqueues a JSON document and a handler with a given sequence tag
+	* This is convenient when the message itself does not carry its tag (e.g. a snapshot downloaded via REST)
+	* @param message: JSON document
+	* @param handler: message handler
+	* @param sequenceTag: sequence tag (see GetSequenceTag)
+	* @return: true in success, error if message or handler is nullptr
+	* */
+	UTILS::BoolResult Enqueue(const std::shared_ptr<JSONDocument> message, const TMessageHandler handler, const std::string &sequenceTag);
 
 private:
 	UTILS::BackgroundWorker<const std::shared_ptr<JSONDocument>, TMessageHandler> m_messageQueue;
 	using TMessageHandlers = std::unordered_map<std::string, std::function<void(const std::shared_ptr<JSONDocument>)>>;
 	TMessageHandlers m_messageHandlers;
 	TMessageTypeDetector m_messageTypeDetector;
+	TSequenceTagDetector m_sequenceTagDetector;
 };
 
 }
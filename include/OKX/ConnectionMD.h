@@ -41,6 +41,12 @@ namespace OKX {
 
         void Subscribe(const CRYPTO::ConnectionBase::TInstruments& instruments, const std::string& method);
 
+		/*! \brief The books channel starts with a full snapshot, which replaces the levels restored from a checkpoint */
+		bool ReconcilesCheckpoint() const override
+		{
+			return true;
+		}
+
 		void SideTranslator(const char *side, CRYPTO::PriceMessage::Levels &depth, const std::shared_ptr<CRYPTO::JSONDocument> jd) const override;
     };
 	
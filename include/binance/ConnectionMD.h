@@ -1,5 +1,8 @@
 #pragma once
 
+#include <deque>
+
+#include "Utils/Lockable.h"
 #include "Definitions.h"
 #include "ConnectionBaseMD.h"
 #include "JSONDocument.h"
@@ -42,7 +45,6 @@ public:
 	}
 
 protected:
-	int64_t m_lastUpdateId;
 	std::unique_ptr<CORE::BINANCE::ConnectionSS> m_connectionSS; //REST Connector for Snapshot.
 	
 	/*! \brief called when Result message received
@@ -62,26 +64,74 @@ protected:
 	 void Start() override
 	{
 		const auto instruments = GetInstruments();
+		RestoreCheckpoint(instruments); //restored books are reconciled with the first depth updates..
 		Subscribe(instruments); //Binance we need to subscribe to stream and enqueue msgs until Snapshot is completed..
 		Snapshot(instruments);
 	}
 	
+	/*! \brief The update IDs of the depth stream tell whether restored levels are continued by the live updates */
+	bool ReconcilesCheckpoint() const override
+	{
+		return true;
+	}
+	
+	void OnCheckpointRestored(UTILS::CurrencyPair cp, int64_t updateId) override;
+	
 	void Snapshot(const CRYPTO::ConnectionBase::TInstruments &instruments) override;
 	
 	/*! \brief subscribe/unsubscribe helper
 	* @param instruments: list of instruments separated by comma
 	* @param method: SUBSCRIBE or UNSUBSCRIBE
+	* @param levels: levels of the partial depth stream, 0 -> diff depth; partial depth messages carry no
+	*                symbol, so it is subscribed for a single symbol, any other symbol gets diff depth
 	* */
 	void Subscribe(const CRYPTO::ConnectionBase::TInstruments &instruments, const std::string &method, unsigned int levels = 0);
 
 private:
-	void DepthUpdate(const std::shared_ptr<CRYPTO::JSONDocument> jd);
+	/*! \brief Depth stream state of one instrument
+	*
+	* Messages are sequenced by symbol (see MessageProcessor::RegisterSequenceTagDetector),
+	* so the state of an instrument is only touched by one worker thread at a time.
+	* */
+	struct DepthState
+	{
+		/*! \brief Outcome of the reconciliation of levels restored from a checkpoint */
+		enum Reconciliation
+		{
+			NotRestored, //!< The book has not been restored (a snapshot is needed)
+			Pending, //!< The book has been restored, no update has been received yet
+			Reconciled, //!< The first update continued the restored levels (no snapshot needed)
+			Failed //!< Updates have been missed since the checkpoint (a snapshot is needed)
+		};
+		
+		int64_t lastUpdateId { 0 }; //!< Update ID of the snapshot, then of the last applied update + 1
+		bool snapshotDone { false }; //!< Has the snapshot been applied?
+		bool stale { true }; //!< Are the updates older than the snapshot still to be dropped?
+		std::deque<std::shared_ptr<CRYPTO::JSONDocument>> pending; //!< Updates received before the snapshot
+		BOOK::InstrumentBook::Ptr book; //!< Order book shard of the symbol
+		std::atomic<Reconciliation> reconciliation { NotRestored }; //!< Read by the snapshot loop
+	};
+	
+	using DepthStateMap = std::unordered_map<std::string, std::shared_ptr<DepthState>>;
+	
+	/*! \brief Symbol of a depth message: field 's', or the symbol of the partial depth stream for its messages (which have none) */
+	std::string SymbolOf(const CRYPTO::JSONDocument &jd) const;
+	
+	/*! \brief Returns the depth state of a symbol (e.g. "BTCUSDT"), or nullptr if it has not been subscribed */
+	std::shared_ptr<DepthState> GetDepthState(const std::string &symbol) const;
+	
+	void DepthUpdate(DepthState &state, const std::shared_ptr<CRYPTO::JSONDocument> jd);
 	
 	//Parse Incremental update of 'n' diff depth...
-	void DepthNUpdate(const std::shared_ptr<CRYPTO::JSONDocument> jd);
+	void DepthNUpdate(DepthState &state, const std::shared_ptr<CRYPTO::JSONDocument> jd);
+	
+	/*! \brief Ends the provisional state of a restored book
+	* @param reconciled: true -> the live updates continue the restored levels, false -> a snapshot must replace them
+	* */
+	void EndProvisional(DepthState &state, bool reconciled);
 	
-	std::unordered_map<UTILS::CurrencyPair, bool> m_snapshot;
-	std::deque<std::shared_ptr<CRYPTO::JSONDocument>> m_messages;
+	UTILS::SharedLockable<DepthStateMap> m_depthStates; //!< Depth stream state per subscribed symbol
+	std::string m_partialDepthSymbol; //!< Symbol subscribed to a partial depth stream (guarded by the mutex of m_depthStates)
 };
 
 } // ns BINANCE
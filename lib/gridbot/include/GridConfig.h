@@ -16,6 +16,7 @@ public:
     bool LoadConfig(const UTILS::XmlDocPtr &pDoc);
 
     std::string m_instrument;
+    std::string m_venue; // venue whose book drives the market signals (venue part of the MD session's schema)
     double m_basePrice;
     int m_levelsBelow;
     int m_levelsAbove;
@@ -4,11 +4,13 @@
 #pragma once
 
 #include <memory>
+#include <mutex>
 #include <unordered_map>
 #include <vector>
 #include <string>
 
 #include "IOrderManager.h"
+#include "OrderBook/OrderBook.h"
 #include "Utils/CurrencyPair.h"
 #include "GridConfig.h"
 
@@ -27,6 +29,22 @@ namespace STRATEGY {
     void CheckFilledOrders();
     void PrintStatus();
 
+    // Hook for the notifier of the grid venue's book (see Venue): checks the fills
+    void OnBookUpdate(const UTILS::CurrencyPair& cp, const CORE::BOOK::TopOfBook::Snapshot& top);
+
+    // Venue whose book drives the market signals (config attribute 'venue')
+    const std::string& Venue() const { return m_cfg.m_venue; }
+
+    // Sets the book of the grid venue, before the strategy is started
+    void SetBook(std::shared_ptr<CORE::BOOK::OrderBook> book) { m_book = std::move(book); }
+
+    // Current market signals of the grid's instrument (spread, imbalance, microprice), read lock-free from the
+    // top-of-book record of the venue's book, so they are never older than the book
+    CORE::BOOK::TopOfBook::Snapshot Signals() const
+    {
+        return m_book ? m_book->GetTopOfBook(m_cp).Read() : CORE::BOOK::TopOfBook::Snapshot { };
+    }
+
   private:
     std::shared_ptr<CORE::IOrderManager> m_orderManager;
     GridConfig m_cfg;
@@ -36,5 +54,8 @@ namespace STRATEGY {
     std::unordered_map<std::string, OrderDetails> m_orderDetails;
     std::unordered_map<std::string, double> m_knownFills;
     UTILS::CurrencyPair m_cp;
+    std::shared_ptr<CORE::BOOK::OrderBook> m_book;
+    // guards the orders: the notifier's dispatch thread checks the fills, the main thread starts and prints the grid
+    mutable std::mutex m_mutex;
   };
 }
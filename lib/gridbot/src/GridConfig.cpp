@@ -5,6 +5,7 @@
 const std::string TAG_GRID_CONFIG = "GridConfig";
 
 const std::string ATTR_INSTRUMENT = "instrument";
+const std::string ATTR_VENUE = "venue";
 const std::string ATTR_BASE_PRICE = "base_price";
 const std::string ATTR_LEVELS_BELOW = "levels_below";
 const std::string ATTR_LEVELS_ABOVE = "levels_above";
@@ -34,6 +35,7 @@ bool GridConfig::LoadConfig(const UTILS::XmlDocPtr &pDoc)
 	 		poco_information_f1(logger(), "Reading %s attributes from XML", TAG_GRID_CONFIG);
 
 	 		m_instrument = UTILS::GetXmlAttribute(baseNode, ATTR_INSTRUMENT, "");
+	 		m_venue = UTILS::GetXmlAttribute(baseNode, ATTR_VENUE, "Coinbase");
 	 		
 	 		std::string basePriceStr = UTILS::GetXmlAttribute(baseNode, ATTR_BASE_PRICE, "0.0");
 	 		std::string levelsBelowStr = UTILS::GetXmlAttribute(baseNode, ATTR_LEVELS_BELOW, "0");
@@ -43,6 +45,7 @@ bool GridConfig::LoadConfig(const UTILS::XmlDocPtr &pDoc)
 	 		std::string maxPositionStr = UTILS::GetXmlAttribute(baseNode, ATTR_MAX_POSITION, "0.0");
 	 		
 	 		poco_information_f1(logger(), "instrument: %s", m_instrument);
+	 		poco_information_f1(logger(), "venue: %s", m_venue);
 	 		poco_information_f1(logger(), "base_price string: %s", basePriceStr);
 	 		
 	 		m_basePrice = std::stod(basePriceStr);
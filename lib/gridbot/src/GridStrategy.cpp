@@ -13,6 +13,7 @@ using namespace std;
 namespace STRATEGY {
   void GridStrategy::Start()
   {
+    std::lock_guard lock { m_mutex };
     double base = m_cfg.m_basePrice;
     double step = m_cfg.m_stepPercent;
 
@@ -37,6 +38,7 @@ namespace STRATEGY {
 
   void GridStrategy::CheckFilledOrders()
   {
+    std::lock_guard lock { m_mutex };
     vector<string> toRemove; // store orders to remove after iteration
 
     poco_information(logger(), "Checking filled state...");
@@ -187,9 +189,18 @@ namespace STRATEGY {
     }
   }
 
+  void GridStrategy::OnBookUpdate(const UTILS::CurrencyPair& cp, const CORE::BOOK::TopOfBook::Snapshot& top)
+  {
+    CheckFilledOrders();
+  }
+
   void GridStrategy::PrintStatus()
   {
+    const CORE::BOOK::TopOfBook::Snapshot signals { Signals() };
+    std::lock_guard lock { m_mutex };
     poco_information_f1(logger(), "Active orders: %s",to_string(m_activeOrders.size()));
+    poco_information_f3(logger(), "Spread: %s Imbalance: %s Microprice: %s", to_string(m_cp.CpipToDbl(signals.Spread())),
+                        to_string(signals.Imbalance()), to_string(m_cp.CpipToDbl(signals.MicroPrice())));
     for (auto &orderId : m_activeOrders)
     {
         auto m = m_orderDetails[orderId];
@@ -0,0 +1,125 @@
+#ifndef COROUT_BOOKCHECKPOINT_H
+#define COROUT_BOOKCHECKPOINT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "Utils/CurrencyPair.h"
+#include "Utils/Result.h"
+#include "OrderBook/L2Ladder.h"
+
+namespace CORE {
+namespace BOOK {
+
+class OrderBook;
+
+/** @brief Header at the start of a checkpoint file */
+struct CheckpointHeader
+{
+	uint64_t magic { 0 }; //!< @a CHECKPOINT_MAGIC
+	uint32_t version { 0 };
+	uint32_t instrumentCount { 0 };
+	int64_t timestamp { 0 }; //!< Time the checkpoint was taken in nanoseconds
+	uint64_t size { 0 }; //!< Size of the file in bytes
+};
+
+/** @brief Record of one instrument of a checkpoint file, followed by its levels */
+struct CheckpointInstrument
+{
+	uint16_t base { 0 }; //!< Base currency
+	uint16_t quote { 0 }; //!< Quote currency
+	uint32_t bidCount { 0 }; //!< Number of bid levels following the record
+	uint32_t askCount { 0 }; //!< Number of ask levels following the bid levels
+	uint32_t reserved { 0 };
+	int64_t updateId { 0 }; //!< Venue update ID of the last message applied (see @a InstrumentBook::UpdateId)
+	int64_t timestamp { 0 }; //!< Time the levels were copied in nanoseconds
+};
+
+static_assert(sizeof(CheckpointHeader) == 32, "The checkpoint header is expected to fill half a cache line");
+static_assert(sizeof(CheckpointInstrument) == 32, "A checkpoint record is expected to fill half a cache line");
+
+constexpr uint64_t CHECKPOINT_MAGIC { 0x3154504b43424f42 }; //!< "BOBCKPT1"
+constexpr uint32_t CHECKPOINT_VERSION { 1 };
+
+/** @brief This class saves the L2 books of an @a OrderBook to a compact
+ * binary file and maps such a file for a warm start.
+ *
+ * The file holds a @a CheckpointHeader, then per instrument a
+ * @a CheckpointInstrument record followed by its @a L2Level records (bids,
+ * then asks, best price first), so a mapped checkpoint is read in place
+ * without parsing. Books in quotes mode are saved aggregated by price.
+ *
+ * @a Save writes a temporary file and renames it, so a reader never maps a
+ * partially written checkpoint. Levels restored by @a Restore are
+ * provisional (see @a OrderBook::RestoreLevels) until the feed has
+ * reconciled them with its first live updates.
+ */
+class BookCheckpoint
+{
+public:
+	/** @brief Instrument of a mapped checkpoint (the levels point into the mapping) */
+	struct Instrument
+	{
+		UTILS::CurrencyPair cp;
+		int64_t updateId { 0 };
+		int64_t timestamp { 0 };
+		const L2Level *bids { nullptr }; //!< Bid levels, best price first
+		size_t bidCount { 0 };
+		const L2Level *asks { nullptr }; //!< Ask levels, best price first
+		size_t askCount { 0 };
+	};
+
+	BookCheckpoint() = default;
+
+	~BookCheckpoint() { Unmap(); }
+
+	BookCheckpoint(const BookCheckpoint &) = delete;
+
+	BookCheckpoint &operator=(const BookCheckpoint &) = delete;
+
+	/** @brief Saves the levels of every instrument of a book
+	 *
+	 * Both sides of an instrument are copied under their shared locks, so each
+	 * instrument is consistent with its update ID; different instruments may be
+	 * copied at slightly different times.
+	 *
+	 * @param book Order book
+	 * @param path Path of the checkpoint file
+	 */
+	static UTILS::BoolResult Save(const OrderBook &book, const std::string &path);
+
+	/** @brief Maps a checkpoint file for reading */
+	UTILS::BoolResult Open(const std::string &path);
+
+	/** @brief Unmaps the file */
+	void Unmap();
+
+	bool Mapped() const { return m_header != nullptr; }
+
+	/** @brief Time the checkpoint was taken in nanoseconds */
+	int64_t Timestamp() const { return m_header ? m_header->timestamp : 0; }
+
+	/** @brief Instruments of the mapped checkpoint */
+	const std::vector<Instrument> &Instruments() const { return m_instruments; }
+
+	/** @brief Instrument of the mapped checkpoint, or @a nullptr if the checkpoint does not hold it */
+	const Instrument *Find(UTILS::CurrencyPair cp) const;
+
+	/** @brief Restores the levels of an instrument into a book (see @a OrderBook::RestoreLevels)
+	 *
+	 * @return @a true if the instrument has been restored
+	 */
+	bool Restore(OrderBook &book, UTILS::CurrencyPair cp) const;
+
+private:
+	const CheckpointHeader *m_header { nullptr };
+	size_t m_size { 0 };
+	std::vector<Instrument> m_instruments;
+};
+
+} // namespace BOOK
+} // namespace CORE
+
+#endif //COROUT_BOOKCHECKPOINT_H
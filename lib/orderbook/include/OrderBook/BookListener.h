@@ -0,0 +1,41 @@
+#ifndef COROUT_BOOKLISTENER_H
+#define COROUT_BOOKLISTENER_H
+
+#include "OrderBook/L2Ladder.h"
+#include "OrderBook/Quote.h"
+
+namespace CORE {
+namespace BOOK {
+
+/** @brief Interface of the receivers of the deltas of one side of an instrument's book
+ * (see @a OrderBook::AddListener).
+ *
+ * The callbacks are executed synchronously by the thread changing the book,
+ * while it holds the exclusive lock of the side, so they see the deltas in
+ * book order and must neither block nor call back into the book. Depending on
+ * the book mode of the instrument, a side reports quote deltas
+ * (@a InstrumentBook::Mode::Quotes) or level deltas
+ * (@a InstrumentBook::Mode::Levels).
+ */
+class BookListener
+{
+public:
+	virtual ~BookListener() = default;
+
+	/** @brief A quote has entered the side */
+	virtual void OnQuoteAdded(bool bid, const Quote::Ptr &quote) = 0;
+
+	/** @brief A quote has left the side (deleted, replaced by an update, or evicted) */
+	virtual void OnQuoteRemoved(bool bid, const Quote::Ptr &quote) = 0;
+
+	/** @brief The quantity of a level of an L2 side has changed (@a level.qty 0 -> the level has been removed) */
+	virtual void OnLevelChanged(bool bid, const L2Level &level) = 0;
+
+	/** @brief All quotes and levels of the side have been removed */
+	virtual void OnSideCleared(bool bid) = 0;
+};
+
+} // namespace BOOK
+} // namespace CORE
+
+#endif //COROUT_BOOKLISTENER_H
@@ -0,0 +1,93 @@
+#ifndef COROUT_BOOKNOTIFIER_H
+#define COROUT_BOOKNOTIFIER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "OrderBook/InstrumentBook.h"
+
+namespace CORE {
+namespace BOOK {
+
+/** @brief This class delivers book-change notifications to subscribers on a
+ * dedicated dispatch thread, conflating changes per instrument.
+ *
+ * The feed thread calls @a Notify when the mid price of an instrument has
+ * changed. If the instrument already has a pending notification, the call only
+ * counts a conflated event; otherwise it raises the instrument's pending flag
+ * and queues its shard for the dispatch thread. The dispatch thread clears the
+ * flag, reads the latest top of book of the instrument and passes it to every
+ * subscriber, so a slow subscriber (e.g. one placing orders through REST)
+ * delays neither the feed nor receives outdated intermediate states.
+ */
+class BookNotifier
+{
+public:
+	/** @brief Subscriber callback, receiving the instrument and its latest top of book */
+	using Callback = std::function<void(UTILS::CurrencyPair cp, const TopOfBook::Snapshot &top)>;
+
+	BookNotifier() = default;
+
+	BookNotifier(const BookNotifier &) = delete;
+
+	BookNotifier &operator=(const BookNotifier &) = delete;
+
+	/** @brief Destructor, stopping the dispatch thread */
+	~BookNotifier() { Stop(); }
+
+	/** @brief Adds a subscriber (called on the dispatch thread, in order of subscription) */
+	void Subscribe(Callback callback);
+
+	/** @brief Starts the dispatch thread */
+	void Start();
+
+	/** @brief Stops the dispatch thread; pending notifications are dropped */
+	void Stop();
+
+	/** @brief Is the dispatch thread running? */
+	bool Running() const { return m_running.load(std::memory_order_relaxed); }
+
+	/** @brief Signals a change of an instrument's book (feed side, does not block on subscribers)
+	 *
+	 * @param book Shard of the instrument (must outlive the notifier)
+	 */
+	void Notify(InstrumentBook &book);
+
+	/** @brief Number of notifications queued for dispatch */
+	uint64_t Queued() const { return m_queued.load(); }
+
+	/** @brief Number of subscriber deliveries of a top of book */
+	uint64_t Dispatched() const { return m_dispatched.load(); }
+
+	/** @brief Number of notifications merged into an already pending one */
+	uint64_t Conflated() const { return m_conflated.load(); }
+
+	/** @brief Number of notifications discarded because the dispatcher was not running */
+	uint64_t Dropped() const { return m_dropped.load(); }
+
+private:
+	mutable std::mutex m_mutex; //!< Guards m_pending, m_subscribers and m_stop
+	std::condition_variable m_cv;
+	std::vector<InstrumentBook *> m_pending; //!< Shards with a pending notification
+	std::vector<Callback> m_subscribers;
+	bool m_stop { false };
+	std::atomic_bool m_running { false };
+	std::thread m_thread;
+
+	std::atomic<uint64_t> m_queued { 0 };
+	std::atomic<uint64_t> m_dispatched { 0 };
+	std::atomic<uint64_t> m_conflated { 0 };
+	std::atomic<uint64_t> m_dropped { 0 };
+
+	/** @brief Dispatch loop */
+	void Run();
+};
+
+} // namespace BOOK
+} // namespace CORE
+
+#endif //COROUT_BOOKNOTIFIER_H
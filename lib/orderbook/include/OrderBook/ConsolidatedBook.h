@@ -0,0 +1,146 @@
+#ifndef COROUT_CONSOLIDATEDBOOK_H
+#define COROUT_CONSOLIDATEDBOOK_H
+
+#include <array>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include "OrderBook/OrderBook.h"
+
+namespace CORE {
+namespace BOOK {
+
+/** @brief This class keeps one order book per venue (sub-book) and offers a
+ * consolidated view over the books of all venues.
+ *
+ * Each market data connection feeds the sub-book of its venue (see
+ * @a AddVenue), so venue identity is kept and the sub-books never mix quotes
+ * of different venues. The consolidated readers do not maintain a merged
+ * book: the best price across venues is read from the venues' lock-free
+ * top-of-book records, and consolidated depth is produced on demand by a
+ * k-way merge of the venues' level summaries, each level tagged with its
+ * venue and the time of its last change.
+ *
+ * Venues are registered at start-up and never removed; registering is
+ * serialized, and the readers access the venue table without locks.
+ */
+class ConsolidatedBook
+{
+public:
+	/** @brief Shared pointer to a consolidated book */
+	using Ptr = std::shared_ptr<ConsolidatedBook>;
+
+	/** @brief Shared pointer to the order book of one venue */
+	using VenueBookPtr = std::shared_ptr<OrderBook>;
+
+	static constexpr size_t MAX_VENUES = 16; //!< Maximum number of venues
+	static constexpr size_t NO_VENUE = MAX_VENUES; //!< Venue index of an empty level
+
+	/** @brief Price level of one venue */
+	struct VenueLevel
+	{
+		size_t venue { NO_VENUE }; //!< Index of the venue (see @a VenueName)
+		PriceLadder::LevelSummary level; //!< Aggregated values of the level (price 0 -> no level)
+
+		/** @brief Age of the level at a given time in nanoseconds */
+		int64_t Age(int64_t now) const { return now - level.timestamp; }
+	};
+
+	ConsolidatedBook() = default;
+
+	ConsolidatedBook(const ConsolidatedBook &) = delete;
+
+	ConsolidatedBook &operator=(const ConsolidatedBook &) = delete;
+
+	/** @brief Returns the sub-book of a venue, creating it on first call
+	 *
+	 * @param venue    Name of the venue (e.g. "Binance")
+	 * @param readMode Read mode of the sub-book if it is created (see @a OrderBook::SetReadMode)
+	 * @return Sub-book of the venue, or @a nullptr if @a MAX_VENUES venues have been registered
+	 */
+	VenueBookPtr AddVenue(const std::string &venue, OrderBook::ReadMode readMode = OrderBook::ReadMode::Locking);
+
+	/** @brief Returns the sub-book of a venue, or @a nullptr if the venue has not been added */
+	VenueBookPtr FindVenue(const std::string &venue) const;
+
+	/** @brief Index of a venue, or @a NO_VENUE if the venue has not been added */
+	size_t VenueIndex(const std::string &venue) const;
+
+	/** @brief Number of registered venues */
+	size_t VenueCount() const { return m_venueCount.load(std::memory_order_acquire); }
+
+	/** @brief Name of the venue with a given index */
+	const std::string &VenueName(size_t venue) const { return m_venues[venue].name; }
+
+	/** @brief Sub-book of the venue with a given index */
+	const VenueBookPtr &VenueBook(size_t venue) const { return m_venues[venue].book; }
+
+	/** @brief Executes an action for each venue, in order of registration
+	 *
+	 * @tparam A Signature: void action(size_t venue, const std::string &name, OrderBook &book)
+	 */
+	template <typename A>
+	void ForEachVenue(A action) const
+	{
+		const size_t count { VenueCount() };
+		for (size_t i { 0 }; i < count; ++i)
+		{
+			action(i, m_venues[i].name, *m_venues[i].book);
+		}
+	}
+
+	/** @brief Best level of one side across all venues (lock-free, O(venues))
+	 *
+	 * Of equal prices, the level with the greater volume wins.
+	 *
+	 * @param cp  Currency pair
+	 * @param bid @a true -> highest bid, @a false -> lowest ask
+	 * @return Best level tagged with its venue; @a venue is @a NO_VENUE if no venue quotes the side
+	 */
+	VenueLevel GetBestLevel(UTILS::CurrencyPair cp, bool bid) const;
+
+	/** @brief Best bid and ask prices across all venues (0 -> side is empty) */
+	UTILS::BidAskPair<int64_t> GetBestPrices(UTILS::CurrencyPair cp) const;
+
+	/** @brief Mid price of the best prices across all venues, or 0 if one of the sides is empty */
+	int64_t GetMidPrice(UTILS::CurrencyPair cp) const;
+
+	/** @brief Copies the best levels of one side across all venues into a buffer
+	 *
+	 * The best @a n levels of each venue are merged by price (best first; equal
+	 * prices by greater volume), so the buffer holds the best @a n levels of
+	 * the consolidated book. Levels of different venues at the same price stay
+	 * separate.
+	 *
+	 * @param cp     Currency pair
+	 * @param bid    @a true -> bid levels, @a false -> ask levels
+	 * @param levels Buffer receiving the levels, best price first
+	 * @param n      Size of the buffer (maximum number of levels)
+	 * @return Number of copied levels
+	 */
+	size_t GetLevels(UTILS::CurrencyPair cp, bool bid, VenueLevel *levels, size_t n) const;
+
+	/** @brief Total number of quotes of one side over all venues */
+	size_t GetQuoteCount(UTILS::CurrencyPair cp, bool bid) const;
+
+private:
+	struct Venue
+	{
+		std::string name;
+		VenueBookPtr book;
+	};
+
+	std::array<Venue, MAX_VENUES> m_venues; //!< Venues, entries below m_venueCount are immutable
+	std::atomic<size_t> m_venueCount { 0 };
+	std::mutex m_addMutex; //!< Serializes AddVenue
+
+	/** @brief Is level @a lhs better than level @a rhs? */
+	static bool Better(bool bid, const VenueLevel &lhs, const VenueLevel &rhs);
+};
+
+} // namespace BOOK
+} // namespace CORE
+
+#endif //COROUT_CONSOLIDATEDBOOK_H
@@ -0,0 +1,92 @@
+#ifndef COROUT_DEPTHINDEX_H
+#define COROUT_DEPTHINDEX_H
+
+#include <cstdint>
+#include <vector>
+
+namespace CORE {
+namespace BOOK {
+
+/** @brief This class maintains cumulative volume and notional over the price
+ * levels of one side of a book, to answer sweep queries ("what does it cost to
+ * fill X") in logarithmic time.
+ *
+ * Every price that has been seen owns a slot; slots are sorted from the best to
+ * the worst price, and two Fenwick trees hold the volume and the notional
+ * (price * volume) per slot. A volume change at a known price costs O(log n).
+ * A new price inserts a slot and rebuilds the trees in O(n); as the prices of a
+ * book mostly stay on the same grid, this is rare once the book is warm.
+ * Slots whose volume dropped to zero are kept (they do not affect any query)
+ * and are compacted at the next rebuild when they outnumber the live ones.
+ *
+ * Notional values are kept as @a double, since price * volume in cpips and
+ * quantity units may exceed the range of 64-bit integers.
+ *
+ * The index is not synchronized; locking is left to the owning ladder.
+ */
+class DepthIndex
+{
+public:
+	/** @brief Result of a sweep through the levels of one side */
+	struct FillEstimate
+	{
+		int64_t filledQty { 0 }; //!< Fillable part of the requested quantity
+		int64_t vwap { 0 }; //!< Volume-weighted average price of the fillable part in cpips (0 -> nothing fillable)
+		int64_t worstPrice { 0 }; //!< Price of the last level touched by the sweep in cpips
+		double notional { 0 }; //!< Sum of price * quantity over the fillable part
+	};
+
+	/** @brief Constructor
+	 *
+	 * @param bid @a true -> bid side (highest price first), @a false -> ask side (lowest price first)
+	 */
+	explicit DepthIndex(bool bid)
+			: m_bid(bid) { }
+
+	/** @brief Adds a (positive or negative) volume change at a price */
+	void Add(int64_t price, int64_t volume);
+
+	/** @brief Removes all slots */
+	void Clear();
+
+	/** @brief Total volume over all levels */
+	int64_t TotalVolume() const { return m_totalVolume; }
+
+	/** @brief Sweeps the levels from the best price until a quantity is filled
+	 *
+	 * @param qty Quantity to be filled
+	 * @return Fill estimate; @a filledQty is less than @a qty if the side is too thin
+	 */
+	FillEstimate CostToFill(int64_t qty) const;
+
+	/** @brief Total volume of the levels at or better than a price */
+	int64_t QtyUpToPrice(int64_t price) const;
+
+	/** @brief Number of slots (including slots with zero volume) */
+	size_t SlotCount() const { return m_prices.size(); }
+
+private:
+	bool m_bid; //!< Side of the index
+	std::vector<int64_t> m_prices; //!< Slot prices, best price first
+	std::vector<int64_t> m_volumes; //!< Volume per slot
+	std::vector<int64_t> m_volumeTree; //!< Fenwick tree over m_volumes (1-based)
+	std::vector<double> m_notionalTree; //!< Fenwick tree over price * volume (1-based)
+	int64_t m_totalVolume { 0 };
+	size_t m_liveSlots { 0 }; //!< Slots with non-zero volume
+
+	bool Better(int64_t lhs, int64_t rhs) const { return m_bid ? lhs > rhs : lhs < rhs; }
+
+	/** @brief Index of the first slot whose price is not better than @a price */
+	size_t LowerBound(int64_t price) const;
+
+	/** @brief Adds a value to a slot of both trees */
+	void Update(size_t slot, int64_t volume, double notional);
+
+	/** @brief Rebuilds both trees from the slot volumes, dropping empty slots if requested */
+	void Rebuild(bool compact);
+};
+
+} // namespace BOOK
+} // namespace CORE
+
+#endif //COROUT_DEPTHINDEX_H
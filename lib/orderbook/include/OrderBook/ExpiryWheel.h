@@ -0,0 +1,109 @@
+#ifndef COROUT_EXPIRYWHEEL_H
+#define COROUT_EXPIRYWHEEL_H
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+namespace CORE {
+namespace BOOK {
+
+/** @brief This class implements a hierarchical timer wheel bucketing quote
+ * keys by their expiry time.
+ *
+ * Time is divided into ticks of a fixed resolution. Level 0 has one slot per
+ * tick for the next @a SLOTS ticks, level 1 one slot per @a SLOTS ticks, and so
+ * on. Scheduling a key is O(1); when the current tick crosses the boundary of
+ * a higher-level slot, the slot's keys are redistributed to the lower levels.
+ * @a Advance therefore touches only the keys that expire (plus the cascaded
+ * ones), never the whole population.
+ *
+ * Keys are not cancelled when their quote leaves the book earlier; the owner
+ * ignores expired keys it does not find any more.
+ *
+ * The wheel is not synchronized; locking is left to the owner.
+ */
+class ExpiryWheel
+{
+public:
+	static constexpr int64_t SLOTS = 64; //!< Slots per level
+	static constexpr int LEVELS = 4; //!< Levels (the wheel spans SLOTS^LEVELS ticks; later expiries are clamped)
+
+	/** @brief Constructor
+	 *
+	 * @param tick Resolution in nanoseconds
+	 * @param now Current time in nanoseconds
+	 */
+	explicit ExpiryWheel(int64_t tick = 1'000'000'000, int64_t now = 0);
+
+	/** @brief Empties the wheel and sets a new resolution and start time */
+	void Reset(int64_t tick, int64_t now);
+
+	/** @brief Schedules a key to expire at a given time (at the latest one tick later) */
+	void Schedule(int64_t expiry, int64_t key);
+
+	/** @brief Advances the wheel to a given time and passes every expired key to an action
+	 *
+	 * @tparam A Signature: void action(int64_t key)
+	 * @return Number of expired keys
+	 */
+	template <typename A>
+	size_t Advance(int64_t now, A action)
+	{
+		size_t expired { 0 };
+		const int64_t target { now / m_tick };
+		if (m_size == 0)
+		{
+			m_current = std::max(m_current, target);
+			return 0;
+		}
+		for (; m_current <= target; )
+		{
+			auto &slot { m_slots[0][m_current % SLOTS] };
+			for (const auto &entry: slot)
+			{
+				action(entry.key);
+			}
+			expired += slot.size();
+			m_size -= slot.size();
+			slot.clear();
+			++m_current;
+			Cascade();
+			if (m_size == 0)
+			{
+				m_current = std::max(m_current, target);
+				break;
+			}
+		}
+		return expired;
+	}
+
+	/** @brief Number of scheduled keys */
+	size_t Size() const { return m_size; }
+
+	/** @brief Resolution in nanoseconds */
+	int64_t Tick() const { return m_tick; }
+
+private:
+	struct Entry
+	{
+		int64_t tick; //!< Expiry tick
+		int64_t key;
+	};
+
+	int64_t m_tick; //!< Resolution in nanoseconds
+	int64_t m_current; //!< Next tick to be processed
+	size_t m_size { 0 };
+	std::vector<Entry> m_slots[LEVELS][SLOTS];
+
+	/** @brief Places an entry into the slot matching its distance from the current tick */
+	void Place(const Entry &entry);
+
+	/** @brief Redistributes the higher-level slots whose period starts at the current tick */
+	void Cascade();
+};
+
+} // namespace BOOK
+} // namespace CORE
+
+#endif //COROUT_EXPIRYWHEEL_H
@@ -0,0 +1,129 @@
+#ifndef COROUT_FILTERVIEW_H
+#define COROUT_FILTERVIEW_H
+
+#include <map>
+#include <memory>
+#include <shared_mutex>
+#include <string>
+#include <vector>
+
+#include "OrderBook/BookListener.h"
+#include "OrderBook/BookView.h"
+#include "OrderBook/SortView.h"
+
+namespace CORE {
+namespace BOOK {
+
+/*! \brief This class is a view holding the quotes of one side of a book that
+ * fulfil a filter condition (e.g. minimum quantity, maximum age, venue).
+ *
+ * Instead of filtering the whole side on every query, the view subscribes to
+ * the deltas of its book (see @a BookListener) and maintains the accepted
+ * quotes sorted by price, so a query costs O(levels returned). Filter views
+ * can be chained: a view accepts the quotes fulfilling its own condition and
+ * the conditions of all its source views, which stay unchanged.
+ *
+ * The maximum age is the only condition depending on time: it is checked when
+ * the view is iterated, as a quote ages without a delta. Quotes that have
+ * become too old stay in the view until the book removes them (see
+ * @a OrderBook::SetQuoteExpiry).
+ *
+ * The view is updated by the feed thread while it holds the lock of the
+ * side, and read under the view's own shared lock, so readers never take the
+ * lock of the book.
+ */
+class FilterView final : public BookView, public BookListener
+{
+public:
+	/*! \brief Type alias for shared pointer to FilterView */
+	using Ptr = std::shared_ptr<FilterView>;
+
+	/*! \brief Constructor, subscribing the view to the deltas of its book
+	 *
+	 * @param name      Name of the view
+	 * @param source    Source view (a @a SortView or another filter view)
+	 * @param filter    Condition to be fulfilled by a quote (@a nullptr -> all quotes)
+	 * @param condition Description of the condition (see @a GetFilterSequence)
+	 * @param maxAge    Maximum age of a quote in nanoseconds, 0 -> no age limit
+	 * @param active    \a true -> the view is active, \a false -> intermediary view
+	 * */
+	FilterView(std::string name, BookView::Ptr source, QuotePred filter, std::string condition, int64_t maxAge = 0,
+			   bool active = true);
+
+	/*! \brief Destructor, unsubscribing the view from its book */
+	~FilterView() override;
+
+	FilterView(const FilterView &) = delete;
+
+	FilterView &operator=(const FilterView &) = delete;
+
+	/*! \brief Creates a view of the quotes with a volume of at least @a minQty */
+	static Ptr CreateMinQty(const BookView::Ptr &source, int64_t minQty);
+
+	/*! \brief Creates a view of the quotes not older than @a maxAge nanoseconds */
+	static Ptr CreateMaxAge(const BookView::Ptr &source, int64_t maxAge);
+
+	/*! \brief Creates a view of the quotes of a venue (see @a Quote::Originator) */
+	static Ptr CreateVenue(const BookView::Ptr &source, const std::string &venue);
+
+	bool Valid() const override { return m_sortView && m_source->Valid(); }
+
+	void IterateQuoteGroups(const QuoteGroupFunc &action, const QuotePred &quotePred = nullptr) const override;
+
+	/*! \brief Iterates the quote groups as seen at a given time (applies the maximum age) */
+	void IterateQuoteGroups(int64_t now, const QuoteGroupFunc &action, const QuotePred &quotePred = nullptr) const;
+
+	const OrderBook *BookPtr() const override { return m_sortView ? m_sortView->BookPtr() : nullptr; }
+
+	BookView::Ptr SourceViewPtr() override { return m_source; }
+
+	BookView::PtrToConst SourceViewPtr() const override { return m_source; }
+
+	void AppendFilter(std::stringstream &ss, bool skipSortView, const std::string &delimiter) const override;
+
+	UTILS::CurrencyPair Instrument() const override { return m_source->Instrument(); }
+
+	UTILS::QuoteType Type() const override { return m_source->Type(); }
+
+	/*! \brief Maximum age of a quote in nanoseconds, including the limits of the source views (0 -> no age limit) */
+	int64_t MaxQuoteAge() const { return m_maxAge; }
+
+	/*! \brief Number of price levels held by the view (quotes too old included) */
+	size_t LevelCount() const;
+
+	/*! \brief Number of quotes held by the view (quotes too old included) */
+	size_t QuoteCount() const;
+
+	void OnQuoteAdded(bool bid, const Quote::Ptr &quote) override;
+
+	void OnQuoteRemoved(bool bid, const Quote::Ptr &quote) override;
+
+	void OnLevelChanged(bool bid, const L2Level &level) override;
+
+	void OnSideCleared(bool bid) override;
+
+private:
+	/*! \brief Accepted quotes of one price, in book order (greater volume first) */
+	using Level = std::vector<Quote::Ptr>;
+
+	const BookView::Ptr m_source;
+	SortView *m_sortView; //!< Sort view at the root of the chain, @a nullptr -> no book to subscribe to
+	const std::string m_condition;
+	std::vector<QuotePred> m_filters; //!< Own condition and the conditions of the source views
+	int64_t m_maxAge { 0 };
+	mutable std::shared_mutex m_mutex; //!< Guards m_levels and m_quoteCount
+	std::map<int64_t, Level> m_levels; //!< Accepted quotes by price (ascending)
+	size_t m_quoteCount { 0 };
+
+	/*! \brief Does a quote fulfil the conditions of the view and its sources (except the maximum age)? */
+	bool Accept(const Quote &quote) const;
+
+	void Insert(const Quote::Ptr &quote);
+
+	void Remove(const Quote::Ptr &quote);
+};
+
+} // namespace BOOK
+} // namespace CORE
+
+#endif //COROUT_FILTERVIEW_H
@@ -0,0 +1,229 @@
+#ifndef COROUT_INSTRUMENTBOOK_H
+#define COROUT_INSTRUMENTBOOK_H
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <shared_mutex>
+#include <vector>
+
+#include "Utils/CurrencyPair.h"
+#include "OrderBook/BookListener.h"
+#include "OrderBook/ExpiryWheel.h"
+#include "OrderBook/L2Ladder.h"
+#include "OrderBook/LevelArrays.h"
+#include "OrderBook/PriceLadder.h"
+#include "OrderBook/TopOfBook.h"
+
+namespace CORE {
+namespace BOOK {
+
+/** @brief Immutable copy of one side of an instrument's book, published by the
+ * writer for readers that must not block it (see @a OrderBook::ReadMode).
+ *
+ * It offers the same iteration functions as @a PriceLadder. In
+ * @a InstrumentBook::Mode::Levels the side is held by @a l2 instead.
+ */
+struct LadderSnapshot
+{
+	std::vector<PriceLadder::Level> levels; //!< Levels, best price first
+	size_t quoteCount { 0 }; //!< Number of quotes over all levels
+	DepthIndex depth { true }; //!< Copy of the ladder's depth index
+	L2Ladder l2 { true }; //!< Copy of the L2 ladder (book mode @a InstrumentBook::Mode::Levels)
+	LevelArrays arrays; //!< Rows of the side in book order for the scan kernels (quotes or L2 levels, by book mode)
+
+	size_t QuoteCount() const { return quoteCount; }
+
+	const DepthIndex &Depth() const { return depth; }
+
+	/** @brief Executes an action for each level, best price first (see @a PriceLadder::ForEachLevel) */
+	template <typename A>
+	void ForEachLevel(A action) const
+	{
+		bool cont { true };
+		for (auto it { levels.begin() }; cont && it != levels.end(); ++it)
+		{
+			action(*it, cont);
+		}
+	}
+
+	/** @brief Copies the summaries of the best levels into a buffer (see @a PriceLadder::CopySummaries) */
+	size_t CopySummaries(PriceLadder::LevelSummary *summaries, size_t n) const
+	{
+		const size_t count { std::min(n, levels.size()) };
+		for (size_t i { 0 }; i < count; ++i)
+		{
+			summaries[i] = levels[i].Summary();
+		}
+		return count;
+	}
+
+	/** @brief Executes an action for each quote, in book order (see @a PriceLadder::ForEachQuote) */
+	template <typename A>
+	void ForEachQuote(A action) const
+	{
+		bool cont { true };
+		for (auto it { levels.begin() }; cont && it != levels.end(); ++it)
+		{
+			for (auto itQuote { it->quotes.begin() }; cont && itQuote != it->quotes.end(); ++itQuote)
+			{
+				action(*itQuote, cont);
+			}
+		}
+	}
+};
+
+/** @brief This class is the shard of an order book holding one instrument:
+ * both price ladders, their locks, and the top-of-book record.
+ *
+ * Shards are allocated by @a OrderBook::AddInstrument and live as long as the
+ * book, so a pointer to a shard is a stable handle: code that has obtained the
+ * handle (e.g. a market data connection at subscription time) reaches the
+ * instrument's ladders without any lookup in a shared map. Each side and the
+ * top-of-book record start on their own cache line, so writers of different
+ * sides or instruments do not share cache lines.
+ *
+ * Depending on its @a Mode, a shard keeps each side either as quotes in a
+ * @a PriceLadder or as price-level records in an @a L2Ladder; the other ladder
+ * stays empty.
+ */
+class alignas(64) InstrumentBook
+{
+public:
+	/** @brief Shared pointer to a shard (stable handle) */
+	using Ptr = std::shared_ptr<InstrumentBook>;
+
+	/** @brief How the sides of the shard store the market data */
+	enum class Mode
+	{
+		Quotes, //!< Every entry becomes a @a Quote in the @a PriceLadder (order-level data, default)
+		Levels //!< Every entry sets the quantity of a price level in the @a L2Ladder (price-level data)
+	};
+
+	explicit InstrumentBook(UTILS::CurrencyPair cp)
+			: m_cp(cp), m_sides { Side(true), Side(false) } { }
+
+	/** @brief Destructor, deleting the published snapshots (retired ones belong to the book's epoch domain) */
+	~InstrumentBook()
+	{
+		for (auto &side: m_sides)
+		{
+			delete side.snapshot.load();
+		}
+	}
+
+	InstrumentBook(const InstrumentBook &) = delete;
+
+	InstrumentBook &operator=(const InstrumentBook &) = delete;
+
+	/** @brief Instrument of the shard */
+	UTILS::CurrencyPair Instrument() const { return m_cp; }
+
+	/** @brief Price ladder of one side (access only while holding @a Mutex(bid)) */
+	PriceLadder &Ladder(bool bid) { return m_sides[bid ? 0 : 1].ladder; }
+
+	/** @brief Price ladder of one side (access only while holding @a Mutex(bid)) */
+	const PriceLadder &Ladder(bool bid) const { return m_sides[bid ? 0 : 1].ladder; }
+
+	/** @brief L2 ladder of one side (access only while holding @a Mutex(bid)) */
+	L2Ladder &L2(bool bid) { return m_sides[bid ? 0 : 1].l2; }
+
+	/** @brief L2 ladder of one side (access only while holding @a Mutex(bid)) */
+	const L2Ladder &L2(bool bid) const { return m_sides[bid ? 0 : 1].l2; }
+
+	/** @brief Book mode of the shard (see @a OrderBook::SetBookMode) */
+	Mode GetMode() const { return m_mode.load(std::memory_order_acquire); }
+
+	/** @brief Sets the book mode (the caller holds the locks of both sides and empties them) */
+	void SetMode(Mode mode) { m_mode.store(mode, std::memory_order_release); }
+
+	/** @brief Shared exclusive lock of one side */
+	std::shared_mutex &Mutex(bool bid) const { return m_sides[bid ? 0 : 1].mutex; }
+
+	/** @brief Published snapshot of one side, or @a nullptr if none has been published
+	 *
+	 * The snapshot may only be dereferenced while an epoch of the book's epoch domain is pinned.
+	 */
+	const LadderSnapshot *Snapshot(bool bid) const { return m_sides[bid ? 0 : 1].snapshot.load(std::memory_order_acquire); }
+
+	/** @brief Publishes a snapshot of one side
+	 *
+	 * @return Previously published snapshot, to be retired by the caller
+	 */
+	const LadderSnapshot *ExchangeSnapshot(bool bid, const LadderSnapshot *snapshot)
+	{
+		return m_sides[bid ? 0 : 1].snapshot.exchange(snapshot, std::memory_order_acq_rel);
+	}
+
+	/** @brief Flag set by writers when a side has changed since its last snapshot */
+	std::atomic_bool &Dirty(bool bid) { return m_sides[bid ? 0 : 1].dirty; }
+
+	/** @brief Expiry wheel of the quotes of one side (access only while holding @a Mutex(bid)) */
+	ExpiryWheel &Wheel(bool bid) { return m_sides[bid ? 0 : 1].wheel; }
+
+	/** @brief Receivers of the deltas of one side (access only while holding @a Mutex(bid), see @a OrderBook::AddListener) */
+	std::vector<BookListener *> &Listeners(bool bid) { return m_sides[bid ? 0 : 1].listeners; }
+
+	/** @brief Maximum age of a quote in the book in nanoseconds (0 -> quotes do not expire) */
+	int64_t MaxQuoteAge() const { return m_maxQuoteAge.load(std::memory_order_relaxed); }
+
+	/** @brief Sets the maximum age of a quote (see @a OrderBook::SetQuoteExpiry) */
+	void SetMaxQuoteAge(int64_t maxAge) { m_maxQuoteAge.store(maxAge, std::memory_order_relaxed); }
+
+	/** @brief Number of best levels of a side whose volume is published as depth (see @a TopOfBook::Snapshot::bidDepth) */
+	size_t SignalDepth() const { return m_signalDepth.load(std::memory_order_relaxed); }
+
+	/** @brief Sets the number of best levels of the published depth (see @a OrderBook::SetSignalDepth) */
+	void SetSignalDepth(size_t levels) { m_signalDepth.store(levels, std::memory_order_relaxed); }
+
+	/** @brief Venue update ID of the last message applied to the shard (0 -> unknown, set by the feed) */
+	int64_t UpdateId() const { return m_updateId.load(std::memory_order_acquire); }
+
+	/** @brief Sets the venue update ID of the last message applied to the shard */
+	void SetUpdateId(int64_t updateId) { m_updateId.store(updateId, std::memory_order_release); }
+
+	/** @brief Are the levels restored from a checkpoint and not yet reconciled with the live feed? */
+	bool Provisional() const { return m_provisional.load(std::memory_order_acquire); }
+
+	/** @brief Marks the levels as restored (@a true) or as reconciled with the live feed (@a false) */
+	void SetProvisional(bool provisional) { m_provisional.store(provisional, std::memory_order_release); }
+
+	/** @brief Flag raised while a change notification of the instrument is pending (see @a BookNotifier) */
+	std::atomic_bool &NotifyPending() { return m_notifyPending; }
+
+	/** @brief Top-of-book record of the instrument (lock-free reads) */
+	TopOfBook &Top() { return m_top; }
+
+	/** @brief Top-of-book record of the instrument (lock-free reads) */
+	const TopOfBook &Top() const { return m_top; }
+
+private:
+	struct alignas(64) Side
+	{
+		explicit Side(bool bid)
+				: ladder(bid), l2(bid) { }
+
+		mutable std::shared_mutex mutex;
+		PriceLadder ladder;
+		L2Ladder l2;
+		std::atomic<const LadderSnapshot *> snapshot { nullptr };
+		std::atomic_bool dirty { false };
+		ExpiryWheel wheel;
+		std::vector<BookListener *> listeners;
+	};
+
+	const UTILS::CurrencyPair m_cp;
+	Side m_sides[2]; //!< bid, ask
+	TopOfBook m_top;
+	std::atomic_bool m_notifyPending { false };
+	std::atomic<int64_t> m_maxQuoteAge { 0 };
+	std::atomic<size_t> m_signalDepth { 5 }; //!< Levels per side of the published depth
+	std::atomic<int64_t> m_updateId { 0 }; //!< Venue update ID of the last applied message
+	std::atomic_bool m_provisional { false }; //!< Levels restored from a checkpoint, not yet reconciled
+	std::atomic<Mode> m_mode { Mode::Quotes };
+};
+
+} // namespace BOOK
+} // namespace CORE
+
+#endif //COROUT_INSTRUMENTBOOK_H
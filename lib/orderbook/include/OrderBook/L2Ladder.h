@@ -0,0 +1,244 @@
+#ifndef COROUT_L2LADDER_H
+#define COROUT_L2LADDER_H
+
+#include <cstdint>
+#include <vector>
+
+#include "OrderBook/DepthIndex.h"
+#include "OrderBook/PriceLadder.h"
+
+namespace CORE {
+namespace BOOK {
+
+/** @brief One aggregated price level of an L2 book (plain data, half a cache line) */
+struct L2Level
+{
+	int64_t price { 0 }; //!< Price in cpips
+	int64_t qty { 0 }; //!< Aggregated quantity at the price
+	int64_t seq { 0 }; //!< Update sequence number of the ladder when the level was last changed
+	int64_t timestamp { 0 }; //!< Time of the last change in nanoseconds
+};
+
+static_assert(sizeof(L2Level) == 32, "L2Level is expected to fill half a cache line");
+
+/** @brief This class represents one side (bid or ask) of an instrument's book
+ * as a contiguous array of @a L2Level records.
+ *
+ * Venues publishing price-level data (depth channels) send the aggregated
+ * quantity per price, not individual orders, so a level needs neither a
+ * @a Quote object nor a key: an update overwrites the quantity at its price,
+ * and a quantity of 0 removes the level. Levels are kept sorted from the worst
+ * to the best price, so the best level is the last element and the frequent
+ * changes close to the top of the book move only a few records.
+ *
+ * The ladder offers the reader interface of @a PriceLadder (@a QuoteCount,
+ * @a Depth, @a CopySummaries, @a ForEachLevel, @a ForEachQuote), so the
+ * book's readers work in both book modes; @a ForEachLevel and @a ForEachQuote
+ * create a temporary quote per level and are meant for the readers that need
+ * quote objects, not for the hot path.
+ *
+ * The ladder can be bounded to the best @a MaxLevels levels (see
+ * @a SetMaxLevels): the levels then stay in an array reserved once, a new
+ * level better than the worst one of a full window evicts the worst, and a new
+ * level worse than all of them is kept out of the window without moving any
+ * record. Levels outside the window are kept in an overflow of up to
+ * @a MaxLevels further levels, which refills the window as deletes drain it,
+ * so the window holds the best levels of the venue as long as the overflow
+ * has not run empty. Levels beyond a full overflow are discarded, and from
+ * then on the ladder is exact only up to the best discarded price: updates at
+ * or beyond it are discarded too, and once the window drains below its bound
+ * the side lacks levels that still exist at the venue (see @a Incomplete)
+ * until it is cleared for a new snapshot.
+ *
+ * The ladder is not synchronized; locking is left to the owning book.
+ */
+class L2Ladder
+{
+public:
+	/** @brief Constructor
+	 *
+	 * @param bid @a true -> bid side (highest price first), @a false -> ask side (lowest price first)
+	 */
+	explicit L2Ladder(bool bid)
+			: m_depth(bid), m_bid(bid) { }
+
+	/** @brief Side of the ladder (@a true -> bid, @a false -> ask) */
+	bool Bid() const { return m_bid; }
+
+	/** @brief Sets the quantity at a price level
+	 *
+	 * @param price Price in cpips
+	 * @param qty Aggregated quantity, 0 -> remove the level
+	 * @param timestamp Time of the change in nanoseconds
+	 * @return @a true if the ladder has changed
+	 */
+	bool Apply(int64_t price, int64_t qty, int64_t timestamp);
+
+	/** @brief Bounds the ladder to the best levels
+	 *
+	 * Levels beyond the bound move to the overflow, and levels beyond the
+	 * overflow are discarded; a larger bound takes levels back from the overflow.
+	 *
+	 * @param maxLevels Maximum number of levels, 0 -> unbounded
+	 */
+	void SetMaxLevels(size_t maxLevels);
+
+	/** @brief Maximum number of levels (0 -> unbounded) */
+	size_t MaxLevels() const { return m_maxLevels; }
+
+	/** @brief Number of levels discarded because they were beyond the window and the overflow of a bounded ladder */
+	uint64_t Discarded() const { return m_discarded; }
+
+	/** @brief Number of levels kept outside the window of a bounded ladder */
+	size_t OverflowCount() const { return m_overflow.size(); }
+
+	/** @brief Can levels be missing from the window? (levels have been discarded and the window is not full)
+	 *
+	 * The side must then be replaced by a new snapshot for its depth to be right.
+	 */
+	bool Incomplete() const { return m_truncated && (m_maxLevels == 0 || m_levels.size() < m_maxLevels); }
+
+	/** @brief Price of the level moved into the window from the overflow by the last @a Apply (0 -> none) */
+	int64_t Refilled() const { return m_refilled; }
+
+	/** @brief Finds the level at a price, or returns @a nullptr if no such level exists */
+	const L2Level *Find(int64_t price) const;
+
+	/** @brief Best level of the ladder, or @a nullptr if the ladder is empty */
+	const L2Level *BestLevel() const { return m_levels.empty() ? nullptr : &m_levels.back(); }
+
+	/** @brief Worst level of the ladder, or @a nullptr if the ladder is empty */
+	const L2Level *WorstLevel() const { return m_levels.empty() ? nullptr : &m_levels.front(); }
+
+	/** @brief Number of price levels */
+	size_t LevelCount() const { return m_levels.size(); }
+
+	/** @brief Number of levels (one quote per level, see @a PriceLadder::QuoteCount) */
+	size_t QuoteCount() const { return m_levels.size(); }
+
+	/** @brief Cumulative volume and notional over the levels */
+	const DepthIndex &Depth() const { return m_depth; }
+
+	/** @brief Is the ladder empty? */
+	bool Empty() const { return m_levels.empty(); }
+
+	/** @brief Total quantity of the best @a n levels (O(n), reads the records at the end of the array) */
+	int64_t TopVolume(size_t n) const
+	{
+		int64_t volume { 0 };
+		for (auto it { m_levels.rbegin() }; n > 0 && it != m_levels.rend(); ++it, --n)
+		{
+			volume += it->qty;
+		}
+		return volume;
+	}
+
+	/** @brief Removes all levels */
+	void Clear()
+	{
+		m_levels.clear();
+		m_overflow.clear();
+		m_depth.Clear();
+		m_truncated = false;
+	}
+
+	/** @brief Copies the summaries of the best levels into a buffer (see @a PriceLadder::CopySummaries) */
+	size_t CopySummaries(PriceLadder::LevelSummary *levels, size_t n) const
+	{
+		size_t count { 0 };
+		for (auto it { m_levels.rbegin() }; count < n && it != m_levels.rend(); ++it)
+		{
+			levels[count++] = { it->price, it->qty, 0, 1, it->timestamp };
+		}
+		return count;
+	}
+
+	/** @brief Checks that the levels are sorted, non-empty, within the bound, and match the depth index
+	 *
+	 * The overflow must be sorted as well, worse than the window and, once
+	 * levels have been discarded, better than the best discarded price.
+	 *
+	 * Intended for tests and debugging; costs O(n).
+	 */
+	bool CheckOrder() const;
+
+	/** @brief Executes an action for each level record, best price first
+	 *
+	 * @tparam A Signature: void action(const L2Level &level, bool &cont).
+	 *           If @a cont is set to @a false, the iteration is stopped.
+	 */
+	template <typename A>
+	void ForEachL2Level(A action) const
+	{
+		bool cont { true };
+		for (auto it { m_levels.rbegin() }; cont && it != m_levels.rend(); ++it)
+		{
+			action(*it, cont);
+		}
+	}
+
+	/** @brief Executes an action for each level, best price first (see @a PriceLadder::ForEachLevel)
+	 *
+	 * Each level holds one temporary quote carrying the level's quantity.
+	 */
+	template <typename A>
+	void ForEachLevel(A action) const
+	{
+		bool cont { true };
+		PriceLadder::Level level;
+		for (auto it { m_levels.rbegin() }; cont && it != m_levels.rend(); ++it)
+		{
+			level.price = it->price;
+			level.totalVolume = it->qty;
+			level.timestamp = it->timestamp;
+			level.quotes.assign(1, ToQuote(*it));
+			action(static_cast<const PriceLadder::Level &>(level), cont);
+		}
+	}
+
+	/** @brief Executes an action for a temporary quote of each level, best price first (see @a PriceLadder::ForEachQuote) */
+	template <typename A>
+	void ForEachQuote(A action) const
+	{
+		bool cont { true };
+		for (auto it { m_levels.rbegin() }; cont && it != m_levels.rend(); ++it)
+		{
+			action(ToQuote(*it), cont);
+		}
+	}
+
+	/** @brief Creates a temporary quote representing a level */
+	static Quote::Ptr ToQuote(const L2Level &level);
+
+private:
+	std::vector<L2Level> m_levels; //!< Levels, worst price first (best price last)
+	std::vector<L2Level> m_overflow; //!< Levels beyond the window of a bounded ladder, worst price first
+	DepthIndex m_depth; //!< Prefix sums of volume and notional over the levels
+	int64_t m_seq { 0 }; //!< Number of changes applied to the ladder
+	size_t m_maxLevels { 0 }; //!< Maximum number of levels, 0 -> unbounded
+	uint64_t m_discarded { 0 }; //!< Number of levels discarded by the bound
+	int64_t m_boundary { 0 }; //!< Best discarded price (valid if @a m_truncated)
+	int64_t m_refilled { 0 }; //!< Price moved into the window by the last @a Apply, 0 -> none
+	bool m_truncated { false }; //!< Have levels been discarded since the ladder was cleared?
+	bool m_bid; //!< Side of the ladder
+
+	/** @brief Is @a lhs a worse price than @a rhs? */
+	bool Worse(int64_t lhs, int64_t rhs) const { return m_bid ? lhs < rhs : lhs > rhs; }
+
+	/** @brief Is @a price at or beyond the best discarded price? */
+	bool Beyond(int64_t price) const { return m_truncated && !Worse(m_boundary, price); }
+
+	/** @brief Index of the first level whose price is not worse than @a price */
+	size_t LowerBound(int64_t price) const;
+
+	/** @brief Sets the quantity at a price level worse than the window of a full bounded ladder */
+	void ApplyOverflow(const L2Level &level);
+
+	/** @brief Discards a level beyond the overflow, which becomes the best discarded price */
+	void Discard(int64_t price);
+};
+
+} // namespace BOOK
+} // namespace CORE
+
+#endif //COROUT_L2LADDER_H
@@ -0,0 +1,153 @@
+#ifndef COROUT_LEVELARRAYS_H
+#define COROUT_LEVELARRAYS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "OrderBook/L2Ladder.h"
+#include "OrderBook/PriceLadder.h"
+
+namespace CORE {
+namespace BOOK {
+
+/** @brief Instruction set used by the scan kernels of @a LevelArrays */
+enum class SimdLevel
+{
+	Scalar, //!< Portable loops
+	SSE4, //!< SSE4.2, two rows per instruction
+	AVX2 //!< AVX2, four rows per instruction
+};
+
+/** @brief This class holds the rows of one side of a book as a structure of
+ * arrays (prices, volumes, minimum quantities, flags), best price first, and
+ * scans them with vectorized kernels.
+ *
+ * A row is either a quote (copied from a @a PriceLadder, so several rows may
+ * share a price) or a price level (copied from an @a L2Ladder). The scans
+ * read the columns they need sequentially instead of following a pointer to
+ * every quote, and compare four (AVX2) or two (SSE4.2) rows per instruction.
+ * The kernels are selected at runtime from the instruction sets of the CPU,
+ * with a scalar fallback; all variants return identical results (the
+ * notional up to the rounding of the summation order).
+ *
+ * The arrays are not synchronized; a book publishes them with its snapshots
+ * (see @a LadderSnapshot::arrays), which are immutable once published.
+ */
+class LevelArrays
+{
+public:
+	/** @brief Flags of a row */
+	enum Flag : uint8_t
+	{
+		FLAG_USED = 1, //!< The quote has already been used in an order
+		FLAG_INVALID = 2 //!< The quote has been replaced or deleted
+	};
+
+	/** @brief Removes all rows */
+	void Clear();
+
+	/** @brief Reserves memory for a number of rows */
+	void Reserve(size_t n);
+
+	/** @brief Appends a row (rows are expected in book order, best price first) */
+	void Append(int64_t price, int64_t volume, int64_t minQty, uint8_t flags);
+
+	/** @brief Replaces the rows by the quotes of a ladder, one row per quote in book order */
+	void Assign(const PriceLadder &ladder);
+
+	/** @brief Replaces the rows by the levels of an L2 ladder, one row per level */
+	void Assign(const L2Ladder &ladder);
+
+	size_t Size() const { return m_prices.size(); }
+
+	bool Empty() const { return m_prices.empty(); }
+
+	const int64_t *Prices() const { return m_prices.data(); }
+
+	const int64_t *Volumes() const { return m_volumes.data(); }
+
+	const int64_t *MinQtys() const { return m_minQtys.data(); }
+
+	const uint8_t *Flags() const { return m_flags.data(); }
+
+	/** @brief End of the group of rows sharing the price of row @a begin (index of the first row of another price) */
+	size_t GroupEnd(size_t begin) const;
+
+	/** @brief Executes an action for each group of rows of equal price (i.e. each price level), best price first
+	 *
+	 * @tparam A Signature: void action(size_t begin, size_t end, bool &cont).
+	 *           If @a cont is set to @a false, the iteration is stopped.
+	 */
+	template <typename A>
+	void ForEachGroup(A action) const
+	{
+		bool cont { true };
+		for (size_t begin { 0 }; cont && begin < Size();)
+		{
+			const size_t end { GroupEnd(begin) };
+			action(begin, end, cont);
+			begin = end;
+		}
+	}
+
+	/** @brief Index of the row at which the volume summed from row @a begin reaches a threshold
+	 *
+	 * Volumes are expected to be non-negative.
+	 *
+	 * @return Index of the row, or @a Size() if the rows do not hold the threshold
+	 */
+	size_t FindCumulativeVolume(size_t begin, int64_t threshold) const;
+
+	/** @brief Executes an action for each run of rows whose volume adds up to a minimum (see @a BookView::AggregateLevels)
+	 *
+	 * The last run may hold less than @a minVolume.
+	 *
+	 * @tparam A Signature: void action(size_t begin, size_t end, bool &cont).
+	 *           If @a cont is set to @a false, the iteration is stopped.
+	 */
+	template <typename A>
+	void ForEachAggregate(int64_t minVolume, A action) const
+	{
+		bool cont { true };
+		for (size_t begin { 0 }; cont && begin < Size();)
+		{
+			const size_t last { FindCumulativeVolume(begin, minVolume) };
+			const size_t end { last < Size() ? last + 1 : Size() };
+			action(begin, end, cont);
+			begin = end;
+		}
+	}
+
+	/** @brief Index of the first row able to fill a quantity on its own
+	 *
+	 * A row qualifies if its volume is at least @a qty, its minimum quantity
+	 * is at most @a qty, and it has none of the @a excludedFlags.
+	 *
+	 * @return Index of the row, or @a Size() if no row qualifies
+	 */
+	size_t FindFirstFillable(int64_t qty, uint8_t excludedFlags = FLAG_USED | FLAG_INVALID) const;
+
+	/** @brief Sum of price * volume over the rows [@a begin, @a end) */
+	double Notional(size_t begin, size_t end) const;
+
+	/** @brief Best instruction set supported by the CPU */
+	static SimdLevel SupportedSimdLevel();
+
+	/** @brief Instruction set used by the kernels */
+	static SimdLevel ActiveSimdLevel();
+
+	/** @brief Selects the instruction set of the kernels (limited to the supported one; for tests and benchmarks) */
+	static void SetSimdLevel(SimdLevel level);
+
+private:
+	std::vector<int64_t> m_prices; //!< Price in cpips per row
+	std::vector<int64_t> m_volumes; //!< Volume per row
+	std::vector<int64_t> m_minQtys; //!< Minimum quantity per row
+	std::vector<uint8_t> m_flags; //!< Flags per row (see @a Flag)
+};
+
+} // namespace BOOK
+} // namespace CORE
+
+#endif //COROUT_LEVELARRAYS_H
@@ -8,9 +8,13 @@
 #include <thread>
 #include <shared_mutex>
 
+#include "Utils/EpochDomain.h"
+#include "Utils/Timer.h"
 #include "OrderBook/Quote.h"
 #include "OrderBook/BookBase.h"
 #include "OrderBook/BookView.h"
+#include "OrderBook/BookNotifier.h"
+#include "OrderBook/InstrumentBook.h"
 
 #define ATTR_BATCHSIZE            "batchsize"
 #define DFLT_BATCHSIZE            1
@@ -27,16 +31,36 @@ namespace BOOK {
 /** @brief This class represents an order book, sorting raw quotes and grouping
  * them by market depth. It provides functions that iterate over the levels and
  * copy them to a vector.
+ *
+ * Each instrument is held by its own @a InstrumentBook shard (allocated by
+ * @a AddInstrument), with one @a PriceLadder per side keyed by price in cpips,
+ * and a @a TopOfBook record publishing the best bid and offer, which can be
+ * read without locks. The functions taking a shard handle do not touch any
+ * map shared between instruments; the functions taking a currency pair look
+ * up the shard first.
+ *
+ * In @a ReadMode::Snapshot the writer additionally publishes an immutable
+ * copy of each changed side at the end of every message; the iterating
+ * readers then walk these copies under an epoch guard instead of taking the
+ * side locks, so they never delay the feed thread.
+ *
+ * Instruments fed with price-level data can be switched to
+ * @a InstrumentBook::Mode::Levels (see @a SetBookMode): entries then update
+ * compact @a L2Level records instead of creating a @a Quote each. The readers
+ * work in both modes; the quote-based ones see one temporary quote per level.
  */
 class OrderBook : public BookBase
 {
 public:
 	/** @brief Type alias for vector of shared pointers to single quotes. */
-	using QuoteVec = std::vector<Quote::Ptr>;
+	using QuoteVec = PriceLadder::QuoteVec;
 	
-	/** @brief Type alias for unique pointer to vector of shared pointers to single quotes. */
-	using QuoteVecPtr = std::shared_ptr<QuoteVec>;
-	using QuoteVecPtrToConst = std::shared_ptr<const QuoteVec>;
+	/** @brief How the iterating readers (@a IterateQuoteGroups, @a IterateQuotes, @a GetQuoteCount) access the ladders */
+	enum class ReadMode
+	{
+		Locking, //!< Readers hold the shared lock of a side while iterating it (default)
+		Snapshot //!< Readers iterate the snapshot published at the end of the last message (RCU), without locks
+	};
 
 	/** @brief Constructor. */
 	explicit OrderBook()
@@ -46,19 +70,24 @@ public:
 	OrderBook(const std::string &loggerName)
 			: BookBase(loggerName), m_action(nullptr) { }
 	
-	~OrderBook() = default;
+	/** @brief Destructor, releases the last quote. */
+	~OrderBook();
 	
-	/** @brief Default copy constructor. */
-	OrderBook(const OrderBook & /* other */) = default;
+	/** @brief Deleted copy constructor (the book owns the epoch domain of its snapshots). */
+	OrderBook(const OrderBook & /* other */) = delete;
 	
-	/** @brief Default copy assignment operator. */
-	OrderBook &operator=(const OrderBook & /* other */) = default;
+	/** @brief Deleted copy assignment operator. */
+	OrderBook &operator=(const OrderBook & /* other */) = delete;
 	
-	/** @brief Default move constructor. */
-	OrderBook(OrderBook && /* other */) = default;
+	/** @brief Selects how readers access the ladders
+	 *
+	 * Switching to @a ReadMode::Snapshot publishes a snapshot of every shard, so
+	 * readers see the current state before the next message arrives.
+	 */
+	void SetReadMode(ReadMode mode);
 	
-	/** @brief Default move assignment operator. */
-	OrderBook &operator=(OrderBook && /* other */) = default;
+	/** @brief Current read mode */
+	ReadMode GetReadMode() const { return m_readMode.load(std::memory_order_relaxed); }
 	
 	void printBook(std::ostream &ostr, UTILS::CurrencyPair cp, bool bid, unsigned int levels) const;
 	
@@ -78,6 +107,20 @@ public:
 	 */
 	BookView::QuoteGroupVec GetLevels(UTILS::CurrencyPair cp, bool bid, unsigned int n, const BookView::QuotePred &quotePred = nullptr) const;
 
+	/** @brief Copies the aggregated values of the best levels of an instrument and side into a buffer
+	 *
+	 * The ladders maintain the aggregates of each level as quotes arrive, so
+	 * this function neither creates quote groups nor allocates memory.
+	 *
+	 * @param cp     Currency pair
+	 * @param bid    @a true -> bid levels, @a false -> ask levels
+	 * @param levels Buffer receiving the level summaries, best price first
+	 * @param n      Size of the buffer (maximum number of levels)
+	 *
+	 * @return Number of copied levels
+	 */
+	size_t GetLevels(UTILS::CurrencyPair cp, bool bid, PriceLadder::LevelSummary *levels, size_t n) const;
+
 	/** @brief Dynamically creates quote groups and passes them to the provided
 	 * callback action.
 	 *
@@ -104,25 +147,10 @@ public:
 	template <typename A>
 	void IterateQuotes(UTILS::CurrencyPair cp, bool bid, A action) const
 	{
-		UTILS::BidAskPair<Quote::Ptr> result { nullptr, nullptr };
-		std::shared_lock lockMap { m_quoteVectorMap.Mutex() };
-		const auto &it { m_quoteVectorMap->find(cp) };
-		if (it != m_quoteVectorMap->end())
+		const InstrumentBook::Ptr book { FindInstrument(cp) };
+		if (book)
 		{
-			std::shared_lock lock { GetLock(cp, bid) };
-			QuoteVecPtrToConst quotes { it->second.Get(bid) };
-			if (!quotes->empty())
-			{
-				bool cont { true };
-				for (const auto &q: *quotes)
-				{
-					action(q, cont);
-					if (!cont)
-					{
-						break;
-					}
-				}
-			}
+			ReadSide(*book, bid, [&action](const auto &side) { side.ForEachQuote(action); });
 		}
 	}
 	
@@ -159,30 +187,37 @@ public:
 	Quote::Ptr GetBestQuote(UTILS::CurrencyPair cp, bool bid, P acceptPredicate) const
 	{
 		Quote::Ptr result { nullptr };
-		std::shared_lock lockMap { m_quoteVectorMap.Mutex() };
-		const auto &it { m_quoteVectorMap->find(cp) };
-		if (it != m_quoteVectorMap->end())
+		const InstrumentBook::Ptr book { FindInstrument(cp) };
+		if (book)
 		{
-			std::shared_lock lock { GetLock(cp, bid) };
-			QuoteVecPtrToConst quotes { it->second.Get(bid) };
-			lockMap.unlock();
-			if (!quotes->empty())
+			ReadLocked(*book, bid, [&result](const auto &side)
 			{
-				for (const auto &q: *quotes)
+				side.ForEachQuote([&result](const Quote::Ptr &q, bool &cont)
 				{
-					if (q->Price() > 0 )
+					if (q->Price() > 0)
 					{
 						result = q;
-						break;
+						cont = false;
 					}
-				}
-			}
+				});
+			});
 		}
 		return result;
 	}
 
 	int64_t GetMidPrice(UTILS::CurrencyPair cp) const;
 	
+	/** @brief Returns the top-of-book record of an instrument
+	 *
+	 * The record belongs to the instrument's shard, which is created on first use
+	 * and stays valid for the lifetime of the book (@a Clear only resets it), so
+	 * callers may keep the reference and read the best bid and offer without any lock.
+	 *
+	 * @param cp Currency pair
+	 * @return Reference to the top-of-book record
+	 */
+	const TopOfBook &GetTopOfBook(UTILS::CurrencyPair cp);
+	
 	template <typename P>
 	int64_t GetMidPrice(UTILS::CurrencyPair cp, P acceptPredicate) const
 	{
@@ -194,25 +229,22 @@ public:
 	UTILS::BidAskPair<Quote::Ptr> GetBestQuotes(UTILS::CurrencyPair cp, P acceptPredicate) const
 	{
 		UTILS::BidAskPair<Quote::Ptr> result { nullptr, nullptr };
-		std::shared_lock lockMap { m_quoteVectorMap.Mutex() };
-		const auto &it { m_quoteVectorMap->find(cp) };
-		if (it != m_quoteVectorMap->end())
+		const InstrumentBook::Ptr book { FindInstrument(cp) };
+		if (book)
 		{
 			for (bool bid: { true, false })
 			{
-				std::shared_lock lock { GetLock(cp, bid) };
-				QuoteVecPtrToConst quotes { it->second.Get(bid) };
-				if (quotes && !quotes->empty())
+				ReadLocked(*book, bid, [&result, &acceptPredicate, bid](const auto &side)
 				{
-					for (const auto &q: *quotes)
+					side.ForEachQuote([&result, &acceptPredicate, bid](const Quote::Ptr &q, bool &cont)
 					{
 						if (q->Price() > 0 && acceptPredicate(bid, *q))
 						{
 							result.Get(bid) = q;
-							break;
+							cont = false;
 						}
-					}
-				}
+					});
+				});
 			}
 		}
 		return result;
@@ -226,22 +258,242 @@ public:
 	void AddEntry(int64_t key, int64_t refKey, int64_t sendTime, int64_t receiveTime, UTILS::CurrencyPair cp,
 				  const UTILS::BookUpdate::Entry &entry);
 	
+	/** @brief Adds an entry to the shard of an instrument (no lookup of the instrument)
+	 *
+	 * @param book Shard handle returned by @a AddInstrument
+	 */
+	void AddEntry(InstrumentBook &book, int64_t key, int64_t refKey, int64_t sendTime, int64_t receiveTime,
+				  const UTILS::BookUpdate::Entry &entry);
+	
+	/** @brief Applies all entries of one market data message
+	 *
+	 * Consecutive entries of the same instrument are applied to its shard while
+	 * holding both side locks once, and the top of book is published once per
+	 * side. The mid price is compared once, after the whole message has been
+	 * applied, so the callback set by @a Initialise fires at most once per
+	 * message and never sees a half-applied message.
+	 *
+	 * Every entry must carry the book keys assigned by the connection
+	 * (@a BookUpdate::Entry::key / @a refKey); entries without a key are skipped.
+	 *
+	 * @param update Normalized market data message
+	 */
+	void ApplyBatch(const UTILS::BookUpdate &update);
+	
+	/** @brief Applies all entries of one market data message to the shard of their instrument (no lookup of the instrument)
+	 *
+	 * Entries of other instruments are skipped.
+	 *
+	 * @param book Shard handle returned by @a AddInstrument
+	 * @param update Normalized market data message
+	 */
+	void ApplyBatch(InstrumentBook &book, const UTILS::BookUpdate &update);
+	
+	/** @brief Returns the shard of an instrument, allocating it on first call
+	 *
+	 * The shard stays valid for the lifetime of the book (@a Clear only empties
+	 * it), so the returned handle can be kept by the caller.
+	 *
+	 * @param cp Currency pair
+	 * @return Shard handle
+	 */
+	InstrumentBook::Ptr AddInstrument(UTILS::CurrencyPair cp);
+	
+	/** @brief Returns the shard of an instrument, or @a nullptr if it has not been added */
+	InstrumentBook::Ptr FindInstrument(UTILS::CurrencyPair cp) const;
+	
+	/** @brief Returns the shards of all instruments added so far */
+	std::vector<InstrumentBook::Ptr> GetInstruments() const;
+	
+	/** @brief Selects how an instrument's shard stores market data
+	 *
+	 * In @a InstrumentBook::Mode::Levels each entry sets the quantity of its
+	 * price level (0 or DELETE removes the level) in a contiguous array of
+	 * 32-byte @a L2Level records; no @a Quote is created and the entries need no
+	 * book keys. @a GetLastQuote is not updated in this mode. Switching the mode
+	 * empties both sides of the instrument.
+	 *
+	 * @param cp   Currency pair
+	 * @param mode Book mode
+	 */
+	void SetBookMode(UTILS::CurrencyPair cp, InstrumentBook::Mode mode);
+	
+	/** @brief Book mode of an instrument (@a InstrumentBook::Mode::Quotes if it has not been added) */
+	InstrumentBook::Mode GetBookMode(UTILS::CurrencyPair cp) const;
+	
+	/** @brief Bounds each side of an instrument's L2 book to its best levels
+	 *
+	 * Applies to @a InstrumentBook::Mode::Levels: new prices outside the window
+	 * of a full side go to a bounded overflow, which refills the window as
+	 * deletes drain it (see @a L2Ladder). Depth queries only see the levels
+	 * within the window; @a IsDepthIncomplete tells when the overflow has run
+	 * out and the side needs a new snapshot.
+	 *
+	 * @param cp        Currency pair
+	 * @param maxLevels Maximum number of levels per side (see ATTR_MAX_QUOTE_COUNT), 0 -> unbounded
+	 */
+	void SetMaxLevels(UTILS::CurrencyPair cp, size_t maxLevels);
+	
+	/** @brief Bounds each side of an instrument's L2 book to the default number of levels (DFLT_MAX_QUOTE_COUNT) */
+	void SetMaxLevels(UTILS::CurrencyPair cp) { SetMaxLevels(cp, DFLT_MAX_QUOTE_COUNT); }
+	
+	/** @brief Sets the number of best levels whose volume the top-of-book record publishes as depth
+	 *
+	 * The depth of a side is updated with its best level on every change of the
+	 * side, so spread, imbalance and microprice (see @a TopOfBook::Snapshot) are
+	 * read from @a GetTopOfBook without touching the levels.
+	 *
+	 * @param cp     Currency pair
+	 * @param levels Number of levels (default 5), 1 -> best level only
+	 */
+	void SetSignalDepth(UTILS::CurrencyPair cp, size_t levels);
+	
+	/** @brief Maximum number of levels per side of an instrument (0 -> unbounded) */
+	size_t GetMaxLevels(UTILS::CurrencyPair cp) const;
+	
+	/** @brief Can levels be missing from a bounded side of an instrument's L2 book? (see @a L2Ladder::Incomplete)
+	 *
+	 * Depth beyond the best level (level N, @a CostToFill, the depth signals)
+	 * is then not reliable until the instrument is replaced by a new snapshot.
+	 */
+	bool IsDepthIncomplete(UTILS::CurrencyPair cp, bool bid) const;
+	
+	/** @brief Estimates the cost of sweeping one side of an instrument's book (O(log n) in the number of levels)
+	 *
+	 * @param cp  Currency pair
+	 * @param bid @a true -> sweep the bid levels (sell), @a false -> sweep the ask levels (buy)
+	 * @param qty Quantity to be filled
+	 * @return Fill estimate; @a filledQty is less than @a qty if the side is too thin
+	 */
+	DepthIndex::FillEstimate CostToFill(UTILS::CurrencyPair cp, bool bid, int64_t qty) const;
+	
+	/** @brief Volume-weighted average price of sweeping a quantity from one side, or 0 if the side is too thin */
+	int64_t VwapForQty(UTILS::CurrencyPair cp, bool bid, int64_t qty) const;
+	
+	/** @brief Total volume of one side at prices at or better than @a price */
+	int64_t QtyUpToPrice(UTILS::CurrencyPair cp, bool bid, int64_t price) const;
+	
+	/** @brief Best price of one side at which a single quote can fill a quantity on its own, or 0 if none can
+	 *
+	 * A quote qualifies if its volume is at least @a qty, its minimum quantity
+	 * is at most @a qty, and it is neither used nor replaced (in levels mode,
+	 * the first level holding @a qty). The scan runs on the @a LevelArrays of
+	 * the published snapshot in snapshot read mode, and on the ladder itself
+	 * under the side's shared lock otherwise.
+	 */
+	int64_t GetBestPriceForQty(UTILS::CurrencyPair cp, bool bid, int64_t qty) const;
+	
 	size_t GetQuoteCount(UTILS::CurrencyPair cp, bool bid) const;
 	
+	/** @brief Enables (or disables) the eviction of stale quotes of an instrument
+	 *
+	 * Quotes older than @a maxAge (time since they entered the book) are removed
+	 * by a task of the book's cleanup timer running every @a cleanupInterval.
+	 * Each side buckets its quotes by expiry in a timer wheel, so a run only
+	 * touches the quotes that have expired.
+	 *
+	 * @param cp              Currency pair
+	 * @param maxAge          Maximum age of a quote in nanoseconds (see ATTR_MAX_QUOTE_AGE), 0 -> no eviction
+	 * @param cleanupInterval Interval between eviction runs in nanoseconds (see ATTR_CLEANUP_INTERVAL)
+	 */
+	void SetQuoteExpiry(UTILS::CurrencyPair cp, int64_t maxAge, int64_t cleanupInterval);
+	
+	/** @brief Enables the eviction of stale quotes of an instrument with the default settings
+	 * (DFLT_MAX_QUOTE_AGE, DFLT_CLEANUP_INTERVAL) */
+	void SetQuoteExpiry(UTILS::CurrencyPair cp)
+	{
+		SetQuoteExpiry(cp, UTILS::StringToNanoseconds(DFLT_MAX_QUOTE_AGE), UTILS::StringToNanoseconds(DFLT_CLEANUP_INTERVAL));
+	}
+	
+	/** @brief Removes the quotes of an instrument that have expired at a given time
+	 *
+	 * Called by the cleanup timer; public for tests and manual cleanup.
+	 *
+	 * @param cp  Currency pair
+	 * @param now Current time in nanoseconds
+	 * @return Number of removed quotes
+	 */
+	size_t EvictStaleQuotes(UTILS::CurrencyPair cp, int64_t now);
+	
+	/** @brief Replaces both sides of an instrument's L2 book with levels restored from a checkpoint
+	 *
+	 * Applies to @a InstrumentBook::Mode::Levels. The levels are stamped with
+	 * the time of the restore (so the expiry does not evict them at once) and
+	 * marked as provisional (see @a InstrumentBook::Provisional) until the feed
+	 * has reconciled them with its first live updates, or has replaced them by
+	 * a snapshot (see @a DiscardProvisional).
+	 *
+	 * @param cp        Currency pair
+	 * @param bids      Bid levels, best price first
+	 * @param bidCount  Number of bid levels
+	 * @param asks      Ask levels, best price first
+	 * @param askCount  Number of ask levels
+	 * @param updateId  Venue update ID of the last message applied to the levels
+	 * @return @a false if the instrument is not in @a InstrumentBook::Mode::Levels
+	 */
+	bool RestoreLevels(UTILS::CurrencyPair cp, const L2Level *bids, size_t bidCount, const L2Level *asks, size_t askCount,
+					   int64_t updateId);
+	
+	/** @brief Empties both sides of a shard if they still hold provisional levels
+	 *
+	 * Called by a feed before it applies a full snapshot, so that restored
+	 * levels the venue no longer has do not survive the snapshot.
+	 *
+	 * @param book Shard handle returned by @a AddInstrument
+	 * @return @a true if provisional levels have been dropped
+	 */
+	bool DiscardProvisional(InstrumentBook &book);
+	
+	/** @brief Are the levels of an instrument restored from a checkpoint and not yet reconciled with the live feed? */
+	bool IsProvisional(UTILS::CurrencyPair cp) const;
+	
+	/** @brief Saves a checkpoint of all instruments periodically (see @a BookCheckpoint::Save)
+	 *
+	 * The checkpoint is written by a task of the book's cleanup timer.
+	 *
+	 * @param path     Path of the checkpoint file, empty -> no checkpoints
+	 * @param interval Interval between two checkpoints in nanoseconds, 0 -> no checkpoints
+	 */
+	void SetCheckpoint(const std::string &path, int64_t interval);
+	
+	/** @brief Subscribes a listener to the deltas of one side of an instrument (see @a BookListener)
+	 *
+	 * The listener first receives the current content of the side as additions,
+	 * then every change, while holding the side's exclusive lock, so it never
+	 * misses or reorders a delta. The listener must be removed before it is
+	 * destroyed.
+	 *
+	 * @param cp       Currency pair
+	 * @param bid      @a true -> bid side, @a false -> ask side
+	 * @param listener Listener to be added
+	 */
+	void AddListener(UTILS::CurrencyPair cp, bool bid, BookListener &listener);
+	
+	/** @brief Unsubscribes a listener added by @a AddListener */
+	void RemoveListener(UTILS::CurrencyPair cp, bool bid, BookListener &listener);
+	
 	void Clear();
 	
 	Quote::Ptr GetLastQuote() const;
 
+	/** @brief Sets an action executed synchronously on the feed thread whenever a mid price changes
+	 *
+	 * Slow actions stall market data processing; subscribe them to @a Notifier instead.
+	 */
 	void Initialise(std::function<void()> action)
 	{
 		m_action = std::move(action);
 	}
 
+	/** @brief Notifier delivering mid price changes to subscribers on its own dispatch thread (conflated per instrument) */
+	BookNotifier &Notifier() { return m_notifier; }
+
 protected:
 	
-	using QuoteVectorMap = std::map<UTILS::CurrencyPair, UTILS::BidAskPair<QuoteVecPtr>>;
+	/** @brief Type alias for map of instrument shards (entries are never erased). */
+	using InstrumentMap = std::map<UTILS::CurrencyPair, InstrumentBook::Ptr>;
 	
-	UTILS::SharedLockable<QuoteVectorMap> m_quoteVectorMap;
+	mutable UTILS::SharedLockable<InstrumentMap> m_instrumentMap;
 	
 	/** @brief Connection type name.
 	 *
@@ -255,28 +507,128 @@ protected:
 
 private:
 	
-	Quote::Ptr m_lastQuote;
+	/** @brief Last quote added to the book, holding one reference
+	 *
+	 * Published as a raw pointer; a replaced quote's reference is released through
+	 * @a m_epochDomain, so a reader of @a GetLastQuote can still take its own reference.
+	 */
+	std::atomic<Quote *> m_lastQuote { nullptr };
+
+	/** @brief Replaces the last quote (writer side) */
+	void PublishLastQuote(Quote::Ptr quote);
 
 	std::function<void()> m_action;
 
-	void AddQuote(UTILS::CurrencyPair cp, bool bid, Quote::Ptr quote);
+	BookNotifier m_notifier;
+
+	/** @brief Signals a mid price change of a shard to the synchronous action and the notifier */
+	void NotifyMidChange(InstrumentBook &book);
+
+	std::atomic<ReadMode> m_readMode { ReadMode::Locking };
+
+	mutable UTILS::EpochDomain m_epochDomain; //!< Reclaims snapshots replaced while readers may still iterate them
+
+	void AddQuote(InstrumentBook &book, bool bid, Quote::Ptr quote, bool endOfMessage);
+
+	/** @brief Applies a quote to the ladder of one side (the caller holds the side's exclusive lock) */
+	void ApplyQuote(InstrumentBook &book, bool bid, const Quote::Ptr &quote);
+
+	/** @brief Adds an entry to a shard in @a InstrumentBook::Mode::Levels (counterpart of @a AddQuote) */
+	void AddLevel(InstrumentBook &book, const UTILS::BookUpdate::Entry &entry);
+
+	/** @brief Applies an entry to the L2 ladder of one side (the caller holds the side's exclusive lock) */
+	static void ApplyLevel(InstrumentBook &book, bool bid, const UTILS::BookUpdate::Entry &entry, int64_t timestamp);
+
+	/** @brief Schedules and reports the level the last @a L2Ladder::Apply moved into the window from the overflow, if any */
+	static void RefillLevel(InstrumentBook &book, bool bid, int64_t timestamp);
+
+	/** @brief Reports the current state of a level of an L2 side to the side's listeners (removed if it no longer exists) */
+	static void NotifyLevel(InstrumentBook &book, bool bid, int64_t price, int64_t timestamp);
+
+	/** @brief Empties one side of a shard and reports it cleared to its listeners (the caller holds the side's exclusive lock) */
+	static void ClearSide(InstrumentBook &book, bool bid, int64_t now);
+
+	/** @brief Reports the current content of one side to a listener (the caller holds the side's lock) */
+	static void ReplaySide(InstrumentBook &book, bool bid, BookListener &listener);
+
+	/** @brief Applies a run of entries of one message to a shard
+	 *
+	 * @return @a true if the mid price of the shard has changed
+	 */
+	bool ApplyEntries(InstrumentBook &book, const UTILS::BookUpdate::Entry *entries, size_t count);
+
+	/** @brief Creates a pooled quote from a market data entry */
+	static Quote::Ptr CreateQuote(int64_t key, int64_t refKey, int64_t sendTime, int64_t receiveTime,
+								  const UTILS::BookUpdate::Entry &entry);
+
+	/** @brief Publishes a new snapshot of each side of a shard changed since its last snapshot */
+	void PublishSnapshots(InstrumentBook &book, bool force = false);
+
+	/** @brief Executes a read-only action on one side of a shard, either on its published
+	 * snapshot (pinning an epoch) or on its ladder (holding the shared lock)
+	 *
+	 * @param action Signature: void action(const S &side), with S = @a LadderSnapshot, @a PriceLadder or @a L2Ladder
+	 */
+	template <typename A>
+	void ReadSide(const InstrumentBook &book, bool bid, A action) const
+	{
+		if (m_readMode.load(std::memory_order_relaxed) == ReadMode::Snapshot)
+		{
+			const UTILS::EpochDomain::Guard guard { m_epochDomain.Pin() };
+			const LadderSnapshot *snapshot { book.Snapshot(bid) };
+			if (snapshot)
+			{
+				if (book.GetMode() == InstrumentBook::Mode::Levels)
+				{
+					action(snapshot->l2);
+				}
+				else
+				{
+					action(*snapshot);
+				}
+				return;
+			}
+		}
+		ReadLocked(book, bid, action);
+	}
+
+	/** @brief Executes a read-only action on the ladder of one side matching the shard's
+	 * book mode, holding the side's shared lock
+	 *
+	 * @param action Signature: void action(const S &side), with S = @a PriceLadder or @a L2Ladder
+	 */
+	template <typename A>
+	static void ReadLocked(const InstrumentBook &book, bool bid, A action)
+	{
+		std::shared_lock lock { book.Mutex(bid) };
+		if (book.GetMode() == InstrumentBook::Mode::Levels)
+		{
+			action(book.L2(bid));
+		}
+		else
+		{
+			action(book.Ladder(bid));
+		}
+	}
 
-	OrderBook::QuoteVec::const_iterator getNextLevel(QuoteGroup::Ptr &quoteGroup, const QuoteVec &srcVec, const BookView::QuotePred &quotePred,
-													QuoteVec::const_iterator iterator) const;
+	static QuoteGroup::Ptr getLevelGroup(const PriceLadder::Level &level, const BookView::QuotePred &quotePred);
 	
-	/** @brief Type alias for map of shared exclusive locks. */
-	using AccessMap = std::map<UTILS::CurrencyPair, std::unique_ptr<std::shared_mutex>>;
+	/** @brief Best price of a ladder at which a single quote can fill @a qty on its own, or 0 (see @a GetBestPriceForQty) */
+	static int64_t FirstFillablePrice(const PriceLadder &ladder, int64_t qty);
 	
-	/** @brief Maps for shared exclusive locks (@a ask and @a bid side. */
-	mutable UTILS::SharedLockable<UTILS::BidAskPair<AccessMap>> m_accessMap;
+	static int64_t FirstFillablePrice(const L2Ladder &ladder, int64_t qty);
 	
-	UTILS::SharedLockable<std::map<UTILS::CurrencyPair, UTILS::BidAskPair<std::optional<int64_t>>>> m_lastCleanupMap; //!< timestamps of last call to CleanupQuoteVec()
+	static TopOfBook::Snapshot PublishTopOfBook(TopOfBook &top, const PriceLadder &ladder, size_t depthLevels);
 	
-	std::shared_mutex &GetLock(UTILS::CurrencyPair cp, bool bid) const;
+	static TopOfBook::Snapshot PublishTopOfBook(TopOfBook &top, const L2Ladder &ladder, size_t depthLevels);
 	
-	void CleanupQuoteVec(UTILS::CurrencyPair cp, QuoteVec &vec, int64_t maxAge);
+	/** @brief Publishes the best level of the ladder of one side matching the shard's book mode */
+	static TopOfBook::Snapshot PublishTopOfBook(InstrumentBook &book, bool bid);
 	
-	std::optional<int64_t> GetLastCleanupTime(UTILS::CurrencyPair cp, bool bid) const;
+	std::mutex m_cleanupMutex; //!< Guards m_cleanupTasks and m_checkpointTask
+	std::map<UTILS::CurrencyPair, int64_t> m_cleanupTasks; //!< Cleanup timer task per instrument
+	int64_t m_checkpointTask { 0 }; //!< Cleanup timer task saving the checkpoints (0 -> none)
+	UTILS::Timer m_cleanupTimer; //!< Runs the eviction tasks (declared last: stopped before the members its tasks use)
 };
 
 } // namespace BOOK
@@ -0,0 +1,272 @@
+#ifndef COROUT_PRICELADDER_H
+#define COROUT_PRICELADDER_H
+
+#include <algorithm>
+#include <map>
+#include <vector>
+
+#include "Utils/FlatHashMap.h"
+#include "OrderBook/DepthIndex.h"
+#include "OrderBook/Quote.h"
+
+namespace CORE {
+namespace BOOK {
+
+/** @brief This class represents one side (bid or ask) of an instrument's book
+ * as a price-indexed ladder.
+ *
+ * Quotes are grouped by their price in cpips (see @a CurrencyPair::DblToCpip).
+ * Each price owns one level holding the quotes of that price, sorted by
+ * volume (greater volume first). Levels are kept in a balanced tree ordered
+ * from the best to the worst price, and an open-addressing index maps each
+ * quote key to the level holding the quote, so the reference key of an
+ * UPDATE/DELETE quote is resolved in O(1). Inserting a quote costs O(log n)
+ * in the number of price levels instead of a linear search and shift of a
+ * sorted vector.
+ *
+ * Every level keeps its aggregates (total volume, smallest minimum
+ * quantity and time of its newest quote) up to date as quotes are inserted and removed, so depth readers
+ * can copy level summaries without visiting the quotes. A @a DepthIndex
+ * holds the cumulative volume and notional over the levels for sweep queries.
+ *
+ * The ladder is not synchronized; locking is left to the owning book.
+ */
+class PriceLadder
+{
+public:
+	/** @brief Type alias for vector of shared pointers to single quotes. */
+	using QuoteVec = std::vector<Quote::Ptr>;
+
+	/** @brief Aggregated values of one price level (plain data, cheap to copy) */
+	struct LevelSummary
+	{
+		int64_t price { 0 }; //!< Price of the level in cpips
+		int64_t totalVolume { 0 }; //!< Sum of the volumes of the level's quotes
+		int64_t minQty { 0 }; //!< Smallest minimum quantity of the level's quotes
+		size_t quoteCount { 0 }; //!< Number of quotes of the level
+		int64_t timestamp { 0 }; //!< Time of the newest quote of the level in nanoseconds
+	};
+
+	/** @brief One price level of the ladder */
+	struct Level
+	{
+		int64_t price { 0 }; //!< Price of the level in cpips
+		QuoteVec quotes; //!< Quotes of this price, greater volume first
+		int64_t totalVolume { 0 }; //!< Sum of the volumes of @a quotes (maintained by the ladder)
+		int64_t minQty { 0 }; //!< Smallest minimum quantity of @a quotes (maintained by the ladder)
+		int64_t timestamp { 0 }; //!< Greatest sort time of @a quotes (maintained by the ladder)
+
+		/** @brief Aggregated values of the level */
+		LevelSummary Summary() const { return { price, totalVolume, minQty, quotes.size(), timestamp }; }
+	};
+
+	/** @brief Constructor
+	 *
+	 * @param bid @a true -> bid side (highest price first), @a false -> ask side (lowest price first)
+	 */
+	explicit PriceLadder(bool bid)
+			: m_levels(PriceOrder { bid }), m_depth(bid), m_bid(bid) { }
+
+	/** @brief Side of the ladder (@a true -> bid, @a false -> ask) */
+	bool Bid() const { return m_bid; }
+
+	/** @brief Inserts a quote at its price level */
+	void Insert(const Quote::Ptr &quote);
+
+	/** @brief Removes a quote with a given key from a given price level
+	 *
+	 * @param price Price of the quote in cpips
+	 * @param key Key of the quote
+	 * @return The removed quote, or @a nullptr if no such quote exists
+	 */
+	Quote::Ptr Remove(int64_t price, int64_t key);
+
+	/** @brief Removes a quote with a given key, looking up its level in the key index
+	 *
+	 * @param key Key of the quote
+	 * @return The removed quote, or @a nullptr if no such quote exists
+	 */
+	Quote::Ptr Remove(int64_t key);
+
+	/** @brief Finds a quote with a given key at a given price level */
+	Quote::Ptr Find(int64_t price, int64_t key) const;
+
+	/** @brief Finds a quote with a given key, or returns @a nullptr if no such quote exists */
+	Quote::Ptr Find(int64_t key) const;
+
+	/** @brief Best level of the ladder, or @a nullptr if the ladder is empty */
+	const Level *BestLevel() const { return m_levels.empty() ? nullptr : &m_levels.begin()->second; }
+
+	/** @brief Number of price levels */
+	size_t LevelCount() const { return m_levels.size(); }
+
+	/** @brief Number of quotes over all levels */
+	size_t QuoteCount() const { return m_quoteCount; }
+
+	/** @brief Cumulative volume and notional over the levels */
+	const DepthIndex &Depth() const { return m_depth; }
+
+	/** @brief Is the ladder empty? */
+	bool Empty() const { return m_levels.empty(); }
+
+	/** @brief Total volume of the best @a n levels (O(n)) */
+	int64_t TopVolume(size_t n) const
+	{
+		int64_t volume { 0 };
+		for (auto it { m_levels.begin() }; n > 0 && it != m_levels.end(); ++it, --n)
+		{
+			volume += it->second.totalVolume;
+		}
+		return volume;
+	}
+
+	/** @brief Copies the levels, best price first */
+	std::vector<Level> CopyLevels() const
+	{
+		std::vector<Level> result;
+		result.reserve(m_levels.size());
+		for (const auto &it: m_levels)
+		{
+			result.push_back(it.second);
+		}
+		return result;
+	}
+
+	/** @brief Removes all levels */
+	void Clear()
+	{
+		m_levels.clear();
+		m_keyIndex.Clear();
+		m_depth.Clear();
+		m_quoteCount = 0;
+	}
+
+	/** @brief Copies the summaries of the best levels into a buffer
+	 *
+	 * @param levels Buffer receiving the summaries, best price first
+	 * @param n Size of the buffer
+	 * @return Number of copied summaries
+	 */
+	size_t CopySummaries(LevelSummary *levels, size_t n) const
+	{
+		size_t count { 0 };
+		for (auto it { m_levels.begin() }; count < n && it != m_levels.end(); ++it)
+		{
+			levels[count++] = it->second.Summary();
+		}
+		return count;
+	}
+
+	/** @brief Checks that the key index and the levels agree
+	 *
+	 * Every quote must be indexed to the level holding it, the index must not
+	 * contain other keys, the levels must be non-empty and sorted, and their
+	 * aggregates (and the depth index) must match their quotes.
+	 * Intended for tests and debugging; costs O(n).
+	 */
+	bool CheckIndex() const;
+
+	/** @brief Executes an action for each level, best price first
+	 *
+	 * @tparam A Signature: void action(const Level &level, bool &cont).
+	 *           If @a cont is set to @a false, the iteration is stopped.
+	 */
+	template <typename A>
+	void ForEachLevel(A action) const
+	{
+		bool cont { true };
+		for (auto it { m_levels.begin() }; cont && it != m_levels.end(); ++it)
+		{
+			action(it->second, cont);
+		}
+	}
+
+	/** @brief Executes an action for each quote, in book order
+	 *
+	 * @tparam A Signature: void action(const Quote::Ptr &quote, bool &cont).
+	 *           If @a cont is set to @a false, the iteration is stopped.
+	 */
+	template <typename A>
+	void ForEachQuote(A action) const
+	{
+		bool cont { true };
+		for (auto it { m_levels.begin() }; cont && it != m_levels.end(); ++it)
+		{
+			for (auto itQuote { it->second.quotes.begin() }; cont && itQuote != it->second.quotes.end(); ++itQuote)
+			{
+				action(*itQuote, cont);
+			}
+		}
+	}
+
+	/** @brief Removes all quotes for which a predicate returns @a true
+	 *
+	 * @tparam P Signature: bool pred(const Quote::Ptr &quote)
+	 * @return Number of removed quotes
+	 */
+	template <typename P>
+	size_t RemoveIf(P pred)
+	{
+		size_t removed { 0 };
+		for (auto it { m_levels.begin() }; it != m_levels.end();)
+		{
+			QuoteVec &quotes { it->second.quotes };
+			// unlike remove_if, stable_partition leaves the removed quotes intact for unindexing
+			const auto itEnd { std::stable_partition(quotes.begin(), quotes.end(), [&pred](const Quote::Ptr &q) { return !pred(q); }) };
+			removed += size_t(std::distance(itEnd, quotes.end()));
+			if (itEnd == quotes.end())
+			{
+				++it;
+				continue;
+			}
+			std::for_each(itEnd, quotes.end(), [this](const Quote::Ptr &q)
+			{
+				m_keyIndex.Erase(q->Key());
+				m_depth.Add(q->Price(), -q->Volume());
+			});
+			quotes.erase(itEnd, quotes.end());
+			if (quotes.empty())
+			{
+				it = m_levels.erase(it);
+			}
+			else
+			{
+				Aggregate(it->second);
+				++it;
+			}
+		}
+		m_quoteCount -= removed;
+		return removed;
+	}
+
+private:
+	/** @brief Orders prices from best to worst */
+	struct PriceOrder
+	{
+		bool bid;
+
+		bool operator()(int64_t lhs, int64_t rhs) const { return bid ? lhs > rhs : lhs < rhs; }
+	};
+
+	using LevelMap = std::map<int64_t, Level, PriceOrder>;
+
+	LevelMap m_levels; //!< Price levels, best price first
+	UTILS::FlatHashMap<int64_t, LevelMap::iterator> m_keyIndex; //!< Quote key -> level holding the quote (map iterators are stable)
+	DepthIndex m_depth; //!< Prefix sums of volume and notional over the levels
+	size_t m_quoteCount { 0 }; //!< Number of quotes over all levels
+	bool m_bid; //!< Side of the ladder
+
+	/** @brief Removes the quote with a given key from a level, erasing the level if it becomes empty */
+	Quote::Ptr RemoveFrom(LevelMap::iterator itLevel, int64_t key);
+
+	/** @brief Finds the quote with a given key in a level */
+	static Quote::Ptr FindIn(const Level &level, int64_t key);
+
+	/** @brief Recalculates the aggregates of a level from its quotes */
+	static void Aggregate(Level &level);
+};
+
+} // namespace BOOK
+} // namespace CORE
+
+#endif //COROUT_PRICELADDER_H
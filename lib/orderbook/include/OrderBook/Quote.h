@@ -14,6 +14,7 @@
 #include "Utils/Utils.h"
 #include "Utils/Lockable.h"
 #include "Utils/CurrencyPair.h"
+#include "Utils/IntrusivePtr.h"
 #include "Utils/ObjectPool.h"
 
 #define UNLIMITED_QUOTE_AGE  (std::numeric_limits<int64_t>::max()) // no (realistic) age limit
@@ -24,14 +25,18 @@ namespace CORE {
 namespace BOOK {
 
 /*! \brief This class contains all data of a single quote
+ *
+ * Quotes are reference counted intrusively (see \a UTILS::IntrusivePtr): the
+ * count lives in the quote, so a quote is a single allocation, and the last
+ * released reference returns the quote to the pool it was taken from
+ * (see \a QuotePool). The count is atomic because a quote referenced by a book
+ * snapshot or a quote group is shared with reader threads.
 */
 class Quote
 {
 public:
-	/*! \brief Shared pointer to a quote. */
-	using Ptr = std::shared_ptr<Quote>;
-	/*! \brief Weak pointer to a quote. */
-	using WkPtr = std::weak_ptr<Quote>;
+	/*! \brief Intrusive reference counted pointer to a quote. */
+	using Ptr = UTILS::IntrusivePtr<Quote>;
 	
 	/*! \brief Enumeration of fields that are part of a quote. */
 	enum Field
@@ -104,7 +109,7 @@ public:
 	
 	bool Valid(int64_t &successorSent, int64_t &successorReceived) const;
 	
-	bool SetInvalid(Quote::Ptr successor);
+	bool SetInvalid(const Quote::Ptr &successor);
 	
 	int64_t GetInt(Field fld) const;
 	
@@ -140,7 +145,17 @@ public:
 	
 	double SortDelayMs() const { return double(SortDelay()) / 1000000.0; }
 	
+	/*! \brief Creates a heap allocated quote (see \a QuotePool::getQuote for pooled quotes) */
+	template <typename... Args>
+	static Ptr Create(Args &&... args) { return Ptr(new Quote(std::forward<Args>(args)...)); }
+	
 private:
+	friend class QuotePool;
+	
+	friend void IntrusiveAddRef(const Quote *quote) { quote->m_refCount.fetch_add(1, std::memory_order_relaxed); }
+	
+	friend void IntrusiveRelease(const Quote *quote);
+	
 
 	const int64_t m_adptReceiveTime; // time when quote was received by the adapter
 	const int64_t m_receiptTime; // time when quote was received by the engine
@@ -163,6 +178,8 @@ private:
 		std::atomic_int64_t sent;
 		std::atomic_int64_t received;
 	} m_successor;
+	mutable std::atomic_uint32_t m_refCount { 0 }; //!< Number of @a Ptr handles referencing the quote
+	bool m_pooled { false }; //!< Was the quote taken from the object pool of @a QuotePool?
 };
 
 
@@ -176,16 +193,29 @@ public:
 	{
 		if(objectPoolDisabled || op.isExhausted())
 		{
-			return std::make_unique<Quote>(std::forward<Args>(args)...);
+			return Quote::Create(std::forward<Args>(args)...);
 		}
 
-		return Quote::Ptr((op.getObject(caller, tid, std::forward<Args>(args)...)));
+		Quote *quote { op.getObject(caller, tid, std::forward<Args>(args)...).release() };
+		quote->m_pooled = true;
+		return Quote::Ptr(quote);
 	}
 
+	/*! \brief Disposes of a quote no longer referenced, returning pooled quotes to the pool */
+	static void Release(Quote *quote);
+
 private:
 	static UTILS::ObjectPool<Quote, POOL_SIZE> op;
 };
 
+inline void IntrusiveRelease(const Quote *quote)
+{
+	if (quote->m_refCount.fetch_sub(1, std::memory_order_acq_rel) == 1)
+	{
+		QuotePool::Release(const_cast<Quote *>(quote));
+	}
+}
+
 
 /*! \brief This class defines a group of quotes (e.g. all quotes of one level)
  * */
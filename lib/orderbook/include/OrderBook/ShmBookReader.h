@@ -0,0 +1,89 @@
+#ifndef COROUT_SHMBOOKREADER_H
+#define COROUT_SHMBOOKREADER_H
+
+#include <limits>
+#include <string>
+#include <unordered_map>
+
+#include "OrderBook/L2Ladder.h"
+#include "OrderBook/ShmRing.h"
+
+namespace ORDERBOOK {
+
+/** @brief This class rebuilds the L2 books published by a @a ShmPublisher
+ * of another process from its ring file.
+ *
+ * @a Poll applies the records written since the last call to one
+ * @a CORE::BOOK::L2Ladder per side, reading them in place from the mapped file
+ * without any lock or system call. A side is in sync once the reader has seen
+ * it cleared or a complete snapshot of it; until then its levels are not
+ * exposed. If the reader falls more than the capacity of the ring behind, it
+ * drops all sides and resynchronizes from the next snapshots.
+ *
+ * The reader is not synchronized: it is meant to be polled and queried by one
+ * thread.
+ */
+class ShmBookReader
+{
+public:
+	/** @brief Maps a ring file and starts at its last snapshot */
+	UTILS::BoolResult Open(const std::string &path);
+
+	/** @brief Applies the records written since the last call
+	 *
+	 * @param maxRecords Maximum number of records to be applied
+	 * @return Number of records applied
+	 */
+	size_t Poll(size_t maxRecords = std::numeric_limits<size_t>::max());
+
+	/** @brief Is a side in sync with the book of the publisher? */
+	bool Synced(UTILS::CurrencyPair cp, bool bid) const;
+
+	/** @brief Levels of a side, or @a nullptr if the side is not in sync */
+	const CORE::BOOK::L2Ladder *Ladder(UTILS::CurrencyPair cp, bool bid) const;
+
+	/** @brief Sequence number of the next record to be read */
+	uint64_t NextSeq() const { return m_nextSeq; }
+
+	/** @brief Number of records written but not yet read */
+	uint64_t Lag() const;
+
+	/** @brief Number of times the reader has fallen too far behind and has resynchronized */
+	uint64_t Overruns() const { return m_overruns; }
+
+	/** @brief Does the publisher still write into the ring? (@a false -> re-open the file once it is back) */
+	bool WriterActive() const;
+
+private:
+	enum class SideState
+	{
+		Unsynced, //!< Records are ignored until the side is cleared or a snapshot begins
+		Loading, //!< A snapshot is being applied
+		Synced
+	};
+
+	struct Side
+	{
+		explicit Side(bool bid)
+				: ladder(bid) { }
+
+		CORE::BOOK::L2Ladder ladder;
+		SideState state { SideState::Unsynced };
+	};
+
+	ShmRingFile m_ring;
+	uint64_t m_nextSeq { 1 };
+	uint64_t m_overruns { 0 };
+	std::unordered_map<uint64_t, Side> m_sides; //!< Sides by key (see @a ShmSideKey)
+
+	const Side *FindSide(UTILS::CurrencyPair cp, bool bid) const;
+
+	void Apply(const ShmDelta &delta);
+
+	/** @brief Drops all sides and moves to the last snapshot still held by the ring */
+	void Resync(uint64_t writeSeq);
+};
+
+} // namespace ORDERBOOK
+
+#endif //COROUT_SHMBOOKREADER_H
@@ -0,0 +1,121 @@
+#ifndef COROUT_SHMPUBLISHER_H
+#define COROUT_SHMPUBLISHER_H
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "OrderBook/BookListener.h"
+#include "OrderBook/IPublisher.h"
+#include "OrderBook/ShmRing.h"
+
+namespace CORE {
+namespace BOOK {
+class OrderBook;
+}
+}
+
+namespace ORDERBOOK {
+
+/** @brief This class publishes the L2 books of instruments into a
+ * memory-mapped ring file read by other processes (see @a ShmBookReader).
+ *
+ * Each record of the ring carries the aggregated quantity of one price of
+ * one side (quantity 0 -> the level has been removed), so the readers rebuild
+ * the books without a connection to the venues. The publisher keeps a copy of
+ * the levels of each side and writes a snapshot of all sides every
+ * @a snapshotInterval records, from which a reader joining late or falling
+ * more than the capacity of the ring behind resynchronizes.
+ *
+ * Changes reach the publisher either through @a Publish or, for the books
+ * of an @a OrderBook, through @a Attach, which subscribes to the deltas of
+ * both sides of an instrument (books in quotes mode are aggregated by price).
+ * Writes are serialized by a mutex, so the ring has a single writer however
+ * many feed threads change the books.
+ */
+class ShmPublisher : public IPublisher
+{
+public:
+	ShmPublisher();
+
+	/** @brief Destructor, detaching all books and marking the ring as closed */
+	~ShmPublisher() override;
+
+	ShmPublisher(const ShmPublisher &) = delete;
+
+	ShmPublisher &operator=(const ShmPublisher &) = delete;
+
+	/** @brief Creates the ring file
+	 *
+	 * @param path             Path of the file (e.g. below /dev/shm)
+	 * @param capacity         Number of records held by the ring, a power of 2;
+	 *                         it should exceed a full snapshot by a wide margin
+	 * @param snapshotInterval Number of records between two snapshots, 0 -> only on @a PublishSnapshot
+	 */
+	UTILS::BoolResult Create(const std::string &path, uint64_t capacity = 1u << 16u, uint64_t snapshotInterval = 1u << 14u);
+
+	/** @brief Publishes the quantity of a price level
+	 *
+	 * @param cp    Currency pair
+	 * @param entry Entry index of the update message
+	 * @param level Level number (1 -> best level), 0 -> unknown
+	 * @param quote Quote holding price and aggregated quantity of the level (volume 0 -> level removed)
+	 * @param bid   \a true -> bid side, \a false -> ask side
+	 */
+	void Publish(UTILS::CurrencyPair cp, int entry, int level, CORE::BOOK::Quote::Ptr quote, bool bid) override;
+
+	/** @brief Publishes the levels of both sides of an instrument's book and all its later changes
+	 *
+	 * The sides are announced as cleared, then replayed, so the readers are in
+	 * sync with them at once. The book must outlive the attachment.
+	 */
+	void Attach(CORE::BOOK::OrderBook &book, UTILS::CurrencyPair cp);
+
+	/** @brief Stops publishing the changes of an instrument's book */
+	void Detach(CORE::BOOK::OrderBook &book, UTILS::CurrencyPair cp);
+
+	/** @brief Writes a snapshot of every side published so far */
+	void PublishSnapshot();
+
+	/** @brief Sequence number of the last record written (0 -> none) */
+	uint64_t LastSeq() const;
+
+private:
+	/** @brief Adapter subscribed to one side of an instrument's book */
+	class SideListener;
+
+	/** @brief Published levels of one side (price -> aggregated quantity) */
+	using SideLevels = std::map<int64_t, int64_t>;
+
+	mutable std::mutex m_mutex; //!< Serializes the writes to the ring and guards the members below
+	ShmRingFile m_ring;
+	uint64_t m_lastSeq { 0 };
+	uint64_t m_snapshotInterval { 0 };
+	uint64_t m_lastSnapshotSeq { 0 };
+	std::unordered_map<uint64_t, SideLevels> m_sides; //!< Levels by side key (see @a ShmSideKey)
+	std::vector<std::unique_ptr<SideListener>> m_listeners;
+
+	/** @brief Sets the quantity of a level and writes its record (the caller holds the lock) */
+	void WriteLevel(uint32_t instrument, bool bid, int64_t price, int64_t qty, int64_t timestamp, int entry, int level);
+
+	/** @brief Adds to the quantity of a level and writes its record (the caller holds the lock) */
+	void AddToLevel(uint32_t instrument, bool bid, int64_t price, int64_t qty, int64_t timestamp);
+
+	/** @brief Empties a side and writes a @a Clear record (the caller holds the lock) */
+	void ClearSide(uint32_t instrument, bool bid);
+
+	/** @brief Writes a record into the next slot (the caller holds the lock) */
+	void Write(const ShmDelta &delta);
+
+	/** @brief Writes a snapshot if the interval has passed (the caller holds the lock) */
+	void CheckSnapshot();
+
+	void WriteSnapshot();
+};
+
+} // namespace ORDERBOOK
+
+#endif //COROUT_SHMPUBLISHER_H
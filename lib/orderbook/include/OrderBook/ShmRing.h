@@ -0,0 +1,142 @@
+#ifndef COROUT_SHMRING_H
+#define COROUT_SHMRING_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "Utils/CurrencyPair.h"
+#include "Utils/Result.h"
+
+namespace ORDERBOOK {
+
+/** @brief Kind of a record of the shared-memory book ring */
+enum class ShmRecordType : uint32_t
+{
+	Level = 1, //!< Aggregated quantity of one price (@a qty 0 -> the level has been removed)
+	Clear, //!< The side is empty; the readers are in sync with it from here on
+	SnapshotBegin, //!< The side is empty; the @a Level records up to @a SnapshotEnd restore it
+	SnapshotEnd //!< The snapshot of the side is complete; the readers are in sync with it
+};
+
+/** @brief Payload of a ring record (one change of one side of an instrument's L2 book) */
+struct ShmDelta
+{
+	ShmRecordType type { ShmRecordType::Level };
+	uint32_t instrument { 0 }; //!< Instrument key (see @a ShmInstrumentKey)
+	int64_t price { 0 }; //!< Price in cpips
+	int64_t qty { 0 }; //!< Aggregated quantity at the price
+	int64_t timestamp { 0 }; //!< Time of the change in nanoseconds
+	int32_t entry { 0 }; //!< Entry index of the update message (see @a IPublisher::Publish), -1 -> none
+	int32_t level { 0 }; //!< Level number (1 -> best level), 0 -> unknown
+	uint8_t bid { 0 }; //!< 1 -> bid side, 0 -> ask side
+
+	bool Bid() const { return bid != 0; }
+
+	UTILS::CurrencyPair Instrument() const;
+};
+
+/** @brief Slot of the ring, one cache line
+ *
+ * The writer sets @a seq to 0 before overwriting the payload, and to the
+ * sequence number of the record once the payload is complete. A reader copies
+ * the payload and accepts it only if @a seq held the expected sequence number
+ * before and after the copy.
+ */
+struct alignas(64) ShmSlot
+{
+	std::atomic<uint64_t> seq { 0 };
+	ShmDelta delta;
+};
+
+static_assert(sizeof(ShmSlot) == 64, "A ring slot is expected to fill one cache line");
+
+/** @brief Header at the start of the ring file */
+struct alignas(64) ShmRingHeader
+{
+	std::atomic<uint64_t> magic { 0 }; //!< @a SHM_RING_MAGIC once the file is initialized
+	uint32_t version { 0 };
+	uint32_t slotSize { 0 };
+	uint64_t capacity { 0 }; //!< Number of slots (power of 2)
+	alignas(64) std::atomic<uint64_t> writeSeq { 0 }; //!< Sequence number of the last complete record (0 -> none)
+	std::atomic<uint64_t> snapshotSeq { 0 }; //!< Sequence number of the first record of the last full snapshot (0 -> none)
+	std::atomic<uint32_t> writerActive { 0 }; //!< 1 while the writer has the file open
+};
+
+constexpr uint64_t SHM_RING_MAGIC { 0x314b4f4f42324c53 }; //!< "SL2BOOK1"
+constexpr uint32_t SHM_RING_VERSION { 1 };
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "The ring needs lock-free 64-bit atomics");
+
+/** @brief Packs a currency pair into the instrument key of a ring record */
+inline uint32_t ShmInstrumentKey(const UTILS::CurrencyPair &cp)
+{
+	return (uint32_t(cp.BaseCCY()) << 16u) | (uint32_t(cp.QuoteCCY()) & 0xffffu);
+}
+
+/** @brief Key of one side of an instrument (see @a ShmInstrumentKey) */
+inline uint64_t ShmSideKey(uint32_t instrument, bool bid)
+{
+	return (uint64_t(instrument) << 1u) | (bid ? 1u : 0u);
+}
+
+inline UTILS::CurrencyPair ShmDelta::Instrument() const
+{
+	return { UTILS::Currency(UTILS::Currency::Value(instrument >> 16u)),
+			 UTILS::Currency(UTILS::Currency::Value(instrument & 0xffffu)) };
+}
+
+/** @brief This class maps the file of a single-writer/multi-reader ring of
+ * book deltas (see @a ShmPublisher and @a ShmBookReader).
+ *
+ * The file holds a @a ShmRingHeader followed by @a capacity slots. Record
+ * @a seq (1, 2, ...) lives in slot (@a seq - 1) modulo @a capacity, so a
+ * reader falling behind by more than @a capacity records has lost records and
+ * must resynchronize from a snapshot.
+ */
+class ShmRingFile
+{
+public:
+	ShmRingFile() = default;
+
+	~ShmRingFile() { Unmap(); }
+
+	ShmRingFile(const ShmRingFile &) = delete;
+
+	ShmRingFile &operator=(const ShmRingFile &) = delete;
+
+	/** @brief Creates and maps a new ring file for writing
+	 *
+	 * An existing file is unlinked first, so readers still mapping it are not
+	 * disturbed and can detect the writer is gone (see @a ShmRingHeader::writerActive).
+	 *
+	 * @param path     Path of the file (e.g. below /dev/shm)
+	 * @param capacity Number of slots, a power of 2
+	 */
+	UTILS::BoolResult Create(const std::string &path, uint64_t capacity);
+
+	/** @brief Maps an existing ring file for reading */
+	UTILS::BoolResult Open(const std::string &path);
+
+	/** @brief Unmaps the file */
+	void Unmap();
+
+	bool Mapped() const { return m_header != nullptr; }
+
+	ShmRingHeader &Header() const { return *m_header; }
+
+	uint64_t Capacity() const { return m_header->capacity; }
+
+	/** @brief Slot holding the record with a sequence number */
+	ShmSlot &Slot(uint64_t seq) const { return m_slots[(seq - 1) & (m_header->capacity - 1)]; }
+
+private:
+	ShmRingHeader *m_header { nullptr };
+	ShmSlot *m_slots { nullptr };
+	size_t m_size { 0 };
+};
+
+} // namespace ORDERBOOK
+
+#endif //COROUT_SHMRING_H
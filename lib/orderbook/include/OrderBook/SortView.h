@@ -0,0 +1,63 @@
+#ifndef COROUT_SORTVIEW_H
+#define COROUT_SORTVIEW_H
+
+#include <memory>
+#include <string>
+
+#include "OrderBook/BookView.h"
+
+namespace CORE {
+namespace BOOK {
+
+/*! \brief This class is the base view of one side of an instrument's book.
+ *
+ * The book keeps its ladders sorted, so the view iterates them directly and
+ * a query stops after the levels it consumes. A sort view is the source of
+ * the filter views of the side (see @a FilterView), which subscribe to the
+ * deltas of its book. The book must outlive the view.
+ */
+class SortView : public BookView
+{
+public:
+	/*! \brief Type alias for shared pointer to SortView */
+	using Ptr = std::shared_ptr<SortView>;
+
+	/*! \brief Constructor
+	 *
+	 * @param name   Name of the view
+	 * @param book   Order book holding the instrument
+	 * @param cp     Currency pair
+	 * @param bid    \a true -> bid side, \a false -> ask side
+	 * @param active \a true -> the view is active, \a false -> intermediary view
+	 * */
+	SortView(std::string name, OrderBook &book, UTILS::CurrencyPair cp, bool bid, bool active = true)
+			: BookView(std::move(name), active), m_book(book), m_cp(cp), m_bid(bid) { }
+
+	/*! \brief Creates a sort view named after its instrument and side (e.g. "EUR/USD bid") */
+	static Ptr Create(OrderBook &book, UTILS::CurrencyPair cp, bool bid);
+
+	bool Valid() const override { return m_cp.Valid(); }
+
+	void IterateQuoteGroups(const QuoteGroupFunc &action, const QuotePred &quotePred = nullptr) const override;
+
+	const OrderBook *BookPtr() const override { return &m_book; }
+
+	/*! \brief Order book of the view (e.g. to subscribe to its deltas) */
+	OrderBook &Book() const { return m_book; }
+
+	void AppendFilter(std::stringstream &ss, bool skipSortView, const std::string &delimiter) const override;
+
+	UTILS::CurrencyPair Instrument() const override { return m_cp; }
+
+	UTILS::QuoteType Type() const override { return m_bid ? UTILS::QuoteType::BID : UTILS::QuoteType::OFFER; }
+
+private:
+	OrderBook &m_book;
+	const UTILS::CurrencyPair m_cp;
+	const bool m_bid;
+};
+
+} // namespace BOOK
+} // namespace CORE
+
+#endif //COROUT_SORTVIEW_H
@@ -0,0 +1,169 @@
+#ifndef COROUT_TOPOFBOOK_H
+#define COROUT_TOPOFBOOK_H
+
+#include <atomic>
+#include <cstdint>
+#include <cmath>
+#include <mutex>
+
+namespace CORE {
+namespace BOOK {
+
+/** @brief This class publishes the best bid and offer (BBO) of one instrument
+ * through a sequence lock.
+ *
+ * Along with the best level of a side, the record carries the volume of the
+ * side's best levels (see @a InstrumentBook::SignalDepth), so spread, depth
+ * imbalance and microprice are read from one snapshot instead of being
+ * recomputed from the levels of the book.
+ *
+ * Writers (the book, while holding the lock of the side they changed) publish
+ * the best level of one side; readers copy a consistent snapshot of both sides
+ * without taking any lock and without touching shared pointers. A reader
+ * retries while a write is in progress, i.e. while the sequence is odd or has
+ * changed during the copy. Writers are serialized by a mutex that readers never
+ * see.
+ *
+ * The record is cache-line aligned and the fields used by readers share its
+ * first cache line, so publishing one instrument's BBO does not invalidate the
+ * cache lines of others.
+ */
+class alignas(64) TopOfBook
+{
+public:
+	/** @brief Consistent copy of the record */
+	struct Snapshot
+	{
+		int64_t bidPrice { 0 }; //!< Best bid price in cpips (0 -> no bid)
+		int64_t bidSize { 0 }; //!< Volume of the best bid level
+		int64_t askPrice { 0 }; //!< Best ask price in cpips (0 -> no ask)
+		int64_t askSize { 0 }; //!< Volume of the best ask level
+		int64_t bidDepth { 0 }; //!< Volume of the best bid levels (see @a InstrumentBook::SignalDepth)
+		int64_t askDepth { 0 }; //!< Volume of the best ask levels
+		uint64_t sequence { 0 }; //!< Number of publications so far
+		int64_t timestamp { 0 }; //!< Time of the last publication
+
+		int64_t Price(bool bid) const { return bid ? bidPrice : askPrice; }
+
+		int64_t Size(bool bid) const { return bid ? bidSize : askSize; }
+
+		int64_t Depth(bool bid) const { return bid ? bidDepth : askDepth; }
+
+		/** @brief Mid price, or 0 if one of the sides is empty (as OrderBook::GetMidPrice) */
+		int64_t MidPrice() const { return bidPrice > 0 && askPrice > 0 ? (bidPrice + askPrice) / 2 : 0; }
+
+		/** @brief Spread in cpips, or 0 if one of the sides is empty */
+		int64_t Spread() const { return bidPrice > 0 && askPrice > 0 ? askPrice - bidPrice : 0; }
+
+		/** @brief Imbalance of the volumes of the best levels, from -1 (asks only) to 1 (bids only), 0 if both are empty */
+		double Imbalance() const
+		{
+			const int64_t total { bidDepth + askDepth };
+			return total > 0 ? double(bidDepth - askDepth) / double(total) : 0.0;
+		}
+
+		/** @brief Mid price weighted by the volumes of the best levels, leaning towards the side
+		 * with less volume, or 0 if one of the sides is empty
+		 */
+		int64_t MicroPrice() const
+		{
+			if (bidPrice <= 0 || askPrice <= 0 || bidSize + askSize <= 0)
+			{
+				return MidPrice();
+			}
+			return std::llround((double(bidPrice) * double(askSize) + double(askPrice) * double(bidSize)) / double(bidSize + askSize));
+		}
+	};
+
+	TopOfBook() = default;
+
+	TopOfBook(const TopOfBook &) = delete;
+
+	TopOfBook &operator=(const TopOfBook &) = delete;
+
+	/** @brief Publishes the best level of one side
+	 *
+	 * @param bid @a true -> bid side, @a false -> ask side
+	 * @param price Best price in cpips (0 -> side is empty)
+	 * @param size Volume of the best level
+	 * @param depth Volume of the best levels
+	 * @param timestamp Time of the publication
+	 * @return Snapshot of the record before the publication
+	 */
+	Snapshot Publish(bool bid, int64_t price, int64_t size, int64_t depth, int64_t timestamp)
+	{
+		std::lock_guard lock { m_writeMutex };
+		const Snapshot previous { Load() };
+		const uint64_t seq { m_seq.load(std::memory_order_relaxed) };
+		m_seq.store(seq + 1, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_release);
+		(bid ? m_bidPrice : m_askPrice).store(price, std::memory_order_relaxed);
+		(bid ? m_bidSize : m_askSize).store(size, std::memory_order_relaxed);
+		(bid ? m_bidDepth : m_askDepth).store(depth, std::memory_order_relaxed);
+		m_timestamp.store(timestamp, std::memory_order_relaxed);
+		m_seq.store(seq + 2, std::memory_order_release);
+		return previous;
+	}
+
+	/** @brief Publishes the best level of one side as the only level of the side */
+	Snapshot Publish(bool bid, int64_t price, int64_t size, int64_t timestamp)
+	{
+		return Publish(bid, price, size, size, timestamp);
+	}
+
+	/** @brief Resets both sides to empty */
+	void Reset(int64_t timestamp)
+	{
+		Publish(true, 0, 0, timestamp);
+		Publish(false, 0, 0, timestamp);
+	}
+
+	/** @brief Reads a consistent snapshot of the record (lock-free, retries while a write is in progress) */
+	Snapshot Read() const
+	{
+		for (;;)
+		{
+			const uint64_t seq { m_seq.load(std::memory_order_acquire) };
+			if ((seq & 1u) == 0)
+			{
+				Snapshot result { Load() };
+				std::atomic_thread_fence(std::memory_order_acquire);
+				if (m_seq.load(std::memory_order_relaxed) == seq)
+				{
+					result.sequence = seq / 2;
+					return result;
+				}
+			}
+		}
+	}
+
+private:
+	std::atomic<uint64_t> m_seq { 0 }; //!< Sequence, odd while a write is in progress
+	std::atomic<int64_t> m_bidPrice { 0 };
+	std::atomic<int64_t> m_bidSize { 0 };
+	std::atomic<int64_t> m_askPrice { 0 };
+	std::atomic<int64_t> m_askSize { 0 };
+	std::atomic<int64_t> m_bidDepth { 0 };
+	std::atomic<int64_t> m_askDepth { 0 };
+	std::atomic<int64_t> m_timestamp { 0 };
+	std::mutex m_writeMutex; //!< Serializes writers
+
+	Snapshot Load() const
+	{
+		Snapshot result;
+		result.bidPrice = m_bidPrice.load(std::memory_order_relaxed);
+		result.bidSize = m_bidSize.load(std::memory_order_relaxed);
+		result.askPrice = m_askPrice.load(std::memory_order_relaxed);
+		result.askSize = m_askSize.load(std::memory_order_relaxed);
+		result.bidDepth = m_bidDepth.load(std::memory_order_relaxed);
+		result.askDepth = m_askDepth.load(std::memory_order_relaxed);
+		result.timestamp = m_timestamp.load(std::memory_order_relaxed);
+		result.sequence = m_seq.load(std::memory_order_relaxed) / 2;
+		return result;
+	}
+};
+
+} // namespace BOOK
+} // namespace CORE
+
+#endif //COROUT_TOPOFBOOK_H
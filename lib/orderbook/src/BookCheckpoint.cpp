@@ -0,0 +1,207 @@
+#include <cerrno>
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "Utils/Utils.h"
+#include "OrderBook/OrderBook.h"
+#include "OrderBook/BookCheckpoint.h"
+
+using namespace UTILS;
+
+namespace CORE {
+namespace BOOK {
+
+namespace {
+
+template <typename T>
+void Append(std::vector<char> &buffer, const T *records, size_t count)
+{
+	const char *data { reinterpret_cast<const char *>(records) };
+	buffer.insert(buffer.end(), data, data + count * sizeof(T));
+}
+
+/** @brief Copies the levels of one side, best price first (the caller holds the side's lock) */
+void CopySide(const InstrumentBook &book, bool bid, std::vector<L2Level> &levels)
+{
+	levels.clear();
+	if (book.GetMode() == InstrumentBook::Mode::Levels)
+	{
+		book.L2(bid).ForEachL2Level([&levels](const L2Level &level, bool &)
+		{
+			levels.push_back(level);
+		});
+	}
+	else
+	{
+		book.Ladder(bid).ForEachLevel([&levels](const PriceLadder::Level &level, bool &)
+		{
+			levels.push_back({ level.price, level.totalVolume, 0, level.timestamp });
+		});
+	}
+}
+
+} // namespace
+
+BoolResult BookCheckpoint::Save(const OrderBook &book, const std::string &path)
+{
+	std::vector<char> buffer(sizeof(CheckpointHeader));
+	std::vector<L2Level> bids;
+	std::vector<L2Level> asks;
+	CheckpointHeader header { CHECKPOINT_MAGIC, CHECKPOINT_VERSION, 0, CurrentTimestamp(), 0 };
+	for (const InstrumentBook::Ptr &instrument: book.GetInstruments())
+	{
+		CheckpointInstrument record;
+		{
+			std::shared_lock lockBid { instrument->Mutex(true) };
+			std::shared_lock lockAsk { instrument->Mutex(false) };
+			CopySide(*instrument, true, bids);
+			CopySide(*instrument, false, asks);
+			// the feed sets the update ID after applying a message, so the levels are at least as recent as the ID
+			record.updateId = instrument->UpdateId();
+		}
+		if (bids.empty() && asks.empty())
+		{
+			continue;
+		}
+		const CurrencyPair cp { instrument->Instrument() };
+		record.base = uint16_t(cp.BaseCCY());
+		record.quote = uint16_t(cp.QuoteCCY());
+		record.bidCount = uint32_t(bids.size());
+		record.askCount = uint32_t(asks.size());
+		record.timestamp = CurrentTimestamp();
+		Append(buffer, &record, 1);
+		Append(buffer, bids.data(), bids.size());
+		Append(buffer, asks.data(), asks.size());
+		++header.instrumentCount;
+	}
+	header.size = buffer.size();
+	std::memcpy(buffer.data(), &header, sizeof(header));
+
+	// readers map either the previous checkpoint or the complete new one
+	const std::string tmpPath { path + ".tmp" };
+	const int fd { ::open(tmpPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644) };
+	if (fd < 0)
+	{
+		return { setError, "Cannot create checkpoint file '%s': %s", tmpPath, std::string(std::strerror(errno)) };
+	}
+	size_t written { 0 };
+	while (written < buffer.size())
+	{
+		const ssize_t n { ::write(fd, buffer.data() + written, buffer.size() - written) };
+		if (n < 0 && errno == EINTR)
+		{
+			continue;
+		}
+		if (n <= 0)
+		{
+			break;
+		}
+		written += size_t(n);
+	}
+	const bool ok { written == buffer.size() && ::fsync(fd) == 0 };
+	const int error { errno };
+	::close(fd);
+	if (!ok || ::rename(tmpPath.c_str(), path.c_str()) != 0)
+	{
+		const int renameError { ok ? errno : error };
+		::unlink(tmpPath.c_str());
+		return { setError, "Cannot write checkpoint file '%s': %s", path, std::string(std::strerror(renameError)) };
+	}
+	return true;
+}
+
+BoolResult BookCheckpoint::Open(const std::string &path)
+{
+	Unmap();
+	const int fd { ::open(path.c_str(), O_RDONLY) };
+	if (fd < 0)
+	{
+		return { setError, "Cannot open checkpoint file '%s': %s", path, std::string(std::strerror(errno)) };
+	}
+	struct stat st { };
+	void *addr { ::fstat(fd, &st) == 0 && size_t(st.st_size) >= sizeof(CheckpointHeader)
+				 ? ::mmap(nullptr, size_t(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0) : MAP_FAILED };
+	const int error { errno };
+	::close(fd);
+	if (addr == MAP_FAILED)
+	{
+		return { setError, "Cannot map checkpoint file '%s': %s", path, std::string(std::strerror(error)) };
+	}
+	const size_t size { size_t(st.st_size) };
+	const auto *header { static_cast<const CheckpointHeader *>(addr) };
+	if (header->magic != CHECKPOINT_MAGIC || header->version != CHECKPOINT_VERSION || header->size != size)
+	{
+		::munmap(addr, size);
+		return { setError, "'%s' is not a book checkpoint of version %u", path, CHECKPOINT_VERSION };
+	}
+
+	const char *data { static_cast<const char *>(addr) };
+	size_t offset { sizeof(CheckpointHeader) };
+	std::vector<Instrument> instruments;
+	instruments.reserve(header->instrumentCount);
+	for (uint32_t i { 0 }; i < header->instrumentCount; ++i)
+	{
+		if (offset + sizeof(CheckpointInstrument) > size)
+		{
+			break;
+		}
+		const auto *record { reinterpret_cast<const CheckpointInstrument *>(data + offset) };
+		offset += sizeof(CheckpointInstrument);
+		const size_t levelCount { size_t(record->bidCount) + record->askCount };
+		if (offset + levelCount * sizeof(L2Level) > size)
+		{
+			break;
+		}
+		const auto *levels { reinterpret_cast<const L2Level *>(data + offset) };
+		offset += levelCount * sizeof(L2Level);
+		instruments.push_back({ { Currency(Currency::Value(record->base)), Currency(Currency::Value(record->quote)) },
+								record->updateId, record->timestamp, levels, record->bidCount, levels + record->bidCount,
+								record->askCount });
+	}
+	if (instruments.size() != header->instrumentCount)
+	{
+		::munmap(addr, size);
+		return { setError, "Checkpoint file '%s' is truncated", path };
+	}
+	m_header = header;
+	m_size = size;
+	m_instruments = std::move(instruments);
+	return true;
+}
+
+void BookCheckpoint::Unmap()
+{
+	if (m_header)
+	{
+		::munmap(const_cast<CheckpointHeader *>(m_header), m_size);
+		m_header = nullptr;
+		m_size = 0;
+		m_instruments.clear();
+	}
+}
+
+const BookCheckpoint::Instrument *BookCheckpoint::Find(CurrencyPair cp) const
+{
+	for (const Instrument &instrument: m_instruments)
+	{
+		if (instrument.cp == cp)
+		{
+			return &instrument;
+		}
+	}
+	return nullptr;
+}
+
+bool BookCheckpoint::Restore(OrderBook &book, CurrencyPair cp) const
+{
+	const Instrument *instrument { Find(cp) };
+	return instrument && book.RestoreLevels(cp, instrument->bids, instrument->bidCount, instrument->asks,
+											instrument->askCount, instrument->updateId);
+}
+
+} // namespace BOOK
+} // namespace CORE
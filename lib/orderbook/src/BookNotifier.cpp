@@ -0,0 +1,120 @@
+#include <iostream>
+
+#include "Utils/Utils.h"
+#include "OrderBook/BookNotifier.h"
+
+namespace CORE {
+namespace BOOK {
+
+void BookNotifier::Subscribe(Callback callback)
+{
+	std::lock_guard lock { m_mutex };
+	m_subscribers.push_back(std::move(callback));
+}
+
+void BookNotifier::Start()
+{
+	std::lock_guard lock { m_mutex };
+	if (!m_thread.joinable())
+	{
+		m_stop = false;
+		m_running = true;
+		m_thread = std::thread([this] { Run(); });
+	}
+}
+
+void BookNotifier::Stop()
+{
+	{
+		std::lock_guard lock { m_mutex };
+		if (!m_thread.joinable())
+		{
+			return;
+		}
+		m_running = false;
+		m_stop = true;
+	}
+	m_cv.notify_one();
+	m_thread.join();
+
+	std::lock_guard lock { m_mutex };
+	for (InstrumentBook *book: m_pending)
+	{
+		book->NotifyPending().store(false);
+	}
+	m_dropped += m_pending.size();
+	m_pending.clear();
+}
+
+/*! \brief Signals a change of an instrument's book
+ *
+ * Only the first change after a dispatch takes the queue lock; later changes
+ * find the pending flag raised and are conflated.
+ * */
+void BookNotifier::Notify(InstrumentBook &book)
+{
+	if (!m_running.load(std::memory_order_relaxed))
+	{
+		++m_dropped;
+		return;
+	}
+	if (book.NotifyPending().exchange(true, std::memory_order_acq_rel))
+	{
+		++m_conflated;
+		return;
+	}
+	{
+		std::lock_guard lock { m_mutex };
+		if (m_stop) // stopped after the check above
+		{
+			book.NotifyPending().store(false);
+			++m_dropped;
+			return;
+		}
+		m_pending.push_back(&book);
+	}
+	++m_queued;
+	m_cv.notify_one();
+}
+
+void BookNotifier::Run()
+{
+	std::vector<InstrumentBook *> pending;
+	std::vector<Callback> subscribers;
+	for (;;)
+	{
+		{
+			std::unique_lock lock { m_mutex };
+			m_cv.wait(lock, [this] { return m_stop || !m_pending.empty(); });
+			if (m_stop)
+			{
+				return;
+			}
+			pending.swap(m_pending);
+			subscribers = m_subscribers;
+		}
+		for (InstrumentBook *book: pending)
+		{
+			// clear the flag before reading, so a change after the read queues the shard again
+			book->NotifyPending().store(false, std::memory_order_release);
+			const TopOfBook::Snapshot top { book->Top().Read() };
+			for (const auto &subscriber: subscribers)
+			{
+				try
+				{
+					subscriber(book->Instrument(), top);
+				}
+				catch (...)
+				{
+					std::cerr << "Exception thrown in book notification of " << book->Instrument().ToString() << ": "
+							  << UTILS::GetMessage(std::current_exception()) << std::endl;
+				}
+				++m_dispatched;
+			}
+		}
+		pending.clear();
+	}
+}
+
+} // namespace BOOK
+} // namespace CORE
@@ -0,0 +1,157 @@
+#include <algorithm>
+#include <vector>
+
+#include "OrderBook/ConsolidatedBook.h"
+
+using namespace UTILS;
+
+namespace CORE {
+namespace BOOK {
+
+ConsolidatedBook::VenueBookPtr ConsolidatedBook::AddVenue(const std::string &venue, OrderBook::ReadMode readMode)
+{
+	std::lock_guard lock { m_addMutex };
+	const size_t count { m_venueCount.load(std::memory_order_relaxed) };
+	for (size_t i { 0 }; i < count; ++i)
+	{
+		if (m_venues[i].name == venue)
+		{
+			return m_venues[i].book;
+		}
+	}
+	if (count == MAX_VENUES)
+	{
+		return nullptr;
+	}
+	m_venues[count].name = venue;
+	m_venues[count].book = std::make_shared<OrderBook>("OrderBook." + venue);
+	m_venues[count].book->SetReadMode(readMode);
+	// readers only access the venues below the published count
+	m_venueCount.store(count + 1, std::memory_order_release);
+	return m_venues[count].book;
+}
+
+ConsolidatedBook::VenueBookPtr ConsolidatedBook::FindVenue(const std::string &venue) const
+{
+	const size_t index { VenueIndex(venue) };
+	return index != NO_VENUE ? m_venues[index].book : nullptr;
+}
+
+size_t ConsolidatedBook::VenueIndex(const std::string &venue) const
+{
+	const size_t count { VenueCount() };
+	for (size_t i { 0 }; i < count; ++i)
+	{
+		if (m_venues[i].name == venue)
+		{
+			return i;
+		}
+	}
+	return NO_VENUE;
+}
+
+ConsolidatedBook::VenueLevel ConsolidatedBook::GetBestLevel(CurrencyPair cp, bool bid) const
+{
+	VenueLevel result;
+	ForEachVenue([&result, cp, bid](size_t venue, const std::string &, const OrderBook &book)
+	{
+		const InstrumentBook::Ptr shard { book.FindInstrument(cp) };
+		if (shard)
+		{
+			const TopOfBook::Snapshot top { shard->Top().Read() };
+			const VenueLevel level { venue, { top.Price(bid), top.Size(bid), 0, 0, top.timestamp } };
+			if (level.level.price > 0 && (result.venue == NO_VENUE || Better(bid, level, result)))
+			{
+				result = level;
+			}
+		}
+	});
+	return result;
+}
+
+BidAskPair<int64_t> ConsolidatedBook::GetBestPrices(CurrencyPair cp) const
+{
+	return { GetBestLevel(cp, true).level.price, GetBestLevel(cp, false).level.price };
+}
+
+int64_t ConsolidatedBook::GetMidPrice(CurrencyPair cp) const
+{
+	const BidAskPair<int64_t> bestPrices { GetBestPrices(cp) };
+	return bestPrices.Bid() > 0 && bestPrices.Ask() > 0 ? (bestPrices.Bid() + bestPrices.Ask()) / 2 : 0;
+}
+
+/*! \brief Copies the best levels of one side across all venues into a buffer
+ *
+ * Each venue copies its best @a n level summaries into a per-thread scratch
+ * buffer (without locks in the book's snapshot read mode); the sorted runs are
+ * then merged through a heap holding the head level of each venue.
+ * */
+size_t ConsolidatedBook::GetLevels(CurrencyPair cp, bool bid, VenueLevel *levels, size_t n) const
+{
+	const size_t venueCount { VenueCount() };
+	if (n == 0 || venueCount == 0)
+	{
+		return 0;
+	}
+	thread_local std::vector<PriceLadder::LevelSummary> scratch;
+	scratch.resize(std::max(scratch.size(), n * venueCount));
+	std::array<size_t, MAX_VENUES> next { }; // position of the head level of each venue in scratch
+	std::array<size_t, MAX_VENUES> end { };
+	std::array<VenueLevel, MAX_VENUES> heap;
+	size_t heapSize { 0 };
+	auto worse { [bid](const VenueLevel &lhs, const VenueLevel &rhs) { return Better(bid, rhs, lhs); } };
+	for (size_t venue { 0 }; venue < venueCount; ++venue)
+	{
+		next[venue] = venue * n;
+		end[venue] = next[venue] + m_venues[venue].book->GetLevels(cp, bid, &scratch[next[venue]], n);
+		if (next[venue] < end[venue])
+		{
+			heap[heapSize++] = { venue, scratch[next[venue]++] };
+		}
+	}
+	std::make_heap(heap.begin(), heap.begin() + std::ptrdiff_t(heapSize), worse);
+	size_t count { 0 };
+	while (count < n && heapSize > 0)
+	{
+		std::pop_heap(heap.begin(), heap.begin() + std::ptrdiff_t(heapSize), worse);
+		const VenueLevel &best { heap[heapSize - 1] };
+		levels[count++] = best;
+		const size_t venue { best.venue };
+		if (next[venue] < end[venue])
+		{
+			heap[heapSize - 1] = { venue, scratch[next[venue]++] };
+			std::push_heap(heap.begin(), heap.begin() + std::ptrdiff_t(heapSize), worse);
+		}
+		else
+		{
+			--heapSize;
+		}
+	}
+	return count;
+}
+
+size_t ConsolidatedBook::GetQuoteCount(CurrencyPair cp, bool bid) const
+{
+	size_t result { 0 };
+	ForEachVenue([&result, cp, bid](size_t, const std::string &, const OrderBook &book)
+	{
+		result += book.GetQuoteCount(cp, bid);
+	});
+	return result;
+}
+
+bool ConsolidatedBook::Better(bool bid, const VenueLevel &lhs, const VenueLevel &rhs)
+{
+	if (lhs.level.price != rhs.level.price)
+	{
+		return bid ? lhs.level.price > rhs.level.price : lhs.level.price < rhs.level.price;
+	}
+	if (lhs.level.totalVolume != rhs.level.totalVolume)
+	{
+		return lhs.level.totalVolume > rhs.level.totalVolume;
+	}
+	return lhs.venue < rhs.venue;
+}
+
+} // namespace BOOK
+} // namespace CORE
@@ -0,0 +1,170 @@
+#include <algorithm>
+#include <cmath>
+
+#include "OrderBook/DepthIndex.h"
+
+namespace CORE {
+namespace BOOK {
+
+void DepthIndex::Add(int64_t price, int64_t volume)
+{
+	if (volume == 0)
+	{
+		return;
+	}
+	size_t slot { LowerBound(price) };
+	if (slot == m_prices.size() || m_prices[slot] != price)
+	{
+		m_prices.insert(m_prices.begin() + long(slot), price);
+		m_volumes.insert(m_volumes.begin() + long(slot), 0);
+		Rebuild(false);
+	}
+	const int64_t before { m_volumes[slot] };
+	m_volumes[slot] += volume;
+	m_totalVolume += volume;
+	if ((before == 0) != (m_volumes[slot] == 0))
+	{
+		m_liveSlots += before == 0 ? 1 : -1;
+	}
+	Update(slot + 1, volume, double(price) * double(volume));
+	if (m_prices.size() > 64 && m_liveSlots < m_prices.size() / 2)
+	{
+		Rebuild(true);
+	}
+}
+
+void DepthIndex::Clear()
+{
+	m_prices.clear();
+	m_volumes.clear();
+	m_volumeTree.clear();
+	m_notionalTree.clear();
+	m_totalVolume = 0;
+	m_liveSlots = 0;
+}
+
+/*! \brief Sweeps the levels from the best price until a quantity is filled
+ *
+ * Descends the volume tree to the last slot whose cumulative volume stays
+ * below @a qty, summing volume and notional on the way, and fills the rest
+ * from the next slot.
+ * */
+DepthIndex::FillEstimate DepthIndex::CostToFill(int64_t qty) const
+{
+	FillEstimate result;
+	if (qty <= 0 || m_prices.empty())
+	{
+		return result;
+	}
+	size_t pos { 0 };
+	int64_t volume { 0 };
+	double notional { 0 };
+	size_t step { 1 };
+	while (step * 2 <= m_prices.size())
+	{
+		step *= 2;
+	}
+	for (; step > 0; step /= 2)
+	{
+		if (pos + step <= m_prices.size() && volume + m_volumeTree[pos + step] < qty)
+		{
+			pos += step;
+			volume += m_volumeTree[pos];
+			notional += m_notionalTree[pos];
+		}
+	}
+	// pos slots are filled completely; slot pos (0-based) fills the rest, if it exists
+	if (pos < m_prices.size())
+	{
+		const int64_t rest { qty - volume };
+		notional += double(m_prices[pos]) * double(rest);
+		volume = qty;
+		result.worstPrice = m_prices[pos];
+	}
+	else
+	{
+		for (size_t slot { pos }; slot > 0; --slot)
+		{
+			if (m_volumes[slot - 1] != 0)
+			{
+				result.worstPrice = m_prices[slot - 1];
+				break;
+			}
+		}
+	}
+	result.filledQty = volume;
+	result.notional = notional;
+	result.vwap = volume > 0 ? std::llround(notional / double(volume)) : 0;
+	return result;
+}
+
+int64_t DepthIndex::QtyUpToPrice(int64_t price) const
+{
+	// slots at or better than price: those before the first slot worse than price
+	size_t end { LowerBound(price) };
+	if (end < m_prices.size() && m_prices[end] == price)
+	{
+		++end;
+	}
+	int64_t result { 0 };
+	for (size_t i { end }; i > 0; i -= i & (~i + 1))
+	{
+		result += m_volumeTree[i];
+	}
+	return result;
+}
+
+size_t DepthIndex::LowerBound(int64_t price) const
+{
+	return size_t(std::lower_bound(m_prices.begin(), m_prices.end(), price, [this](int64_t lhs, int64_t rhs)
+	{
+		return Better(lhs, rhs);
+	}) - m_prices.begin());
+}
+
+void DepthIndex::Update(size_t slot, int64_t volume, double notional)
+{
+	for (size_t i { slot }; i <= m_prices.size(); i += i & (~i + 1))
+	{
+		m_volumeTree[i] += volume;
+		m_notionalTree[i] += notional;
+	}
+}
+
+void DepthIndex::Rebuild(bool compact)
+{
+	if (compact)
+	{
+		size_t n { 0 };
+		for (size_t i { 0 }; i < m_prices.size(); ++i)
+		{
+			if (m_volumes[i] != 0)
+			{
+				m_prices[n] = m_prices[i];
+				m_volumes[n++] = m_volumes[i];
+			}
+		}
+		m_prices.resize(n);
+		m_volumes.resize(n);
+	}
+	// linear construction: every node passes its sum on to its parent
+	const size_t n { m_prices.size() };
+	m_volumeTree.assign(n + 1, 0);
+	m_notionalTree.assign(n + 1, 0);
+	m_liveSlots = 0;
+	for (size_t i { 1 }; i <= n; ++i)
+	{
+		m_volumeTree[i] += m_volumes[i - 1];
+		m_notionalTree[i] += double(m_prices[i - 1]) * double(m_volumes[i - 1]);
+		m_liveSlots += m_volumes[i - 1] != 0 ? 1 : 0;
+		const size_t parent { i + (i & (~i + 1)) };
+		if (parent <= n)
+		{
+			m_volumeTree[parent] += m_volumeTree[i];
+			m_notionalTree[parent] += m_notionalTree[i];
+		}
+	}
+}
+
+} // namespace BOOK
+} // namespace CORE
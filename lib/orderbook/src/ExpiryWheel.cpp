@@ -0,0 +1,75 @@
+#include "OrderBook/ExpiryWheel.h"
+
+namespace CORE {
+namespace BOOK {
+
+ExpiryWheel::ExpiryWheel(int64_t tick, int64_t now)
+		: m_tick(std::max<int64_t>(tick, 1)), m_current(now / m_tick)
+{
+}
+
+void ExpiryWheel::Reset(int64_t tick, int64_t now)
+{
+	for (auto &level: m_slots)
+	{
+		for (auto &slot: level)
+		{
+			slot.clear();
+		}
+	}
+	m_tick = std::max<int64_t>(tick, 1);
+	m_current = now / m_tick;
+	m_size = 0;
+}
+
+void ExpiryWheel::Schedule(int64_t expiry, int64_t key)
+{
+	// round up, so a key never expires before its time
+	Place({ (expiry + m_tick - 1) / m_tick, key });
+	++m_size;
+}
+
+/*! \brief Places an entry into the slot matching its distance from the current tick
+ *
+ * An entry at level L is S^L <= distance < S^(L+1) ticks away and sits in slot
+ * (tick / S^L) % S; it is cascaded to a lower level when the current tick
+ * reaches the start of that slot's period.
+ * */
+void ExpiryWheel::Place(const Entry &entry)
+{
+	const int64_t distance { entry.tick - m_current };
+	if (distance < SLOTS)
+	{
+		m_slots[0][std::max(entry.tick, m_current) % SLOTS].push_back(entry);
+		return;
+	}
+	int64_t span { SLOTS };
+	for (int level { 1 }; level < LEVELS; ++level, span *= SLOTS)
+	{
+		if (distance < span * SLOTS || level == LEVELS - 1)
+		{
+			// beyond the wheel's range: park the entry in the farthest slot, it is placed again when cascaded
+			const int64_t tick { std::min(entry.tick, m_current + span * SLOTS - 1) };
+			m_slots[level][(tick / span) % SLOTS].push_back(entry);
+			return;
+		}
+	}
+}
+
+void ExpiryWheel::Cascade()
+{
+	int64_t span { SLOTS };
+	for (int level { 1 }; level < LEVELS && m_current % span == 0; ++level, span *= SLOTS)
+	{
+		auto &slot { m_slots[level][(m_current / span) % SLOTS] };
+		std::vector<Entry> entries;
+		entries.swap(slot);
+		for (const auto &entry: entries)
+		{
+			Place(entry);
+		}
+	}
+}
+
+} // namespace BOOK
+} // namespace CORE
@@ -0,0 +1,228 @@
+#include <algorithm>
+#include <sstream>
+#include <stdexcept>
+
+#include "Utils/Utils.h"
+#include "OrderBook/FilterView.h"
+#include "OrderBook/OrderBook.h"
+
+using namespace UTILS;
+
+namespace CORE {
+namespace BOOK {
+
+FilterView::FilterView(std::string name, BookView::Ptr source, QuotePred filter, std::string condition, int64_t maxAge, bool active)
+		: BookView(std::move(name), active), m_source(std::move(source)), m_sortView(nullptr), m_condition(std::move(condition)),
+		  m_maxAge(maxAge)
+{
+	if (!m_source)
+	{
+		throw std::invalid_argument("FilterView " + Name() + ": missing source view");
+	}
+	m_sortView = dynamic_cast<SortView *>(m_source->SortViewPtr());
+	if (const auto upstream { std::dynamic_pointer_cast<FilterView>(m_source) })
+	{
+		// the conditions of the chain are checked by each view, so no view depends on the deltas of another
+		m_filters = upstream->m_filters;
+		if (upstream->m_maxAge > 0)
+		{
+			m_maxAge = m_maxAge > 0 ? std::min(m_maxAge, upstream->m_maxAge) : upstream->m_maxAge;
+		}
+	}
+	if (filter)
+	{
+		m_filters.push_back(std::move(filter));
+	}
+	if (m_sortView)
+	{
+		m_sortView->Book().AddListener(Instrument(), Bid(), *this);
+	}
+}
+
+FilterView::~FilterView()
+{
+	if (m_sortView)
+	{
+		m_sortView->Book().RemoveListener(Instrument(), Bid(), *this);
+	}
+}
+
+FilterView::Ptr FilterView::CreateMinQty(const BookView::Ptr &source, int64_t minQty)
+{
+	const std::string condition { "qty >= " + std::to_string(minQty) };
+	return std::make_shared<FilterView>(source->Name() + " [" + condition + "]", source,
+										[minQty](const Quote &q) { return q.Volume() >= minQty; }, condition);
+}
+
+FilterView::Ptr FilterView::CreateMaxAge(const BookView::Ptr &source, int64_t maxAge)
+{
+	const std::string condition { "age <= " + NanosecondsToString(maxAge) };
+	return std::make_shared<FilterView>(source->Name() + " [" + condition + "]", source, nullptr, condition, maxAge);
+}
+
+FilterView::Ptr FilterView::CreateVenue(const BookView::Ptr &source, const std::string &venue)
+{
+	const std::string condition { "venue == " + venue };
+	return std::make_shared<FilterView>(source->Name() + " [" + condition + "]", source,
+										[venue](const Quote &q) { return q.Originator() == venue; }, condition);
+}
+
+void FilterView::IterateQuoteGroups(const QuoteGroupFunc &action, const QuotePred &quotePred) const
+{
+	IterateQuoteGroups(CurrentTimestamp(), action, quotePred);
+}
+
+/*! \brief Passes a quote group per level of the view to an action, best price first
+ *
+ * Only the levels up to the last one consumed by the action are visited.
+ *
+ * @param now       Current time in nanoseconds (for the maximum age)
+ * @param action    void-function to be called for every quote group
+ * @param quotePred (optional) additional predicate to be fulfilled by a quote
+ * */
+void FilterView::IterateQuoteGroups(int64_t now, const QuoteGroupFunc &action, const QuotePred &quotePred) const
+{
+	std::shared_lock lock { m_mutex };
+	int levelNo { 1 };
+	bool cont { true };
+	auto visit { [this, now, &action, &quotePred, &levelNo, &cont](const Level &level)
+	{
+		QuoteGroup::Ptr quoteGroup { nullptr };
+		for (const auto &q: level)
+		{
+			if ((m_maxAge == 0 || now - q->SortTime() <= m_maxAge) && (!quotePred || quotePred(*q)))
+			{
+				if (!quoteGroup)
+				{
+					quoteGroup = QuoteGroup::Create();
+				}
+				quoteGroup->AddQuote(q);
+			}
+		}
+		if (quoteGroup)
+		{
+			action(levelNo++, quoteGroup, cont);
+		}
+	} };
+	if (Bid())
+	{
+		for (auto it { m_levels.rbegin() }; cont && it != m_levels.rend(); ++it)
+		{
+			visit(it->second);
+		}
+	}
+	else
+	{
+		for (auto it { m_levels.begin() }; cont && it != m_levels.end(); ++it)
+		{
+			visit(it->second);
+		}
+	}
+}
+
+/*! \brief Appends the condition of the view to the conditions of its source views */
+void FilterView::AppendFilter(std::stringstream &ss, bool skipSortView, const std::string &delimiter) const
+{
+	m_source->AppendFilter(ss, skipSortView, delimiter);
+	if (ss.tellp() > 0)
+	{
+		ss << delimiter;
+	}
+	ss << m_condition;
+}
+
+size_t FilterView::LevelCount() const
+{
+	std::shared_lock lock { m_mutex };
+	return m_levels.size();
+}
+
+size_t FilterView::QuoteCount() const
+{
+	std::shared_lock lock { m_mutex };
+	return m_quoteCount;
+}
+
+void FilterView::OnQuoteAdded(bool, const Quote::Ptr &quote)
+{
+	if (Accept(*quote))
+	{
+		std::unique_lock lock { m_mutex };
+		Insert(quote);
+	}
+}
+
+void FilterView::OnQuoteRemoved(bool, const Quote::Ptr &quote)
+{
+	std::unique_lock lock { m_mutex };
+	Remove(quote);
+}
+
+void FilterView::OnLevelChanged(bool, const L2Level &level)
+{
+	// an L2 side holds one quote per price, replaced by each change of its level
+	Quote::Ptr quote { level.qty > 0 ? L2Ladder::ToQuote(level) : nullptr };
+	const bool accepted { quote && Accept(*quote) };
+	std::unique_lock lock { m_mutex };
+	const auto it { m_levels.find(level.price) };
+	if (it != m_levels.end())
+	{
+		m_quoteCount -= it->second.size();
+		m_levels.erase(it);
+	}
+	if (accepted)
+	{
+		Insert(quote);
+	}
+}
+
+void FilterView::OnSideCleared(bool)
+{
+	std::unique_lock lock { m_mutex };
+	m_levels.clear();
+	m_quoteCount = 0;
+}
+
+bool FilterView::Accept(const Quote &quote) const
+{
+	return std::all_of(m_filters.begin(), m_filters.end(), [&quote](const QuotePred &filter) { return filter(quote); });
+}
+
+/*! \brief Inserts a quote at its price (the caller holds the exclusive lock)
+ *
+ * Within a level, quotes are sorted like in the book: greater volume first,
+ * and of equal volumes the newer quote first.
+ * */
+void FilterView::Insert(const Quote::Ptr &quote)
+{
+	Level &level { m_levels[quote->Price()] };
+	level.insert(std::find_if(level.begin(), level.end(), [&quote](const Quote::Ptr &q)
+	{
+		return quote->Volume() > q->Volume() || (quote->Volume() == q->Volume() && quote->SortTime() >= q->SortTime());
+	}), quote);
+	++m_quoteCount;
+}
+
+/*! \brief Removes a quote, if the view holds it (the caller holds the exclusive lock) */
+void FilterView::Remove(const Quote::Ptr &quote)
+{
+	const auto itLevel { m_levels.find(quote->Price()) };
+	if (itLevel == m_levels.end())
+	{
+		return;
+	}
+	Level &level { itLevel->second };
+	const auto it { std::find(level.begin(), level.end(), quote) };
+	if (it != level.end())
+	{
+		level.erase(it);
+		--m_quoteCount;
+		if (level.empty())
+		{
+			m_levels.erase(itLevel);
+		}
+	}
+}
+
+} // namespace BOOK
+} // namespace CORE
@@ -0,0 +1,215 @@
+#include <algorithm>
+
+#include "OrderBook/L2Ladder.h"
+#include "Utils/FixDefs.h"
+
+namespace CORE {
+namespace BOOK {
+
+/*! \brief Sets the quantity at a price level
+ *
+ * An existing level is overwritten in place; a new level is inserted at its
+ * position, and a level whose quantity drops to 0 is erased. Both move only
+ * the levels better than the changed one, which are few for the changes close
+ * to the top of the book. In a full bounded ladder, a new level shifts the
+ * worse levels down over the evicted worst one instead, and a deleted level is
+ * replaced by shifting the worse levels up and refilling the worst one from
+ * the overflow, so the array never grows.
+ * */
+bool L2Ladder::Apply(int64_t price, int64_t qty, int64_t timestamp)
+{
+	m_refilled = 0;
+	const auto it { m_levels.begin() + std::ptrdiff_t(LowerBound(price)) };
+	const bool found { it != m_levels.end() && it->price == price };
+	if (qty <= 0)
+	{
+		if (!found)
+		{
+			ApplyOverflow({ price, 0, 0, timestamp });
+			return false;
+		}
+		m_depth.Add(price, -it->qty);
+		if (m_overflow.empty())
+		{
+			m_levels.erase(it);
+		}
+		else
+		{
+			// the best level of the overflow becomes the worst one of the window
+			std::move_backward(m_levels.begin(), it, it + 1);
+			m_levels.front() = m_overflow.back();
+			m_overflow.pop_back();
+			m_depth.Add(m_levels.front().price, m_levels.front().qty);
+			m_refilled = m_levels.front().price;
+		}
+	}
+	else if (found)
+	{
+		m_depth.Add(price, qty - it->qty);
+		it->qty = qty;
+		it->seq = ++m_seq;
+		it->timestamp = timestamp;
+		return true;
+	}
+	else if (Beyond(price))
+	{
+		// levels may be missing between this one and the window
+		++m_discarded;
+		return false;
+	}
+	else if (m_maxLevels > 0 && m_levels.size() >= m_maxLevels)
+	{
+		if (it == m_levels.begin())
+		{
+			// worse than every level of the full window
+			ApplyOverflow({ price, qty, m_seq + 1, timestamp });
+			return false;
+		}
+		ApplyOverflow(m_levels.front());
+		m_depth.Add(m_levels.front().price, -m_levels.front().qty);
+		m_depth.Add(price, qty);
+		std::move(m_levels.begin() + 1, it, m_levels.begin());
+		*(it - 1) = { price, qty, m_seq + 1, timestamp };
+	}
+	else
+	{
+		m_depth.Add(price, qty);
+		m_levels.insert(it, { price, qty, m_seq + 1, timestamp });
+	}
+	++m_seq;
+	return true;
+}
+
+void L2Ladder::ApplyOverflow(const L2Level &level)
+{
+	const auto it { std::lower_bound(m_overflow.begin(), m_overflow.end(), level.price, [this](const L2Level &l, int64_t p)
+	{
+		return Worse(l.price, p);
+	}) };
+	if (it != m_overflow.end() && it->price == level.price)
+	{
+		if (level.qty > 0)
+		{
+			*it = level;
+		}
+		else
+		{
+			m_overflow.erase(it);
+		}
+	}
+	else if (level.qty <= 0)
+	{
+		return;
+	}
+	else if (Beyond(level.price))
+	{
+		++m_discarded;
+	}
+	else if (m_overflow.size() < m_maxLevels)
+	{
+		m_overflow.insert(it, level);
+	}
+	else if (it == m_overflow.begin())
+	{
+		Discard(level.price);
+	}
+	else
+	{
+		Discard(m_overflow.front().price);
+		std::move(m_overflow.begin() + 1, it, m_overflow.begin());
+		*(it - 1) = level;
+	}
+}
+
+void L2Ladder::Discard(int64_t price)
+{
+	// everything kept is better than the discarded level, so the boundary only moves towards the top
+	m_boundary = price;
+	m_truncated = true;
+	++m_discarded;
+}
+
+void L2Ladder::SetMaxLevels(size_t maxLevels)
+{
+	m_maxLevels = maxLevels;
+	// the window and the overflow are cut anew from all levels kept, worst price first
+	m_overflow.insert(m_overflow.end(), m_levels.begin(), m_levels.end());
+	const size_t windowSize { maxLevels > 0 ? std::min(maxLevels, m_overflow.size()) : m_overflow.size() };
+	const auto itWindow { m_overflow.end() - std::ptrdiff_t(windowSize) };
+	m_levels.reserve(maxLevels);
+	m_levels.assign(itWindow, m_overflow.end());
+	m_overflow.erase(itWindow, m_overflow.end());
+	if (m_overflow.size() > maxLevels)
+	{
+		const auto itKept { m_overflow.end() - std::ptrdiff_t(maxLevels) };
+		m_discarded += uint64_t(itKept - m_overflow.begin()) - 1;
+		Discard((itKept - 1)->price);
+		m_overflow.erase(m_overflow.begin(), itKept);
+	}
+	m_overflow.reserve(maxLevels);
+	m_depth.Clear();
+	for (const L2Level &level: m_levels)
+	{
+		m_depth.Add(level.price, level.qty);
+	}
+}
+
+const L2Level *L2Ladder::Find(int64_t price) const
+{
+	const size_t index { LowerBound(price) };
+	return index < m_levels.size() && m_levels[index].price == price ? &m_levels[index] : nullptr;
+}
+
+bool L2Ladder::CheckOrder() const
+{
+	int64_t totalVolume { 0 };
+	if (m_maxLevels > 0 && (m_levels.size() > m_maxLevels || m_overflow.size() > m_maxLevels))
+	{
+		return false;
+	}
+	if (!m_overflow.empty() && (m_levels.size() < m_maxLevels || Beyond(m_overflow.front().price)
+								|| !Worse(m_overflow.back().price, m_levels.front().price)))
+	{
+		return false;
+	}
+	for (size_t i { 0 }; i < m_overflow.size(); ++i)
+	{
+		if (m_overflow[i].qty <= 0 || (i > 0 && !Worse(m_overflow[i - 1].price, m_overflow[i].price)))
+		{
+			return false;
+		}
+	}
+	if (!m_levels.empty() && Beyond(m_levels.front().price))
+	{
+		return false;
+	}
+	for (size_t i { 0 }; i < m_levels.size(); ++i)
+	{
+		if (m_levels[i].qty <= 0 || (i > 0 && !Worse(m_levels[i - 1].price, m_levels[i].price)))
+		{
+			return false;
+		}
+		if (m_depth.QtyUpToPrice(m_levels[i].price) != m_depth.TotalVolume() - totalVolume)
+		{
+			return false;
+		}
+		totalVolume += m_levels[i].qty;
+	}
+	return totalVolume == m_depth.TotalVolume();
+}
+
+size_t L2Ladder::LowerBound(int64_t price) const
+{
+	return size_t(std::lower_bound(m_levels.begin(), m_levels.end(), price, [this](const L2Level &level, int64_t p)
+	{
+		return Worse(level.price, p);
+	}) - m_levels.begin());
+}
+
+Quote::Ptr L2Ladder::ToQuote(const L2Level &level)
+{
+	return Quote::Create(0, level.timestamp, level.timestamp, "", level.seq, level.price, level.qty, 0, 0, 0, 0, QT_NEW, 0, "", "");
+}
+
+} // namespace BOOK
+} // namespace CORE
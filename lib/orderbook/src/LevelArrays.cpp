@@ -0,0 +1,441 @@
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+
+#include "OrderBook/LevelArrays.h"
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define LEVELARRAYS_X86_KERNELS 1
+#include <immintrin.h>
+#endif
+
+namespace CORE {
+namespace BOOK {
+
+namespace {
+
+//------------------------------------------------------------------------------
+// Scalar kernels (reference and fallback; the vector kernels finish their tails with them)
+
+size_t GroupEndScalar(const int64_t *prices, size_t begin, size_t n)
+{
+	const int64_t price { prices[begin] };
+	size_t i { begin + 1 };
+	while (i < n && prices[i] == price)
+	{
+		++i;
+	}
+	return i;
+}
+
+size_t CumulativeScalar(const int64_t *volumes, size_t begin, size_t n, int64_t sum, int64_t threshold)
+{
+	for (size_t i { begin }; i < n; ++i)
+	{
+		sum += volumes[i];
+		if (sum >= threshold)
+		{
+			return i;
+		}
+	}
+	return n;
+}
+
+size_t FillableScalar(const int64_t *volumes, const int64_t *minQtys, const uint8_t *flags, size_t begin, size_t n,
+					  int64_t qty, uint8_t excludedFlags)
+{
+	for (size_t i { begin }; i < n; ++i)
+	{
+		if (volumes[i] >= qty && minQtys[i] <= qty && (flags[i] & excludedFlags) == 0)
+		{
+			return i;
+		}
+	}
+	return n;
+}
+
+double NotionalScalar(const int64_t *prices, const int64_t *volumes, size_t begin, size_t end)
+{
+	double notional { 0 };
+	for (size_t i { begin }; i < end; ++i)
+	{
+		notional += double(prices[i]) * double(volumes[i]);
+	}
+	return notional;
+}
+
+#ifdef LEVELARRAYS_X86_KERNELS
+
+//------------------------------------------------------------------------------
+// SSE4.2 kernels (two rows per instruction)
+
+__attribute__((target("sse4.2")))
+size_t GroupEndSse4(const int64_t *prices, size_t begin, size_t n)
+{
+	// most levels hold one or two quotes, so the next row is checked before any vector is loaded
+	if (begin + 1 == n || prices[begin + 1] != prices[begin])
+	{
+		return begin + 1;
+	}
+	const __m128i price { _mm_set1_epi64x(prices[begin]) };
+	size_t i { begin + 2 };
+	for (; i + 2 <= n; i += 2)
+	{
+		const __m128i v { _mm_loadu_si128(reinterpret_cast<const __m128i *>(prices + i)) };
+		const int equal { _mm_movemask_pd(_mm_castsi128_pd(_mm_cmpeq_epi64(v, price))) };
+		if (equal != 0x3)
+		{
+			return i + size_t(__builtin_ctz(~equal));
+		}
+	}
+	return i < n && prices[i] == prices[begin] ? i + 1 : i;
+}
+
+__attribute__((target("sse4.2")))
+size_t CumulativeSse4(const int64_t *volumes, size_t begin, size_t n, int64_t threshold)
+{
+	int64_t sum { 0 };
+	size_t i { begin };
+	// whole blocks are skipped while the sum stays below the threshold
+	for (; i + 2 <= n; i += 2)
+	{
+		const __m128i v { _mm_loadu_si128(reinterpret_cast<const __m128i *>(volumes + i)) };
+		const int64_t block { _mm_cvtsi128_si64(v) + _mm_extract_epi64(v, 1) };
+		if (sum + block >= threshold)
+		{
+			break;
+		}
+		sum += block;
+	}
+	return CumulativeScalar(volumes, i, n, sum, threshold);
+}
+
+__attribute__((target("sse4.2")))
+size_t FillableSse4(const int64_t *volumes, const int64_t *minQtys, const uint8_t *flags, size_t begin, size_t n,
+					int64_t qty, uint8_t excludedFlags)
+{
+	const __m128i qtyMinus1 { _mm_set1_epi64x(qty - 1) };
+	const __m128i qtyV { _mm_set1_epi64x(qty) };
+	const __m128i excluded { _mm_set1_epi64x(excludedFlags) };
+	const __m128i zero { _mm_setzero_si128() };
+	size_t i { begin };
+	for (; i + 2 <= n; i += 2)
+	{
+		uint16_t flagBytes;
+		std::memcpy(&flagBytes, flags + i, sizeof(flagBytes));
+		const __m128i f { _mm_cvtepu8_epi64(_mm_cvtsi32_si128(flagBytes)) };
+		const __m128i volumeOk { _mm_cmpgt_epi64(_mm_loadu_si128(reinterpret_cast<const __m128i *>(volumes + i)), qtyMinus1) };
+		const __m128i minQtyTooHigh { _mm_cmpgt_epi64(_mm_loadu_si128(reinterpret_cast<const __m128i *>(minQtys + i)), qtyV) };
+		const __m128i flagsOk { _mm_cmpeq_epi64(_mm_and_si128(f, excluded), zero) };
+		const int match { _mm_movemask_pd(_mm_castsi128_pd(_mm_andnot_si128(minQtyTooHigh, _mm_and_si128(volumeOk, flagsOk)))) };
+		if (match != 0)
+		{
+			return i + size_t(__builtin_ctz(match));
+		}
+	}
+	return FillableScalar(volumes, minQtys, flags, i, n, qty, excludedFlags);
+}
+
+/** @brief Converts signed 64-bit integers to doubles (SSE4.1 has no such instruction)
+ *
+ * The high and low parts are placed in the mantissas of two doubles with
+ * magic exponents, which are subtracted and added back.
+ */
+__attribute__((target("sse4.2")))
+inline __m128d Int64ToDoubleSse4(__m128i x)
+{
+	__m128i high { _mm_srai_epi32(x, 16) };
+	high = _mm_blend_epi16(high, _mm_setzero_si128(), 0x33);
+	high = _mm_add_epi64(high, _mm_castpd_si128(_mm_set1_pd(442721857769029238784.))); // 3 * 2^67
+	const __m128i low { _mm_blend_epi16(x, _mm_castpd_si128(_mm_set1_pd(0x0010000000000000)), 0x88) }; // 2^52
+	const __m128d f { _mm_sub_pd(_mm_castsi128_pd(high), _mm_set1_pd(442726361368656609280.)) }; // 3 * 2^67 + 2^52
+	return _mm_add_pd(f, _mm_castsi128_pd(low));
+}
+
+__attribute__((target("sse4.2")))
+double NotionalSse4(const int64_t *prices, const int64_t *volumes, size_t begin, size_t end)
+{
+	// two accumulators, so consecutive additions do not wait for each other
+	__m128d sum0 { _mm_setzero_pd() };
+	__m128d sum1 { _mm_setzero_pd() };
+	size_t i { begin };
+	for (; i + 4 <= end; i += 4)
+	{
+		const __m128d p0 { Int64ToDoubleSse4(_mm_loadu_si128(reinterpret_cast<const __m128i *>(prices + i))) };
+		const __m128d v0 { Int64ToDoubleSse4(_mm_loadu_si128(reinterpret_cast<const __m128i *>(volumes + i))) };
+		const __m128d p1 { Int64ToDoubleSse4(_mm_loadu_si128(reinterpret_cast<const __m128i *>(prices + i + 2))) };
+		const __m128d v1 { Int64ToDoubleSse4(_mm_loadu_si128(reinterpret_cast<const __m128i *>(volumes + i + 2))) };
+		sum0 = _mm_add_pd(sum0, _mm_mul_pd(p0, v0));
+		sum1 = _mm_add_pd(sum1, _mm_mul_pd(p1, v1));
+	}
+	double lanes[2];
+	_mm_storeu_pd(lanes, _mm_add_pd(sum0, sum1));
+	return lanes[0] + lanes[1] + NotionalScalar(prices, volumes, i, end);
+}
+
+//------------------------------------------------------------------------------
+// AVX2 kernels (four rows per instruction)
+
+__attribute__((target("avx2")))
+size_t GroupEndAvx2(const int64_t *prices, size_t begin, size_t n)
+{
+	// most levels hold one or two quotes, so the next row is checked before any vector is loaded
+	if (begin + 1 == n || prices[begin + 1] != prices[begin])
+	{
+		return begin + 1;
+	}
+	const __m256i price { _mm256_set1_epi64x(prices[begin]) };
+	size_t i { begin + 2 };
+	for (; i + 4 <= n; i += 4)
+	{
+		const __m256i v { _mm256_loadu_si256(reinterpret_cast<const __m256i *>(prices + i)) };
+		const int equal { _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpeq_epi64(v, price))) };
+		if (equal != 0xf)
+		{
+			return i + size_t(__builtin_ctz(~equal));
+		}
+	}
+	while (i < n && prices[i] == prices[begin])
+	{
+		++i;
+	}
+	return i;
+}
+
+__attribute__((target("avx2")))
+size_t CumulativeAvx2(const int64_t *volumes, size_t begin, size_t n, int64_t threshold)
+{
+	int64_t sum { 0 };
+	size_t i { begin };
+	// whole blocks are skipped while the sum stays below the threshold
+	for (; i + 4 <= n; i += 4)
+	{
+		const __m256i v { _mm256_loadu_si256(reinterpret_cast<const __m256i *>(volumes + i)) };
+		const __m128i s { _mm_add_epi64(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1)) };
+		const int64_t block { _mm_cvtsi128_si64(s) + _mm_extract_epi64(s, 1) };
+		if (sum + block >= threshold)
+		{
+			break;
+		}
+		sum += block;
+	}
+	return CumulativeScalar(volumes, i, n, sum, threshold);
+}
+
+__attribute__((target("avx2")))
+size_t FillableAvx2(const int64_t *volumes, const int64_t *minQtys, const uint8_t *flags, size_t begin, size_t n,
+					int64_t qty, uint8_t excludedFlags)
+{
+	const __m256i qtyMinus1 { _mm256_set1_epi64x(qty - 1) };
+	const __m256i qtyV { _mm256_set1_epi64x(qty) };
+	const __m256i excluded { _mm256_set1_epi64x(excludedFlags) };
+	const __m256i zero { _mm256_setzero_si256() };
+	size_t i { begin };
+	for (; i + 4 <= n; i += 4)
+	{
+		int32_t flagBytes;
+		std::memcpy(&flagBytes, flags + i, sizeof(flagBytes));
+		const __m256i f { _mm256_cvtepu8_epi64(_mm_cvtsi32_si128(flagBytes)) };
+		const __m256i volumeOk { _mm256_cmpgt_epi64(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(volumes + i)), qtyMinus1) };
+		const __m256i minQtyTooHigh { _mm256_cmpgt_epi64(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(minQtys + i)), qtyV) };
+		const __m256i flagsOk { _mm256_cmpeq_epi64(_mm256_and_si256(f, excluded), zero) };
+		const int match { _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_andnot_si256(minQtyTooHigh, _mm256_and_si256(volumeOk, flagsOk)))) };
+		if (match != 0)
+		{
+			return i + size_t(__builtin_ctz(match));
+		}
+	}
+	return FillableScalar(volumes, minQtys, flags, i, n, qty, excludedFlags);
+}
+
+/** @brief Converts signed 64-bit integers to doubles (see @a Int64ToDoubleSse4) */
+__attribute__((target("avx2")))
+inline __m256d Int64ToDoubleAvx2(__m256i x)
+{
+	__m256i high { _mm256_srai_epi32(x, 16) };
+	high = _mm256_blend_epi16(high, _mm256_setzero_si256(), 0x33);
+	high = _mm256_add_epi64(high, _mm256_castpd_si256(_mm256_set1_pd(442721857769029238784.))); // 3 * 2^67
+	const __m256i low { _mm256_blend_epi16(x, _mm256_castpd_si256(_mm256_set1_pd(0x0010000000000000)), 0x88) }; // 2^52
+	const __m256d f { _mm256_sub_pd(_mm256_castsi256_pd(high), _mm256_set1_pd(442726361368656609280.)) }; // 3 * 2^67 + 2^52
+	return _mm256_add_pd(f, _mm256_castsi256_pd(low));
+}
+
+__attribute__((target("avx2")))
+double NotionalAvx2(const int64_t *prices, const int64_t *volumes, size_t begin, size_t end)
+{
+	__m256d sum0 { _mm256_setzero_pd() };
+	__m256d sum1 { _mm256_setzero_pd() };
+	size_t i { begin };
+	for (; i + 8 <= end; i += 8)
+	{
+		const __m256d p0 { Int64ToDoubleAvx2(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(prices + i))) };
+		const __m256d v0 { Int64ToDoubleAvx2(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(volumes + i))) };
+		const __m256d p1 { Int64ToDoubleAvx2(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(prices + i + 4))) };
+		const __m256d v1 { Int64ToDoubleAvx2(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(volumes + i + 4))) };
+		sum0 = _mm256_add_pd(sum0, _mm256_mul_pd(p0, v0));
+		sum1 = _mm256_add_pd(sum1, _mm256_mul_pd(p1, v1));
+	}
+	double lanes[4];
+	_mm256_storeu_pd(lanes, _mm256_add_pd(sum0, sum1));
+	return (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]) + NotionalScalar(prices, volumes, i, end);
+}
+
+#endif // LEVELARRAYS_X86_KERNELS
+
+SimdLevel DetectSimdLevel()
+{
+#ifdef LEVELARRAYS_X86_KERNELS
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx2"))
+	{
+		return SimdLevel::AVX2;
+	}
+	if (__builtin_cpu_supports("sse4.2"))
+	{
+		return SimdLevel::SSE4;
+	}
+#endif
+	return SimdLevel::Scalar;
+}
+
+const SimdLevel s_supportedLevel { DetectSimdLevel() };
+std::atomic<SimdLevel> s_activeLevel { s_supportedLevel };
+
+} // namespace
+
+void LevelArrays::Clear()
+{
+	m_prices.clear();
+	m_volumes.clear();
+	m_minQtys.clear();
+	m_flags.clear();
+}
+
+void LevelArrays::Reserve(size_t n)
+{
+	m_prices.reserve(n);
+	m_volumes.reserve(n);
+	m_minQtys.reserve(n);
+	m_flags.reserve(n);
+}
+
+void LevelArrays::Append(int64_t price, int64_t volume, int64_t minQty, uint8_t flags)
+{
+	m_prices.push_back(price);
+	m_volumes.push_back(volume);
+	m_minQtys.push_back(minQty);
+	m_flags.push_back(flags);
+}
+
+void LevelArrays::Assign(const PriceLadder &ladder)
+{
+	Clear();
+	Reserve(ladder.QuoteCount());
+	ladder.ForEachQuote([this](const Quote::Ptr &q, bool &)
+	{
+		Append(q->Price(), q->Volume(), q->MinQty(), uint8_t((q->Used() ? FLAG_USED : 0) | (q->Valid() ? 0 : FLAG_INVALID)));
+	});
+}
+
+void LevelArrays::Assign(const L2Ladder &ladder)
+{
+	Clear();
+	Reserve(ladder.LevelCount());
+	ladder.ForEachL2Level([this](const L2Level &level, bool &)
+	{
+		Append(level.price, level.qty, 0, 0);
+	});
+}
+
+size_t LevelArrays::GroupEnd(size_t begin) const
+{
+	const size_t n { Size() };
+	if (begin >= n)
+	{
+		return n;
+	}
+	switch (s_activeLevel.load(std::memory_order_relaxed))
+	{
+#ifdef LEVELARRAYS_X86_KERNELS
+		case SimdLevel::AVX2:
+			return GroupEndAvx2(Prices(), begin, n);
+		case SimdLevel::SSE4:
+			return GroupEndSse4(Prices(), begin, n);
+#endif
+		default:
+			return GroupEndScalar(Prices(), begin, n);
+	}
+}
+
+size_t LevelArrays::FindCumulativeVolume(size_t begin, int64_t threshold) const
+{
+	const size_t n { Size() };
+	if (begin >= n)
+	{
+		return n;
+	}
+	switch (s_activeLevel.load(std::memory_order_relaxed))
+	{
+#ifdef LEVELARRAYS_X86_KERNELS
+		case SimdLevel::AVX2:
+			return CumulativeAvx2(Volumes(), begin, n, threshold);
+		case SimdLevel::SSE4:
+			return CumulativeSse4(Volumes(), begin, n, threshold);
+#endif
+		default:
+			return CumulativeScalar(Volumes(), begin, n, 0, threshold);
+	}
+}
+
+size_t LevelArrays::FindFirstFillable(int64_t qty, uint8_t excludedFlags) const
+{
+	switch (s_activeLevel.load(std::memory_order_relaxed))
+	{
+#ifdef LEVELARRAYS_X86_KERNELS
+		case SimdLevel::AVX2:
+			return FillableAvx2(Volumes(), MinQtys(), Flags(), 0, Size(), qty, excludedFlags);
+		case SimdLevel::SSE4:
+			return FillableSse4(Volumes(), MinQtys(), Flags(), 0, Size(), qty, excludedFlags);
+#endif
+		default:
+			return FillableScalar(Volumes(), MinQtys(), Flags(), 0, Size(), qty, excludedFlags);
+	}
+}
+
+double LevelArrays::Notional(size_t begin, size_t end) const
+{
+	end = std::min(end, Size());
+	if (begin >= end)
+	{
+		return 0;
+	}
+	switch (s_activeLevel.load(std::memory_order_relaxed))
+	{
+#ifdef LEVELARRAYS_X86_KERNELS
+		case SimdLevel::AVX2:
+			return NotionalAvx2(Prices(), Volumes(), begin, end);
+		case SimdLevel::SSE4:
+			return NotionalSse4(Prices(), Volumes(), begin, end);
+#endif
+		default:
+			return NotionalScalar(Prices(), Volumes(), begin, end);
+	}
+}
+
+SimdLevel LevelArrays::SupportedSimdLevel()
+{
+	return s_supportedLevel;
+}
+
+SimdLevel LevelArrays::ActiveSimdLevel()
+{
+	return s_activeLevel.load(std::memory_order_relaxed);
+}
+
+void LevelArrays::SetSimdLevel(SimdLevel level)
+{
+	s_activeLevel.store(level > s_supportedLevel ? s_supportedLevel : level, std::memory_order_relaxed);
+}
+
+} // namespace BOOK
+} // namespace CORE
@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <memory>
 
 #include <Poco/DOM/Node.h>
@@ -9,6 +10,7 @@
 #include "Utils/Utils.h"
 #include "Utils/CurrencyPair.h"
 #include "OrderBook/OrderBook.h"
+#include "OrderBook/BookCheckpoint.h"
 
 #include <Poco/Logger.h>
 
@@ -17,6 +19,14 @@ using namespace UTILS;
 namespace CORE {
 namespace BOOK {
 
+OrderBook::~OrderBook()
+{
+	if (Quote *last { m_lastQuote.load() })
+	{
+		IntrusiveRelease(last);
+	}
+}
+
 std::string OrderBook::propDefaultValue(const std::string &name) const
 {
 	if (name == ATTR_BATCHSIZE)
@@ -43,7 +53,13 @@ std::string OrderBook::propDefaultValue(const std::string &name) const
 
 void OrderBook::AddEntry(int64_t key, int64_t refKey, int64_t receiveTime, CurrencyPair cp, const BookUpdate::Entry &entry)
 {
-    AddQuote(cp, entry.entryType.Bid(),
+	InstrumentBook &book { *AddInstrument(cp) };
+	if (book.GetMode() == InstrumentBook::Mode::Levels)
+	{
+		AddLevel(book, entry);
+		return;
+	}
+    AddQuote(book, entry.entryType.Bid(),
 		QuotePool::getQuote(__PRETTY_FUNCTION__,
 							true,
 							std::this_thread::get_id(),
@@ -52,110 +68,261 @@ void OrderBook::AddEntry(int64_t key, int64_t refKey, int64_t receiveTime, Curre
 							CurrentTimestamp(),
 							entry.quoteId,
 							1,
-							cp.DblToCpip(entry.price),
-							cp.DoubleToQty(entry.volume),
-							cp.DoubleToQty(entry.minQty),
+							entry.price,
+							entry.volume,
+							entry.minQty,
 							key,
 							refKey,
 							0,
 							int(entry.updateType),
 							int(entry.positionNo),
 							entry.settlDate,
-							entry.originators));
+							entry.originators), entry.endOfMessage);
 }
 
 void OrderBook::AddEntry(int64_t key, int64_t refKey, int64_t sendTime, int64_t receiveTime, CurrencyPair cp,
 						const BookUpdate::Entry &entry)
 {
-    AddQuote(cp, entry.entryType.Bid(),
+	InstrumentBook &book { *AddInstrument(cp) };
+	if (book.GetMode() == InstrumentBook::Mode::Levels)
+	{
+		AddLevel(book, entry);
+		return;
+	}
+    AddQuote(book, entry.entryType.Bid(),
 		QuotePool::getQuote(__PRETTY_FUNCTION__, true, std::this_thread::get_id(),
 			entry.adptReceiveTime, receiveTime, CurrentTimestamp(), entry.quoteId,
-							1, cp.DblToCpip(entry.price),
-							cp.DoubleToQty(entry.volume), cp.DoubleToQty(entry.minQty), key, refKey, sendTime, int(entry.updateType),
-							int(entry.positionNo), entry.settlDate, entry.originators));
+							1, entry.price, entry.volume, entry.minQty, key, refKey, sendTime, int(entry.updateType),
+							int(entry.positionNo), entry.settlDate, entry.originators), entry.endOfMessage);
+}
+
+void OrderBook::AddEntry(InstrumentBook &book, int64_t key, int64_t refKey, int64_t sendTime, int64_t receiveTime,
+						const BookUpdate::Entry &entry)
+{
+	if (book.GetMode() == InstrumentBook::Mode::Levels)
+	{
+		AddLevel(book, entry);
+		return;
+	}
+	AddQuote(book, entry.entryType.Bid(), CreateQuote(key, refKey, sendTime, receiveTime, entry), entry.endOfMessage);
 }
 
-void OrderBook::AddQuote(CurrencyPair cp, bool bid, Quote::Ptr quote)
+void OrderBook::ApplyBatch(const BookUpdate &update)
 {
-	auto midPrice=GetMidPrice(cp);
+	bool midChanged { false };
+	const auto &entries { update.entries };
+	for (size_t begin { 0 }; begin < entries.size();)
 	{
-		std::shared_lock lockMap { m_quoteVectorMap.Mutex() };
-		
-		auto it { m_quoteVectorMap->find(cp) };
-		
-		if (it == m_quoteVectorMap->end())
+		// runs of entries of the same instrument share one shard lookup and one lock acquisition
+		const CurrencyPair cp { entries[begin].instrument };
+		size_t end { begin + 1 };
+		while (end < entries.size() && entries[end].instrument == cp)
 		{
-			lockMap.unlock();
-			{
-				std::unique_lock uniqueLock { m_quoteVectorMap.Mutex() };
-				m_quoteVectorMap->emplace(cp, BidAskPair<QuoteVecPtr>(std::make_shared<QuoteVec>(), std::make_shared<QuoteVec>()));
-			}
-			lockMap.lock();
-			it = m_quoteVectorMap->find(cp);
-			if (it == m_quoteVectorMap->end())
-			{
-				poco_error_f1(logger(), "FAILED TO CREATE QUOTE VECTOR ENTRY FOR %s", cp.ToString());
-				return;
-			}
+			++end;
 		}
-		
-		std::unique_lock lock { GetLock(cp, bid) };
-		
-		QuoteVecPtr vec { it->second.Get(bid) };
-		lockMap.unlock();
-		// delete, check if there is something to delete, then erase element and change rest of affected quotes
-		if (quote->QuoteType() == QT_DELETE || quote->QuoteType() == QT_UPDATE)
+		if (cp.Valid())
 		{
-			if (!vec->empty() && quote->RefKey() > 0)
+			InstrumentBook &book { *AddInstrument(cp) };
+			if (ApplyEntries(book, &entries[begin], end - begin))
 			{
-				const auto
-						&resultIter { std::find_if(vec->begin(), vec->end(), [&quote](const Quote::Ptr &q) { return q->Key() == quote->RefKey(); }) };
-				if (resultIter != vec->end())
+				if (m_notifier.Running())
 				{
-					(*resultIter)->SetInvalid(quote);
-					vec->erase(resultIter);
-				}
-				else
-				{
-                    std::string msg = UTILS::Format("*** %s %s/%Ld: FAILED UPDATE/DELETE: Quote with RefKey %Ld %Ld not found !!! ***", cp.ToString(),
-                                                    quote->SeqNum(), quote->RefKey(), quote->Price());
-					poco_error(logger(),msg);
+					m_notifier.Notify(book);
 				}
+				midChanged = true;
+			}
+		}
+		else
+		{
+			poco_error_f1(logger(), "*** ApplyBatch: %z entries without valid instrument skipped ***", end - begin);
+		}
+		begin = end;
+	}
+	if (midChanged && m_action)
+	{
+		m_action(); //Need to recheck the GridBot current orders and fill status
+	}
+}
+
+void OrderBook::ApplyBatch(InstrumentBook &book, const BookUpdate &update)
+{
+	if (!update.entries.empty() && ApplyEntries(book, update.entries.data(), update.entries.size()))
+	{
+		NotifyMidChange(book);
+	}
+}
+
+bool OrderBook::ApplyEntries(InstrumentBook &book, const BookUpdate::Entry *entries, size_t count)
+{
+	const CurrencyPair cp { book.Instrument() };
+	const int64_t previousMid { book.Top().Read().MidPrice() };
+	const int64_t receiveTime { CurrentTimestamp() };
+	Quote::Ptr lastQuote;
+	bool changed[2] { false, false };
+	{
+		std::scoped_lock lock { book.Mutex(true), book.Mutex(false) };
+		// the mode only changes while both side locks are held
+		const bool levels { book.GetMode() == InstrumentBook::Mode::Levels };
+		for (size_t i { 0 }; i < count; ++i)
+		{
+			const BookUpdate::Entry &entry { entries[i] };
+			if ((entry.key == 0 && !levels) || !entry.entryType.Valid() || !(entry.instrument == cp))
+			{
+				continue;
+			}
+			const bool bid { entry.entryType.Bid() };
+			if (levels)
+			{
+				ApplyLevel(book, bid, entry, receiveTime);
 			}
 			else
 			{
-				poco_error_f3(logger(), "*** %s/%Ld %Ld: Missing RefKey in UPDATE/DELETE ***", cp.ToString(),  quote->SeqNum(), quote->Price());
+				lastQuote = CreateQuote(entry.key, entry.refKey, receiveTime, receiveTime, entry);
+				ApplyQuote(book, bid, lastQuote);
 			}
+			changed[bid ? 0 : 1] = true;
 		}
-		if (quote->QuoteType() != QT_DELETE)
+		for (bool bid: { true, false })
 		{
-			if (vec->empty()) // vector empty, create and no need to sort
+			if (changed[bid ? 0 : 1])
 			{
-				vec->push_back(quote);
+				PublishTopOfBook(book, bid);
 			}
-			else // vector NOT empty, update and sort or insert at correct position
+		}
+	}
+	if (!changed[0] && !changed[1])
+	{
+		return false;
+	}
+
+	if (lastQuote)
+	{
+		PublishLastQuote(std::move(lastQuote));
+	}
+
+	if (m_readMode.load(std::memory_order_relaxed) == ReadMode::Snapshot)
+	{
+		PublishSnapshots(book);
+	}
+	return previousMid != book.Top().Read().MidPrice();
+}
+
+Quote::Ptr OrderBook::CreateQuote(int64_t key, int64_t refKey, int64_t sendTime, int64_t receiveTime, const BookUpdate::Entry &entry)
+{
+	return QuotePool::getQuote(__PRETTY_FUNCTION__, true, std::this_thread::get_id(),
+							   entry.adptReceiveTime, receiveTime, CurrentTimestamp(), entry.quoteId,
+							   1, entry.price, entry.volume, entry.minQty, key, refKey, sendTime, int(entry.updateType),
+							   int(entry.positionNo), entry.settlDate, entry.originators);
+}
+
+InstrumentBook::Ptr OrderBook::AddInstrument(CurrencyPair cp)
+{
+	{
+		std::shared_lock slock { m_instrumentMap.Mutex() };
+		const auto &it { m_instrumentMap->find(cp) };
+		if (it != m_instrumentMap->end())
+		{
+			return it->second;
+		}
+	}
+	std::unique_lock ulock { m_instrumentMap.Mutex() };
+	InstrumentBook::Ptr &book { (*m_instrumentMap)[cp] };
+	if (!book)
+	{
+		book = std::make_shared<InstrumentBook>(cp);
+		if (m_readMode.load() == ReadMode::Snapshot)
+		{
+			PublishSnapshots(*book, true);
+		}
+	}
+	return book;
+}
+
+void OrderBook::SetReadMode(ReadMode mode)
+{
+	std::shared_lock lockInstrumentMap { m_instrumentMap.Mutex() };
+	if (m_readMode.exchange(mode) != mode && mode == ReadMode::Snapshot)
+	{
+		for (const auto &it: *m_instrumentMap)
+		{
+			PublishSnapshots(*it.second, true);
+		}
+	}
+}
+
+void OrderBook::PublishSnapshots(InstrumentBook &book, bool force)
+{
+	for (bool bid: { true, false })
+	{
+		if (book.Dirty(bid).load() || force)
+		{
+			auto *snapshot { new LadderSnapshot };
+			const LadderSnapshot *previous;
 			{
-				//insert quote at right place
-				vec->insert(std::find_if(vec->begin(), vec->end(), [bid, &quote](const Quote::Ptr &q)
+				// the exclusive lock orders concurrent publishers of the same side
+				std::unique_lock lock { book.Mutex(bid) };
+				const PriceLadder &ladder { book.Ladder(bid) };
+				book.Dirty(bid).store(false);
+				snapshot->levels = ladder.CopyLevels();
+				snapshot->quoteCount = ladder.QuoteCount();
+				snapshot->depth = ladder.Depth();
+				snapshot->l2 = book.L2(bid);
+				if (book.GetMode() == InstrumentBook::Mode::Levels)
 				{
-					if (quote->Price() != q->Price()) // different price -> better price first
-					{
-						return bid ? quote->Price() > q->Price() : quote->Price() < q->Price();
-					}
-					else // same price -> greater volume first
-					{
-						return quote->Volume() >= q->Volume();
-					}
-				}), quote);
+					snapshot->arrays.Assign(snapshot->l2);
+				}
+				else
+				{
+					snapshot->arrays.Assign(ladder);
+				}
+				previous = book.ExchangeSnapshot(bid, snapshot);
+			}
+			if (previous)
+			{
+				m_epochDomain.Retire([previous] { delete previous; });
 			}
 		}
 	}
+}
 
-	std::atomic_store(&m_lastQuote, quote);
+InstrumentBook::Ptr OrderBook::FindInstrument(CurrencyPair cp) const
+{
+	std::shared_lock slock { m_instrumentMap.Mutex() };
+	const auto &it { m_instrumentMap->find(cp) };
+	return it != m_instrumentMap->end() ? it->second : nullptr;
+}
 
-	if ( midPrice != GetMidPrice(cp) ) //We have a different 'mid price' so we have price movement!
+std::vector<InstrumentBook::Ptr> OrderBook::GetInstruments() const
+{
+	std::shared_lock slock { m_instrumentMap.Mutex() };
+	std::vector<InstrumentBook::Ptr> result;
+	result.reserve(m_instrumentMap->size());
+	for (const auto &it: *m_instrumentMap)
 	{
-		m_action(); //Need to recheck the GridBot current orders and fill status
+		result.push_back(it.second);
+	}
+	return result;
+}
+
+void OrderBook::AddQuote(InstrumentBook &book, bool bid, Quote::Ptr quote, bool endOfMessage)
+{
+	TopOfBook::Snapshot previousTop;
+	{
+		std::unique_lock lock { book.Mutex(bid) };
+		ApplyQuote(book, bid, quote);
+		previousTop = PublishTopOfBook(book, bid);
+	}
+
+	if (endOfMessage && m_readMode.load(std::memory_order_relaxed) == ReadMode::Snapshot)
+	{
+		PublishSnapshots(book);
+	}
+
+	PublishLastQuote(std::move(quote));
+
+	if (previousTop.MidPrice() != book.Top().Read().MidPrice()) //We have a different 'mid price' so we have price movement!
+	{
+		NotifyMidChange(book);
 	}
 
 	// static int cnt=1;
@@ -168,6 +335,203 @@ void OrderBook::AddQuote(CurrencyPair cp, bool bid, Quote::Ptr quote)
 	// }
 }
 
+void OrderBook::NotifyMidChange(InstrumentBook &book)
+{
+	if (m_action)
+	{
+		m_action(); //Need to recheck the GridBot current orders and fill status
+	}
+	if (m_notifier.Running())
+	{
+		m_notifier.Notify(book);
+	}
+}
+
+void OrderBook::AddLevel(InstrumentBook &book, const BookUpdate::Entry &entry)
+{
+	if (!entry.entryType.Valid())
+	{
+		return;
+	}
+	const bool bid { entry.entryType.Bid() };
+	TopOfBook::Snapshot previousTop;
+	{
+		std::unique_lock lock { book.Mutex(bid) };
+		ApplyLevel(book, bid, entry, CurrentTimestamp());
+		previousTop = PublishTopOfBook(book, bid);
+	}
+
+	if (entry.endOfMessage && m_readMode.load(std::memory_order_relaxed) == ReadMode::Snapshot)
+	{
+		PublishSnapshots(book);
+	}
+
+	if (previousTop.MidPrice() != book.Top().Read().MidPrice())
+	{
+		NotifyMidChange(book);
+	}
+}
+
+void OrderBook::ApplyLevel(InstrumentBook &book, bool bid, const BookUpdate::Entry &entry, int64_t timestamp)
+{
+	const int64_t price { entry.price };
+	const int64_t qty { entry.updateType == QT_DELETE ? 0 : entry.volume };
+	L2Ladder &l2 { book.L2(bid) };
+	const bool listening { !book.Listeners(bid).empty() };
+	// a new level of a full bounded ladder evicts the worst one, which the listeners must learn about
+	const L2Level *worst { listening && l2.MaxLevels() > 0 && l2.LevelCount() == l2.MaxLevels() ? l2.WorstLevel() : nullptr };
+	const int64_t worstPrice { worst ? worst->price : 0 };
+	if (l2.Apply(price, qty, timestamp))
+	{
+		const int64_t maxAge { book.MaxQuoteAge() };
+		if (qty > 0 && maxAge > 0)
+		{
+			// levels are keyed by their price in the expiry wheel
+			book.Wheel(bid).Schedule(timestamp + maxAge, price);
+		}
+		book.Dirty(bid).store(true);
+		if (listening)
+		{
+			NotifyLevel(book, bid, price, timestamp);
+			if (worstPrice != 0 && worstPrice != price && !l2.Find(worstPrice))
+			{
+				NotifyLevel(book, bid, worstPrice, timestamp);
+			}
+		}
+		RefillLevel(book, bid, timestamp);
+	}
+}
+
+void OrderBook::RefillLevel(InstrumentBook &book, bool bid, int64_t timestamp)
+{
+	// a delete in a full bounded ladder moves a level from the overflow into the window
+	const L2Ladder &l2 { book.L2(bid) };
+	const L2Level *refilled { l2.Refilled() != 0 ? l2.Find(l2.Refilled()) : nullptr };
+	if (!refilled)
+	{
+		return;
+	}
+	const int64_t maxAge { book.MaxQuoteAge() };
+	if (maxAge > 0)
+	{
+		book.Wheel(bid).Schedule(refilled->timestamp + maxAge, refilled->price);
+	}
+	if (!book.Listeners(bid).empty())
+	{
+		NotifyLevel(book, bid, refilled->price, timestamp);
+	}
+}
+
+void OrderBook::NotifyLevel(InstrumentBook &book, bool bid, int64_t price, int64_t timestamp)
+{
+	const L2Level *level { book.L2(bid).Find(price) };
+	const L2Level current { level ? *level : L2Level { price, 0, 0, timestamp } };
+	for (BookListener *listener: book.Listeners(bid))
+	{
+		listener->OnLevelChanged(bid, current);
+	}
+}
+
+void OrderBook::ReplaySide(InstrumentBook &book, bool bid, BookListener &listener)
+{
+	if (book.GetMode() == InstrumentBook::Mode::Levels)
+	{
+		book.L2(bid).ForEachL2Level([&listener, bid](const L2Level &level, bool &)
+		{
+			listener.OnLevelChanged(bid, level);
+		});
+	}
+	else
+	{
+		book.Ladder(bid).ForEachQuote([&listener, bid](const Quote::Ptr &q, bool &)
+		{
+			listener.OnQuoteAdded(bid, q);
+		});
+	}
+}
+
+void OrderBook::ClearSide(InstrumentBook &book, bool bid, int64_t now)
+{
+	PriceLadder &ladder { book.Ladder(bid) };
+	ladder.ForEachQuote([](const Quote::Ptr &q, bool &)
+	{
+		q->SetInvalid(nullptr);
+	});
+	ladder.Clear();
+	book.L2(bid).Clear();
+	book.Wheel(bid).Reset(book.Wheel(bid).Tick(), now);
+	book.Dirty(bid).store(true);
+	for (BookListener *listener: book.Listeners(bid))
+	{
+		listener->OnSideCleared(bid);
+	}
+}
+
+void OrderBook::AddListener(CurrencyPair cp, bool bid, BookListener &listener)
+{
+	const InstrumentBook::Ptr book { AddInstrument(cp) };
+	std::unique_lock lock { book->Mutex(bid) };
+	ReplaySide(*book, bid, listener);
+	book->Listeners(bid).push_back(&listener);
+}
+
+void OrderBook::RemoveListener(CurrencyPair cp, bool bid, BookListener &listener)
+{
+	const InstrumentBook::Ptr book { FindInstrument(cp) };
+	if (book)
+	{
+		std::unique_lock lock { book->Mutex(bid) };
+		std::vector<BookListener *> &listeners { book->Listeners(bid) };
+		listeners.erase(std::remove(listeners.begin(), listeners.end(), &listener), listeners.end());
+	}
+}
+
+void OrderBook::ApplyQuote(InstrumentBook &book, bool bid, const Quote::Ptr &quote)
+{
+	const CurrencyPair cp { book.Instrument() };
+	PriceLadder &ladder { book.Ladder(bid) };
+	// delete, check if there is something to delete, then erase element and change rest of affected quotes
+	if (quote->QuoteType() == QT_DELETE || quote->QuoteType() == QT_UPDATE)
+	{
+		if (!ladder.Empty() && quote->RefKey() > 0)
+		{
+			const Quote::Ptr refQuote { ladder.Remove(quote->RefKey()) };
+			if (refQuote)
+			{
+				refQuote->SetInvalid(quote);
+				for (BookListener *listener: book.Listeners(bid))
+				{
+					listener->OnQuoteRemoved(bid, refQuote);
+				}
+			}
+			else
+			{
+                    std::string msg = UTILS::Format("*** %s %s/%Ld: FAILED UPDATE/DELETE: Quote with RefKey %Ld %Ld not found !!! ***", cp.ToString(),
+                                                    quote->SeqNum(), quote->RefKey(), quote->Price());
+				poco_error(logger(),msg);
+			}
+		}
+		else
+		{
+			poco_error_f3(logger(), "*** %s/%Ld %Ld: Missing RefKey in UPDATE/DELETE ***", cp.ToString(),  quote->SeqNum(), quote->Price());
+		}
+	}
+	if (quote->QuoteType() != QT_DELETE)
+	{
+		ladder.Insert(quote);
+		const int64_t maxAge { book.MaxQuoteAge() };
+		if (maxAge > 0)
+		{
+			book.Wheel(bid).Schedule(quote->SortTime() + maxAge, quote->Key());
+		}
+		for (BookListener *listener: book.Listeners(bid))
+		{
+			listener->OnQuoteAdded(bid, quote);
+		}
+	}
+	book.Dirty(bid).store(true);
+}
+
 BookView::QuoteGroupVec OrderBook::GetLevels(CurrencyPair cp, bool bid, unsigned int n, const BookView::QuotePred &quotePred) const
 {
 	BookView::QuoteGroupVec out;
@@ -179,50 +543,143 @@ BookView::QuoteGroupVec OrderBook::GetLevels(CurrencyPair cp, bool bid, unsigned
 	return out;
 }
 
+size_t OrderBook::GetLevels(CurrencyPair cp, bool bid, PriceLadder::LevelSummary *levels, size_t n) const
+{
+	size_t result { 0 };
+	const InstrumentBook::Ptr book { FindInstrument(cp) };
+	if (book)
+	{
+		ReadSide(*book, bid, [&result, levels, n](const auto &side) { result = side.CopySummaries(levels, n); });
+	}
+	return result;
+}
+
+DepthIndex::FillEstimate OrderBook::CostToFill(CurrencyPair cp, bool bid, int64_t qty) const
+{
+	DepthIndex::FillEstimate result;
+	const InstrumentBook::Ptr book { FindInstrument(cp) };
+	if (book)
+	{
+		ReadSide(*book, bid, [&result, qty](const auto &side) { result = side.Depth().CostToFill(qty); });
+	}
+	return result;
+}
+
+int64_t OrderBook::VwapForQty(CurrencyPair cp, bool bid, int64_t qty) const
+{
+	const DepthIndex::FillEstimate estimate { CostToFill(cp, bid, qty) };
+	return estimate.filledQty == qty ? estimate.vwap : 0;
+}
+
+int64_t OrderBook::QtyUpToPrice(CurrencyPair cp, bool bid, int64_t price) const
+{
+	int64_t result { 0 };
+	const InstrumentBook::Ptr book { FindInstrument(cp) };
+	if (book)
+	{
+		ReadSide(*book, bid, [&result, price](const auto &side) { result = side.Depth().QtyUpToPrice(price); });
+	}
+	return result;
+}
+
+int64_t OrderBook::GetBestPriceForQty(CurrencyPair cp, bool bid, int64_t qty) const
+{
+	const InstrumentBook::Ptr book { FindInstrument(cp) };
+	if (!book)
+	{
+		return 0;
+	}
+	if (m_readMode.load(std::memory_order_relaxed) == ReadMode::Snapshot)
+	{
+		const EpochDomain::Guard guard { m_epochDomain.Pin() };
+		const LadderSnapshot *snapshot { book->Snapshot(bid) };
+		if (snapshot)
+		{
+			const LevelArrays &arrays { snapshot->arrays };
+			const size_t i { arrays.FindFirstFillable(qty) };
+			return i < arrays.Size() ? arrays.Prices()[i] : 0;
+		}
+	}
+	// the arrays are only maintained for the snapshots, so the ladder is scanned in place
+	int64_t result { 0 };
+	ReadLocked(*book, bid, [&result, qty](const auto &side) { result = FirstFillablePrice(side, qty); });
+	return result;
+}
+
+int64_t OrderBook::FirstFillablePrice(const PriceLadder &ladder, int64_t qty)
+{
+	int64_t result { 0 };
+	ladder.ForEachQuote([&result, qty](const Quote::Ptr &q, bool &cont)
+	{
+		if (q->Volume() >= qty && q->MinQty() <= qty && !q->Used() && q->Valid())
+		{
+			result = q->Price();
+			cont = false;
+		}
+	});
+	return result;
+}
+
+int64_t OrderBook::FirstFillablePrice(const L2Ladder &ladder, int64_t qty)
+{
+	int64_t result { 0 };
+	ladder.ForEachL2Level([&result, qty](const L2Level &level, bool &cont)
+	{
+		if (level.qty >= qty)
+		{
+			result = level.price;
+			cont = false;
+		}
+	});
+	return result;
+}
+
 size_t OrderBook::GetQuoteCount(CurrencyPair cp, bool bid) const
 {
 	size_t result { 0 };
-	std::shared_lock lockMap { m_quoteVectorMap.Mutex() };
-	const auto &it { m_quoteVectorMap->find(cp) };
-	if (it != m_quoteVectorMap->end())
+	const InstrumentBook::Ptr book { FindInstrument(cp) };
+	if (book)
 	{
-		std::shared_lock lock { GetLock(cp, bid) };
-		result = it->second.Get(bid)->size();
+		ReadSide(*book, bid, [&result](const auto &side) { result = side.QuoteCount(); });
 	}
 	return result;
 }
 
 void OrderBook::IterateQuoteGroups(CurrencyPair cp, bool bid, const BookView::QuoteGroupFunc &action, const BookView::QuotePred &quotePred) const
 {
-	std::shared_lock lockMap { m_quoteVectorMap.Mutex() };
-	const auto &it { m_quoteVectorMap->find(cp) };
-	if (it != m_quoteVectorMap->end())
+	const InstrumentBook::Ptr book { FindInstrument(cp) };
+	if (book)
 	{
-		std::shared_lock lock { GetLock(cp, bid) };
-		QuoteVecPtrToConst quotes { it->second.Get(bid) };
-		lockMap.unlock();
-		QuoteGroup::Ptr quoteGroup;
-		bool cont { true };
-		int level { 1 };
-		for (auto itQuote { quotes->begin() }; cont && itQuote != quotes->end(); ++level)
+		ReadSide(*book, bid, [&action, &quotePred](const auto &side)
 		{
-			itQuote = getNextLevel(quoteGroup, *quotes, quotePred, itQuote);
-			if (quoteGroup)
+			int level { 1 };
+			side.ForEachLevel([&action, &quotePred, &level](const PriceLadder::Level &priceLevel, bool &cont)
 			{
-				action(level, quoteGroup, cont);
-			}
-		}
+				QuoteGroup::Ptr quoteGroup { getLevelGroup(priceLevel, quotePred) };
+				if (quoteGroup)
+				{
+					action(level++, quoteGroup, cont);
+				}
+			});
+		});
 	}
 }
 
 BidAskPair<int64_t> OrderBook::GetBestPrices(CurrencyPair cp) const
 {
-	return GetBestPrices(cp, [](bool, BOOK::Quote&) { return true; });
+	const InstrumentBook::Ptr book { FindInstrument(cp) };
+	if (book)
+	{
+		const TopOfBook::Snapshot snapshot { book->Top().Read() };
+		return { snapshot.bidPrice, snapshot.askPrice };
+	}
+	return { 0, 0 };
 }
 
 int64_t OrderBook::GetBestPrice(CurrencyPair cp, bool bid) const
 {
-	return GetBestPrice(cp, bid, [](bool, BOOK::Quote&) { return true; });
+	const InstrumentBook::Ptr book { FindInstrument(cp) };
+	return book ? book->Top().Read().Price(bid) : 0;
 }
 
 Quote::Ptr OrderBook::GetBestQuote(CurrencyPair cp, bool bid) const
@@ -232,7 +689,13 @@ Quote::Ptr OrderBook::GetBestQuote(CurrencyPair cp, bool bid) const
 
 int64_t OrderBook::GetMidPrice(CurrencyPair cp) const
 {
-	return GetMidPrice(cp, [](bool, BOOK::Quote&) { return true; });
+	const InstrumentBook::Ptr book { FindInstrument(cp) };
+	return book ? book->Top().Read().MidPrice() : 0;
+}
+
+const TopOfBook &OrderBook::GetTopOfBook(CurrencyPair cp)
+{
+	return AddInstrument(cp)->Top();
 }
 
 BidAskPair<Quote::Ptr> OrderBook::GetBestQuotes(CurrencyPair cp) const
@@ -243,63 +706,63 @@ BidAskPair<Quote::Ptr> OrderBook::GetBestQuotes(CurrencyPair cp) const
 void OrderBook::Clear()
 {
 	{
-		std::unique_lock lockQuoteVectorMap { m_quoteVectorMap.Mutex() };
-		std::unique_lock lockAccessMap { m_accessMap.Mutex() };
-		
-		// set invalid all quotes:
-		for (const auto &it: *m_quoteVectorMap)
+		// shards are referenced by their handles, so they are emptied rather than erased
+		std::shared_lock lockInstrumentMap { m_instrumentMap.Mutex() };
+		for (const auto &it: *m_instrumentMap)
 		{
+			InstrumentBook &book { *it.second };
 			for (bool bid: { true, false })
 			{
-				const QuoteVecPtr &qvp { it.second.Get(bid) };
-				if (qvp)
+				std::unique_lock lock { book.Mutex(bid) };
+				PriceLadder &ladder { book.Ladder(bid) };
+				// set invalid all quotes:
+				ladder.ForEachQuote([](const Quote::Ptr &q, bool &)
 				{
-					for (auto &q: *qvp)
+					if (q)
 					{
-						if (q)
-						{
-							q->SetInvalid(nullptr);
-						}
+						q->SetInvalid(nullptr);
 					}
+				});
+				ladder.Clear();
+				book.L2(bid).Clear();
+				book.Dirty(bid).store(true);
+				for (BookListener *listener: book.Listeners(bid))
+				{
+					listener->OnSideCleared(bid);
 				}
 			}
+			book.Top().Reset(CurrentTimestamp());
+			if (m_readMode.load() == ReadMode::Snapshot)
+			{
+				PublishSnapshots(book);
+			}
 		}
-		
-		m_quoteVectorMap->clear();
-		m_accessMap->Bid().clear();
-		m_accessMap->Ask().clear();
 	}
 
-	std::atomic_store(&m_lastQuote, BOOK::Quote::Ptr(nullptr));
+	PublishLastQuote(nullptr);
 }
 
-OrderBook::QuoteVec::const_iterator OrderBook::getNextLevel(QuoteGroup::Ptr &quoteGroup, const QuoteVec &srcVec, const BookView::QuotePred &quotePred,
-														  QuoteVec::const_iterator iterator) const
+/*! \brief Creates a quote group from the quotes of one price level
+ *
+ * @param level Price level of a ladder
+ * @param quotePred (optional) predicate to be fulfilled by a quote to be added to the quote group
+ * @return Quote group, or @a nullptr if no quote of the level fulfils the predicate
+ * */
+QuoteGroup::Ptr OrderBook::getLevelGroup(const PriceLadder::Level &level, const BookView::QuotePred &quotePred)
 {
-	bool success { false };
-	quoteGroup = QuoteGroup::Create();
-	while (iterator != srcVec.end())
+	QuoteGroup::Ptr quoteGroup { nullptr };
+	for (const auto &q: level.quotes)
 	{
-		int64_t price { iterator->get()->Price() };
-		while (iterator != srcVec.end() && price == iterator->get()->Price())
+		if (!quotePred || quotePred(*q))
 		{
-			if (!quotePred || quotePred(**iterator))
+			if (!quoteGroup)
 			{
-				quoteGroup->AddQuote(*iterator);
-				success = true;
+				quoteGroup = QuoteGroup::Create();
 			}
-			++iterator;
+			quoteGroup->AddQuote(q);
 		}
-		if (success) // if quoteGroup contains at least one quote -> done
-		{
-			break;
-		}
-	}
-	if (!success)
-	{
-		quoteGroup = nullptr;
 	}
-	return iterator;
+	return quoteGroup;
 }
 
 // DEBUG
@@ -324,60 +787,408 @@ void OrderBook::printBook(std::ostream &ostr, CurrencyPair cp, bool bid, unsigne
 
 void OrderBook::printBooks(std::ostream &ostr, bool bid, unsigned int levels) const
 {
-	std::shared_lock lockMap { m_quoteVectorMap.Mutex() };
-	QuoteVectorMap mapCopy { *m_quoteVectorMap };
+	std::shared_lock lockMap { m_instrumentMap.Mutex() };
+	InstrumentMap mapCopy { *m_instrumentMap };
 	lockMap.unlock();
 	for (auto &it: mapCopy)
 	{
-		std::shared_lock lock { GetLock(it.first, bid) };
 		printBook(ostr, it.first, bid, levels);
 	}
 }
 
 
-std::shared_mutex &OrderBook::GetLock(CurrencyPair cp, bool bid) const
+/*! \brief Publishes the best level of a ladder to a top-of-book record
+ *
+ * Must be called while holding the lock of the ladder's side.
+ *
+ * @return Snapshot of the record before the publication
+ * */
+TopOfBook::Snapshot OrderBook::PublishTopOfBook(TopOfBook &top, const PriceLadder &ladder, size_t depthLevels)
+{
+	const PriceLadder::Level *best { ladder.BestLevel() };
+	return top.Publish(ladder.Bid(), best ? best->price : 0, best ? best->totalVolume : 0, ladder.TopVolume(depthLevels),
+					   CurrentTimestamp());
+}
+
+TopOfBook::Snapshot OrderBook::PublishTopOfBook(TopOfBook &top, const L2Ladder &ladder, size_t depthLevels)
+{
+	const L2Level *best { ladder.BestLevel() };
+	return top.Publish(ladder.Bid(), best ? best->price : 0, best ? best->qty : 0, ladder.TopVolume(depthLevels),
+					   CurrentTimestamp());
+}
+
+TopOfBook::Snapshot OrderBook::PublishTopOfBook(InstrumentBook &book, bool bid)
+{
+	const size_t depthLevels { book.SignalDepth() };
+	return book.GetMode() == InstrumentBook::Mode::Levels ? PublishTopOfBook(book.Top(), book.L2(bid), depthLevels)
+														  : PublishTopOfBook(book.Top(), book.Ladder(bid), depthLevels);
+}
+
+void OrderBook::SetBookMode(CurrencyPair cp, InstrumentBook::Mode mode)
 {
-	std::shared_lock slock { m_accessMap.Mutex() };
-	AccessMap &map { m_accessMap->Get(bid) };
-	const auto &it { map.find(cp) };
-	if (it != map.end())
+	const InstrumentBook::Ptr book { AddInstrument(cp) };
 	{
-		return *(it->second);
+		std::scoped_lock lock { book->Mutex(true), book->Mutex(false) };
+		if (book->GetMode() == mode)
+		{
+			return;
+		}
+		const int64_t now { CurrentTimestamp() };
+		for (bool bid: { true, false })
+		{
+			ClearSide(*book, bid, now);
+		}
+		book->SetMode(mode);
+		book->Top().Reset(now);
 	}
-	else
+	poco_information_f2(logger(), "%s: Book mode set to %s", cp.ToString(),
+						std::string(mode == InstrumentBook::Mode::Levels ? "LEVELS" : "QUOTES"));
+	if (m_readMode.load(std::memory_order_relaxed) == ReadMode::Snapshot)
 	{
-		slock.unlock();
-		std::unique_lock ulock { m_accessMap.Mutex() };
-		AccessMap &map2 { m_accessMap->Get(bid) }; // "map" could have been invalidated while unlocked
-		return *map2.emplace(cp, std::make_unique<std::shared_mutex>()).first->second;
+		PublishSnapshots(*book);
 	}
 }
 
+InstrumentBook::Mode OrderBook::GetBookMode(CurrencyPair cp) const
+{
+	const InstrumentBook::Ptr book { FindInstrument(cp) };
+	return book ? book->GetMode() : InstrumentBook::Mode::Quotes;
+}
 
-void OrderBook::CleanupQuoteVec(CurrencyPair cp, QuoteVec &vec, int64_t maxAge)
+void OrderBook::SetMaxLevels(CurrencyPair cp, size_t maxLevels)
 {
-	if (maxAge > 0)
+	const InstrumentBook::Ptr book { AddInstrument(cp) };
+	for (bool bid: { true, false })
 	{
-		auto it = vec.begin();
-		while (it != vec.end())
+		std::unique_lock lock { book->Mutex(bid) };
+		L2Ladder &l2 { book->L2(bid) };
+		if (l2.MaxLevels() != maxLevels)
 		{
-			if ((*it)->AgeSinceSend() > maxAge)
+			// trimming removes the worst levels only, so the top of book stays
+			l2.SetMaxLevels(maxLevels);
+			PublishTopOfBook(*book, bid);
+			book->Dirty(bid).store(true);
+			for (BookListener *listener: book->Listeners(bid))
 			{
-				poco_information_f2(logger(), "Erase outdated quote: %s (older than MaxAge = %s)", (*it)->ToString(cp), NanosecondsToString(maxAge));
-				(*it)->SetInvalid(nullptr);
-				it = vec.erase(it);
+				listener->OnSideCleared(bid);
+				ReplaySide(*book, bid, *listener);
 			}
-			else
+		}
+	}
+	if (m_readMode.load(std::memory_order_relaxed) == ReadMode::Snapshot)
+	{
+		PublishSnapshots(*book);
+	}
+}
+
+void OrderBook::SetSignalDepth(CurrencyPair cp, size_t levels)
+{
+	const InstrumentBook::Ptr book { AddInstrument(cp) };
+	book->SetSignalDepth(std::max<size_t>(levels, 1));
+	for (bool bid: { true, false })
+	{
+		std::unique_lock lock { book->Mutex(bid) };
+		PublishTopOfBook(*book, bid);
+	}
+}
+
+size_t OrderBook::GetMaxLevels(CurrencyPair cp) const
+{
+	const InstrumentBook::Ptr book { FindInstrument(cp) };
+	if (!book)
+	{
+		return 0;
+	}
+	std::shared_lock lock { book->Mutex(true) };
+	return book->L2(true).MaxLevels();
+}
+
+bool OrderBook::IsDepthIncomplete(CurrencyPair cp, bool bid) const
+{
+	const InstrumentBook::Ptr book { FindInstrument(cp) };
+	if (!book)
+	{
+		return false;
+	}
+	std::shared_lock lock { book->Mutex(bid) };
+	return book->L2(bid).Incomplete();
+}
+
+void OrderBook::SetQuoteExpiry(CurrencyPair cp, int64_t maxAge, int64_t cleanupInterval)
+{
+	const InstrumentBook::Ptr book { AddInstrument(cp) };
+	book->SetMaxQuoteAge(maxAge);
+	const int64_t now { CurrentTimestamp() };
+	for (bool bid: { true, false })
+	{
+		// quotes added from now on are scheduled by ApplyQuote, the ones in the book are scheduled here
+		std::unique_lock lock { book->Mutex(bid) };
+		ExpiryWheel &wheel { book->Wheel(bid) };
+		wheel.Reset(std::max<int64_t>(cleanupInterval / 16, 1'000'000), now);
+		if (maxAge > 0)
+		{
+			book->Ladder(bid).ForEachQuote([&wheel, maxAge](const Quote::Ptr &q, bool &)
 			{
-				++it;
+				wheel.Schedule(q->SortTime() + maxAge, q->Key());
+			});
+			book->L2(bid).ForEachL2Level([&wheel, maxAge](const L2Level &level, bool &)
+			{
+				wheel.Schedule(level.timestamp + maxAge, level.price);
+			});
+		}
+	}
+
+	std::lock_guard lock { m_cleanupMutex };
+	const auto it { m_cleanupTasks.find(cp) };
+	if (it != m_cleanupTasks.end())
+	{
+		m_cleanupTimer.Cancel(it->second);
+		m_cleanupTasks.erase(it);
+	}
+	if (maxAge > 0 && cleanupInterval > 0)
+	{
+		if (!m_cleanupTimer.Running())
+		{
+			m_cleanupTimer.Start("BookCleanup");
+		}
+		const auto taskId { m_cleanupTimer.Schedule("Evict " + cp.ToString(), [this, cp](Timer::Task &)
+		{
+			EvictStaleQuotes(cp, CurrentTimestamp());
+		}, std::chrono::nanoseconds(cleanupInterval), std::chrono::nanoseconds(cleanupInterval)) };
+		if (taskId)
+		{
+			m_cleanupTasks[cp] = taskId.Value();
+		}
+		else
+		{
+			poco_error_f2(logger(), "*** %s: Failed to schedule quote cleanup: %s ***", cp.ToString(), taskId.ErrorMessage());
+		}
+	}
+}
+
+bool OrderBook::RestoreLevels(CurrencyPair cp, const L2Level *bids, size_t bidCount, const L2Level *asks, size_t askCount,
+							  int64_t updateId)
+{
+	const InstrumentBook::Ptr book { AddInstrument(cp) };
+	const int64_t previousMid { book->Top().Read().MidPrice() };
+	size_t levelCount[2] { 0, 0 }; // bid, ask
+	{
+		std::scoped_lock lock { book->Mutex(true), book->Mutex(false) };
+		if (book->GetMode() != InstrumentBook::Mode::Levels)
+		{
+			return false;
+		}
+		const int64_t now { CurrentTimestamp() };
+		const int64_t maxAge { book->MaxQuoteAge() };
+		for (bool bid: { true, false })
+		{
+			ClearSide(*book, bid, now);
+			const L2Level *levels { bid ? bids : asks };
+			L2Ladder &l2 { book->L2(bid) };
+			// worst level first, so each level is appended at the top of the ladder
+			for (size_t i { bid ? bidCount : askCount }; i > 0; --i)
+			{
+				const L2Level &level { levels[i - 1] };
+				if (level.qty > 0 && l2.Apply(level.price, level.qty, now) && maxAge > 0)
+				{
+					book->Wheel(bid).Schedule(now + maxAge, level.price);
+				}
+			}
+			for (BookListener *listener: book->Listeners(bid))
+			{
+				ReplaySide(*book, bid, *listener);
 			}
+			PublishTopOfBook(*book, bid);
+			levelCount[bid ? 0 : 1] = l2.LevelCount();
+		}
+		book->SetUpdateId(updateId);
+		book->SetProvisional(true);
+	}
+	poco_information_f3(logger(), "%s: Restored %z bid and %z ask levels (provisional)", cp.ToString(), levelCount[0],
+						levelCount[1]);
+	if (m_readMode.load(std::memory_order_relaxed) == ReadMode::Snapshot)
+	{
+		PublishSnapshots(*book);
+	}
+	if (previousMid != book->Top().Read().MidPrice())
+	{
+		NotifyMidChange(*book);
+	}
+	return true;
+}
+
+bool OrderBook::DiscardProvisional(InstrumentBook &book)
+{
+	if (!book.Provisional())
+	{
+		return false;
+	}
+	const int64_t previousMid { book.Top().Read().MidPrice() };
+	{
+		std::scoped_lock lock { book.Mutex(true), book.Mutex(false) };
+		if (!book.Provisional())
+		{
+			return false;
+		}
+		const int64_t now { CurrentTimestamp() };
+		for (bool bid: { true, false })
+		{
+			ClearSide(book, bid, now);
+			PublishTopOfBook(book, bid);
 		}
+		book.SetProvisional(false);
 	}
+	if (m_readMode.load(std::memory_order_relaxed) == ReadMode::Snapshot)
+	{
+		PublishSnapshots(book);
+	}
+	if (previousMid != book.Top().Read().MidPrice())
+	{
+		NotifyMidChange(book);
+	}
+	return true;
+}
+
+bool OrderBook::IsProvisional(CurrencyPair cp) const
+{
+	const InstrumentBook::Ptr book { FindInstrument(cp) };
+	return book && book->Provisional();
+}
+
+void OrderBook::SetCheckpoint(const std::string &path, int64_t interval)
+{
+	std::lock_guard lock { m_cleanupMutex };
+	if (m_checkpointTask)
+	{
+		m_cleanupTimer.Cancel(m_checkpointTask);
+		m_checkpointTask = 0;
+	}
+	if (path.empty() || interval <= 0)
+	{
+		return;
+	}
+	if (!m_cleanupTimer.Running())
+	{
+		m_cleanupTimer.Start("BookCleanup");
+	}
+	const auto taskId { m_cleanupTimer.Schedule("Checkpoint", [this, path](Timer::Task &)
+	{
+		const BoolResult result { BookCheckpoint::Save(*this, path) };
+		if (!result)
+		{
+			poco_error_f1(logger(), "*** Failed to save book checkpoint: %s ***", result.ErrorMessage());
+		}
+	}, std::chrono::nanoseconds(interval), std::chrono::nanoseconds(interval)) };
+	if (taskId)
+	{
+		m_checkpointTask = taskId.Value();
+	}
+	else
+	{
+		poco_error_f1(logger(), "*** Failed to schedule book checkpoints: %s ***", taskId.ErrorMessage());
+	}
+}
+
+size_t OrderBook::EvictStaleQuotes(CurrencyPair cp, int64_t now)
+{
+	const InstrumentBook::Ptr book { FindInstrument(cp) };
+	if (!book)
+	{
+		return 0;
+	}
+	const int64_t maxAge { book->MaxQuoteAge() };
+	const int64_t previousMid { book->Top().Read().MidPrice() };
+	size_t result { 0 };
+	for (bool bid: { true, false })
+	{
+		std::unique_lock lock { book->Mutex(bid) };
+		PriceLadder &ladder { book->Ladder(bid) };
+		L2Ladder &l2 { book->L2(bid) };
+		size_t removed { 0 };
+		if (book->GetMode() == InstrumentBook::Mode::Levels)
+		{
+			std::vector<int64_t> refilled;
+			book->Wheel(bid).Advance(now, [&book, &l2, &removed, &refilled, bid, now, maxAge](int64_t price)
+			{
+				// levels changed since they were scheduled have been scheduled again
+				const L2Level *level { l2.Find(price) };
+				if (level && maxAge > 0 && now - level->timestamp >= maxAge)
+				{
+					l2.Apply(price, 0, now);
+					NotifyLevel(*book, bid, price, now);
+					++removed;
+					if (l2.Refilled() != 0)
+					{
+						refilled.push_back(l2.Refilled());
+					}
+				}
+			});
+			// levels moved into the window are scheduled once the wheel has been advanced
+			for (int64_t price: refilled)
+			{
+				const L2Level *level { l2.Find(price) };
+				if (level)
+				{
+					book->Wheel(bid).Schedule(level->timestamp + maxAge, price);
+					NotifyLevel(*book, bid, price, now);
+				}
+			}
+		}
+		else
+		{
+			book->Wheel(bid).Advance(now, [&book, &ladder, &removed, bid, now, maxAge](int64_t key)
+			{
+				// keys of quotes that have already left the book are skipped
+				const Quote::Ptr quote { ladder.Find(key) };
+				if (quote && maxAge > 0 && now - quote->SortTime() >= maxAge)
+				{
+					ladder.Remove(key);
+					quote->SetInvalid(nullptr);
+					for (BookListener *listener: book->Listeners(bid))
+					{
+						listener->OnQuoteRemoved(bid, quote);
+					}
+					++removed;
+				}
+			});
+		}
+		if (removed > 0)
+		{
+			PublishTopOfBook(*book, bid);
+			book->Dirty(bid).store(true);
+			poco_information_f4(logger(), "%s %s: %z outdated quotes erased (older than MaxAge = %s)", cp.ToString(),
+								std::string(bid ? "BID" : "ASK"), removed, NanosecondsToString(maxAge));
+		}
+		result += removed;
+	}
+	if (result > 0)
+	{
+		if (m_readMode.load(std::memory_order_relaxed) == ReadMode::Snapshot)
+		{
+			PublishSnapshots(*book);
+		}
+		if (previousMid != book->Top().Read().MidPrice())
+		{
+			NotifyMidChange(*book);
+		}
+	}
+	return result;
 }
 
 Quote::Ptr OrderBook::GetLastQuote() const
 {
-	return std::atomic_load(&m_lastQuote);
+	const UTILS::EpochDomain::Guard guard { m_epochDomain.Pin() };
+	return Quote::Ptr(m_lastQuote.load(std::memory_order_acquire));
+}
+
+void OrderBook::PublishLastQuote(Quote::Ptr quote)
+{
+	Quote *previous { m_lastQuote.exchange(quote.Detach(), std::memory_order_acq_rel) };
+	if (previous)
+	{
+		// a reader may have loaded the previous quote and not yet taken its reference
+		m_epochDomain.Retire([previous] { IntrusiveRelease(previous); });
+	}
 }
 
 } // namespace BOOK
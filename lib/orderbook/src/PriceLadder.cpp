@@ -0,0 +1,161 @@
+#include <algorithm>
+
+#include "OrderBook/PriceLadder.h"
+
+namespace CORE {
+namespace BOOK {
+
+/*! \brief Inserts a quote at its price level
+ *
+ * Within a level, quotes are sorted by volume (greater volume first); a new
+ * quote is placed in front of existing quotes of equal volume.
+ *
+ * @param quote Quote to be inserted
+ * */
+void PriceLadder::Insert(const Quote::Ptr &quote)
+{
+	const auto itLevel { m_levels.try_emplace(quote->Price()).first };
+	Level &level { itLevel->second };
+	if (level.quotes.empty())
+	{
+		level.price = quote->Price();
+		level.quotes.push_back(quote);
+		level.minQty = quote->MinQty();
+		level.timestamp = quote->SortTime();
+	}
+	else
+	{
+		level.quotes.insert(std::find_if(level.quotes.begin(), level.quotes.end(), [&quote](const Quote::Ptr &q)
+		{
+			return quote->Volume() >= q->Volume();
+		}), quote);
+		level.minQty = std::min(level.minQty, quote->MinQty());
+		level.timestamp = std::max(level.timestamp, quote->SortTime());
+	}
+	level.totalVolume += quote->Volume();
+	m_depth.Add(quote->Price(), quote->Volume());
+	m_keyIndex.Insert(quote->Key(), itLevel);
+	++m_quoteCount;
+}
+
+Quote::Ptr PriceLadder::Remove(int64_t price, int64_t key)
+{
+	const auto itLevel { m_levels.find(price) };
+	return itLevel != m_levels.end() ? RemoveFrom(itLevel, key) : nullptr;
+}
+
+Quote::Ptr PriceLadder::Remove(int64_t key)
+{
+	const auto *itLevel { m_keyIndex.Find(key) };
+	return itLevel ? RemoveFrom(*itLevel, key) : nullptr;
+}
+
+Quote::Ptr PriceLadder::Find(int64_t price, int64_t key) const
+{
+	const auto itLevel { m_levels.find(price) };
+	return itLevel != m_levels.end() ? FindIn(itLevel->second, key) : nullptr;
+}
+
+Quote::Ptr PriceLadder::Find(int64_t key) const
+{
+	const auto *itLevel { m_keyIndex.Find(key) };
+	return itLevel ? FindIn((*itLevel)->second, key) : nullptr;
+}
+
+bool PriceLadder::CheckIndex() const
+{
+	if (m_keyIndex.Size() != m_quoteCount)
+	{
+		return false;
+	}
+	size_t quoteCount { 0 };
+	int64_t totalVolume { 0 };
+	const Level *prev { nullptr };
+	for (auto itLevel { m_levels.begin() }; itLevel != m_levels.end(); ++itLevel)
+	{
+		const Level &level { itLevel->second };
+		if (level.quotes.empty() || level.price != itLevel->first || (prev && !m_levels.key_comp()(prev->price, level.price)))
+		{
+			return false;
+		}
+		Level aggregated { level };
+		Aggregate(aggregated);
+		if (aggregated.totalVolume != level.totalVolume || aggregated.minQty != level.minQty || aggregated.timestamp != level.timestamp)
+		{
+			return false;
+		}
+		for (const auto &q: level.quotes)
+		{
+			const auto *indexed { m_keyIndex.Find(q->Key()) };
+			if (!indexed || *indexed != itLevel || q->Price() != level.price)
+			{
+				return false;
+			}
+		}
+		quoteCount += level.quotes.size();
+		totalVolume += level.totalVolume;
+		if (m_depth.QtyUpToPrice(level.price) != totalVolume)
+		{
+			return false;
+		}
+		prev = &level;
+	}
+	return quoteCount == m_quoteCount && totalVolume == m_depth.TotalVolume();
+}
+
+Quote::Ptr PriceLadder::RemoveFrom(LevelMap::iterator itLevel, int64_t key)
+{
+	QuoteVec &quotes { itLevel->second.quotes };
+	const auto itQuote { std::find_if(quotes.begin(), quotes.end(), [key](const Quote::Ptr &q) { return q->Key() == key; }) };
+	if (itQuote == quotes.end())
+	{
+		return nullptr;
+	}
+	Quote::Ptr result { std::move(*itQuote) };
+	quotes.erase(itQuote);
+	m_depth.Add(result->Price(), -result->Volume());
+	if (quotes.empty())
+	{
+		m_levels.erase(itLevel);
+	}
+	else
+	{
+		Level &level { itLevel->second };
+		level.totalVolume -= result->Volume();
+		if (result->MinQty() == level.minQty || result->SortTime() == level.timestamp)
+		{
+			Aggregate(level);
+		}
+	}
+	m_keyIndex.Erase(key);
+	--m_quoteCount;
+	return result;
+}
+
+Quote::Ptr PriceLadder::FindIn(const Level &level, int64_t key)
+{
+	for (const auto &q: level.quotes)
+	{
+		if (q->Key() == key)
+		{
+			return q;
+		}
+	}
+	return nullptr;
+}
+
+void PriceLadder::Aggregate(Level &level)
+{
+	level.totalVolume = 0;
+	level.minQty = level.quotes.empty() ? 0 : level.quotes.front()->MinQty();
+	level.timestamp = 0;
+	for (const auto &q: level.quotes)
+	{
+		level.totalVolume += q->Volume();
+		level.minQty = std::min(level.minQty, q->MinQty());
+		level.timestamp = std::max(level.timestamp, q->SortTime());
+	}
+}
+
+} // namespace BOOK
+} // namespace CORE
@@ -14,6 +14,19 @@ namespace BOOK {
 
 ObjectPool<Quote, QuotePool::POOL_SIZE> QuotePool::op;
 
+// static
+void QuotePool::Release(Quote *quote)
+{
+	if (quote->m_pooled)
+	{
+		const ObjectPool<Quote, POOL_SIZE>::ItemPtr pooled { quote, &op }; // the pool's deleter destroys the quote and returns its buffer
+	}
+	else
+	{
+		delete quote;
+	}
+}
+
 /*! \brief Set the \a used flag of this quote to \a true
  *
  * @return \a true if successful, \a false if \a used flag was already set
@@ -36,7 +49,7 @@ bool Quote::Valid(int64_t &successorSent, int64_t &successorReceived) const
 	return Valid();
 }
 
-bool Quote::SetInvalid(Quote::Ptr successor)
+bool Quote::SetInvalid(const Quote::Ptr &successor)
 {
 	bool result { false };
 	if (Valid() && successor.get() != this)
@@ -0,0 +1,136 @@
+#include "OrderBook/ShmBookReader.h"
+
+using namespace UTILS;
+using namespace CORE::BOOK;
+
+namespace ORDERBOOK {
+
+BoolResult ShmBookReader::Open(const std::string &path)
+{
+	m_sides.clear();
+	m_nextSeq = 1;
+	m_overruns = 0;
+	const BoolResult result { m_ring.Open(path) };
+	if (result)
+	{
+		Resync(m_ring.Header().writeSeq.load(std::memory_order_acquire));
+		m_overruns = 0;
+	}
+	return result;
+}
+
+size_t ShmBookReader::Poll(size_t maxRecords)
+{
+	if (!m_ring.Mapped())
+	{
+		return 0;
+	}
+	const uint64_t capacity { m_ring.Capacity() };
+	size_t count { 0 };
+	while (count < maxRecords)
+	{
+		const uint64_t writeSeq { m_ring.Header().writeSeq.load(std::memory_order_acquire) };
+		if (m_nextSeq > writeSeq)
+		{
+			break;
+		}
+		if (writeSeq - m_nextSeq >= capacity)
+		{
+			Resync(writeSeq);
+			continue;
+		}
+		const ShmSlot &slot { m_ring.Slot(m_nextSeq) };
+		const uint64_t seq { slot.seq.load(std::memory_order_acquire) };
+		const ShmDelta delta { slot.delta };
+		std::atomic_thread_fence(std::memory_order_acquire);
+		if (seq != m_nextSeq || slot.seq.load(std::memory_order_relaxed) != seq)
+		{
+			// the writer has wrapped around and overwritten the record
+			Resync(m_ring.Header().writeSeq.load(std::memory_order_acquire));
+			continue;
+		}
+		Apply(delta);
+		++m_nextSeq;
+		++count;
+	}
+	return count;
+}
+
+bool ShmBookReader::Synced(CurrencyPair cp, bool bid) const
+{
+	const Side *side { FindSide(cp, bid) };
+	return side && side->state == SideState::Synced;
+}
+
+const L2Ladder *ShmBookReader::Ladder(CurrencyPair cp, bool bid) const
+{
+	const Side *side { FindSide(cp, bid) };
+	return side && side->state == SideState::Synced ? &side->ladder : nullptr;
+}
+
+uint64_t ShmBookReader::Lag() const
+{
+	return m_ring.Mapped() ? m_ring.Header().writeSeq.load(std::memory_order_acquire) + 1 - m_nextSeq : 0;
+}
+
+bool ShmBookReader::WriterActive() const
+{
+	return m_ring.Mapped() && m_ring.Header().writerActive.load(std::memory_order_acquire) != 0;
+}
+
+const ShmBookReader::Side *ShmBookReader::FindSide(CurrencyPair cp, bool bid) const
+{
+	const auto it { m_sides.find(ShmSideKey(ShmInstrumentKey(cp), bid)) };
+	return it != m_sides.end() ? &it->second : nullptr;
+}
+
+void ShmBookReader::Apply(const ShmDelta &delta)
+{
+	Side &side { m_sides.try_emplace(ShmSideKey(delta.instrument, delta.Bid()), delta.Bid()).first->second };
+	switch (delta.type)
+	{
+		case ShmRecordType::Level:
+			if (side.state != SideState::Unsynced)
+			{
+				side.ladder.Apply(delta.price, delta.qty, delta.timestamp);
+			}
+			break;
+		case ShmRecordType::Clear:
+			side.ladder.Clear();
+			side.state = SideState::Synced;
+			break;
+		case ShmRecordType::SnapshotBegin:
+			side.ladder.Clear();
+			side.state = SideState::Loading;
+			break;
+		case ShmRecordType::SnapshotEnd:
+			if (side.state == SideState::Loading)
+			{
+				side.state = SideState::Synced;
+			}
+			break;
+	}
+}
+
+void ShmBookReader::Resync(uint64_t writeSeq)
+{
+	++m_overruns;
+	for (auto &[key, side]: m_sides)
+	{
+		side.ladder.Clear();
+		side.state = SideState::Unsynced;
+	}
+	// start at the last snapshot if the writer is not about to overwrite it, else halfway through the ring
+	const uint64_t capacity { m_ring.Capacity() };
+	const uint64_t snapshotSeq { m_ring.Header().snapshotSeq.load(std::memory_order_acquire) };
+	if (snapshotSeq > 0 && snapshotSeq <= writeSeq + 1 && writeSeq + 1 - snapshotSeq < capacity - capacity / 4)
+	{
+		m_nextSeq = snapshotSeq;
+	}
+	else
+	{
+		m_nextSeq = writeSeq + 1 > capacity / 2 ? writeSeq + 1 - capacity / 2 : 1;
+	}
+}
+
+} // namespace ORDERBOOK
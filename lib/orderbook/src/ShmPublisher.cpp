@@ -0,0 +1,232 @@
+#include <algorithm>
+
+#include "Utils/Utils.h"
+#include "OrderBook/OrderBook.h"
+#include "OrderBook/ShmPublisher.h"
+
+using namespace UTILS;
+using namespace CORE::BOOK;
+
+namespace ORDERBOOK {
+
+class ShmPublisher::SideListener final : public BookListener
+{
+public:
+	SideListener(ShmPublisher &publisher, OrderBook &book, CurrencyPair cp)
+			: m_publisher(publisher), m_book(book), m_cp(cp), m_instrument(ShmInstrumentKey(cp)) { }
+
+	bool Matches(const OrderBook &book, CurrencyPair cp) const { return &m_book == &book && m_cp == cp; }
+
+	OrderBook &Book() const { return m_book; }
+
+	CurrencyPair Instrument() const { return m_cp; }
+
+	void OnQuoteAdded(bool bid, const Quote::Ptr &quote) override
+	{
+		std::lock_guard lock { m_publisher.m_mutex };
+		m_publisher.AddToLevel(m_instrument, bid, quote->Price(), quote->Volume(), quote->SortTime());
+	}
+
+	void OnQuoteRemoved(bool bid, const Quote::Ptr &quote) override
+	{
+		std::lock_guard lock { m_publisher.m_mutex };
+		m_publisher.AddToLevel(m_instrument, bid, quote->Price(), -quote->Volume(), CurrentTimestamp());
+	}
+
+	void OnLevelChanged(bool bid, const L2Level &level) override
+	{
+		std::lock_guard lock { m_publisher.m_mutex };
+		m_publisher.WriteLevel(m_instrument, bid, level.price, level.qty, level.timestamp, -1, 0);
+	}
+
+	void OnSideCleared(bool bid) override
+	{
+		std::lock_guard lock { m_publisher.m_mutex };
+		m_publisher.ClearSide(m_instrument, bid);
+	}
+
+private:
+	ShmPublisher &m_publisher;
+	OrderBook &m_book;
+	const CurrencyPair m_cp;
+	const uint32_t m_instrument;
+};
+
+ShmPublisher::ShmPublisher() = default;
+
+ShmPublisher::~ShmPublisher()
+{
+	for (const auto &listener: m_listeners)
+	{
+		listener->Book().RemoveListener(listener->Instrument(), true, *listener);
+		listener->Book().RemoveListener(listener->Instrument(), false, *listener);
+	}
+	if (m_ring.Mapped())
+	{
+		m_ring.Header().writerActive.store(0, std::memory_order_release);
+	}
+}
+
+BoolResult ShmPublisher::Create(const std::string &path, uint64_t capacity, uint64_t snapshotInterval)
+{
+	std::lock_guard lock { m_mutex };
+	if (m_ring.Mapped())
+	{
+		m_ring.Header().writerActive.store(0, std::memory_order_release);
+	}
+	m_lastSeq = 0;
+	m_lastSnapshotSeq = 0;
+	m_snapshotInterval = snapshotInterval;
+	return m_ring.Create(path, capacity);
+}
+
+void ShmPublisher::Publish(CurrencyPair cp, int entry, int level, Quote::Ptr quote, bool bid)
+{
+	if (quote)
+	{
+		std::lock_guard lock { m_mutex };
+		WriteLevel(ShmInstrumentKey(cp), bid, quote->Price(), quote->Volume(), quote->SortTime(), entry, level);
+	}
+}
+
+void ShmPublisher::Attach(OrderBook &book, CurrencyPair cp)
+{
+	SideListener *listener;
+	{
+		std::lock_guard lock { m_mutex };
+		m_listeners.push_back(std::make_unique<SideListener>(*this, book, cp));
+		listener = m_listeners.back().get();
+		ClearSide(ShmInstrumentKey(cp), true);
+		ClearSide(ShmInstrumentKey(cp), false);
+	}
+	// the book replays each side under its lock before reporting its changes
+	book.AddListener(cp, true, *listener);
+	book.AddListener(cp, false, *listener);
+}
+
+void ShmPublisher::Detach(OrderBook &book, CurrencyPair cp)
+{
+	std::unique_ptr<SideListener> listener;
+	{
+		std::lock_guard lock { m_mutex };
+		const auto it { std::find_if(m_listeners.begin(), m_listeners.end(), [&book, cp](const auto &l) { return l->Matches(book, cp); }) };
+		if (it == m_listeners.end())
+		{
+			return;
+		}
+		listener = std::move(*it);
+		m_listeners.erase(it);
+	}
+	book.RemoveListener(cp, true, *listener);
+	book.RemoveListener(cp, false, *listener);
+	// the readers drop the levels of the instrument, which are no longer maintained
+	std::lock_guard lock { m_mutex };
+	for (const bool bid: { true, false })
+	{
+		ClearSide(ShmInstrumentKey(cp), bid);
+		m_sides.erase(ShmSideKey(ShmInstrumentKey(cp), bid));
+	}
+}
+
+void ShmPublisher::PublishSnapshot()
+{
+	std::lock_guard lock { m_mutex };
+	WriteSnapshot();
+}
+
+uint64_t ShmPublisher::LastSeq() const
+{
+	std::lock_guard lock { m_mutex };
+	return m_lastSeq;
+}
+
+void ShmPublisher::WriteLevel(uint32_t instrument, bool bid, int64_t price, int64_t qty, int64_t timestamp, int entry, int level)
+{
+	SideLevels &levels { m_sides[ShmSideKey(instrument, bid)] };
+	if (qty > 0)
+	{
+		levels[price] = qty;
+	}
+	else
+	{
+		qty = 0;
+		levels.erase(price);
+	}
+	Write({ ShmRecordType::Level, instrument, price, qty, timestamp, entry, level, uint8_t(bid) });
+	CheckSnapshot();
+}
+
+void ShmPublisher::AddToLevel(uint32_t instrument, bool bid, int64_t price, int64_t qty, int64_t timestamp)
+{
+	const SideLevels &levels { m_sides[ShmSideKey(instrument, bid)] };
+	const auto it { levels.find(price) };
+	WriteLevel(instrument, bid, price, (it != levels.end() ? it->second : 0) + qty, timestamp, -1, 0);
+}
+
+void ShmPublisher::ClearSide(uint32_t instrument, bool bid)
+{
+	m_sides[ShmSideKey(instrument, bid)].clear();
+	Write({ ShmRecordType::Clear, instrument, 0, 0, CurrentTimestamp(), -1, 0, uint8_t(bid) });
+}
+
+void ShmPublisher::Write(const ShmDelta &delta)
+{
+	if (!m_ring.Mapped())
+	{
+		return;
+	}
+	const uint64_t seq { m_lastSeq + 1 };
+	ShmSlot &slot { m_ring.Slot(seq) };
+	// readers still copying the slot's former record see the change of the sequence number and retry
+	slot.seq.store(0, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+	slot.delta = delta;
+	slot.seq.store(seq, std::memory_order_release);
+	m_ring.Header().writeSeq.store(seq, std::memory_order_release);
+	m_lastSeq = seq;
+}
+
+void ShmPublisher::CheckSnapshot()
+{
+	if (m_snapshotInterval > 0 && m_lastSeq - m_lastSnapshotSeq >= m_snapshotInterval)
+	{
+		WriteSnapshot();
+	}
+}
+
+void ShmPublisher::WriteSnapshot()
+{
+	if (!m_ring.Mapped())
+	{
+		return;
+	}
+	const uint64_t firstSeq { m_lastSeq + 1 };
+	const int64_t now { CurrentTimestamp() };
+	for (const auto &[key, levels]: m_sides)
+	{
+		const auto instrument { uint32_t(key >> 1u) };
+		const bool bid { (key & 1u) != 0 };
+		Write({ ShmRecordType::SnapshotBegin, instrument, 0, 0, now, -1, 0, uint8_t(bid) });
+		int levelNo { 1 };
+		auto write { [this, instrument, bid, now, &levelNo](const auto &level)
+		{
+			Write({ ShmRecordType::Level, instrument, level.first, level.second, now, -1, levelNo++, uint8_t(bid) });
+		} };
+		if (bid)
+		{
+			std::for_each(levels.rbegin(), levels.rend(), write);
+		}
+		else
+		{
+			std::for_each(levels.begin(), levels.end(), write);
+		}
+		Write({ ShmRecordType::SnapshotEnd, instrument, 0, 0, now, -1, 0, uint8_t(bid) });
+	}
+	m_lastSnapshotSeq = m_lastSeq;
+	if (m_lastSeq >= firstSeq)
+	{
+		m_ring.Header().snapshotSeq.store(firstSeq, std::memory_order_release);
+	}
+}
+
+} // namespace ORDERBOOK
@@ -0,0 +1,98 @@
+#include <cerrno>
+#include <cstring>
+#include <new>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "OrderBook/ShmRing.h"
+
+using namespace UTILS;
+
+namespace ORDERBOOK {
+
+namespace {
+
+constexpr size_t SlotsOffset() { return sizeof(ShmRingHeader); }
+
+} // namespace
+
+BoolResult ShmRingFile::Create(const std::string &path, uint64_t capacity)
+{
+	Unmap();
+	if (capacity < 2 || (capacity & (capacity - 1)) != 0)
+	{
+		return { setError, "Ring capacity %lu is not a power of 2", capacity };
+	}
+	::unlink(path.c_str());
+	const int fd { ::open(path.c_str(), O_RDWR | O_CREAT | O_EXCL, 0644) };
+	if (fd < 0)
+	{
+		return { setError, "Cannot create ring file '%s': %s", path, std::string(std::strerror(errno)) };
+	}
+	const size_t size { SlotsOffset() + capacity * sizeof(ShmSlot) };
+	void *addr { ::ftruncate(fd, off_t(size)) == 0 ? ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0) : MAP_FAILED };
+	const int error { errno };
+	::close(fd);
+	if (addr == MAP_FAILED)
+	{
+		::unlink(path.c_str());
+		return { setError, "Cannot map ring file '%s': %s", path, std::string(std::strerror(error)) };
+	}
+	// the file is zero-filled, so the slots hold no record; the magic number is set last
+	m_header = new(addr) ShmRingHeader;
+	m_header->version = SHM_RING_VERSION;
+	m_header->slotSize = sizeof(ShmSlot);
+	m_header->capacity = capacity;
+	m_header->writerActive.store(1, std::memory_order_relaxed);
+	m_slots = new(static_cast<char *>(addr) + SlotsOffset()) ShmSlot[capacity];
+	m_size = size;
+	m_header->magic.store(SHM_RING_MAGIC, std::memory_order_release);
+	return true;
+}
+
+BoolResult ShmRingFile::Open(const std::string &path)
+{
+	Unmap();
+	const int fd { ::open(path.c_str(), O_RDONLY) };
+	if (fd < 0)
+	{
+		return { setError, "Cannot open ring file '%s': %s", path, std::string(std::strerror(errno)) };
+	}
+	struct stat st { };
+	void *addr { ::fstat(fd, &st) == 0 && size_t(st.st_size) >= SlotsOffset()
+				 ? ::mmap(nullptr, size_t(st.st_size), PROT_READ, MAP_SHARED, fd, 0) : MAP_FAILED };
+	const int error { errno };
+	::close(fd);
+	if (addr == MAP_FAILED)
+	{
+		return { setError, "Cannot map ring file '%s': %s", path, std::string(std::strerror(error)) };
+	}
+	auto *header { static_cast<ShmRingHeader *>(addr) };
+	// the header is complete once the magic number is set
+	if (header->magic.load(std::memory_order_acquire) != SHM_RING_MAGIC || header->version != SHM_RING_VERSION
+		|| header->slotSize != sizeof(ShmSlot) || size_t(st.st_size) < SlotsOffset() + header->capacity * sizeof(ShmSlot))
+	{
+		::munmap(addr, size_t(st.st_size));
+		return { setError, "'%s' is not a book ring file of version %u", path, SHM_RING_VERSION };
+	}
+	m_header = header;
+	m_slots = reinterpret_cast<ShmSlot *>(static_cast<char *>(addr) + SlotsOffset());
+	m_size = size_t(st.st_size);
+	return true;
+}
+
+void ShmRingFile::Unmap()
+{
+	if (m_header)
+	{
+		::munmap(m_header, m_size);
+		m_header = nullptr;
+		m_slots = nullptr;
+		m_size = 0;
+	}
+}
+
+} // namespace ORDERBOOK
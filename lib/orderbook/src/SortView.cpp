@@ -0,0 +1,31 @@
+#include <sstream>
+
+#include "OrderBook/OrderBook.h"
+#include "OrderBook/SortView.h"
+
+using namespace UTILS;
+
+namespace CORE {
+namespace BOOK {
+
+SortView::Ptr SortView::Create(OrderBook &book, CurrencyPair cp, bool bid)
+{
+	return std::make_shared<SortView>(cp.ToString() + (bid ? " bid" : " ask"), book, cp, bid);
+}
+
+void SortView::IterateQuoteGroups(const QuoteGroupFunc &action, const QuotePred &quotePred) const
+{
+	m_book.IterateQuoteGroups(m_cp, m_bid, action, quotePred);
+}
+
+/*! \brief Appends instrument and side of the view, unless the sort view is to be skipped */
+void SortView::AppendFilter(std::stringstream &ss, bool skipSortView, const std::string &delimiter) const
+{
+	if (!skipSortView)
+	{
+		ss << Name();
+	}
+}
+
+} // namespace BOOK
+} // namespace CORE
@@ -0,0 +1,186 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace UTILS
+{
+
+/*! \brief This class is a bump allocator for objects living as long as one message.
+ *
+ * Allocations are carved one after the other from a buffer given by the owner
+ * (e.g. a member of the message) and, once it is used up, from blocks taken
+ * from the heap. Nothing is freed before the arena is destroyed, which frees
+ * all blocks at once; the objects must therefore be trivially destructible.
+ *
+ * The last allocation can be grown in place (see \a Extend), so an array
+ * filled element by element (see \a ArenaArray) is copied only when it
+ * crosses into a new block.
+ */
+class Arena
+{
+public:
+	/*! \brief Default size of the blocks taken from the heap */
+	static constexpr size_t DEFAULT_BLOCK_SIZE = 64 * 1024;
+
+	explicit Arena(size_t blockSize = DEFAULT_BLOCK_SIZE)
+			: m_blockSize(blockSize) { }
+
+	/*! \brief Arena starting with a buffer of the owner (which must outlive the arena) */
+	Arena(void *buffer, size_t size, size_t blockSize = DEFAULT_BLOCK_SIZE)
+			: m_current(static_cast<char *>(buffer)), m_end(m_current + size), m_blockSize(blockSize) { }
+
+	~Arena();
+
+	Arena(const Arena &) = delete;
+
+	Arena &operator=(const Arena &) = delete;
+
+	/*! \brief Allocates \a bytes aligned to \a align (a power of two); throws \a std::bad_alloc if a block cannot be taken */
+	void *Allocate(size_t bytes, size_t align = alignof(std::max_align_t))
+	{
+		char *const p { Align(m_current, align) };
+		if (p && p <= m_end && size_t(m_end - p) >= bytes)
+		{
+			m_last = p;
+			m_current = p + bytes;
+			return p;
+		}
+		return AllocateBlock(bytes, align);
+	}
+
+	/*! \brief Grows the last allocation \a ptr in place from \a oldBytes to \a newBytes
+	 *
+	 * @return \a false if \a ptr is not the last allocation or the space after it is too small
+	 */
+	bool Extend(const void *ptr, size_t oldBytes, size_t newBytes)
+	{
+		if (ptr != m_last || m_current != m_last + oldBytes || size_t(m_end - m_last) < newBytes)
+		{
+			return false;
+		}
+		m_current = m_last + newBytes;
+		return true;
+	}
+
+	/*! \brief Number of blocks taken from the heap */
+	size_t BlockCount() const { return m_blockCount; }
+
+private:
+	/*! \brief Header of a block taken from the heap, followed by its bytes */
+	struct Block
+	{
+		Block *next;
+	};
+
+	static char *Align(char *p, size_t align)
+	{
+		return reinterpret_cast<char *>((reinterpret_cast<uintptr_t>(p) + align - 1) & ~uintptr_t(align - 1));
+	}
+
+	/*! \brief Takes a new block large enough for \a bytes and allocates them at its start */
+	void *AllocateBlock(size_t bytes, size_t align);
+
+	char *m_current { nullptr }; //!< Start of the free space
+	char *m_end { nullptr }; //!< End of the free space
+	char *m_last { nullptr }; //!< Start of the last allocation
+	Block *m_blocks { nullptr }; //!< Blocks taken from the heap, last one first
+	size_t m_blockCount { 0 };
+	size_t m_blockSize;
+};
+
+/*! \brief This class template is an array filled element by element in an \a Arena.
+ *
+ * It grows like a \a std::vector, but in place as long as it is the arena's
+ * last allocation and the space after it suffices; elements are copied
+ * bytewise and never destroyed, so \a T must be trivially copyable.
+ */
+template <typename T>
+class ArenaArray
+{
+	static_assert(std::is_trivially_copyable_v<T> && std::is_trivially_destructible_v<T>, "elements of an arena array are never destroyed");
+
+public:
+	/*! \brief Capacity of the first allocation */
+	static constexpr size_t MIN_CAPACITY = 16;
+
+	explicit ArenaArray(Arena &arena)
+			: m_arena(&arena) { }
+
+	void push_back(const T &value)
+	{
+		if (m_size == m_capacity)
+		{
+			reserve(m_capacity ? 2 * m_capacity : MIN_CAPACITY);
+		}
+		m_data[m_size++] = value;
+	}
+
+	template <typename... Args>
+	T &emplace_back(Args &&...args)
+	{
+		if (m_size == m_capacity)
+		{
+			reserve(m_capacity ? 2 * m_capacity : MIN_CAPACITY);
+		}
+		return *new (m_data + m_size++) T { std::forward<Args>(args)... };
+	}
+
+	void reserve(size_t capacity)
+	{
+		if (capacity <= m_capacity)
+		{
+			return;
+		}
+		if (m_data && m_arena->Extend(m_data, m_capacity * sizeof(T), capacity * sizeof(T)))
+		{
+			m_capacity = capacity;
+			return;
+		}
+		T *const data { static_cast<T *>(m_arena->Allocate(capacity * sizeof(T), alignof(T))) };
+		if (m_size)
+		{
+			std::memcpy(static_cast<void *>(data), m_data, m_size * sizeof(T));
+		}
+		m_data = data;
+		m_capacity = capacity;
+	}
+
+	size_t size() const { return m_size; }
+
+	size_t capacity() const { return m_capacity; }
+
+	bool empty() const { return m_size == 0; }
+
+	T *data() { return m_data; }
+
+	const T *data() const { return m_data; }
+
+	T &operator[](size_t i) { return m_data[i]; }
+
+	const T &operator[](size_t i) const { return m_data[i]; }
+
+	T &back() { return m_data[m_size - 1]; }
+
+	const T &back() const { return m_data[m_size - 1]; }
+
+	T *begin() { return m_data; }
+
+	T *end() { return m_data + m_size; }
+
+	const T *begin() const { return m_data; }
+
+	const T *end() const { return m_data + m_size; }
+
+private:
+	Arena *m_arena;
+	T *m_data { nullptr };
+	size_t m_size { 0 };
+	size_t m_capacity { 0 };
+};
+
+} // namespace UTILS
@@ -23,6 +23,7 @@
 #include "Utils/BgwMonitor.h"
 
 #define MAX_QUEUESIZE       100'000ul
+#define MAX_SPARE_ELEMENTS  1'024ul
 
 #define QUEUE_NEW           0
 #define QUEUE_UPDATE        1
@@ -315,11 +316,14 @@ private:
 	using SequenceTagType = size_t; //!< Type of sequence tag
 	using SequenceTag = std::optional<SequenceTagType>; //!< Type of optional sequence tag
 	
-	/** @brief Type of a single queued item. */
+	/** @brief Type of a single queued item.
+	 *
+	 * Processed items are kept for reuse (see @a m_spareElements); the
+	 * arguments are destroyed as soon as the item is processed. */
 	struct Element
 	{
 		SequenceTag sequenceTag; //!< optional sequence tag
-		ArgTuple args; //!< argument tuple
+		std::optional<ArgTuple> args; //!< argument tuple (empty while the item is spare)
 	};
 	
 	using ElementPtr = std::unique_ptr<Element>; //!< unique pointer to a queued item
@@ -330,6 +334,10 @@ private:
 	
 	Queue m_queue; //!< queue
 	
+	/** Processed items ready for reuse, so that queueing an item allocates
+	 * nothing in steady state (at most @a MAX_SPARE_ELEMENTS are kept). */
+	std::vector<ElementPtr> m_spareElements;
+	
 	std::unordered_set<SequenceTagType> m_openSequences; //!< set of sequences currently being processed
 	
 	mutable std::shared_mutex m_mtx; //!< Mutex for accessing the processing queue
@@ -375,7 +383,19 @@ private:
 				{
 					m_waitingSince = CurrentTimestamp();
 				}
-				m_queue.emplace_back(ElementPtr(new Element { sequenceTag, ArgTuple { std::forward<Args>(args)... }}));
+				ElementPtr elem;
+				if (!m_spareElements.empty())
+				{
+					elem = std::move(m_spareElements.back());
+					m_spareElements.pop_back();
+					elem->sequenceTag = sequenceTag;
+				}
+				else
+				{
+					elem.reset(new Element { sequenceTag, std::nullopt });
+				}
+				elem->args.emplace(std::forward<Args>(args)...);
+				m_queue.push_back(std::move(elem));
 				
 				if (m_autoflush)
 				{
@@ -470,17 +490,22 @@ private:
 				lock.unlock(); //!< release the queue before starting to process the popped item
 				try
 				{
-					call_action_with_tuple(action, elem->args, std::index_sequence_for<Args...>());
+					call_action_with_tuple(action, *elem->args, std::index_sequence_for<Args...>());
 				}
 				catch (...)
 				{
 					/// ignore exceptions in action
 				}
+				elem->args.reset(); //!< release the arguments before taking the lock again
 				lock.lock(); //!< processing finished -> lock queue
 				if (elem->sequenceTag)
 				{
 					m_openSequences.erase(elem->sequenceTag.value()); //!< mark the sequence as closed
 				}
+				if (m_spareElements.size() < MAX_SPARE_ELEMENTS)
+				{
+					m_spareElements.push_back(std::move(elem)); //!< keep the item for reuse
+				}
 				it = m_queue.begin(); //!< reset the queue iterator
 			}
 		}
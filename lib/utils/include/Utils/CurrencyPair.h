@@ -10,7 +10,9 @@
 #include <string>
 #include <map>
 #include <cmath>
+#include <string_view>
 
+#include "Utils/Decimal.h"
 #include "Utils/Result.h"
 #include "Utils/Lockable.h"
 
@@ -334,6 +336,19 @@ public:
 	/*! \brief Converts "CentiPips" to a a double currency value */
 	double CpipToDbl(int64_t cpip) const { return (double) (cpip) / CpipFactor(); }
 
+	/*! \brief Number of decimals of "CentiPips" (-1 if the factor is not a power of ten) */
+	int CpipDecimals() const { return FactorDecimals(CpipFactor()); }
+
+	/*! \brief Number of decimals of quantities (see DoubleToQty) */
+	int QtyDecimals() const { return IsFX() ? FactorDecimals(QUANTITY_DECIMAL_FACTOR) : FactorDecimals(QUANTITY_DECIMAL_FACTOR_CRYPTO); }
+
+	/*! \brief Converts the text of a price (e.g. "21921.73") to "CentiPips", exactly (see ParseDecimal)
+	 * @return \a false if the text is not a number or the price does not fit */
+	bool StrToCpip(std::string_view text, int64_t &cpip) const { return ParseDecimal(text, CpipDecimals(), cpip); }
+
+	/*! \brief Converts the text of a quantity (e.g. "0.00012") to quantity units, exactly (see ParseDecimal) */
+	bool StrToQty(std::string_view text, int64_t &qty) const { return ParseDecimal(text, QtyDecimals(), qty); }
+
     const double QtyToDouble(int64_t qty) const
     {
         return IsFX() ? (double(qty) / QUANTITY_DECIMAL_FACTOR) : (double(qty) / QUANTITY_DECIMAL_FACTOR_CRYPTO);
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+
+namespace UTILS
+{
+
+/*! \brief Largest number of decimals \a ParseDecimal scales to */
+constexpr int MAX_DECIMALS = 18;
+
+/*! \brief Converts the text of a decimal number to an integer scaled by 10^decimals, exactly.
+ *
+ * The text is an optional sign, digits with an optional fraction, and an
+ * optional exponent (e.g. "-0.00012", "21921.73", "1.5e-3"). Digits beyond
+ * \a decimals are rounded half away from zero, the way \a llround rounds the
+ * product of a double and the scale factor, but without the error of the
+ * double. Runs of eight digits are converted in one step (SWAR).
+ *
+ * @param text Text of the number (e.g. a price or size string of a venue)
+ * @param decimals Number of decimals of the result (0..MAX_DECIMALS)
+ * @param out Scaled integer (unchanged on failure)
+ * @return \a false if the text is not a number or the result overflows
+ */
+bool ParseDecimal(std::string_view text, int decimals, int64_t &out);
+
+/*! \brief Number of decimals of a scale factor that is a power of ten (e.g. 6 for 1000000), or -1 */
+int FactorDecimals(int64_t factor);
+
+} // namespace UTILS
@@ -0,0 +1,168 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace UTILS
+{
+
+/*! \brief This class implements epoch-based reclamation for read-copy-update
+ * (RCU) data structures.
+ *
+ * Readers pin the current epoch (\a Pin) for as long as they dereference
+ * objects published by a writer; pinning and unpinning is one atomic exchange
+ * each, without locks. A writer that has replaced a published object hands the
+ * old one to \a Retire. Retired objects are deleted by \a Reclaim as soon as no
+ * reader is pinned at an epoch at or before the retirement, i.e. when no reader
+ * can still hold a pointer to them.
+ *
+ * The number of concurrently pinned guards is limited to \a MAX_READERS; a
+ * reader spins while all slots are taken.
+ */
+class EpochDomain
+{
+public:
+	static constexpr size_t MAX_READERS = 64; //!< Maximum number of concurrently pinned guards
+
+	/*! \brief RAII object keeping an epoch pinned */
+	class Guard
+	{
+	public:
+		Guard(Guard &&other) noexcept
+				: m_domain(other.m_domain), m_slot(other.m_slot) { other.m_domain = nullptr; }
+
+		Guard(const Guard &) = delete;
+
+		Guard &operator=(const Guard &) = delete;
+
+		~Guard()
+		{
+			if (m_domain)
+			{
+				m_domain->m_slots[m_slot].epoch.store(FREE, std::memory_order_release);
+			}
+		}
+
+	private:
+		friend class EpochDomain;
+
+		Guard(EpochDomain *domain, size_t slot)
+				: m_domain(domain), m_slot(slot) { }
+
+		EpochDomain *m_domain;
+		size_t m_slot;
+	};
+
+	EpochDomain() = default;
+
+	EpochDomain(const EpochDomain &) = delete;
+
+	EpochDomain &operator=(const EpochDomain &) = delete;
+
+	/*! \brief Deletes all retired objects (no reader may be pinned any more) */
+	~EpochDomain()
+	{
+		for (auto &retired: m_retired)
+		{
+			retired.deleter();
+		}
+	}
+
+	/*! \brief Pins the current epoch
+	 *
+	 * Objects loaded after this call stay valid until the returned guard is destroyed.
+	 */
+	Guard Pin()
+	{
+		size_t slot { std::hash<std::thread::id>()(std::this_thread::get_id()) % MAX_READERS };
+		for (;; slot = (slot + 1) % MAX_READERS)
+		{
+			uint64_t expected { FREE };
+			uint64_t epoch { m_epoch.load() };
+			if (m_slots[slot].epoch.compare_exchange_strong(expected, epoch))
+			{
+				// the writer may have advanced the epoch before our slot became visible -> publish the current one
+				for (uint64_t current { m_epoch.load() }; current != epoch; current = m_epoch.load())
+				{
+					epoch = current;
+					m_slots[slot].epoch.store(epoch);
+				}
+				return Guard(this, slot);
+			}
+		}
+	}
+
+	/*! \brief Retires an object that has been unpublished (writer side)
+	 *
+	 * @param deleter Action deleting the object, executed once no reader can reference it
+	 */
+	void Retire(std::function<void()> deleter)
+	{
+		std::lock_guard lock { m_retiredMutex };
+		m_retired.push_back({ m_epoch.load(), std::move(deleter) });
+		if (m_retired.size() >= RECLAIM_THRESHOLD)
+		{
+			ReclaimLocked();
+		}
+	}
+
+	/*! \brief Advances the epoch and deletes the retired objects no reader can reference any more */
+	void Reclaim()
+	{
+		std::lock_guard lock { m_retiredMutex };
+		ReclaimLocked();
+	}
+
+	/*! \brief Number of retired objects not yet deleted */
+	size_t RetiredCount() const
+	{
+		std::lock_guard lock { m_retiredMutex };
+		return m_retired.size();
+	}
+
+private:
+	static constexpr uint64_t FREE = 0; //!< Slot value of an unpinned slot (epochs start at 1)
+	static constexpr size_t RECLAIM_THRESHOLD = 32; //!< Retired objects triggering a reclamation
+
+	struct alignas(64) Slot
+	{
+		std::atomic<uint64_t> epoch { FREE };
+	};
+
+	struct Retired
+	{
+		uint64_t epoch;
+		std::function<void()> deleter;
+	};
+
+	alignas(64) std::atomic<uint64_t> m_epoch { 1 }; //!< Global epoch
+	Slot m_slots[MAX_READERS]; //!< Epochs pinned by readers
+	mutable std::mutex m_retiredMutex;
+	std::vector<Retired> m_retired; //!< Retired objects, in order of retirement
+
+	void ReclaimLocked()
+	{
+		m_epoch.fetch_add(1);
+		uint64_t minPinned { UINT64_MAX };
+		for (const auto &slot: m_slots)
+		{
+			const uint64_t epoch { slot.epoch.load() };
+			if (epoch != FREE && epoch < minPinned)
+			{
+				minPinned = epoch;
+			}
+		}
+		size_t n { 0 };
+		while (n < m_retired.size() && m_retired[n].epoch < minPinned)
+		{
+			m_retired[n++].deleter();
+		}
+		m_retired.erase(m_retired.begin(), m_retired.begin() + long(n));
+	}
+};
+
+}
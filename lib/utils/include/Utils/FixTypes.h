@@ -478,15 +478,18 @@ struct BookUpdate
 		QuoteType entryType { QuoteType::INVALID }; //!< tag 269
 		CurrencyPair instrument { }; //!< tag 55
 		Currency currency { }; //!< tag 15
-		double price { 0.0 }, volume { 0.0 }, minQty { 0.0 }; //!< tags 270, 271, 110, respectively
+		int64_t price { 0 }; //!< tag 270, in "CentiPips" of the instrument (see CurrencyPair::StrToCpip)
+		int64_t volume { 0 }, minQty { 0 }; //!< tags 271, 110, in quantity units (see CurrencyPair::StrToQty)
 #ifdef PARSE_ORIGINATORS
 		OriginatorVectorPtr originators;
 #else
 		std::string originators { "" }; //!< tag 282
 #endif
         int64_t adptReceiveTime { 0 };
-        uint64_t sequenceTag {0};
+        uint64_t sequenceTag {0}; //!< Hash of the instrument: entries of one instrument are applied in order
 		bool endOfMessage { false }; //!< Is this the last entry of the message?
+		int64_t key { 0 }; //!< Book key assigned by the connection (0 -> entry is skipped by OrderBook::ApplyBatch)
+		int64_t refKey { 0 }; //!< Book key of the entry replaced or deleted by this one (0 -> none)
 	};
 	
 	std::string mdReqID { "" }; //!< tag 262
@@ -0,0 +1,196 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace UTILS
+{
+
+/*! \brief This class template is a hash map with open addressing (linear
+ * probing) over a single contiguous slot array.
+ *
+ * Lookups touch one or a few adjacent slots instead of chasing the node
+ * pointers of \a std::unordered_map, and inserting an existing key or
+ * erasing a key never allocates. Erased slots are refilled by shifting the
+ * following entries of the probe sequence back, so no tombstones are left.
+ * The capacity is a power of two and doubles when the map is half full.
+ *
+ * \a K and \a V must be default constructible. The map is not synchronized.
+ */
+template <typename K, typename V, typename Hash = std::hash<K>>
+class FlatHashMap
+{
+public:
+	/*! \brief Constructor
+	 *
+	 * @param capacity Initial number of slots (rounded up to a power of two)
+	 */
+	explicit FlatHashMap(size_t capacity = 16)
+	{
+		Rehash(capacity);
+	}
+
+	/*! \brief Number of entries */
+	size_t Size() const { return m_size; }
+
+	/*! \brief Is the map empty? */
+	bool Empty() const { return m_size == 0; }
+
+	/*! \brief Number of slots */
+	size_t Capacity() const { return m_slots.size(); }
+
+	/*! \brief Pointer to the value of a key, or \a nullptr if the key is not contained */
+	V *Find(const K &key)
+	{
+		const size_t idx { FindIndex(key) };
+		return idx != NPOS ? &m_slots[idx].value : nullptr;
+	}
+
+	/*! \brief Pointer to the value of a key, or \a nullptr if the key is not contained (const) */
+	const V *Find(const K &key) const
+	{
+		const size_t idx { FindIndex(key) };
+		return idx != NPOS ? &m_slots[idx].value : nullptr;
+	}
+
+	/*! \brief Does the map contain a key? */
+	bool Contains(const K &key) const { return FindIndex(key) != NPOS; }
+
+	/*! \brief Inserts a key, or assigns the value if the key is already contained
+	 *
+	 * @return \a true if the key has been inserted, \a false if the value has been assigned
+	 */
+	bool Insert(const K &key, V value)
+	{
+		if ((m_size + 1) * 2 > m_slots.size())
+		{
+			Rehash(m_slots.size() * 2);
+		}
+		for (size_t idx { Home(key) };; idx = (idx + 1) & m_mask)
+		{
+			Slot &slot { m_slots[idx] };
+			if (!slot.used)
+			{
+				slot.key = key;
+				slot.value = std::move(value);
+				slot.used = true;
+				++m_size;
+				return true;
+			}
+			if (slot.key == key)
+			{
+				slot.value = std::move(value);
+				return false;
+			}
+		}
+	}
+
+	/*! \brief Erases a key
+	 *
+	 * @return \a true if the key was contained
+	 */
+	bool Erase(const K &key)
+	{
+		size_t hole { FindIndex(key) };
+		if (hole == NPOS)
+		{
+			return false;
+		}
+		// backward shift: move entries of the probe sequence into the hole unless they would move before their home slot
+		for (size_t idx { (hole + 1) & m_mask }; m_slots[idx].used; idx = (idx + 1) & m_mask)
+		{
+			const size_t home { Home(m_slots[idx].key) };
+			if (((idx - home) & m_mask) >= ((idx - hole) & m_mask))
+			{
+				m_slots[hole] = std::move(m_slots[idx]);
+				hole = idx;
+			}
+		}
+		m_slots[hole] = Slot { };
+		--m_size;
+		return true;
+	}
+
+	/*! \brief Erases all entries, keeping the capacity */
+	void Clear()
+	{
+		std::fill(m_slots.begin(), m_slots.end(), Slot { });
+		m_size = 0;
+	}
+
+	/*! \brief Executes an action for each entry (in slot order)
+	 *
+	 * @tparam A Signature: void action(const K &key, const V &value)
+	 */
+	template <typename A>
+	void ForEach(A action) const
+	{
+		for (const auto &slot: m_slots)
+		{
+			if (slot.used)
+			{
+				action(slot.key, slot.value);
+			}
+		}
+	}
+
+private:
+	static constexpr size_t NPOS { size_t(-1) };
+
+	struct Slot
+	{
+		K key { };
+		V value { };
+		bool used { false };
+	};
+
+	std::vector<Slot> m_slots; //!< Slot array, size is a power of two
+	size_t m_mask { 0 }; //!< Slot count - 1
+	unsigned m_shift { 0 }; //!< 64 - log2(slot count)
+	size_t m_size { 0 }; //!< Number of used slots
+
+	/*! \brief Home slot of a key (Fibonacci hashing, spreads sequential keys over the table) */
+	size_t Home(const K &key) const
+	{
+		return size_t((uint64_t(Hash { }(key)) * 0x9E3779B97F4A7C15ull) >> m_shift) & m_mask;
+	}
+
+	size_t FindIndex(const K &key) const
+	{
+		for (size_t idx { Home(key) }; m_slots[idx].used; idx = (idx + 1) & m_mask)
+		{
+			if (m_slots[idx].key == key)
+			{
+				return idx;
+			}
+		}
+		return NPOS;
+	}
+
+	void Rehash(size_t capacity)
+	{
+		size_t count { 2 };
+		unsigned bits { 1 };
+		while (count < capacity)
+		{
+			count <<= 1u;
+			++bits;
+		}
+		std::vector<Slot> old(count);
+		old.swap(m_slots);
+		m_mask = count - 1;
+		m_shift = 64 - bits;
+		m_size = 0;
+		for (auto &slot: old)
+		{
+			if (slot.used)
+			{
+				Insert(slot.key, std::move(slot.value));
+			}
+		}
+	}
+};
+
+}
@@ -0,0 +1,186 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <string_view>
+#include <vector>
+
+namespace UTILS
+{
+
+class FrameSlabPool;
+
+/*! \brief This class is a buffer a received frame is read into in place.
+ *
+ * A slab is handed out by \a FrameSlabPool::Acquire and goes back to its pool
+ * when the last reference to it is dropped. In front of the frame's bytes it
+ * reserves a small header for the object the frame is handed on in (see
+ * \a FrameSlabAllocator), so that passing a frame to another thread costs no
+ * allocation.
+ */
+class FrameSlab
+{
+public:
+	/*! \brief Size of the header (enough for a shared_ptr control block and the document it holds) */
+	static constexpr size_t HEADER_SIZE = 512;
+
+	char *Data() { return m_data; }
+
+	const char *Data() const { return m_data; }
+
+	size_t Capacity() const { return m_capacity; }
+
+	/*! \brief Received frame (the first \a size bytes of the slab, see \a SetSize) */
+	std::string_view View() const { return { m_data, m_size }; }
+
+	void SetSize(size_t size) { m_size = size < m_capacity ? size : m_capacity; }
+
+	/*! \brief Is the object at \a ptr placed in the header of the slab? */
+	bool InHeader(const void *ptr) const
+	{
+		const char *p { static_cast<const char *>(ptr) };
+		return p >= m_header && p < m_header + HEADER_SIZE;
+	}
+
+private:
+	friend class FrameSlabPool;
+
+	template <typename T>
+	friend class FrameSlabAllocator;
+
+	std::shared_ptr<FrameSlabPool> m_pool; //!< Keeps the pool alive while the slab is out
+	char *m_header { nullptr };
+	char *m_data { nullptr };
+	size_t m_capacity { 0 };
+	size_t m_size { 0 };
+	bool m_headerUsed { false };
+};
+
+/*! \brief This class is a pool of slabs receiving frames of at most a given size.
+ *
+ * The slabs are carved from one anonymous mapping, so memory is committed only
+ * for the pages frames are actually written to. Free slabs are kept on a stack:
+ * the slab released last, whose pages are still in the cache, is handed out
+ * first, and in steady state a few slabs circulate while the others stay
+ * untouched. Slabs are acquired by one thread (the reader of a socket) and may
+ * be released by any other.
+ *
+ * The pool is shared: each slab that is out holds a reference to it, so the
+ * mapping outlives the last frame still being handled.
+ */
+class FrameSlabPool : public std::enable_shared_from_this<FrameSlabPool>
+{
+public:
+	/*! \brief Returns a slab to its pool */
+	struct Releaser
+	{
+		void operator()(FrameSlab *slab) const;
+	};
+
+	using SlabPtr = std::unique_ptr<FrameSlab, Releaser>;
+
+	/*! \brief Creates a pool of \a slabCount slabs of \a slabCapacity bytes each */
+	static std::shared_ptr<FrameSlabPool> Create(size_t slabCount, size_t slabCapacity);
+
+	~FrameSlabPool();
+
+	FrameSlabPool(const FrameSlabPool &) = delete;
+
+	FrameSlabPool &operator=(const FrameSlabPool &) = delete;
+
+	/*! \brief Takes a free slab
+	 *
+	 * @return The slab, or \a nullptr if all slabs are out (or the mapping failed);
+	 * the caller then falls back to its own buffer.
+	 */
+	SlabPtr Acquire();
+
+	size_t SlabCount() const { return m_slabs.size(); }
+
+	size_t SlabCapacity() const { return m_slabCapacity; }
+
+	/*! \brief Number of free slabs */
+	size_t Available() const
+	{
+		std::lock_guard lock { m_mtx };
+		return m_free.size();
+	}
+
+	/*! \brief Number of times \a Acquire found no free slab */
+	size_t Misses() const { return m_misses.load(std::memory_order_relaxed); }
+
+private:
+	FrameSlabPool(size_t slabCount, size_t slabCapacity);
+
+	void Release(FrameSlab *slab);
+
+	size_t m_slabCapacity;
+	char *m_memory { nullptr };
+	size_t m_mappedSize { 0 };
+	std::vector<FrameSlab> m_slabs;
+	std::vector<FrameSlab *> m_free; //!< Stack of free slabs (never grows beyond the number of slabs)
+	mutable std::mutex m_mtx;
+	std::atomic<size_t> m_misses { 0 };
+};
+
+/*! \brief This class template is an allocator placing a single object in the header of a slab.
+ *
+ * It is meant for \a std::allocate_shared: the control block and the object
+ * go into the slab's header (or come from the heap if they do not fit), and
+ * when the control block is deallocated (the last reference is dropped) the
+ * slab goes back to its pool.
+ *
+ * The allocator serves one allocation per slab. The caller keeps its
+ * \a FrameSlabPool::SlabPtr until \a std::allocate_shared has returned and
+ * then gives it up (see \a SlabPtr::release); the object's constructor must
+ * therefore not throw.
+ */
+template <typename T>
+class FrameSlabAllocator
+{
+public:
+	using value_type = T;
+
+	explicit FrameSlabAllocator(FrameSlab *slab) noexcept
+			: m_slab(slab) { }
+
+	template <typename U>
+	FrameSlabAllocator(const FrameSlabAllocator<U> &other) noexcept
+			: m_slab(other.m_slab) { }
+
+	T *allocate(size_t n)
+	{
+		if (!m_slab->m_headerUsed && n * sizeof(T) <= FrameSlab::HEADER_SIZE && alignof(T) <= alignof(std::max_align_t))
+		{
+			m_slab->m_headerUsed = true;
+			return reinterpret_cast<T *>(m_slab->m_header);
+		}
+		return static_cast<T *>(::operator new(n * sizeof(T)));
+	}
+
+	void deallocate(T *ptr, size_t)
+	{
+		if (!m_slab->InHeader(ptr))
+		{
+			::operator delete(ptr);
+		}
+		FrameSlabPool::Releaser()(m_slab);
+	}
+
+	template <typename U>
+	bool operator==(const FrameSlabAllocator<U> &other) const { return m_slab == other.m_slab; }
+
+	template <typename U>
+	bool operator!=(const FrameSlabAllocator<U> &other) const { return m_slab != other.m_slab; }
+
+private:
+	template <typename U>
+	friend class FrameSlabAllocator;
+
+	FrameSlab *m_slab;
+};
+
+} // namespace UTILS
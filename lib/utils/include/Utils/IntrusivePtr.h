@@ -0,0 +1,105 @@
+#pragma once
+
+#include <cstddef>
+#include <utility>
+
+namespace UTILS
+{
+
+/*! \brief This class template is a smart pointer to an object carrying its own
+ * reference count.
+ *
+ * Unlike \a std::shared_ptr it needs no separate control block, so an object
+ * is a single allocation (which may come from an object pool), and a handle is
+ * one pointer wide. The object type decides how references are counted and
+ * how an object is disposed of: the free functions
+ * \a IntrusiveAddRef(const T *) and \a IntrusiveRelease(const T *) are found
+ * by argument-dependent lookup.
+ *
+ * Copying a handle adds a reference, moving it does not; hot paths should hand
+ * handles on by move. The handle itself is not synchronized.
+ */
+template <typename T>
+class IntrusivePtr
+{
+public:
+	using element_type = T;
+
+	IntrusivePtr() noexcept = default;
+
+	IntrusivePtr(std::nullptr_t) noexcept { }
+
+	/*! \brief Constructor
+	 *
+	 * @param ptr Object to be referenced
+	 * @param addRef \a true -> adds a reference, \a false -> adopts a reference already held by the caller
+	 */
+	explicit IntrusivePtr(T *ptr, bool addRef = true) noexcept
+			: m_ptr(ptr)
+	{
+		if (m_ptr && addRef)
+		{
+			IntrusiveAddRef(m_ptr);
+		}
+	}
+
+	IntrusivePtr(const IntrusivePtr &other) noexcept
+			: IntrusivePtr(other.m_ptr) { }
+
+	IntrusivePtr(IntrusivePtr &&other) noexcept
+			: m_ptr(other.m_ptr) { other.m_ptr = nullptr; }
+
+	~IntrusivePtr()
+	{
+		if (m_ptr)
+		{
+			IntrusiveRelease(m_ptr);
+		}
+	}
+
+	IntrusivePtr &operator=(const IntrusivePtr &other) noexcept
+	{
+		IntrusivePtr(other).Swap(*this);
+		return *this;
+	}
+
+	IntrusivePtr &operator=(IntrusivePtr &&other) noexcept
+	{
+		IntrusivePtr(std::move(other)).Swap(*this);
+		return *this;
+	}
+
+	IntrusivePtr &operator=(std::nullptr_t) noexcept
+	{
+		reset();
+		return *this;
+	}
+
+	void reset() noexcept { IntrusivePtr().Swap(*this); }
+
+	/*! \brief Gives up the reference without releasing it; the caller becomes responsible for it */
+	T *Detach() noexcept { return std::exchange(m_ptr, nullptr); }
+
+	void Swap(IntrusivePtr &other) noexcept { std::swap(m_ptr, other.m_ptr); }
+
+	T *get() const noexcept { return m_ptr; }
+
+	T &operator*() const noexcept { return *m_ptr; }
+
+	T *operator->() const noexcept { return m_ptr; }
+
+	explicit operator bool() const noexcept { return m_ptr != nullptr; }
+
+	friend bool operator==(const IntrusivePtr &lhs, const IntrusivePtr &rhs) noexcept { return lhs.m_ptr == rhs.m_ptr; }
+
+	friend bool operator==(const IntrusivePtr &lhs, std::nullptr_t) noexcept { return lhs.m_ptr == nullptr; }
+
+	friend bool operator!=(const IntrusivePtr &lhs, const IntrusivePtr &rhs) noexcept { return lhs.m_ptr != rhs.m_ptr; }
+
+	friend bool operator!=(const IntrusivePtr &lhs, std::nullptr_t) noexcept { return lhs.m_ptr != nullptr; }
+
+private:
+	T *m_ptr { nullptr };
+};
+
+} // namespace UTILS
@@ -0,0 +1,181 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace UTILS
+{
+
+/*! \brief This class is an on-demand, read-only view of a JSON value.
+ *
+ * A value is a pointer to its first character in a document held by the
+ * caller; nothing is parsed until a field is requested, and then only the
+ * bytes in front of it are scanned. Looking up a member skips the members
+ * before it (and their nested values) without materializing them, so a
+ * handler reading a few fields of a frame never builds a tree or allocates.
+ * Strings, containers and the bytes between tokens are skipped with SIMD
+ * scans for quotes, backslashes and brackets (SSE2 on x86-64, 16 bytes per
+ * step, with a scalar fallback elsewhere).
+ *
+ * Values refer to the document's bytes and must not outlive them. Malformed
+ * JSON never reads outside the document: lookups into it return values of
+ * type \a Type::Invalid, and the conversions fail.
+ */
+class JsonValue
+{
+public:
+	enum class Type
+	{
+		Invalid, //!< Missing member, index out of range, or malformed JSON
+		Null,
+		Bool,
+		Number,
+		String,
+		Array,
+		Object
+	};
+
+	JsonValue() = default;
+
+	/*! \brief Root value of a document */
+	static JsonValue Parse(std::string_view document);
+
+	Type GetType() const { return m_type; }
+
+	bool Valid() const { return m_type != Type::Invalid; }
+
+	bool IsNull() const { return m_type == Type::Null; }
+
+	bool IsArray() const { return m_type == Type::Array; }
+
+	bool IsObject() const { return m_type == Type::Object; }
+
+	bool IsString() const { return m_type == Type::String; }
+
+	/*! \brief Member of an object, or an invalid value if the value is not an object or has no such member */
+	JsonValue operator[](std::string_view name) const;
+
+	/*! \brief Element of an array, or an invalid value if the value is not an array or is too short */
+	JsonValue At(size_t index) const;
+
+	/*! \brief Number of elements of an array or members of an object (0 for other values) */
+	size_t Size() const;
+
+	/*! \brief Executes an action for each element of an array
+	 *
+	 * @tparam A Signature: void action(const JsonValue &element, bool &cont).
+	 *           If \a cont is set to \a false, the iteration is stopped.
+	 */
+	template <typename A>
+	void ForEachElement(A action) const
+	{
+		if (m_type != Type::Array)
+		{
+			return;
+		}
+		bool cont { true };
+		for (JsonValue element { First() }; cont && element.Valid(); element = element.Next())
+		{
+			action(element, cont);
+		}
+	}
+
+	/*! \brief Executes an action for each member of an object
+	 *
+	 * @tparam A Signature: void action(std::string_view name, const JsonValue &value, bool &cont),
+	 *           with the name as in the document (escape sequences are not resolved).
+	 *           If \a cont is set to \a false, the iteration is stopped.
+	 */
+	template <typename A>
+	void ForEachMember(A action) const
+	{
+		if (m_type != Type::Object)
+		{
+			return;
+		}
+		bool cont { true };
+		for (JsonValue member { First() }; cont && member.Valid(); member = member.Next())
+		{
+			action(member.Name(), member, cont);
+		}
+	}
+
+	/*! \brief Text of a string without the quotes (escape sequences are not resolved), of a number or
+	 * literal, or the whole text of an array or object; empty for invalid values */
+	std::string_view Raw() const;
+
+	/*! \brief Text of a value as \a Poco::Dynamic::Var::convert<std::string> gives it:
+	 * a string with its escape sequences resolved, or a number or literal as written
+	 *
+	 * @return \a false for invalid values, null, arrays and objects
+	 */
+	bool Get(std::string &out) const;
+
+	/*! \brief Integer of a number or of a string holding one (no fraction, no exponent, no overflow) */
+	bool Get(int64_t &out) const;
+
+	/*! \brief Floating-point value of a number or of a string holding one */
+	bool Get(double &out) const;
+
+	/*! \brief Value of a literal \a true or \a false */
+	bool Get(bool &out) const;
+
+	/*! \brief String of a value (see \a Get), or an empty string */
+	std::string String() const
+	{
+		std::string result;
+		Get(result);
+		return result;
+	}
+
+	/*! \brief Integer of a value (see \a Get), or 0 */
+	int64_t Int64() const
+	{
+		int64_t result { 0 };
+		return Get(result) ? result : 0;
+	}
+
+	/*! \brief Floating-point value of a value (see \a Get), or 0 */
+	double Double() const
+	{
+		double result { 0 };
+		return Get(result) ? result : 0;
+	}
+
+private:
+	JsonValue(const char *begin, const char *end, std::string_view name = { });
+
+	/*! \brief Member of an object starting at the opening quote of its name */
+	static JsonValue Member(const char *p, const char *end);
+
+	/*! \brief First element or member of a container */
+	JsonValue First() const;
+
+	/*! \brief Next element or member of the same container, or an invalid value after the last one */
+	JsonValue Next() const;
+
+	/*! \brief Name of a member as in the document (the value was obtained by iterating an object) */
+	std::string_view Name() const { return m_name; }
+
+	/*! \brief Compares a member name holding escape sequences */
+	static bool NameEquals(std::string_view raw, std::string_view name);
+
+	/*! \brief End of the value (one past its last character), or \a nullptr if the value is malformed */
+	const char *Skip() const;
+
+	const char *m_begin { nullptr }; //!< First character of the value
+	const char *m_end { nullptr }; //!< End of the document
+	std::string_view m_name; //!< Name of the member, without the quotes (members of an object only)
+	Type m_type { Type::Invalid };
+	bool m_nameEscaped { false }; //!< Does the name hold escape sequences?
+};
+
+/*! \brief Resolves the escape sequences of the text of a JSON string
+ *
+ * @return \a false if an escape sequence is malformed
+ */
+bool JsonUnescape(std::string_view raw, std::string &out);
+
+} // namespace UTILS
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <chrono>
 #include <cmath>
 #include <fstream>
 #include <memory>
@@ -78,7 +79,10 @@ std::string QtyToString(const CurrencyPair& cp, int64_t qty);
 int64_t StringToQty(const CurrencyPair& cp, const std::string &str);
 
 /*! current timestamp in nanoseconds */
-inline int64_t CurrentTimestamp() { return 0; }
+inline int64_t CurrentTimestamp()
+{
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+}
 
 std::string NanosecondsToString(int64_t ns);
 
@@ -0,0 +1,33 @@
+#include "Utils/Arena.h"
+
+namespace UTILS
+{
+
+//------------------------------------------------------------------------------
+Arena::~Arena()
+{
+	while (m_blocks)
+	{
+		Block *const next { m_blocks->next };
+		::operator delete(m_blocks);
+		m_blocks = next;
+	}
+}
+
+
+//------------------------------------------------------------------------------
+void *Arena::AllocateBlock(size_t bytes, size_t align)
+{
+	// the block's bytes follow its header, aligned to the allocation
+	const size_t size { sizeof(Block) + align - 1 + (bytes > m_blockSize ? bytes : m_blockSize) };
+	Block *const block { static_cast<Block *>(::operator new(size)) };
+	block->next = m_blocks;
+	m_blocks = block;
+	++m_blockCount;
+	m_last = Align(reinterpret_cast<char *>(block + 1), align);
+	m_current = m_last + bytes;
+	m_end = reinterpret_cast<char *>(block) + size;
+	return m_last;
+}
+
+} // namespace UTILS
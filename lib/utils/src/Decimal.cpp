@@ -0,0 +1,203 @@
+#include <cstring>
+#include <limits>
+
+#include "Utils/Decimal.h"
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+#define DECIMAL_SWAR 1
+#endif
+
+namespace UTILS
+{
+
+namespace {
+
+constexpr uint64_t POW10[20] { 1ull, 10ull, 100ull, 1000ull, 10000ull, 100000ull, 1000000ull, 10000000ull, 100000000ull,
+							   1000000000ull, 10000000000ull, 100000000000ull, 1000000000000ull, 10000000000000ull,
+							   100000000000000ull, 1000000000000000ull, 10000000000000000ull, 100000000000000000ull,
+							   1000000000000000000ull, 10000000000000000000ull };
+
+/*! \brief Largest number of digits that always fits into an uint64_t */
+constexpr int64_t MAX_DIGITS = 19;
+
+inline bool IsDigit(char c)
+{
+	return unsigned(c - '0') < 10u;
+}
+
+#ifdef DECIMAL_SWAR
+inline uint64_t Load8(const char *p)
+{
+	uint64_t v;
+	std::memcpy(&v, p, sizeof(v));
+	return v;
+}
+
+/*! \brief Are the eight characters (first one in the low byte) all digits? */
+inline bool EightDigits(uint64_t v)
+{
+	return ((v & 0xF0F0F0F0F0F0F0F0ull) | (((v + 0x0606060606060606ull) & 0xF0F0F0F0F0F0F0F0ull) >> 4)) == 0x3333333333333333ull;
+}
+
+/*! \brief Value of eight digits: digits, then pairs, then quadruples are combined in three multiplications */
+inline uint64_t EightDigitsValue(uint64_t v)
+{
+	v -= 0x3030303030303030ull;
+	v = v * 10 + (v >> 8);
+	return (((v & 0x000000FF000000FFull) * (100 + (1000000ull << 32)))
+			+ (((v >> 16) & 0x000000FF000000FFull) * (1 + (10000ull << 32)))) >> 32;
+}
+#endif
+
+/*! \brief End of the run of digits starting at \a p */
+inline const char *SkipDigits(const char *p, const char *end)
+{
+#ifdef DECIMAL_SWAR
+	while (end - p >= 8 && EightDigits(Load8(p)))
+	{
+		p += 8;
+	}
+#endif
+	while (p < end && IsDigit(*p))
+	{
+		++p;
+	}
+	return p;
+}
+
+/*! \brief Appends \a n digits to \a value (the caller makes sure the result has at most MAX_DIGITS digits) */
+inline uint64_t Accumulate(uint64_t value, const char *p, int64_t n)
+{
+#ifdef DECIMAL_SWAR
+	for (; n >= 8; p += 8, n -= 8)
+	{
+		value = value * POW10[8] + EightDigitsValue(Load8(p));
+	}
+#endif
+	for (; n > 0; ++p, --n)
+	{
+		value = value * 10 + uint64_t(*p - '0');
+	}
+	return value;
+}
+
+} // namespace
+
+//------------------------------------------------------------------------------
+bool ParseDecimal(std::string_view text, int decimals, int64_t &out)
+{
+	if (decimals < 0 || decimals > MAX_DECIMALS)
+	{
+		return false;
+	}
+	const char *p { text.data() };
+	const char *const end { p + text.size() };
+	bool negative { false };
+	if (p < end && (*p == '-' || *p == '+'))
+	{
+		negative = *p++ == '-';
+	}
+	const char *intBegin { p };
+	const char *const intEnd { SkipDigits(p, end) };
+	const char *fracBegin { intEnd };
+	const char *fracEnd { intEnd };
+	if (intEnd < end && *intEnd == '.')
+	{
+		fracBegin = intEnd + 1;
+		fracEnd = SkipDigits(fracBegin, end);
+	}
+	if (intBegin == intEnd && fracBegin == fracEnd)
+	{
+		return false; // no digits
+	}
+	p = fracEnd;
+	int64_t exponent { 0 };
+	if (p < end && (*p == 'e' || *p == 'E'))
+	{
+		++p;
+		bool negativeExponent { false };
+		if (p < end && (*p == '-' || *p == '+'))
+		{
+			negativeExponent = *p++ == '-';
+		}
+		const char *const exponentBegin { p };
+		for (; p < end && IsDigit(*p); ++p)
+		{
+			exponent = exponent < 100000 ? exponent * 10 + (*p - '0') : exponent; // far beyond any result
+		}
+		if (p == exponentBegin)
+		{
+			return false;
+		}
+		exponent = negativeExponent ? -exponent : exponent;
+	}
+	if (p != end)
+	{
+		return false;
+	}
+
+	// The number's digits are those of the integer part followed by those of the fraction, without
+	// leading zeros; the result is made of the first `point` of them, padded with zeros, and rounded
+	// by the digit after them.
+	while (intBegin < intEnd && *intBegin == '0')
+	{
+		++intBegin;
+	}
+	const int64_t intLen { intEnd - intBegin };
+	int64_t point { intLen + exponent + decimals };
+	if (intLen == 0)
+	{
+		for (; fracBegin < fracEnd && *fracBegin == '0'; ++fracBegin)
+		{
+			--point;
+		}
+	}
+	const int64_t fracLen { fracEnd - fracBegin };
+	if (intLen + fracLen == 0)
+	{
+		out = 0;
+		return true;
+	}
+	if (point > MAX_DIGITS)
+	{
+		return false; // at least 10^19
+	}
+	uint64_t value { 0 };
+	char roundingDigit { '0' };
+	if (point >= 0)
+	{
+		const int64_t fromInt { point < intLen ? point : intLen };
+		const int64_t fromFrac { point - fromInt < fracLen ? point - fromInt : fracLen };
+		value = Accumulate(Accumulate(0, intBegin, fromInt), fracBegin, fromFrac) * POW10[point - fromInt - fromFrac];
+		if (point < intLen)
+		{
+			roundingDigit = intBegin[point];
+		}
+		else if (point - intLen < fracLen)
+		{
+			roundingDigit = fracBegin[point - intLen];
+		}
+	}
+	value += roundingDigit >= '5' ? 1 : 0;
+	if (value > uint64_t(std::numeric_limits<int64_t>::max()))
+	{
+		return false;
+	}
+	out = negative ? -int64_t(value) : int64_t(value);
+	return true;
+}
+
+//------------------------------------------------------------------------------
+int FactorDecimals(int64_t factor)
+{
+	for (int decimals { 0 }; decimals <= MAX_DIGITS - 1; ++decimals)
+	{
+		if (uint64_t(factor) == POW10[decimals])
+		{
+			return decimals;
+		}
+	}
+	return -1;
+}
+
+} // namespace UTILS
@@ -0,0 +1,93 @@
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "Utils/FrameSlabPool.h"
+
+namespace UTILS
+{
+
+//------------------------------------------------------------------------------
+void FrameSlabPool::Releaser::operator()(FrameSlab *slab) const
+{
+	// the slab's reference keeps the pool alive until the slab is back on the stack
+	const std::shared_ptr<FrameSlabPool> pool { std::move(slab->m_pool) };
+	pool->Release(slab);
+}
+
+
+//------------------------------------------------------------------------------
+std::shared_ptr<FrameSlabPool> FrameSlabPool::Create(size_t slabCount, size_t slabCapacity)
+{
+	return std::shared_ptr<FrameSlabPool>(new FrameSlabPool(slabCount, slabCapacity));
+}
+
+
+//------------------------------------------------------------------------------
+FrameSlabPool::FrameSlabPool(size_t slabCount, size_t slabCapacity)
+		: m_slabCapacity(slabCapacity)
+{
+	const size_t page { size_t(::sysconf(_SC_PAGESIZE)) };
+	const size_t stride { (FrameSlab::HEADER_SIZE + slabCapacity + page - 1) / page * page };
+	void *memory { slabCount ? ::mmap(nullptr, stride * slabCount, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0)
+							 : MAP_FAILED };
+	if (memory == MAP_FAILED)
+	{
+		return; // no slabs: every Acquire misses
+	}
+	m_memory = static_cast<char *>(memory);
+	m_mappedSize = stride * slabCount;
+	m_slabs.resize(slabCount);
+	m_free.reserve(slabCount);
+	for (size_t i { slabCount }; i-- > 0;)
+	{
+		FrameSlab &slab { m_slabs[i] };
+		slab.m_header = m_memory + i * stride;
+		slab.m_data = slab.m_header + FrameSlab::HEADER_SIZE;
+		slab.m_capacity = slabCapacity;
+		m_free.push_back(&slab); // slab 0 on top
+	}
+}
+
+
+//------------------------------------------------------------------------------
+FrameSlabPool::~FrameSlabPool()
+{
+	if (m_memory)
+	{
+		::munmap(m_memory, m_mappedSize);
+	}
+}
+
+
+//------------------------------------------------------------------------------
+FrameSlabPool::SlabPtr FrameSlabPool::Acquire()
+{
+	FrameSlab *slab { nullptr };
+	{
+		std::lock_guard lock { m_mtx };
+		if (!m_free.empty())
+		{
+			slab = m_free.back();
+			m_free.pop_back();
+		}
+	}
+	if (!slab)
+	{
+		m_misses.fetch_add(1, std::memory_order_relaxed);
+		return nullptr;
+	}
+	slab->m_pool = shared_from_this();
+	slab->m_size = 0;
+	slab->m_headerUsed = false;
+	return SlabPtr(slab);
+}
+
+
+//------------------------------------------------------------------------------
+void FrameSlabPool::Release(FrameSlab *slab)
+{
+	std::lock_guard lock { m_mtx };
+	m_free.push_back(slab);
+}
+
+} // namespace UTILS
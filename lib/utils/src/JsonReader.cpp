@@ -0,0 +1,544 @@
+#include <charconv>
+
+#include "Utils/JsonReader.h"
+
+#if defined(__SSE2__) && (defined(__GNUC__) || defined(__clang__))
+#define JSONREADER_SSE2 1
+#include <emmintrin.h>
+#endif
+
+namespace UTILS
+{
+
+namespace
+{
+
+inline bool IsWhitespace(char c)
+{
+	return c == ' ' || c == '\n' || c == '\r' || c == '\t';
+}
+
+inline const char *SkipWhitespace(const char *p, const char *end)
+{
+	while (p < end && IsWhitespace(*p))
+	{
+		++p;
+	}
+	return p;
+}
+
+/*! \brief First quote or backslash at or after \a p, or \a end */
+inline const char *FindQuoteOrBackslash(const char *p, const char *end)
+{
+#ifdef JSONREADER_SSE2
+	const __m128i quote { _mm_set1_epi8('"') };
+	const __m128i backslash { _mm_set1_epi8('\\') };
+	for (; p + 16 <= end; p += 16)
+	{
+		const __m128i block { _mm_loadu_si128(reinterpret_cast<const __m128i *>(p)) };
+		const int mask { _mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(block, quote), _mm_cmpeq_epi8(block, backslash))) };
+		if (mask != 0)
+		{
+			return p + __builtin_ctz(unsigned(mask));
+		}
+	}
+#endif
+	while (p < end && *p != '"' && *p != '\\')
+	{
+		++p;
+	}
+	return p;
+}
+
+/*! \brief First quote or bracket at or after \a p, or \a end */
+inline const char *FindQuoteOrBracket(const char *p, const char *end)
+{
+#ifdef JSONREADER_SSE2
+	const __m128i quote { _mm_set1_epi8('"') };
+	const __m128i openSquare { _mm_set1_epi8('[') };
+	const __m128i closeSquare { _mm_set1_epi8(']') };
+	const __m128i openCurly { _mm_set1_epi8('{') };
+	const __m128i closeCurly { _mm_set1_epi8('}') };
+	for (; p + 16 <= end; p += 16)
+	{
+		const __m128i block { _mm_loadu_si128(reinterpret_cast<const __m128i *>(p)) };
+		const __m128i square { _mm_or_si128(_mm_cmpeq_epi8(block, openSquare), _mm_cmpeq_epi8(block, closeSquare)) };
+		const __m128i curly { _mm_or_si128(_mm_cmpeq_epi8(block, openCurly), _mm_cmpeq_epi8(block, closeCurly)) };
+		const __m128i match { _mm_or_si128(_mm_cmpeq_epi8(block, quote), _mm_or_si128(square, curly)) };
+		const int mask { _mm_movemask_epi8(match) };
+		if (mask != 0)
+		{
+			return p + __builtin_ctz(unsigned(mask));
+		}
+	}
+#endif
+	while (p < end && *p != '"' && *p != '[' && *p != ']' && *p != '{' && *p != '}')
+	{
+		++p;
+	}
+	return p;
+}
+
+/*! \brief End of a string starting at its opening quote (one past the closing quote), or \a nullptr
+ *
+ * @param escaped Set if the string holds escape sequences (optional)
+ */
+const char *SkipString(const char *p, const char *end, bool *escaped = nullptr)
+{
+	++p;
+	for (;;)
+	{
+		const char *q { FindQuoteOrBackslash(p, end) };
+		if (q == end)
+		{
+			return nullptr;
+		}
+		if (*q == '"')
+		{
+			return q + 1;
+		}
+		if (escaped)
+		{
+			*escaped = true;
+		}
+		p = q + 2; // escaped character
+		if (p > end)
+		{
+			return nullptr;
+		}
+	}
+}
+
+/*! \brief End of an array or object starting at its opening bracket, or \a nullptr */
+const char *SkipContainer(const char *p, const char *end)
+{
+	int depth { 0 };
+	for (;;)
+	{
+		const char *q { FindQuoteOrBracket(p, end) };
+		if (q == end)
+		{
+			return nullptr;
+		}
+		if (*q == '"')
+		{
+			p = SkipString(q, end);
+			if (!p)
+			{
+				return nullptr;
+			}
+		}
+		else if (*q == '[' || *q == '{')
+		{
+			++depth;
+			p = q + 1;
+		}
+		else if (--depth == 0)
+		{
+			return q + 1;
+		}
+		else
+		{
+			p = q + 1;
+		}
+	}
+}
+
+/*! \brief Characters ending a number or literal */
+struct ScalarDelimiters
+{
+	bool table[256] { };
+
+	constexpr ScalarDelimiters()
+	{
+		for (unsigned char c: { ',', '}', ']', ' ', '\n', '\r', '\t' })
+		{
+			table[c] = true;
+		}
+	}
+};
+
+constexpr ScalarDelimiters s_scalarDelimiters;
+
+/*! \brief End of a number or literal */
+const char *SkipScalar(const char *p, const char *end)
+{
+	while (p < end && !s_scalarDelimiters.table[static_cast<unsigned char>(*p)])
+	{
+		++p;
+	}
+	return p;
+}
+
+
+void AppendUtf8(std::string &out, uint32_t cp)
+{
+	if (cp < 0x80)
+	{
+		out += char(cp);
+	}
+	else if (cp < 0x800)
+	{
+		out += char(0xc0 | (cp >> 6));
+		out += char(0x80 | (cp & 0x3f));
+	}
+	else if (cp < 0x10000)
+	{
+		out += char(0xe0 | (cp >> 12));
+		out += char(0x80 | ((cp >> 6) & 0x3f));
+		out += char(0x80 | (cp & 0x3f));
+	}
+	else
+	{
+		out += char(0xf0 | (cp >> 18));
+		out += char(0x80 | ((cp >> 12) & 0x3f));
+		out += char(0x80 | ((cp >> 6) & 0x3f));
+		out += char(0x80 | (cp & 0x3f));
+	}
+}
+
+bool ParseHex4(std::string_view raw, size_t pos, uint32_t &out)
+{
+	if (pos + 4 > raw.size())
+	{
+		return false;
+	}
+	const auto result { std::from_chars(raw.data() + pos, raw.data() + pos + 4, out, 16) };
+	return result.ec == std::errc() && result.ptr == raw.data() + pos + 4;
+}
+
+/*! \brief End of the value starting at \a p, or \a nullptr */
+inline const char *SkipValue(const char *p, const char *end)
+{
+	switch (*p)
+	{
+		case '"':
+			return SkipString(p, end);
+		case '{':
+		case '[':
+			return SkipContainer(p, end);
+		default:
+			return SkipScalar(p, end);
+	}
+}
+
+} // namespace
+
+JsonValue::JsonValue(const char *begin, const char *end, std::string_view name)
+		: m_begin(SkipWhitespace(begin, end)), m_end(end), m_name(name)
+{
+	if (m_begin >= m_end)
+	{
+		return;
+	}
+	switch (*m_begin)
+	{
+		case '{':
+			m_type = Type::Object;
+			break;
+		case '[':
+			m_type = Type::Array;
+			break;
+		case '"':
+			m_type = Type::String;
+			break;
+		case 't':
+		case 'f':
+			m_type = Type::Bool;
+			break;
+		case 'n':
+			m_type = Type::Null;
+			break;
+		default:
+			m_type = *m_begin == '-' || (*m_begin >= '0' && *m_begin <= '9') ? Type::Number : Type::Invalid;
+			break;
+	}
+}
+
+JsonValue JsonValue::Parse(std::string_view document)
+{
+	return { document.data(), document.data() + document.size() };
+}
+
+JsonValue JsonValue::Member(const char *p, const char *end)
+{
+	if (p >= end || *p != '"')
+	{
+		return { };
+	}
+	bool escaped { false };
+	const char *nameEnd { SkipString(p, end, &escaped) };
+	if (!nameEnd)
+	{
+		return { };
+	}
+	const char *colon { SkipWhitespace(nameEnd, end) };
+	if (colon >= end || *colon != ':')
+	{
+		return { };
+	}
+	JsonValue member { colon + 1, end, std::string_view(p + 1, size_t(nameEnd - 1 - (p + 1))) };
+	member.m_nameEscaped = escaped;
+	return member;
+}
+
+const char *JsonValue::Skip() const
+{
+	switch (m_type)
+	{
+		case Type::Object:
+		case Type::Array:
+			return SkipContainer(m_begin, m_end);
+		case Type::String:
+			return SkipString(m_begin, m_end);
+		case Type::Invalid:
+			return nullptr;
+		default:
+			return SkipScalar(m_begin, m_end);
+	}
+}
+
+JsonValue JsonValue::First() const
+{
+	const char *p { SkipWhitespace(m_begin + 1, m_end) };
+	if (p >= m_end || *p == (m_type == Type::Array ? ']' : '}'))
+	{
+		return { };
+	}
+	return m_type == Type::Array ? JsonValue(p, m_end) : Member(p, m_end);
+}
+
+JsonValue JsonValue::Next() const
+{
+	const char *p { Skip() };
+	if (!p)
+	{
+		return { };
+	}
+	p = SkipWhitespace(p, m_end);
+	if (p >= m_end || *p != ',')
+	{
+		return { }; // end of the container (or malformed)
+	}
+	p = SkipWhitespace(p + 1, m_end);
+	return m_name.data() ? Member(p, m_end) : JsonValue(p, m_end);
+}
+
+JsonValue JsonValue::operator[](std::string_view name) const
+{
+	if (m_type != Type::Object)
+	{
+		return { };
+	}
+	// one pass over the members, without creating a value for the members skipped
+	const char *p { SkipWhitespace(m_begin + 1, m_end) };
+	while (p < m_end && *p == '"')
+	{
+		bool escaped { false };
+		const char *nameEnd { SkipString(p, m_end, &escaped) };
+		const char *colon { nameEnd ? SkipWhitespace(nameEnd, m_end) : m_end };
+		if (colon >= m_end || *colon != ':')
+		{
+			break;
+		}
+		const std::string_view memberName { p + 1, size_t(nameEnd - 1 - (p + 1)) };
+		const char *value { SkipWhitespace(colon + 1, m_end) };
+		if (value >= m_end)
+		{
+			break;
+		}
+		if (escaped ? NameEquals(memberName, name) : memberName == name)
+		{
+			JsonValue member { value, m_end, memberName };
+			member.m_nameEscaped = escaped;
+			return member;
+		}
+		const char *valueEnd { SkipValue(value, m_end) };
+		p = valueEnd ? SkipWhitespace(valueEnd, m_end) : m_end;
+		if (p >= m_end || *p != ',')
+		{
+			break;
+		}
+		p = SkipWhitespace(p + 1, m_end);
+	}
+	return { };
+}
+
+bool JsonValue::NameEquals(std::string_view raw, std::string_view name)
+{
+	std::string unescaped;
+	return JsonUnescape(raw, unescaped) && unescaped == name;
+}
+
+JsonValue JsonValue::At(size_t index) const
+{
+	if (m_type == Type::Array)
+	{
+		for (JsonValue element { First() }; element.Valid(); element = element.Next())
+		{
+			if (index-- == 0)
+			{
+				return element;
+			}
+		}
+	}
+	return { };
+}
+
+size_t JsonValue::Size() const
+{
+	size_t result { 0 };
+	if (m_type == Type::Array || m_type == Type::Object)
+	{
+		for (JsonValue child { First() }; child.Valid(); child = child.Next())
+		{
+			++result;
+		}
+	}
+	return result;
+}
+
+std::string_view JsonValue::Raw() const
+{
+	const char *end { Skip() };
+	if (!end)
+	{
+		return { };
+	}
+	if (m_type == Type::String)
+	{
+		return { m_begin + 1, size_t(end - 1 - (m_begin + 1)) };
+	}
+	return { m_begin, size_t(end - m_begin) };
+}
+
+bool JsonValue::Get(std::string &out) const
+{
+	switch (m_type)
+	{
+		case Type::String:
+		{
+			const std::string_view raw { Raw() };
+			if (raw.find('\\') == std::string_view::npos)
+			{
+				out.assign(raw.data(), raw.size());
+				return Skip() != nullptr;
+			}
+			out.clear();
+			return JsonUnescape(raw, out);
+		}
+		case Type::Number:
+		case Type::Bool:
+		{
+			const std::string_view raw { Raw() };
+			out.assign(raw.data(), raw.size());
+			return true;
+		}
+		default:
+			return false;
+	}
+}
+
+bool JsonValue::Get(int64_t &out) const
+{
+	if (m_type != Type::Number && m_type != Type::String)
+	{
+		return false;
+	}
+	const std::string_view raw { Raw() };
+	const auto result { std::from_chars(raw.data(), raw.data() + raw.size(), out) };
+	return !raw.empty() && result.ec == std::errc() && result.ptr == raw.data() + raw.size();
+}
+
+bool JsonValue::Get(double &out) const
+{
+	if (m_type != Type::Number && m_type != Type::String)
+	{
+		return false;
+	}
+	const std::string_view raw { Raw() };
+	const auto result { std::from_chars(raw.data(), raw.data() + raw.size(), out) };
+	return !raw.empty() && result.ec == std::errc() && result.ptr == raw.data() + raw.size();
+}
+
+bool JsonValue::Get(bool &out) const
+{
+	if (m_type != Type::Bool)
+	{
+		return false;
+	}
+	const std::string_view raw { Raw() };
+	if (raw == "true" || raw == "false")
+	{
+		out = raw == "true";
+		return true;
+	}
+	return false;
+}
+
+bool JsonUnescape(std::string_view raw, std::string &out)
+{
+	out.reserve(out.size() + raw.size());
+	for (size_t i { 0 }; i < raw.size(); ++i)
+	{
+		if (raw[i] != '\\')
+		{
+			out += raw[i];
+			continue;
+		}
+		if (++i == raw.size())
+		{
+			return false;
+		}
+		switch (raw[i])
+		{
+			case '"':
+			case '\\':
+			case '/':
+				out += raw[i];
+				break;
+			case 'b':
+				out += '\b';
+				break;
+			case 'f':
+				out += '\f';
+				break;
+			case 'n':
+				out += '\n';
+				break;
+			case 'r':
+				out += '\r';
+				break;
+			case 't':
+				out += '\t';
+				break;
+			case 'u':
+			{
+				uint32_t cp { 0 };
+				if (!ParseHex4(raw, i + 1, cp))
+				{
+					return false;
+				}
+				i += 4;
+				if (cp >= 0xd800 && cp < 0xdc00) // high surrogate, a low one must follow
+				{
+					uint32_t low { 0 };
+					if (i + 2 >= raw.size() || raw[i + 1] != '\\' || raw[i + 2] != 'u' || !ParseHex4(raw, i + 3, low)
+						|| low < 0xdc00 || low >= 0xe000)
+					{
+						return false;
+					}
+					i += 6;
+					cp = 0x10000 + ((cp - 0xd800) << 10) + (low - 0xdc00);
+				}
+				AppendUtf8(out, cp);
+				break;
+			}
+			default:
+				return false;
+		}
+	}
+	return true;
+}
+
+} // namespace UTILS
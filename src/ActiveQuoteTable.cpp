@@ -10,8 +10,8 @@ namespace CORE {
 //static
 size_t ActiveQuoteTable::CalculateHashValue(const UTILS::BookUpdate::Entry &entry)
 {
-	std::hash<double> dblHash;
-	size_t result { dblHash(entry.volume) ^ dblHash(entry.price) ^ dblHash(entry.minQty) };
+	std::hash<int64_t> intHash;
+	size_t result { intHash(entry.volume) ^ intHash(entry.price) ^ intHash(entry.minQty) };
 	if (!entry.quoteId.empty()) // if quote ID is set -> include in hash value
 	{
 		std::hash<std::string> strHash;
@@ -23,65 +23,138 @@ size_t ActiveQuoteTable::CalculateHashValue(const UTILS::BookUpdate::Entry &entr
 
 bool ActiveQuoteTable::Empty() const
 {
-	std::shared_lock lock { m_activeQuoteMap.Mutex() };
-	return m_activeQuoteMap->empty();
+	for (const Shard &shard: m_shards)
+	{
+		std::lock_guard lock { shard.mtx };
+		if (!shard.quotes.Empty())
+		{
+			return false;
+		}
+	}
+	return true;
 }
 
 
-bool ActiveQuoteTable::FindQuoteInfo(const std::string &refId, QuoteInfo &quoteInfo)
+//static
+uint64_t ActiveQuoteTable::FindKey(const Shard &shard, UTILS::CurrencyPair cp, UTILS::QuoteType side, int64_t price)
 {
-	bool result { false };
-	std::shared_lock lock { m_activeQuoteMap.Mutex() };
-	if (!refId.empty())
+	if (!CanIdentify(cp, side, price))
 	{
-		const auto &it { m_activeQuoteMap->find(refId) };
-		if (it != m_activeQuoteMap->end())
-		{
-			quoteInfo = *it->second;
-			result = true;
-		}
+		return NO_KEY;
 	}
-	return result;
+	const uint64_t *index { shard.instruments.Find(InstrumentId(cp)) };
+	if (!index)
+	{
+		return NO_KEY;
+	}
+	return (*index << (PRICE_BITS + 1)) | (uint64_t(side.Offer()) << PRICE_BITS) | uint64_t(price);
 }
 
 
-ActiveQuoteTable::QuoteInfoPtr ActiveQuoteTable::ReplaceQuoteInfoAt(QuoteMap::iterator it, const std::string &newId, QuoteInfoPtr &&newQuote)
+//static
+uint64_t ActiveQuoteTable::AddKey(Shard &shard, UTILS::CurrencyPair cp, UTILS::QuoteType side, int64_t price)
 {
-	ActiveQuoteTable::QuoteInfoPtr lastQuote { nullptr };
-	if (it != m_activeQuoteMap->end())
+	if (!CanIdentify(cp, side, price))
+	{
+		return NO_KEY;
+	}
+	if (!shard.instruments.Find(InstrumentId(cp)))
 	{
-		lastQuote = std::move(it->second); // save replaced entry
-		it->second = std::move(newQuote); // replace quote info
-		if (newId != it->first) // new ID -> replace map key:
+		if (shard.instruments.Size() >> INSTRUMENT_BITS)
 		{
-			auto nh { m_activeQuoteMap->extract(it) };
-			nh.key() = newId;
-			m_activeQuoteMap->insert(move(nh));
+			return NO_KEY; // more instruments than the keys can tell apart
 		}
+		shard.instruments.Insert(InstrumentId(cp), shard.instruments.Size());
 	}
-	else // Ref ID not found -> create new entry
+	return FindKey(shard, cp, side, price);
+}
+
+
+bool ActiveQuoteTable::FindQuoteInfo(UTILS::CurrencyPair cp, UTILS::QuoteType side, int64_t price, QuoteInfo &quoteInfo) const
+{
+	const Shard &shard { ShardOf(cp) };
+	std::lock_guard lock { shard.mtx };
+	const uint64_t quoteKey { FindKey(shard, cp, side, price) };
+	const QuoteInfo *found { quoteKey == NO_KEY ? nullptr : shard.quotes.Find(quoteKey) };
+	if (found)
 	{
-		m_activeQuoteMap->emplace(newId, std::move(newQuote));
+		quoteInfo = *found;
 	}
-	return lastQuote;
+	return found != nullptr;
 }
 
 
-ActiveQuoteTable::QuoteInfoPtr ActiveQuoteTable::RemoveQuoteInfo(const std::string &refId)
+bool ActiveQuoteTable::ReplaceQuoteInfo(UTILS::CurrencyPair cp, UTILS::QuoteType side, int64_t price, QuoteInfo quoteInfo, QuoteInfo *replaced)
 {
-	QuoteInfoPtr lastQuote { nullptr };
+	quoteInfo.oriKey = quoteInfo.key; // new quote -> oriKey = key
+	Shard &shard { ShardOf(cp) };
+	std::lock_guard lock { shard.mtx };
+	const uint64_t quoteKey { AddKey(shard, cp, side, price) };
+	if (quoteKey == NO_KEY)
+	{
+		return false;
+	}
+	QuoteInfo *found { shard.quotes.Find(quoteKey) };
+	if (!found)
+	{
+		shard.quotes.Insert(quoteKey, quoteInfo);
+		return false;
+	}
+	if (replaced)
+	{
+		*replaced = *found;
+	}
+	*found = quoteInfo;
+	return true;
+}
+
 
-	std::unique_lock lock { m_activeQuoteMap.Mutex() };
-	if (!refId.empty())
+std::pair<bool, bool> ActiveQuoteTable::ReplaceQuoteInfo(bool forceKey, UTILS::CurrencyPair cp, UTILS::QuoteType side, int64_t price,
+														 QuoteInfo quoteInfo, QuoteInfo *replaced)
+{
+	Shard &shard { ShardOf(cp) };
+	std::lock_guard lock { shard.mtx };
+	const uint64_t quoteKey { AddKey(shard, cp, side, price) };
+	if (quoteKey == NO_KEY)
+	{
+		return { false, false };
+	}
+	QuoteInfo *found { shard.quotes.Find(quoteKey) };
+	const bool skipKey { !forceKey && found && found->hashValue == quoteInfo.hashValue };
+	quoteInfo.oriKey = skipKey ? found->oriKey : quoteInfo.key;
+	if (!found)
+	{
+		shard.quotes.Insert(quoteKey, quoteInfo);
+		return { false, skipKey };
+	}
+	if (replaced)
 	{
-		const auto &it { m_activeQuoteMap->find(refId) };
-		if (it != m_activeQuoteMap->end())
+		*replaced = *found;
+	}
+	*found = quoteInfo;
+	return { true, skipKey };
+}
+
+
+bool ActiveQuoteTable::RemoveQuoteInfo(UTILS::CurrencyPair cp, UTILS::QuoteType side, int64_t price, QuoteInfo *removed)
+{
+	Shard &shard { ShardOf(cp) };
+	std::lock_guard lock { shard.mtx };
+	const uint64_t quoteKey { FindKey(shard, cp, side, price) };
+	if (quoteKey == NO_KEY)
+	{
+		return false;
+	}
+	if (removed)
+	{
+		const QuoteInfo *found { shard.quotes.Find(quoteKey) };
+		if (!found)
 		{
-			lastQuote = std::move(it->second);
-			m_activeQuoteMap->erase(it);
+			return false;
 		}
+		*removed = *found;
 	}
-	return lastQuote;
+	return shard.quotes.Erase(quoteKey);
 }
 
-}
\ No newline at end of file
+}
@@ -43,7 +43,17 @@ BoolResult ConnectionBase::Connect()
 			return false;
 		}
 		
-		m_messageProcessor.Start();
+		// the buffers are allocated for the sessions receiving frames only, untouched pages cost no memory
+		if (!m_buffer)
+		{
+			m_buffer.reset(new char[MAX_BUFF]);
+		}
+		if (!m_framePool && GetFrameSlabs() > 0)
+		{
+			m_framePool = UTILS::FrameSlabPool::Create(GetFrameSlabs(), GetFrameSlabSize());
+		}
+		
+		m_messageProcessor.Start(GetWorkerThreads());
 		m_connected = true;
 		
 		// Start listener thread..
@@ -54,10 +64,12 @@ BoolResult ConnectionBase::Connect()
 															 {
 																 try
 																 {
-																	 memset(m_buffer, 0, sizeof(m_buffer));
+																	 // Receive into a free slab, or into the own buffer if all slabs are being handled
+																	 auto slab = m_framePool ? m_framePool->Acquire() : nullptr;
+																	 char *buffer = slab ? slab->Data() : m_buffer.get();
 																	 int flags { };
 																	 const auto bytes =
-																			 ReceiveWebSocketData(m_ws.get(), m_buffer, sizeof(m_buffer), flags);
+																			 ReceiveWebSocketData(m_ws.get(), buffer, slab ? slab->Capacity() : MAX_BUFF, flags);
 					
 																	 // Process ping/pong
 																	 using namespace Poco::Net;
@@ -65,7 +77,7 @@ BoolResult ConnectionBase::Connect()
 																	 {
 																		 poco_information(logger(), "received PING");
 																	 	m_ws->sendFrame(
-																			 m_buffer,
+																			 buffer,
 																			 bytes,  // ✅ MUST echo full payload
 																			 WebSocket::FRAME_FLAG_FIN | WebSocket::FRAME_OP_PONG
 																		 );
@@ -92,16 +104,24 @@ BoolResult ConnectionBase::Connect()
 																	 // Processing bytes
 																	 if (bytes)
 																	 {
-																	 	std::string msg(m_buffer, bytes);
-																		 const auto res = GetMessageProcessor().ProcessMessage(
-																				 std::make_shared<CRYPTO::JSONDocument>(msg));
+																	 	std::shared_ptr<CRYPTO::JSONDocument> document;
+																		 if (slab)
+																		 {
+																			 slab->SetSize(size_t(bytes));
+																			 document = CRYPTO::JSONDocument::FromSlab(std::move(slab));
+																		 }
+																		 else
+																		 {
+																			 document = std::make_shared<CRYPTO::JSONDocument>(std::string(m_buffer.get(), bytes));
+																		 }
+																		 const auto res = GetMessageProcessor().ProcessMessage(document);
 																		 if (!res)
 																		 {
 																			 poco_error_f2(logger(), "Message processor error: %s [buffer='%s']",
-																						   res.ErrorMessage(), msg);
+																						   res.ErrorMessage(), std::string(document->Text()));
 																		 }
 																		 
-																		 m_logger.Protocol().Incoming(m_buffer);
+																		 m_logger.Protocol().Incoming(document->Text());
 																	 }
 																	 else
 																	 {
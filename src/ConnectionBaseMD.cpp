@@ -1,13 +1,26 @@
 #include "ConnectionBaseMD.h"
 #include "ConnectionManager.h"
+#include "OrderBook/BookCheckpoint.h"
 #include "Utils/Result.h"
 
 using namespace UTILS;
 
 namespace {
-std::string GenerateStandardEntryId(const UTILS::CurrencyPair &cp, UTILS::QuoteType entryType, const std::string &price)
+std::string VenueOfSchema(const std::string &schema)
 {
-	return UTILS::Format("%s_%c%s", cp.ToString(), entryType.Bid() ? 'B' : 'A', price);
+	return schema.substr(0, schema.find(':'));
+}
+
+CORE::BOOK::InstrumentBook::Mode BookModeOfSettings(const CORE::CRYPTO::Settings &settings)
+{
+	return settings.GetParameter(CORE::CRYPTO::PARAM_ATTR_BookMode, "levels") == "quotes" ? CORE::BOOK::InstrumentBook::Mode::Quotes
+																						   : CORE::BOOK::InstrumentBook::Mode::Levels;
+}
+
+CORE::BOOK::OrderBook::ReadMode ReadModeOfSettings(const CORE::CRYPTO::Settings &settings)
+{
+	return settings.GetParameter(CORE::CRYPTO::PARAM_ATTR_ReadMode, "locking") == "snapshot" ? CORE::BOOK::OrderBook::ReadMode::Snapshot
+																							  : CORE::BOOK::OrderBook::ReadMode::Locking;
 }
 }
 
@@ -16,8 +29,30 @@ namespace CRYPTO {
 
 ConnectionBaseMD::ConnectionBaseMD(const CRYPTO::Settings &settings, const std::string &loggingPropsPath, 
                                    const std::string &loggerName, const ConnectionManager& connectionManager)
-	: ConnectionBase(settings, loggingPropsPath, loggerName, connectionManager)
+	: ConnectionBase(settings, loggingPropsPath, loggerName, connectionManager), m_venue(VenueOfSchema(settings.m_schema)),
+	  m_orderBook(connectionManager.GetOrderBook(m_venue, ReadModeOfSettings(settings))), m_bookMode(BookModeOfSettings(settings))
 {
+	if (!m_orderBook)
+	{
+		throw std::runtime_error(UTILS::Format("Session '%s': No order book for venue '%s' (too many venues)", settings.m_name, m_venue));
+	}
+	const std::string shmRingPath { GetShmRingPath() };
+	if (!shmRingPath.empty())
+	{
+		auto publisher { std::make_unique<ORDERBOOK::ShmPublisher>() };
+		const uint64_t capacity { std::strtoull(GetSettings().GetParameter(PARAM_ATTR_ShmRingCapacity, "65536").c_str(), nullptr, 10) };
+		const uint64_t snapshotInterval { std::strtoull(GetSettings().GetParameter(PARAM_ATTR_ShmSnapshotInterval, "16384").c_str(), nullptr, 10) };
+		const BoolResult result { publisher->Create(shmRingPath, capacity, snapshotInterval) };
+		if (result)
+		{
+			poco_information_f1(logger(), "Books published to ring '%s'", shmRingPath);
+			m_shmPublisher = std::move(publisher);
+		}
+		else
+		{
+			poco_error_f1(logger(), "Books not published: %s", result.ErrorMessage());
+		}
+	}
 }
 
 ConnectionBaseMD::~ConnectionBaseMD()
@@ -28,31 +63,116 @@ ConnectionBaseMD::~ConnectionBaseMD()
 UTILS::BoolResult ConnectionBaseMD::PublishQuote(int64_t key, int64_t refKey, int64_t timestamp,
                                                   int64_t receiveTime, UTILS::CurrencyPair cp, const UTILS::BookUpdate::Entry &entry)
 {
-	m_connectionManager.GetOrderBook()->AddEntry(key, refKey, timestamp, receiveTime, cp, entry);
+	m_orderBook->AddEntry(key, refKey, timestamp, receiveTime, cp, entry);
+	return true;
+}
+
+//------------------------------------------------------------------------------
+UTILS::BoolResult ConnectionBaseMD::PublishQuote(BOOK::InstrumentBook &book, int64_t key, int64_t refKey, int64_t timestamp,
+                                                  int64_t receiveTime, const UTILS::BookUpdate::Entry &entry)
+{
+	m_orderBook->AddEntry(book, key, refKey, timestamp, receiveTime, entry);
 	return true;
 }
 
 //------------------------------------------------------------------------------
-UTILS::BoolResult ConnectionBaseMD::SubscribeInstrument(const std::string &symbol)
+BOOK::InstrumentBook::Ptr ConnectionBaseMD::AddInstrumentBook(UTILS::CurrencyPair cp)
+{
+	if (!cp.Valid())
+	{
+		return nullptr;
+	}
+	std::lock_guard lock { m_instrumentBooksMutex };
+	const auto books { std::atomic_load(&m_instrumentBooks) };
+	const auto it { books->find(cp) };
+	if (it != books->end())
+	{
+		return it->second;
+	}
+	BOOK::InstrumentBook::Ptr book { m_orderBook->AddInstrument(cp) };
+	m_orderBook->SetBookMode(cp, m_bookMode);
+	m_orderBook->SetMaxLevels(cp, GetMaxLevels());
+	m_orderBook->SetSignalDepth(cp, GetSignalDepth());
+	m_orderBook->SetQuoteExpiry(cp, GetMaxQuoteAge(), GetCleanupInterval());
+	if (m_shmPublisher)
+	{
+		m_shmPublisher->Attach(*m_orderBook, cp);
+	}
+	auto newBooks { std::make_shared<InstrumentBookMap>(*books) };
+	newBooks->emplace(cp, book);
+	std::atomic_store(&m_instrumentBooks, std::shared_ptr<const InstrumentBookMap>(std::move(newBooks)));
+	return book;
+}
+
+//------------------------------------------------------------------------------
+BOOK::InstrumentBook::Ptr ConnectionBaseMD::FindInstrumentBook(UTILS::CurrencyPair cp) const
+{
+	const auto books { std::atomic_load(&m_instrumentBooks) };
+	const auto it { books->find(cp) };
+	return it != books->end() ? it->second : nullptr;
+}
+
+//------------------------------------------------------------------------------
+void ConnectionBaseMD::RestoreCheckpoint(const TInstruments &instruments)
+{
+	const std::string path { GetCheckpointPath() };
+	if (path.empty())
+	{
+		return;
+	}
+	if (ReconcilesCheckpoint() && GetBookMode() == BOOK::InstrumentBook::Mode::Levels)
+	{
+		BOOK::BookCheckpoint checkpoint;
+		const BoolResult result { checkpoint.Open(path) };
+		if (result)
+		{
+			int restored { 0 };
+			for (const auto &instrument: instruments)
+			{
+				const CurrencyPair cp { GetCurrencyPair(TranslateSymbol(instrument)) };
+				const BOOK::BookCheckpoint::Instrument *saved { checkpoint.Find(cp) };
+				if (saved && AddInstrumentBook(cp) && checkpoint.Restore(*m_orderBook, cp))
+				{
+					OnCheckpointRestored(cp, saved->updateId);
+					++restored;
+				}
+			}
+			poco_information_f3(logger(), "Restored %d instrument(s) from checkpoint '%s' taken %s ago", restored, path,
+								UTILS::NanosecondsToString(CurrentTimestamp() - checkpoint.Timestamp()));
+		}
+		else
+		{
+			poco_warning_f1(logger(), "No books restored: %s", result.ErrorMessage());
+		}
+	}
+	m_orderBook->SetCheckpoint(path, GetCheckpointInterval());
+}
+
+//------------------------------------------------------------------------------
+UTILS::Result<BOOK::InstrumentBook::Ptr> ConnectionBaseMD::SubscribeInstrument(const std::string &symbol)
 {
 	const auto instStr = UTILS::toupper(symbol);
-	if (UTILS::CurrencyPair(TranslateSymbol(instStr)).Invalid())
+	const UTILS::CurrencyPair cp { TranslateSymbol(instStr) };
+	if (cp.Invalid())
 	{
-		return BoolResult(false, UTILS::Format("Invalid instrument '%s'", instStr));
+		return { setError, "Invalid instrument '%s'", instStr };
 	}
 	
 	const auto existingInstruments = GetInstruments();
 	if (existingInstruments.find(instStr) != existingInstruments.cend())
 	{
-		return BoolResult(false, UTILS::Format("Instrument '%s' has been already subscribed", instStr));
+		return { setError, "Instrument '%s' has been already subscribed", instStr };
 	}
 	
 	// Update config
 	m_settings.m_instruments += (m_settings.m_instruments.empty() ? "" : ",") + instStr;
 	
+	// Allocate the order book shard before the first quote arrives
+	BOOK::InstrumentBook::Ptr book { AddInstrumentBook(cp) };
+	
 	// Request snapshot and subscribe
 	Subscribe({ instStr });
-	return true;
+	return book;
 }
 
 //------------------------------------------------------------------------------
@@ -72,29 +192,34 @@ UTILS::BoolResult ConnectionBaseMD::UnsubscribeInstrument(const std::string &sym
 }
 
 //------------------------------------------------------------------------------
-UTILS::BookUpdate::Ptr ConnectionBaseMD::ParseQuote(CORE::CRYPTO::PriceMessage::Levels &levels, const char side, const std::string &instrument)
+void ConnectionBaseMD::ParseQuote(UTILS::BookUpdate &nmd, const LevelView *levels, size_t levelCount, const char side, UTILS::CurrencyPair cp)
 {
-	BookUpdate::Ptr nmd { std::make_unique<BookUpdate>() };
-	BookUpdate::Entry *entry;
-	
-	nmd->entries.resize(levels.size());
+	const int priceDecimals { cp.CpipDecimals() }; // looked up once per side
+	const int qtyDecimals { cp.QtyDecimals() };
+	const bool bid { QuoteType(side).Bid() };
+	size_t count { nmd.entries.size() };
+	nmd.entries.resize(count + levelCount);
 	BidAskPair<int64_t> currentLevel { 0, 0 };
-	for (size_t i { 0 }; i < levels.size(); ++i)
+	for (size_t i { 0 }; i < levelCount; ++i)
 	{
-		entry = &(nmd->entries[i]);
-		entry->entryType = side;
+		BookUpdate::Entry *entry { &nmd.entries[count] };
 		
-		bool bid { entry->entryType.Bid() };
-
-		entry->instrument = GetCurrencyPair(instrument);
-		entry->price = std::stod(levels[i]->price);
-		entry->volume = std::stod(levels[i]->size);
+		// prices and sizes are converted from the venue's decimal strings to integers exactly
+		if (!ParseDecimal(levels[i].price, priceDecimals, entry->price) || !ParseDecimal(levels[i].size, qtyDecimals, entry->volume))
+		{
+			poco_warning_f3(logger(), "Price level '%s' / '%s' of '%s' is not a valid decimal - ignored",
+							std::string(levels[i].price), std::string(levels[i].size), cp.ToString());
+			continue;
+		}
+		++count;
+		entry->entryType = side;
+		entry->instrument = cp;
 		entry->updateType = (entry->volume == 0) ? QT_DELETE : QT_NEW;
-		entry->refId = entry->id = GenerateStandardEntryId(entry->instrument, entry->entryType, levels[i]->price);
 		entry->quoteId = "";
+		entry->originators = m_venue;
 		entry->positionNo = currentLevel.Get(bid);
 	}
-	return nmd;
+	nmd.entries.resize(count);
 }
 
 //------------------------------------------------------------------------------
@@ -102,83 +227,90 @@ void ConnectionBaseMD::PublishQuotes(UTILS::BookUpdate::Ptr nmd)
 {
 	if (nmd)
 	{
-		int64_t key { 0 }, refKey { 0 };
-		ActiveQuoteTable::QuoteInfoPtr replacedQuoteRef;
-
 		const size_t cnt { nmd->entries.size() };
-		uint64_t sequenceTag { std::hash<std::string>()("") };
+		CurrencyPair messageCp { }; // instrument of all entries, if the message has only one
+		bool singleInstrument { true };
+		// price levels are applied by price, without book keys
+		const bool levels { m_bookMode == BOOK::InstrumentBook::Mode::Levels };
 
+		// resolve the book keys of all entries first, then apply the message to the book in one batch
 		for (size_t i { 0 }; i < cnt; ++i)
 		{
 			BookUpdate::Entry &entry { nmd->entries[i] };
 			entry.endOfMessage = (i == cnt - 1);
-			entry.sequenceTag = sequenceTag;
-			CurrencyPair cp = entry.instrument;
-			if ((!entry.entryType.Valid() || !cp.Valid())) //no entry type with UPDATEs and DELETEs -> lookup entry and guess type
+			entry.key = entry.refKey = 0;
+			const CurrencyPair cp { entry.instrument };
+			if (levels && entry.entryType.Valid() && cp.Valid())
 			{
-				if (!entry.refId.empty())
+				entry.sequenceTag = std::hash<CurrencyPair>()(cp); // entries are sequenced per instrument
+				if (!messageCp.Valid())
 				{
-					ActiveQuoteTable::QuoteInfo quoteInfo;
-					if (m_activeQuoteTable.FindQuoteInfo(entry.refId, quoteInfo))
-					{
-						if (!cp.Valid())
-						{
-							cp = quoteInfo.cp;
-						}
-						if (!entry.entryType.Valid())
-						{
-							entry.entryType = quoteInfo.entryType;
-						}
-					}
-					else
-					{
-						poco_error_f3(logger(), "Session %ld - ERROR: No quote info found for entry '%s'->'%s' -> QUOTE SKIPPED", GetSettings().m_numId, entry.id,
-									  entry.refId);
-						continue;
-					}
-				}
-				else
-				{
-					poco_error_f3(logger(), "Session %ld - ERROR: No entry type and/or symbol and no ref ID in entry '%s'-> '%s' -> QUOTE SKIPPED",
-								  GetSettings().m_numId, entry.id, entry.refId);
-					continue;
+					messageCp = cp;
 				}
+				singleInstrument = singleInstrument && cp == messageCp;
+				m_publishedQuotesCounter++;
+				continue;
 			}
-
-			key = NewInt64Key();
-			if (entry.updateType == QT_DELETE)
+			// quotes are identified by instrument, side and price
+			if (!ActiveQuoteTable::CanIdentify(cp, entry.entryType, entry.price))
 			{
-				replacedQuoteRef = entry.refId.empty() ? nullptr : m_activeQuoteTable.RemoveQuoteInfo(entry.refId);
+				poco_error_f3(logger(), "Session %ld - ERROR: No entry type, symbol or valid price in entry of '%s' at %ld -> QUOTE SKIPPED",
+							  GetSettings().m_numId, cp.ToString(), entry.price);
+				continue;
 			}
-			else
-			{
-				replacedQuoteRef = m_activeQuoteTable.ReplaceQuoteInfo(entry.refId, entry.id, key, cp, entry.entryType);
-			}
-			if (replacedQuoteRef)
+
+			const int64_t key { NewInt64Key() };
+			ActiveQuoteTable::QuoteInfo replacedQuote { };
+			const bool replaced { entry.updateType == QT_DELETE
+								  ? m_activeQuoteTable.RemoveQuoteInfo(cp, entry.entryType, entry.price, &replacedQuote)
+								  : m_activeQuoteTable.ReplaceQuoteInfo(cp, entry.entryType, entry.price, { key, cp, entry.entryType, 0, 0, 0 },
+																		&replacedQuote) };
+			if (replaced)
 			{
 				if (entry.updateType == QT_NEW) // NEW refers to existing quote-> UPDATE
 				{
 					entry.updateType = QT_UPDATE;
 				}
-				refKey = replacedQuoteRef->key;
+				entry.refKey = replacedQuote.key;
 			}
 			else
 			{
 				if (entry.updateType == QT_DELETE)
 				{
-					poco_error_f3(logger(), "%ld - ERROR: DELETE referring to non-existent entry '%s' --> '%s'", GetSettings().m_numId, entry.id, entry.refId);
-					return;
+					poco_error_f3(logger(), "%ld - ERROR: DELETE referring to non-existent level '%s' at %ld", GetSettings().m_numId, cp.ToString(), entry.price);
+					break; // the entries resolved so far are still applied
 				}
 				else if (entry.updateType == QT_UPDATE) // UPDATE -> NEW
 				{
 					entry.updateType = QT_NEW;
 				}
-				refKey = 0;
 			}
 
-			PublishQuote(key, refKey, CurrentTimestamp(), CurrentTimestamp(), cp, entry);
+			entry.key = key;
+			entry.sequenceTag = std::hash<CurrencyPair>()(cp);
+			if (!messageCp.Valid())
+			{
+				messageCp = cp;
+			}
+			singleInstrument = singleInstrument && cp == messageCp;
 			m_publishedQuotesCounter++;
 		}
+
+		BOOK::InstrumentBook *book { nullptr }; // shards live as long as the order book
+		if (singleInstrument && messageCp.Valid())
+		{
+			const auto books { std::atomic_load(&m_instrumentBooks) };
+			const auto itBook { books->find(messageCp) };
+			book = itBook != books->end() ? itBook->second.get() : AddInstrumentBook(messageCp).get();
+		}
+		if (book)
+		{
+			m_orderBook->ApplyBatch(*book, *nmd);
+		}
+		else if (messageCp.Valid())
+		{
+			m_orderBook->ApplyBatch(*nmd);
+		}
 	}
 	else
 	{
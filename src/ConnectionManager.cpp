@@ -30,8 +30,8 @@ using namespace UTILS;
 
 namespace CORE {
 
-ConnectionManager::ConnectionManager(const std::string& configPath, const std::string& loggingPropsPath, std::shared_ptr<BOOK::OrderBook> orderBook)
-	: Logging("ConnectionManager"), ErrorHandler(pLogger()), m_configPath(configPath), m_loggingPropsPath(loggingPropsPath), m_orderBook(orderBook) {
+ConnectionManager::ConnectionManager(const std::string& configPath, const std::string& loggingPropsPath, BOOK::ConsolidatedBook::Ptr books)
+	: Logging("ConnectionManager"), ErrorHandler(pLogger()), m_configPath(configPath), m_loggingPropsPath(loggingPropsPath), m_books(books) {
 
 	// Register supported connection types
 	RegisterConnectionCreator<BINANCE::ConnectionMD>(BINANCE::SCHEMAMD);
@@ -29,6 +29,16 @@ void MessageProcessor::Register(TMessageTypeDetector messageTypeDetector)
 	m_messageTypeDetector = messageTypeDetector;
 }
 
+void MessageProcessor::RegisterSequenceTagDetector(TSequenceTagDetector sequenceTagDetector)
+{
+	m_sequenceTagDetector = sequenceTagDetector;
+}
+
+std::string MessageProcessor::GetSequenceTag(const std::shared_ptr<CRYPTO::JSONDocument> message) const
+{
+	return m_sequenceTagDetector ? m_sequenceTagDetector(message) : "";
+}
+
 UTILS::BoolResult MessageProcessor::Register(const std::string &msgType, const TMessageHandler handler)
 {
 	if (!handler)
@@ -69,7 +79,7 @@ size_t MessageProcessor::Size() const
 }
 
 /*! \brief Starts message processor. It must be started before processing any messages */
-void MessageProcessor::Start()
+void MessageProcessor::Start(size_t workerThreads)
 {
 	m_messageQueue.Start("MessageProcessorQueue", [](const std::shared_ptr<JSONDocument> &message, const TMessageHandler handler)
 	{
@@ -77,7 +87,7 @@ void MessageProcessor::Start()
 		{
 			handler(message);
 		}
-	});
+	}, workerThreads);
 }
 
 /*! \brief Stops message processor */
@@ -97,7 +107,23 @@ UTILS::BoolResult MessageProcessor::Enqueue(const std::shared_ptr<JSONDocument>
 		return UTILS::BoolResult(false, "NULL message handler ignored");
 	}
 	
-	return m_messageQueue.Enqueue(message, handler);
+	return Enqueue(message, handler, GetSequenceTag(message));
+}
+
+UTILS::BoolResult MessageProcessor::Enqueue(const std::shared_ptr<JSONDocument> message, const TMessageHandler handler,
+											const std::string &sequenceTag)
+{
+	if (!message)
+	{
+		return UTILS::BoolResult(false, "NULL message ignored");
+	}
+	if (!handler)
+	{
+		return UTILS::BoolResult(false, "NULL message handler ignored");
+	}
+	
+	// messages without a tag share the empty tag, so they are never handled in parallel with each other
+	return m_messageQueue.Enqueue(std::optional<std::string>(sequenceTag), message, handler);
 }
 
 }
@@ -27,20 +27,28 @@ ConnectionMD::ConnectionMD(const CRYPTO::Settings &settings, const std::string &
 									   }
 									   return MSGTYPE_Unknown;
 								   });
+	// the messages of one instrument are handled in order, different instruments in parallel
+	GetMessageProcessor().RegisterSequenceTagDetector([](const std::shared_ptr<CRYPTO::JSONDocument> jd)
+	{
+		return jd->Get("arg")["instId"].String();
+	});
 	// Register messages
 	GetMessageProcessor().Register(MSGTYPE_Snapshot, [this](const std::shared_ptr<CRYPTO::JSONDocument> jd)
 	{
-		auto arg = jd->GetSubObject("arg");
-		if (!arg)
+		const JsonValue arg { jd->Get("arg") };
+		if (!arg.IsObject())
 		{
 			poco_error(logger(), "QT_SNAPSHOT Invalid (or not supported) arg not found");
 			return;
 		}
 
-		const auto inst = TranslateSymbol(arg->get("instId").toString());
+		const auto inst = TranslateSymbol(arg["instId"].String());
+		if (const auto book = FindInstrumentBook(GetCurrencyPair(inst)))
+		{
+			GetOrderBook()->DiscardProvisional(*book); // levels restored from the checkpoint are replaced by the snapshot
+		}
 		const auto update = ParseMessage(jd, "bids", "asks");
-		PublishQuotes(ParseQuote(update->Bids, QuoteType::BID, inst));
-		PublishQuotes(ParseQuote(update->Asks, QuoteType::OFFER, inst));
+		PublishQuotes(ParseQuote(*update, inst));
 
 		poco_information_f2(logger(), "QT_SNAPSHOT %s bid Levels: %d ", inst, int(update->Bids.size()));
 		poco_information_f2(logger(), "QT_SNAPSHOT %s ask Levels: %d ", inst, int(update->Asks.size()));
@@ -48,17 +56,16 @@ ConnectionMD::ConnectionMD(const CRYPTO::Settings &settings, const std::string &
 
 	GetMessageProcessor().Register(MSGTYPE_Update, [this](const std::shared_ptr<CRYPTO::JSONDocument> jd)
 	{
-		auto arg = jd->GetSubObject("arg");
-		if (!arg)
+		const JsonValue arg { jd->Get("arg") };
+		if (!arg.IsObject())
 		{
 			poco_error(logger(), "QT_UPDATE Invalid (or not supported) arg not found");
 			return;
 		}
 
-		const auto inst = TranslateSymbol(arg->get("instId").toString());
+		const auto inst = TranslateSymbol(arg["instId"].String());
 		const auto update = ParseMessage(jd, "bids", "asks");
-		PublishQuotes(ParseQuote(update->Bids, QuoteType::BID, inst));
-		PublishQuotes(ParseQuote(update->Asks, QuoteType::OFFER, inst));
+		PublishQuotes(ParseQuote(*update, inst));
 	});
 
 	GetMessageProcessor().Register(MSGTYPE_Subscribe, [this](const std::shared_ptr<CRYPTO::JSONDocument> jd)
@@ -77,24 +84,13 @@ ConnectionMD::ConnectionMD(const CRYPTO::Settings &settings, const std::string &
 // Helper: translates levels from snapshot or incremental update
 void ConnectionMD::SideTranslator(const char *side, CRYPTO::PriceMessage::Levels &depth, const std::shared_ptr<CRYPTO::JSONDocument> jd) const
 {
-	if (auto data = jd->GetArray("data"))
+	jd->Get("data").ForEachElement([side, &depth](const JsonValue &data, bool &)
 	{
-		Poco::Dynamic::Array dynArray = *data;
-		for (size_t i = 0; i < data->size(); ++i)
+		data[side].ForEachElement([&depth](const JsonValue &level, bool &)
 		{
-			const auto &s = dynArray[i];
-			const auto prices = s[side];
-			if (prices.isArray())
-			{
-				for (size_t i = 0; i < prices.size(); ++i)
-				{
-					depth.emplace_back(std::make_shared<CRYPTO::Level>());
-					depth.back()->price = prices[i][0].toString();
-					depth.back()->size = prices[i][1].toString();
-				}
-			}
-		}
-	}
+			depth.push_back({ level.At(0).Raw(), level.At(1).Raw() });
+		});
+	});
 }
 
 //------------------------------------------------------------------------------
@@ -1,4 +1,10 @@
 
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
 #include "Utils/Result.h"
 #include "Definitions.h"
 #include "binance/ConnectionMD.h"
@@ -29,8 +35,7 @@ ConnectionMD::ConnectionMD(const CRYPTO::Settings &settings, const std::string &
 									   } // it was simple - type was in the field
 									   else
 									   {
-										   msgType = jd->GetValue<std::string>("lastUpdateId"); //Incremental updates contain field 'lastUpdateId'
-										   if (!msgType.empty())
+										   if (jd->Has("lastUpdateId")) //Incremental updates contain field 'lastUpdateId'
 										   {
 											   return MSGTYPE_DepthNUpdate;
 										   }
@@ -52,43 +57,43 @@ ConnectionMD::ConnectionMD(const CRYPTO::Settings &settings, const std::string &
 									   return MSGTYPE_Unknown;
 								   });
 	
+	// the messages of one symbol are handled in order, different symbols in parallel
+	GetMessageProcessor().RegisterSequenceTagDetector([this](const std::shared_ptr<CRYPTO::JSONDocument> jd)
+	{
+		return SymbolOf(*jd);
+	});
+	
 	// Register messages
 	//For unlimited depth we use the following msg
 	GetMessageProcessor().Register(MSGTYPE_DepthUpdate, [this](const std::shared_ptr<CRYPTO::JSONDocument> jd)
 	{
-		auto snapshot = m_snapshot.find(UTILS::CurrencyPair(jd->GetValue<std::string>("s")));
-		if (!snapshot->second)
+		const auto state = GetDepthState(jd->GetValue<std::string>("s"));
+		if (!state)
 		{
-			m_messages.emplace_back(jd); //snapshot has not completed so cache msgs..
-			return;
+			return; // symbol not subscribed
 		}
-		
-		while (!m_messages.empty())
+		if (!state->snapshotDone)
 		{
-			DepthUpdate(m_messages.front());  //flush cached msgs as snapshot download is now completed..
-			m_messages.pop_front();
+			state->pending.emplace_back(jd); //snapshot has not completed so cache msgs..
+			return;
 		}
-		
-		DepthUpdate(jd); //process incoming msg
+		DepthUpdate(*state, jd); //process incoming msg
 	});
 	
 	//For limited depth 'n' levels we use the following msg
 	GetMessageProcessor().Register(MSGTYPE_DepthNUpdate, [this](const std::shared_ptr<CRYPTO::JSONDocument> jd)
 	{
-		auto snapshot = m_snapshot.find(UTILS::CurrencyPair(jd->GetValue<std::string>("s")));
-		if (!snapshot->second)
+		const auto state = GetDepthState(SymbolOf(*jd));
+		if (!state)
 		{
-			m_messages.emplace_back(jd);
-			return;
+			return; // symbol not subscribed
 		}
-		
-		while (!m_messages.empty())
+		if (!state->snapshotDone)
 		{
-			DepthNUpdate(m_messages.front());  //flush cached msgs as snapshot download is now completed..
-			m_messages.pop_front();
+			state->pending.emplace_back(jd);
+			return;
 		}
-		
-		DepthNUpdate(jd); //process incoming msg
+		DepthNUpdate(*state, jd); //process incoming msg
 	});
 	
 	GetMessageProcessor().Register(MSGTYPE_Result, [this](const std::shared_ptr<CRYPTO::JSONDocument> jd)
@@ -117,49 +122,126 @@ ConnectionMD::ConnectionMD(const CRYPTO::Settings &settings, const std::string &
 	});
 }
 
-void ConnectionMD::DepthUpdate(const std::shared_ptr<CRYPTO::JSONDocument> jd)
+std::shared_ptr<ConnectionMD::DepthState> ConnectionMD::GetDepthState(const std::string &symbol) const
 {
-	static bool stale(true); // On startup check for old/stale msgs to be dropped.
-	
-	int64_t u = stol(jd->GetValue<std::string>("u"));
-	if (stale)
+	std::shared_lock lock { m_depthStates.Mutex() };
+	const auto it = m_depthStates->find(symbol);
+	return it != m_depthStates->end() ? it->second : nullptr;
+}
+
+std::string ConnectionMD::SymbolOf(const CRYPTO::JSONDocument &jd) const
+{
+	std::string symbol { jd.GetValue<std::string>("s") };
+	if (symbol.empty() && jd.Has("lastUpdateId"))
 	{
-		if (u <= m_lastUpdateId)
+		// partial depth messages carry no symbol; they are subscribed for one symbol only (see Subscribe)
+		std::shared_lock lock { m_depthStates.Mutex() };
+		symbol = m_partialDepthSymbol;
+	}
+	return symbol;
+}
+
+void ConnectionMD::DepthUpdate(DepthState &state, const std::shared_ptr<CRYPTO::JSONDocument> jd)
+{
+	int64_t u = jd->GetValue<int64_t>("u");
+	if (state.stale) // On startup check for old/stale msgs to be dropped.
+	{
+		if (u <= state.lastUpdateId)
 		{
-			poco_warning_f2(logger(), "Snapshot '%ld' dropping stale msg %ld", m_lastUpdateId, u);
+			poco_warning_f2(logger(), "Snapshot '%ld' dropping stale msg %ld", state.lastUpdateId, u);
 			return;
 		}
-		stale = false; //Now receiving fresh msgs..
+		state.stale = false; //Now receiving fresh msgs..
 	}
 		
-	int64_t U = stol(jd->GetValue<std::string>("U"));
-	if (U <= m_lastUpdateId + 1 && u >= m_lastUpdateId)
+	int64_t U = jd->GetValue<int64_t>("U");
+	if (U <= state.lastUpdateId + 1 && u >= state.lastUpdateId)
 	{
 		const auto update = ParseMessage(jd, "b", "a");
-		PublishQuotes(ParseQuote(update->Bids, QuoteType::BID, jd->GetValue<std::string>("s")));
-		PublishQuotes(ParseQuote(update->Asks, QuoteType::OFFER, jd->GetValue<std::string>("s")));
-		m_lastUpdateId = u + 1;
+		PublishQuotes(ParseQuote(*update, jd->GetValue<std::string>("s")));
+		state.lastUpdateId = u + 1;
+		if (state.book)
+		{
+			state.book->SetUpdateId(u); // saved with the checkpoints, read back like the ID of a snapshot
+		}
+		EndProvisional(state, true);
+	}
+	else if (state.reconciliation == DepthState::Pending)
+	{
+		// updates have been missed since the checkpoint, so the update waits for the snapshot replacing the restored levels
+		poco_warning_f3(logger(), "Checkpoint '%ld' not continued by U %ld u %ld, waiting for SNAPSHOT", state.lastUpdateId, U, u);
+		EndProvisional(state, false);
+		state.pending.emplace_back(jd);
 	}
 	else
 	{
-		poco_error_f3(logger(), "Snapshot SKIPPING '%ld' sequence U %ld u", m_lastUpdateId, U, u);
+		poco_error_f3(logger(), "Snapshot SKIPPING '%ld' sequence U %ld u", state.lastUpdateId, U, u);
 	}
 }
 
 
-void ConnectionMD::DepthNUpdate(const std::shared_ptr<CRYPTO::JSONDocument> jd)
+void ConnectionMD::DepthNUpdate(DepthState &state, const std::shared_ptr<CRYPTO::JSONDocument> jd)
 {
-	int64_t lastUpdateId = stol(jd->GetValue<std::string>("lastUpdateId"));
-	if (m_lastUpdateId <= lastUpdateId)
+	int64_t lastUpdateId = jd->GetValue<int64_t>("lastUpdateId");
+	if (state.lastUpdateId <= lastUpdateId)
 	{
+		if (state.reconciliation == DepthState::Pending && state.book)
+		{
+			// each message holds the whole top of the book, which replaces the restored levels
+			GetOrderBook()->DiscardProvisional(*state.book);
+		}
 		const auto update = ParseMessage(jd, "bids", "asks");
-		PublishQuotes(ParseQuote(update->Bids, QuoteType::BID, jd->GetValue<std::string>("s")));
-		PublishQuotes(ParseQuote(update->Asks, QuoteType::OFFER, jd->GetValue<std::string>("s")));
+		PublishQuotes(ParseQuote(*update, SymbolOf(*jd)));
+		if (state.book)
+		{
+			state.book->SetUpdateId(lastUpdateId);
+		}
+		EndProvisional(state, true);
+	}
+	else
+	{
+		poco_information_f2(logger(), "Snapshot '%ld' ignoring msg %ld", state.lastUpdateId, lastUpdateId);
+	}
+}
+
+void ConnectionMD::EndProvisional(DepthState &state, bool reconciled)
+{
+	if (state.reconciliation != DepthState::Pending)
+	{
+		return;
+	}
+	const std::string instrument { state.book ? state.book->Instrument().ToString() : std::string() };
+	if (reconciled)
+	{
+		if (state.book)
+		{
+			state.book->SetProvisional(false);
+		}
+		poco_information_f2(logger(), "%s: Book restored from checkpoint continued at update %ld", instrument, state.lastUpdateId);
 	}
 	else
 	{
-		poco_information_f2(logger(), "Snapshot '%ld' ignoring msg %ld", m_lastUpdateId, lastUpdateId);
+		// the restored levels stay visible (provisional) until the snapshot has been applied
+		state.snapshotDone = false;
+		state.stale = true;
 	}
+	state.reconciliation = reconciled ? DepthState::Reconciled : DepthState::Failed;
+}
+
+//------------------------------------------------------------------------------
+/*! \brief Prepares the depth state of an instrument restored from the checkpoint
+* @param cp: currency pair
+* @param updateId: update ID of the last depth update applied to the restored levels
+* */
+void ConnectionMD::OnCheckpointRestored(UTILS::CurrencyPair cp, int64_t updateId)
+{
+	auto state = std::make_shared<DepthState>();
+	state->lastUpdateId = updateId; // like the ID of a snapshot: older updates are dropped
+	state->snapshotDone = true; // the updates are applied to the restored levels at once
+	state->book = FindInstrumentBook(cp);
+	state->reconciliation = DepthState::Pending;
+	std::unique_lock lock { m_depthStates.Mutex() };
+	(*m_depthStates)[UTILS::toupper(TranslateSymbolToExchangeSpecific(cp.ToString()))] = state;
 }
 
 //------------------------------------------------------------------------------
@@ -190,11 +272,29 @@ void ConnectionMD::OnMsgError(const int errCode, const std::string &errMsg, cons
 /*! \brief Processing snapshot for each instrument */
 void ConnectionMD::Snapshot(const TInstruments &instruments)
 {
-	std::condition_variable_any cv;
-	std:: mutex mtx;
-
+	// the first depth update tells whether a book restored from the checkpoint is still continued;
+	// the restored instruments are waited for together, so the startup waits once at most
+	const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+	auto pendingReconciliation = [this, &instruments]()
+	{
+		return std::any_of(instruments.begin(), instruments.end(), [this](const auto &inst)
+		{
+			const auto state = GetDepthState(UTILS::toupper(inst));
+			return state && state->reconciliation == DepthState::Pending;
+		});
+	};
+	while (pendingReconciliation() && std::chrono::steady_clock::now() < deadline)
+	{
+		std::this_thread::sleep_for(std::chrono::milliseconds(10));
+	}
 	for (const auto &inst: instruments)
 	{
+		const std::string symbol { UTILS::toupper(inst) };
+		if (const auto state = GetDepthState(symbol); state && state->reconciliation == DepthState::Reconciled)
+		{
+			poco_information_f1(logger(), "SNAPSHOT for '%s' skipped, book continued from checkpoint", inst);
+			continue;
+		}
 		Poco::replaceInPlace(m_settings.m_snapshot_http, std::string("INSTRUMENT"), inst);
 		poco_information_f1(logger(), "Start SNAPSHOT for '%s'...", inst);
 		try
@@ -207,24 +307,69 @@ void ConnectionMD::Snapshot(const TInstruments &instruments)
 			
 			// Create json and push in the queue
 			auto jd = std::make_shared<CRYPTO::JSONDocument>(msg);
-			m_lastUpdateId = stol(jd->GetValue<std::string>("lastUpdateId"));
+			std::mutex mtx;
+			std::condition_variable cv;
+			bool done { false };
 			
-			GetMessageProcessor().Enqueue(jd, [this, inst, &cv](const std::shared_ptr<CRYPTO::JSONDocument> jd)
+			// tagged with its symbol, the snapshot is sequenced with the symbol's depth updates
+			GetMessageProcessor().Enqueue(jd, [this, inst, symbol, &mtx, &cv, &done](const std::shared_ptr<CRYPTO::JSONDocument> jd)
 			{
-				const auto update = ParseMessage(jd, "bids", "asks");
-				PublishQuotes(ParseQuote(update->Bids, QuoteType::BID, inst));
-				PublishQuotes(ParseQuote(update->Asks, QuoteType::OFFER, inst));
-				
-				poco_information_f2(logger(), "QT_SNAPSHOT %s bid Levels: %d ", inst, int(update->Bids.size()));
-				poco_information_f2(logger(), "QT_SNAPSHOT %s ask Levels: %d ", inst, int(update->Asks.size()));
+				const auto state = GetDepthState(symbol);
+				if (state && state->reconciliation == DepthState::Reconciled)
+				{
+					// the book restored from the checkpoint has been continued while the snapshot was downloaded
+					poco_information_f1(logger(), "QT_SNAPSHOT %s ignored, book continued from checkpoint", inst);
+				}
+				else
+				{
+					if (state)
+					{
+						EndProvisional(*state, false);
+						if (state->book)
+						{
+							GetOrderBook()->DiscardProvisional(*state->book);
+						}
+					}
+					
+					const auto update = ParseMessage(jd, "bids", "asks");
+					PublishQuotes(ParseQuote(*update, inst));
+					
+					poco_information_f2(logger(), "QT_SNAPSHOT %s bid Levels: %d ", inst, int(update->Bids.size()));
+					poco_information_f2(logger(), "QT_SNAPSHOT %s ask Levels: %d ", inst, int(update->Asks.size()));
+					
+					if (state)
+					{
+						state->lastUpdateId = jd->GetValue<int64_t>("lastUpdateId");
+						if (state->book)
+						{
+							state->book->SetUpdateId(state->lastUpdateId);
+						}
+						state->snapshotDone = true;
+						while (!state->pending.empty()) //flush cached msgs as snapshot download is now completed..
+						{
+							const auto &pending = state->pending.front();
+							if (pending->Has("lastUpdateId"))
+							{
+								DepthNUpdate(*state, pending);
+							}
+							else
+							{
+								DepthUpdate(*state, pending);
+							}
+							state->pending.pop_front();
+						}
+					}
+				}
+				{
+					std::lock_guard lock { mtx };
+					done = true;
+				}
 				cv.notify_one();
-			});
+			}, symbol);
 
-			cv.wait(mtx);
+			std::unique_lock lock { mtx };
+			cv.wait(lock, [&done] { return done; });
 			poco_information_f1(logger(), "Finished SNAPSHOT for '%s'", inst);
-
-			auto snapshot = m_snapshot.find(UTILS::CurrencyPair(inst));
-			snapshot->second = true;
 		}
 		catch (...)
 		{
@@ -242,11 +387,41 @@ void ConnectionMD::Snapshot(const TInstruments &instruments)
 void ConnectionMD::Subscribe(const CRYPTO::ConnectionBase::TInstruments &instruments, const std::string &method, unsigned int levels)
 {
 	std::string depthStr;
-	std::string depth { levels > 0 ? std::to_string(levels) : "" };
 	for (const auto &inst: instruments)
 	{
-		m_snapshot.insert(std::make_pair<UTILS::CurrencyPair, bool>(UTILS::CurrencyPair(inst), false));
+		const std::string symbol { UTILS::toupper(inst) };
+		unsigned int symbolLevels { levels };
+		if (method == "SUBSCRIBE")
+		{
+			std::unique_lock lock { m_depthStates.Mutex() };
+			const auto &state = m_depthStates->try_emplace(symbol, std::make_shared<DepthState>()).first->second;
+			if (!state->book) // restored instruments already hold their shard
+			{
+				state->book = AddInstrumentBook(GetCurrencyPair(TranslateSymbol(inst)));
+			}
+			// the messages of partial depth streams carry no symbol, so they can only be told apart for one symbol
+			if (symbolLevels > 0 && m_partialDepthSymbol.empty() && instruments.size() == 1)
+			{
+				m_partialDepthSymbol = symbol;
+			}
+			else if (symbolLevels > 0 && m_partialDepthSymbol != symbol)
+			{
+				poco_warning_f2(logger(), "Partial depth (%u levels) is subscribed for one symbol only: '%s' subscribed to diff depth",
+								symbolLevels, symbol);
+				symbolLevels = 0;
+			}
+		}
+		else if (method == "UNSUBSCRIBE")
+		{
+			std::unique_lock lock { m_depthStates.Mutex() };
+			if (m_partialDepthSymbol == symbol)
+			{
+				symbolLevels = GetDepth();
+				m_partialDepthSymbol.clear();
+			}
+		}
 		
+		const std::string depth { symbolLevels > 0 ? std::to_string(symbolLevels) : "" };
 		depthStr += (depthStr.empty() ? "" : ",") + std::string("\"") + UTILS::tolower(inst) + // note: instrument must be in lower case for feed
 					"@depth" + depth + "@100ms\"";
 	}
@@ -32,6 +32,12 @@ namespace CORE {
                                                 return message->GetValue<std::string>("channel");
                                             });
 
+            // the messages of one product are handled in order, different products in parallel
+            GetMessageProcessor().RegisterSequenceTagDetector([](const std::shared_ptr<CRYPTO::JSONDocument> message)
+                                            {
+                                                return message->Get("events").At(0)["product_id"].String();
+                                            });
+
             GetMessageProcessor().Register(MSG_TYPE_HEARTBEAT, [this](const std::shared_ptr<CRYPTO::JSONDocument> jd) {
                     poco_information_f1(logger(), "Received Heartbeat: %s", GetCurrency(jd).ToString());
             });
@@ -43,46 +49,42 @@ namespace CORE {
 
             // Handler for new Advanced Trade API l2_data channel
             GetMessageProcessor().Register(MSG_TYPE_L2DATA, [this](const std::shared_ptr<CRYPTO::JSONDocument> jd) {
-                auto events = jd->GetArray("events");
-                if (!events || events->size() == 0) {
+                const JsonValue events { jd->Get("events") };
+                if (!events.At(0).Valid()) {
                     poco_warning(logger(), "l2_data message has no events");
                     return;
                 }
                 
-                Poco::Dynamic::Array eventsArray = *events;
-                
-                // Process each event in the array
-                for (size_t i = 0; i < events->size(); i++) {
-                    auto eventObj = eventsArray[i].extract<Poco::JSON::Object::Ptr>();
-                    if (!eventObj) continue;
+                // Process each event in the array (fields are read on demand from the frame);
+                // all updates of the message are applied to the book at once
+                UTILS::BookUpdate::Ptr nmd{std::make_unique<UTILS::BookUpdate>()};
+                events.ForEachElement([this, &nmd](const JsonValue &event, bool &) {
+                    if (!event.IsObject()) return;
                     
-                    std::string product_id = eventObj->getValue<std::string>("product_id");
-                    auto cp = GetCurrencyPair(TranslateSymbol(product_id));
+                    const auto cp = GetCurrencyPair(TranslateSymbol(event["product_id"].String()));
                     if (!cp.Valid()) {
                         poco_error(logger(), "Invalid (or not supported) instrument - ignored");
-                        continue;
+                        return;
                     }
                     
-                    std::string event_type = eventObj->getValue<std::string>("type");
-                    if (event_type == "update") {
+                    if (event["type"].Raw() == "update") {
                         // Handle update: updates array with side, price_level, new_quantity
-                        auto updates = eventObj->getArray("updates");
-                        if (updates) {
-                            Poco::Dynamic::Array updatesArray = *updates;
-                            for (size_t j = 0; j < updates->size(); j++) {
-                                auto updateObj = updatesArray[j].extract<Poco::JSON::Object::Ptr>();
-                                if (!updateObj) continue;
-                                
-                                std::string side = updateObj->getValue<std::string>("side");
-                                std::string price = updateObj->getValue<std::string>("price_level");
-                                std::string qty = updateObj->getValue<std::string>("new_quantity");
-                                
-                                std::vector level{std::make_shared<CORE::CRYPTO::Level>(price, qty)};
-                                PublishQuotes(ParseQuote(level, (side == "bid" ? QuoteType::BID : QuoteType::OFFER), cp));
-                            }
-                            poco_information_f2(logger(), "l2_data UPDATE %s: %d updates", cp.ToString(), (int)updates->size());
+                        const JsonValue updates { event["updates"] };
+                        int count = 0;
+                        updates.ForEachElement([this, cp, &nmd, &count](const JsonValue &update, bool &) {
+                            if (!update.IsObject()) return;
+                            
+                            const CORE::CRYPTO::LevelView level{update["price_level"].Raw(), update["new_quantity"].Raw()};
+                            ParseQuote(*nmd, &level, 1, (update["side"].Raw() == "bid" ? QuoteType::BID : QuoteType::OFFER), cp);
+                            ++count;
+                        });
+                        if (updates.IsArray()) {
+                            poco_information_f2(logger(), "l2_data UPDATE %s: %d updates", cp.ToString(), count);
                         }
                     }
+                });
+                if (!nmd->entries.empty()) {
+                    PublishQuotes(std::move(nmd));
                 }
             });
         }
@@ -34,10 +34,11 @@ int main(int argc, char** argv)
 
         CurrencyPair::InitializeCurrencyConfigs();
 
-        auto m_orderBook = std::make_shared<BOOK::OrderBook>();
+        // one order book per venue, fed by the venue's market data sessions
+        auto m_books = std::make_shared<BOOK::ConsolidatedBook>();
 
         Options options(argc, argv);
-        auto m_connectionManager = make_shared<ConnectionManager>(options.ConfigPath(), options.LoggingPropsPath(), m_orderBook);
+        auto m_connectionManager = make_shared<ConnectionManager>(options.ConfigPath(), options.LoggingPropsPath(), m_books);
         auto m_orderManager = make_shared<OrderManager>(m_connectionManager);
         
         // Set OrderManager reference in ConnectionManager so WebSocket connections can push order updates
@@ -45,7 +46,19 @@ int main(int argc, char** argv)
 
         STRATEGY::GridStrategy strat(m_orderManager, options.ConfigPath());
 
-        m_orderBook->Initialise([&strat]() { strat.CheckFilledOrders(); });
+        // fills are checked on the notifier's dispatch thread, so REST calls of the strategy do not stall market data;
+        // only the grid venue's book drives the strategy, and its signals are read from that book
+        const auto gridBook { m_books->FindVenue(strat.Venue()) };
+        if (gridBook)
+        {
+            strat.SetBook(gridBook);
+            gridBook->Notifier().Subscribe([&strat](const CurrencyPair &cp, const BOOK::TopOfBook::Snapshot &top) { strat.OnBookUpdate(cp, top); });
+            gridBook->Notifier().Start();
+        }
+        else
+        {
+            poco_warning_f1(logger, "No market data session for grid venue '%s'", strat.Venue());
+        }
 
         m_connectionManager->Connect(); //connect market data and populate orderbook.
         
@@ -72,6 +85,7 @@ int main(int argc, char** argv)
         std::cin.get();
 
         m_connectionManager->Disconnect();
+        m_books->ForEachVenue([](size_t, const std::string &, BOOK::OrderBook &book) { book.Notifier().Stop(); });
     }
     catch (Poco::Exception& e) // explicitly catch poco exceptions
     {
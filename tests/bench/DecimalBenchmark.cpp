@@ -0,0 +1,109 @@
+//
+// Compares converting the price and size strings of price levels to integers
+// through doubles (std::stod, then CurrencyPair::DblToCpip / DoubleToQty, as
+// ParseQuote did) with the exact decimal parser, and counts the conversions
+// the double path gets wrong.
+//
+// Usage: DecimalBenchmark
+//
+
+#include <iomanip>
+#include <random>
+
+#include "Utils/FixDefs.h"
+#include "DepthStream.h"
+
+namespace {
+
+constexpr size_t LEVELS { 100000 };
+
+struct Level
+{
+	std::string price;
+	std::string size;
+};
+
+std::string Decimal(int64_t value, int decimals)
+{
+	std::string digits { std::to_string(value) };
+	if (int(digits.size()) <= decimals)
+	{
+		digits.insert(0, size_t(decimals + 1) - digits.size(), '0');
+	}
+	digits.insert(digits.size() - size_t(decimals), ".");
+	return digits;
+}
+
+/** @brief Levels with prices of @a priceDecimals decimals around @a mid and sizes of 8 decimals */
+std::vector<Level> GenerateLevels(int64_t mid, int priceDecimals, unsigned seed = 42)
+{
+	std::mt19937_64 rng { seed };
+	std::vector<Level> levels;
+	levels.reserve(LEVELS);
+	for (size_t i { 0 }; i < LEVELS; ++i)
+	{
+		levels.push_back({ Decimal(mid + int64_t(rng() % 200000) - 100000, priceDecimals), Decimal(1 + int64_t(rng() % 5000000000), 8) });
+	}
+	return levels;
+}
+
+void Report(const std::string &name, const UTILS::CurrencyPair &cp, const std::vector<Level> &levels)
+{
+	constexpr int ROUNDS { 20 };
+	int64_t sumDouble { 0 };
+	int64_t sumExact { 0 };
+	const int64_t nsDouble { BENCH::Measure([&]()
+	{
+		for (int round { 0 }; round < ROUNDS; ++round)
+		{
+			for (const Level &level: levels)
+			{
+				sumDouble += cp.DblToCpip(std::stod(level.price)) + cp.DoubleToQty(std::stod(level.size));
+			}
+		}
+	}) };
+	const int64_t nsExact { BENCH::Measure([&]()
+	{
+		// the scales are looked up once per message, as ParseQuote does
+		const int priceDecimals { cp.CpipDecimals() };
+		const int qtyDecimals { cp.QtyDecimals() };
+		for (int round { 0 }; round < ROUNDS; ++round)
+		{
+			for (const Level &level: levels)
+			{
+				int64_t price { 0 };
+				int64_t size { 0 };
+				UTILS::ParseDecimal(level.price, priceDecimals, price);
+				UTILS::ParseDecimal(level.size, qtyDecimals, size);
+				sumExact += price + size;
+			}
+		}
+	}) };
+	size_t mismatches { 0 };
+	for (const Level &level: levels)
+	{
+		int64_t price { 0 };
+		int64_t size { 0 };
+		cp.StrToCpip(level.price, price);
+		cp.StrToQty(level.size, size);
+		mismatches += price != cp.DblToCpip(std::stod(level.price)) || size != cp.DoubleToQty(std::stod(level.size));
+	}
+	const double count { double(ROUNDS) * double(levels.size()) };
+	std::cout << std::left << std::setw(40) << name << std::right
+			  << std::setw(10) << std::fixed << std::setprecision(1) << double(nsDouble) / count << " ns/level (double)"
+			  << std::setw(10) << double(nsExact) / count << " ns/level (exact)"
+			  << std::setw(8) << std::setprecision(2) << double(nsDouble) / double(nsExact) << "x"
+			  << std::setw(8) << mismatches << " levels converted differently" << std::endl;
+}
+
+} // namespace
+
+int main(int, char **)
+{
+	const UTILS::CurrencyPair btc { "BTC/USDT" };
+	Report("BTC/USDT, prices with 2 decimals", btc, GenerateLevels(2192173, 2));
+	Report("BTC/USDT, prices with 8 decimals", btc, GenerateLevels(2192173000000, 8));
+	const UTILS::CurrencyPair eur { "EUR/USD" };
+	Report("EUR/USD, prices with 5 decimals", eur, GenerateLevels(110250, 5));
+	return 0;
+}
@@ -0,0 +1,144 @@
+#ifndef SPOTGRIDBOT_DEPTHSTREAM_H
+#define SPOTGRIDBOT_DEPTHSTREAM_H
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "Utils/CurrencyPair.h"
+
+namespace BENCH {
+
+/** @brief One L2 change of a depth stream: the size at a price level of one side.
+ * A size of 0 removes the level. */
+struct DepthEvent
+{
+	bool bid { true };
+	int64_t price { 0 }; //!< Price in cpips
+	int64_t size { 0 }; //!< Size in quantity units of the instrument
+};
+
+using DepthStream = std::vector<DepthEvent>;
+
+/** @brief Loads a recorded depth stream.
+ *
+ * The file is expected to contain one L2 change per line in the format
+ * <tt>side,price,size</tt> where side is @a b (bid) or @a a (ask), and price and
+ * size are decimal strings as sent by the venue (e.g. <tt>b,27012.35,0.125</tt>).
+ * Lines starting with '#' are skipped.
+ *
+ * @param path Path of the recorded depth stream
+ * @param cp Instrument of the stream (used to convert prices and sizes)
+ * @return Depth stream, empty if the file could not be read
+ */
+inline DepthStream LoadDepthStream(const std::string &path, UTILS::CurrencyPair cp)
+{
+	DepthStream result;
+	std::ifstream file { path };
+	std::string line;
+	while (std::getline(file, line))
+	{
+		if (line.empty() || line[0] == '#')
+		{
+			continue;
+		}
+		std::istringstream fields { line };
+		std::string side, price, size;
+		DepthEvent event;
+		if (std::getline(fields, side, ',') && std::getline(fields, price, ',') && std::getline(fields, size, ',')
+			&& cp.StrToCpip(price, event.price) && cp.StrToQty(size, event.size))
+		{
+			event.bid = side == "b";
+			result.push_back(event);
+		}
+	}
+	return result;
+}
+
+/** @brief Generates a synthetic depth stream around a random-walk mid price.
+ *
+ * Most changes hit the levels close to the top of the book, mimicking the
+ * shape of the depth channels of crypto venues.
+ *
+ * @param count Number of events
+ * @param depth Number of price levels per side
+ * @param tick Price increment between levels in cpips
+ * @param seed Seed of the random generator
+ */
+inline DepthStream GenerateDepthStream(size_t count, int64_t depth, int64_t tick = 100, unsigned seed = 42)
+{
+	DepthStream result;
+	result.reserve(count);
+	std::mt19937_64 rng { seed };
+	std::geometric_distribution<int64_t> distance { 4.0 / double(depth) };
+	std::uniform_int_distribution<int64_t> size { 0, 20 };
+	std::uniform_int_distribution<int> walk { -1, 1 };
+	int64_t mid { 270000000 };
+	for (size_t i = 0; i < count; ++i)
+	{
+		if (i % 64 == 0)
+		{
+			mid += walk(rng) * tick;
+		}
+		const bool bid { (rng() & 1) != 0 };
+		const int64_t offset { 1 + std::min(distance(rng), depth - 1) };
+		const int64_t price { bid ? mid - offset * tick : mid + offset * tick };
+		const int64_t qty { size(rng) };
+		result.push_back({ bid, price, qty == 0 && offset < 3 ? 1 : qty * 1000000 });
+	}
+	return result;
+}
+
+/** @brief Replays a depth stream as NEW/UPDATE/DELETE quotes against one side per event.
+ *
+ * The replayer keeps track of the key of the quote at each price (as the
+ * ActiveQuoteTable does for the connections), so every change of an existing
+ * level is an UPDATE/DELETE referencing the previous quote.
+ *
+ * @tparam A Signature: void action(bool bid, int64_t price, int64_t size, int64_t key, int64_t refKey)
+ */
+template <typename A>
+void Replay(const DepthStream &stream, A action)
+{
+	std::map<std::pair<bool, int64_t>, int64_t> keys;
+	int64_t nextKey { 1 };
+	for (const auto &event: stream)
+	{
+		auto it { keys.find({ event.bid, event.price }) };
+		const int64_t refKey { it != keys.end() ? it->second : 0 };
+		if (event.size == 0 && refKey == 0)
+		{
+			continue;
+		}
+		const int64_t key { nextKey++ };
+		action(event.bid, event.price, event.size, key, refKey);
+		if (event.size == 0)
+		{
+			keys.erase(it);
+		}
+		else
+		{
+			keys[{ event.bid, event.price }] = key;
+		}
+	}
+}
+
+/** @brief Nanoseconds elapsed while executing @a action */
+template <typename A>
+int64_t Measure(A action)
+{
+	const auto start { std::chrono::steady_clock::now() };
+	action();
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+} // namespace BENCH
+
+#endif //SPOTGRIDBOT_DEPTHSTREAM_H
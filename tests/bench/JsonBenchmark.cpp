@@ -0,0 +1,287 @@
+//
+// Compares reading market data frames through the Poco DOM (the former
+// JSONDocument) with the on-demand reader, for the fields the Coinbase,
+// Binance and OKX handlers read: message type, sequence tag, and the price
+// and size of every level.
+//
+// Usage: JsonBenchmark [<frames file>]
+//        (one captured frame per line; the venue is detected from the frame)
+//
+
+#include <fstream>
+#include <iomanip>
+#include <random>
+
+#include "JSONDocument.h"
+#include "DepthStream.h"
+
+using namespace CORE::CRYPTO;
+
+namespace {
+
+enum class Venue
+{
+	Coinbase,
+	Binance,
+	OKX
+};
+
+const char *Name(Venue venue)
+{
+	switch (venue)
+	{
+		case Venue::Coinbase:
+			return "coinbase l2_data";
+		case Venue::Binance:
+			return "binance depthUpdate";
+		default:
+			return "okx books";
+	}
+}
+
+Venue Detect(const std::string &frame)
+{
+	if (frame.find("\"channel\"") != std::string::npos && frame.find("\"events\"") != std::string::npos)
+	{
+		return Venue::Coinbase;
+	}
+	return frame.find("\"arg\"") != std::string::npos ? Venue::OKX : Venue::Binance;
+}
+
+std::string Decimal(int64_t value, int decimals)
+{
+	std::string digits { std::to_string(value) };
+	if (int(digits.size()) <= decimals)
+	{
+		digits.insert(0, size_t(decimals + 1) - digits.size(), '0');
+	}
+	digits.insert(digits.size() - size_t(decimals), ".");
+	return digits;
+}
+
+/** @brief A frame of a venue's wire format with @a levels levels per side */
+std::string GenerateFrame(Venue venue, int levels, unsigned seed = 42)
+{
+	std::mt19937 rng { seed };
+	auto price = [](bool bid, int i) { return Decimal(2192173 + (bid ? -i : i + 1) * 7, 2); };
+	auto size = [&rng]() { return Decimal(1 + int64_t(rng() % 500000000), 8); };
+	std::string frame;
+	switch (venue)
+	{
+		case Venue::Coinbase:
+			frame = R"({"channel":"l2_data","client_id":"","timestamp":"2023-02-09T20:32:50.714964855Z","sequence_num":0,)"
+					R"("events":[{"type":"update","product_id":"BTC-USD","updates":[)";
+			for (int i = 0; i < 2 * levels; ++i)
+			{
+				const bool bid { i % 2 == 0 };
+				frame += std::string(i ? "," : "") + R"({"side":")" + (bid ? "bid" : "offer")
+						 + R"(","event_time":"1970-01-01T00:00:00Z","price_level":")" + price(bid, i / 2)
+						 + R"(","new_quantity":")" + size() + "\"}";
+			}
+			frame += "]}]}";
+			break;
+		case Venue::Binance:
+			frame = R"({"e":"depthUpdate","E":1672515782136,"s":"BTCUSDT","U":157,"u":160,"b":[)";
+			for (int i = 0; i < levels; ++i)
+			{
+				frame += std::string(i ? "," : "") + "[\"" + price(true, i) + "\",\"" + size() + "\"]";
+			}
+			frame += "],\"a\":[";
+			for (int i = 0; i < levels; ++i)
+			{
+				frame += std::string(i ? "," : "") + "[\"" + price(false, i) + "\",\"" + size() + "\"]";
+			}
+			frame += "]}";
+			break;
+		case Venue::OKX:
+			frame = R"({"arg":{"channel":"books","instId":"BTC-USDT"},"action":"update","data":[{"asks":[)";
+			for (int i = 0; i < levels; ++i)
+			{
+				frame += std::string(i ? "," : "") + "[\"" + price(false, i) + "\",\"" + size() + "\",\"0\",\"2\"]";
+			}
+			frame += "],\"bids\":[";
+			for (int i = 0; i < levels; ++i)
+			{
+				frame += std::string(i ? "," : "") + "[\"" + price(true, i) + "\",\"" + size() + "\",\"0\",\"1\"]";
+			}
+			frame += R"(],"ts":"1597026383085","checksum":-855196043,"seqId":123456,"prevSeqId":123455}]})";
+			break;
+	}
+	return frame;
+}
+
+/** @brief Reads a frame through the Poco tree, the way the handlers did */
+size_t ReadDom(Venue venue, const std::string &frame)
+{
+	Poco::JSON::Parser parser;
+	const Poco::JSON::Object::Ptr root { parser.parse(frame).extract<Poco::JSON::Object::Ptr>() };
+	size_t checksum { 0 };
+	auto addSide = [&checksum](const Poco::Dynamic::Var &levels)
+	{
+		for (size_t i = 0; i < levels.size(); ++i)
+		{
+			checksum += levels[i][0].toString().size() + levels[i][1].toString().size();
+		}
+	};
+	switch (venue)
+	{
+		case Venue::Coinbase:
+		{
+			checksum += root->get("channel").toString().size();
+			const Poco::JSON::Array::Ptr events { root->getArray("events") };
+			Poco::Dynamic::Array eventsArray = *events;
+			for (size_t i = 0; i < events->size(); ++i)
+			{
+				const auto event { eventsArray[i].extract<Poco::JSON::Object::Ptr>() };
+				checksum += event->getValue<std::string>("product_id").size();
+				const auto updates { event->getArray("updates") };
+				Poco::Dynamic::Array updatesArray = *updates;
+				for (size_t j = 0; j < updates->size(); ++j)
+				{
+					const auto update { updatesArray[j].extract<Poco::JSON::Object::Ptr>() };
+					checksum += update->getValue<std::string>("side").size() + update->getValue<std::string>("price_level").size()
+								+ update->getValue<std::string>("new_quantity").size();
+				}
+			}
+			break;
+		}
+		case Venue::Binance:
+			checksum += root->get("e").toString().size() + root->get("s").toString().size()
+						+ size_t(root->get("u").convert<int64_t>() - root->get("U").convert<int64_t>());
+			addSide(root->get("b"));
+			addSide(root->get("a"));
+			break;
+		case Venue::OKX:
+		{
+			checksum += root->get("action").toString().size() + root->getObject("arg")->get("instId").toString().size();
+			const Poco::Dynamic::Var data { root->get("data") };
+			for (size_t i = 0; i < data.size(); ++i)
+			{
+				addSide(data[i]["bids"]);
+				addSide(data[i]["asks"]);
+			}
+			break;
+		}
+	}
+	return checksum;
+}
+
+/** @brief Reads a frame on demand, the way the handlers do */
+size_t ReadOnDemand(Venue venue, const std::string &frame)
+{
+	const JSONDocument document { frame };
+	size_t checksum { 0 };
+	auto addSide = [&checksum](const UTILS::JsonValue &levels)
+	{
+		levels.ForEachElement([&checksum](const UTILS::JsonValue &level, bool &)
+		{
+			checksum += level.At(0).String().size() + level.At(1).String().size();
+		});
+	};
+	switch (venue)
+	{
+		case Venue::Coinbase:
+			checksum += document.GetValue<std::string>("channel").size();
+			document.Get("events").ForEachElement([&checksum](const UTILS::JsonValue &event, bool &)
+			{
+				checksum += event["product_id"].String().size();
+				event["updates"].ForEachElement([&checksum](const UTILS::JsonValue &update, bool &)
+				{
+					checksum += update["side"].String().size() + update["price_level"].String().size()
+								+ update["new_quantity"].String().size();
+				});
+			});
+			break;
+		case Venue::Binance:
+			checksum += document.GetValue<std::string>("e").size() + document.GetValue<std::string>("s").size()
+						+ size_t(document.GetValue<int64_t>("u") - document.GetValue<int64_t>("U"));
+			addSide(document.Get("b"));
+			addSide(document.Get("a"));
+			break;
+		case Venue::OKX:
+			checksum += document.GetValue<std::string>("action").size() + document.Get("arg")["instId"].String().size();
+			document.Get("data").ForEachElement([&addSide](const UTILS::JsonValue &data, bool &)
+			{
+				addSide(data["bids"]);
+				addSide(data["asks"]);
+			});
+			break;
+	}
+	return checksum;
+}
+
+void Report(const std::string &name, const std::vector<std::pair<Venue, std::string>> &frames)
+{
+	size_t bytes { 0 };
+	for (const auto &frame: frames)
+	{
+		bytes += frame.second.size();
+	}
+	const size_t rounds { std::max<size_t>(1, 20000000 / std::max<size_t>(bytes, 1)) };
+	size_t checksumDom { 0 };
+	size_t checksumOnDemand { 0 };
+	const int64_t nsDom { BENCH::Measure([&]()
+	{
+		for (size_t round { 0 }; round < rounds; ++round)
+		{
+			for (const auto &frame: frames)
+			{
+				checksumDom += ReadDom(frame.first, frame.second);
+			}
+		}
+	}) };
+	const int64_t nsOnDemand { BENCH::Measure([&]()
+	{
+		for (size_t round { 0 }; round < rounds; ++round)
+		{
+			for (const auto &frame: frames)
+			{
+				checksumOnDemand += ReadOnDemand(frame.first, frame.second);
+			}
+		}
+	}) };
+	const double count { double(rounds * frames.size()) };
+	std::cout << std::left << std::setw(36) << name << std::right
+			  << std::setw(10) << bytes / frames.size() << " B/frame"
+			  << std::setw(12) << std::fixed << std::setprecision(1) << double(nsDom) / count << " ns/frame (dom)"
+			  << std::setw(12) << double(nsOnDemand) / count << " ns/frame (on demand)"
+			  << std::setw(8) << std::setprecision(2) << double(nsDom) / double(nsOnDemand) << "x"
+			  << std::setw(10) << std::setprecision(2) << double(bytes) * double(rounds) / double(nsOnDemand) << " GB/s"
+			  << (checksumDom != checksumOnDemand ? "  CHECKSUM MISMATCH" : "") << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+	if (argc > 1)
+	{
+		std::ifstream in { argv[1] };
+		std::vector<std::pair<Venue, std::string>> frames;
+		for (std::string line; std::getline(in, line);)
+		{
+			if (!line.empty())
+			{
+				frames.emplace_back(Detect(line), line);
+			}
+		}
+		if (frames.empty())
+		{
+			std::cerr << "No frames read from " << argv[1] << std::endl;
+			return 1;
+		}
+		Report(argv[1], frames);
+	}
+	else
+	{
+		for (Venue venue: { Venue::Coinbase, Venue::Binance, Venue::OKX })
+		{
+			for (int levels: { 1, 10, 100, 1000 })
+			{
+				Report(std::string(Name(venue)) + ", " + std::to_string(levels) + " levels/side",
+					   { { venue, GenerateFrame(venue, levels) } });
+			}
+		}
+	}
+	return 0;
+}
@@ -0,0 +1,261 @@
+//
+// Compares the quote-based price ladder with the compact L2 ladder used in
+// the Levels book mode, replaying recorded (or synthetic) L2 depth streams.
+// Reports time, heap bytes per price level and cache misses per update.
+//
+// Cache misses are read from the hardware counters (Linux perf events); they
+// are reported as n/a where the counters are not accessible (e.g. containers
+// without perf_event_paranoid <= 2).
+//
+// Usage: L2Benchmark [<depth stream file> <symbol>]
+//
+
+#include <atomic>
+#include <cstdlib>
+#include <iomanip>
+#include <new>
+
+#ifdef __linux__
+#include <cstring>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include "Utils/FixDefs.h"
+#include "OrderBook/L2Ladder.h"
+#include "DepthStream.h"
+
+using namespace CORE::BOOK;
+
+namespace {
+
+std::atomic<int64_t> s_heapBytes { 0 }; //!< Bytes currently allocated through operator new
+
+} // namespace
+
+void *operator new(std::size_t size)
+{
+	// the size is stored in front of the block, so operator delete can account for it
+	auto *block { static_cast<std::size_t *>(std::malloc(size + sizeof(std::max_align_t))) };
+	if (!block)
+	{
+		throw std::bad_alloc();
+	}
+	*block = size;
+	s_heapBytes += int64_t(size);
+	return reinterpret_cast<char *>(block) + sizeof(std::max_align_t);
+}
+
+void operator delete(void *ptr) noexcept
+{
+	if (ptr)
+	{
+		auto *block { reinterpret_cast<std::size_t *>(static_cast<char *>(ptr) - sizeof(std::max_align_t)) };
+		s_heapBytes -= int64_t(*block);
+		std::free(block);
+	}
+}
+
+void operator delete(void *ptr, std::size_t) noexcept
+{
+	operator delete(ptr);
+}
+
+namespace {
+
+/** @brief Counts the cache misses of the calling thread while it exists (Linux only) */
+class CacheMissCounter
+{
+public:
+	CacheMissCounter()
+	{
+#ifdef __linux__
+		perf_event_attr attr;
+		std::memset(&attr, 0, sizeof(attr));
+		attr.type = PERF_TYPE_HARDWARE;
+		attr.size = sizeof(attr);
+		attr.config = PERF_COUNT_HW_CACHE_MISSES;
+		attr.disabled = 1;
+		attr.exclude_kernel = 1;
+		attr.exclude_hv = 1;
+		m_fd = int(syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0));
+#endif
+	}
+
+	~CacheMissCounter()
+	{
+#ifdef __linux__
+		if (m_fd >= 0)
+		{
+			close(m_fd);
+		}
+#endif
+	}
+
+	/** @brief Are the counters accessible? */
+	bool Valid() const { return m_fd >= 0; }
+
+	void Start()
+	{
+#ifdef __linux__
+		if (Valid())
+		{
+			ioctl(m_fd, PERF_EVENT_IOC_RESET, 0);
+			ioctl(m_fd, PERF_EVENT_IOC_ENABLE, 0);
+		}
+#endif
+	}
+
+	/** @brief Stops counting and returns the number of misses since @a Start (-1 if not accessible) */
+	int64_t Stop()
+	{
+		int64_t result { -1 };
+#ifdef __linux__
+		if (Valid())
+		{
+			ioctl(m_fd, PERF_EVENT_IOC_DISABLE, 0);
+			if (read(m_fd, &result, sizeof(result)) != sizeof(result))
+			{
+				result = -1;
+			}
+		}
+#endif
+		return result;
+	}
+
+private:
+	int m_fd { -1 };
+};
+
+/** @brief One side of the book as a price ladder of quotes (book mode Quotes) */
+class QuoteSide
+{
+public:
+	explicit QuoteSide(bool bid)
+			: m_ladder(bid) { }
+
+	void Apply(int64_t price, int64_t size, int64_t key, int64_t refKey)
+	{
+		if (refKey > 0)
+		{
+			m_ladder.Remove(refKey);
+		}
+		if (size > 0)
+		{
+			m_ladder.Insert(Quote::Create(0, 0, 0, "", 1, price, size, 0, key, refKey, 0, refKey > 0 ? QT_UPDATE : QT_NEW, 0, "", ""));
+		}
+	}
+
+	int64_t Best() const { return m_ladder.Empty() ? 0 : m_ladder.BestLevel()->price; }
+
+	size_t LevelCount() const { return m_ladder.LevelCount(); }
+
+private:
+	PriceLadder m_ladder;
+};
+
+/** @brief One side of the book as an L2 ladder (book mode Levels) */
+class LevelSide
+{
+public:
+	explicit LevelSide(bool bid)
+			: m_ladder(bid) { }
+
+	void Apply(int64_t price, int64_t size, int64_t key, int64_t)
+	{
+		m_ladder.Apply(price, size, key);
+	}
+
+	int64_t Best() const { return m_ladder.Empty() ? 0 : m_ladder.BestLevel()->price; }
+
+	size_t LevelCount() const { return m_ladder.LevelCount(); }
+
+private:
+	L2Ladder m_ladder;
+};
+
+struct Result
+{
+	int64_t ns { 0 };
+	int64_t cacheMisses { -1 };
+	double bytesPerLevel { 0 };
+	int64_t checksum { 0 };
+};
+
+template <typename S>
+Result Run(const BENCH::DepthStream &stream)
+{
+	Result result;
+	const int64_t heapBefore { s_heapBytes.load() };
+	S bids { true };
+	S asks { false };
+	CacheMissCounter counter;
+	counter.Start();
+	result.ns = BENCH::Measure([&]()
+	{
+		BENCH::Replay(stream, [&](bool bid, int64_t price, int64_t size, int64_t key, int64_t refKey)
+		{
+			(bid ? bids : asks).Apply(price, size, key, refKey);
+			result.checksum += bids.Best() - asks.Best(); // read top of book after every update, as the mid price check does
+		});
+	});
+	result.cacheMisses = counter.Stop();
+	const size_t levels { bids.LevelCount() + asks.LevelCount() };
+	result.bytesPerLevel = levels > 0 ? double(s_heapBytes.load() - heapBefore) / double(levels) : 0;
+	return result;
+}
+
+void Report(const std::string &name, const BENCH::DepthStream &stream)
+{
+	size_t updates { 0 };
+	BENCH::Replay(stream, [&updates](bool, int64_t, int64_t, int64_t, int64_t) { ++updates; });
+	const Result quotes { Run<QuoteSide>(stream) };
+	const Result levels { Run<LevelSide>(stream) };
+	auto misses { [updates](const Result &r)
+	{
+		std::ostringstream out;
+		if (r.cacheMisses < 0)
+		{
+			out << "n/a";
+		}
+		else
+		{
+			out << std::fixed << std::setprecision(2) << double(r.cacheMisses) / double(updates);
+		}
+		return out.str();
+	} };
+	std::cout << std::left << std::setw(32) << name << std::right
+			  << std::setw(10) << updates << " updates" << std::fixed << std::setprecision(1)
+			  << std::setw(9) << double(quotes.ns) / double(updates) << " /" << std::setw(6) << double(levels.ns) / double(updates) << " ns/update"
+			  << std::setw(9) << quotes.bytesPerLevel << " /" << std::setw(6) << levels.bytesPerLevel << " bytes/level"
+			  << std::setw(8) << misses(quotes) << " /" << std::setw(6) << misses(levels) << " misses/update"
+			  << "  (quotes / levels)"
+			  << (quotes.checksum != levels.checksum ? "  CHECKSUM MISMATCH" : "") << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+	if (argc > 2)
+	{
+		const UTILS::CurrencyPair cp { argv[2] };
+		const auto stream { BENCH::LoadDepthStream(argv[1], cp) };
+		if (stream.empty())
+		{
+			std::cerr << "No depth events read from " << argv[1] << std::endl;
+			return 1;
+		}
+		Report(argv[1], stream);
+	}
+	else
+	{
+		for (int64_t depth: { 10, 100, 1000, 5000 })
+		{
+			Report("synthetic, depth " + std::to_string(depth), BENCH::GenerateDepthStream(200000, depth));
+		}
+	}
+	return 0;
+}
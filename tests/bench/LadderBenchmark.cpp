@@ -0,0 +1,150 @@
+//
+// Compares the price ladder of the order book with the sorted quote vector it
+// replaced, replaying recorded (or synthetic) L2 depth streams.
+//
+// Usage: LadderBenchmark [<depth stream file> <symbol>]
+//
+
+#include <iomanip>
+
+#include "Utils/FixDefs.h"
+#include "OrderBook/PriceLadder.h"
+#include "DepthStream.h"
+
+using namespace CORE::BOOK;
+
+namespace {
+
+/** @brief One side of the book as a sorted vector of quotes (the former OrderBook implementation) */
+class VectorSide
+{
+public:
+	explicit VectorSide(bool bid)
+			: m_bid(bid) { }
+
+	void Apply(const Quote::Ptr &quote)
+	{
+		if (quote->RefKey() > 0)
+		{
+			const auto it { std::find_if(m_quotes.begin(), m_quotes.end(), [&quote](const Quote::Ptr &q) { return q->Key() == quote->RefKey(); }) };
+			if (it != m_quotes.end())
+			{
+				m_quotes.erase(it);
+			}
+		}
+		if (quote->QuoteType() != QT_DELETE)
+		{
+			m_quotes.insert(std::find_if(m_quotes.begin(), m_quotes.end(), [this, &quote](const Quote::Ptr &q)
+			{
+				if (quote->Price() != q->Price())
+				{
+					return m_bid ? quote->Price() > q->Price() : quote->Price() < q->Price();
+				}
+				return quote->Volume() >= q->Volume();
+			}), quote);
+		}
+	}
+
+	int64_t Best() const { return m_quotes.empty() ? 0 : m_quotes.front()->Price(); }
+
+private:
+	bool m_bid;
+	std::vector<Quote::Ptr> m_quotes;
+};
+
+/** @brief One side of the book as a price ladder, applied the way OrderBook::AddQuote does */
+class LadderSide
+{
+public:
+	explicit LadderSide(bool bid)
+			: m_ladder(bid) { }
+
+	void Apply(const Quote::Ptr &quote)
+	{
+		if (quote->RefKey() > 0)
+		{
+			m_ladder.Remove(quote->RefKey());
+		}
+		if (quote->QuoteType() != QT_DELETE)
+		{
+			m_ladder.Insert(quote);
+		}
+	}
+
+	int64_t Best() const { return m_ladder.Empty() ? 0 : m_ladder.BestLevel()->price; }
+
+private:
+	PriceLadder m_ladder;
+};
+
+struct Input
+{
+	bool bid;
+	Quote::Ptr quote;
+};
+
+std::vector<Input> CreateInput(const BENCH::DepthStream &stream)
+{
+	std::vector<Input> result;
+	BENCH::Replay(stream, [&result](bool bid, int64_t price, int64_t size, int64_t key, int64_t refKey)
+	{
+		const int quoteType { size == 0 ? QT_DELETE : (refKey > 0 ? QT_UPDATE : QT_NEW) };
+		result.push_back({ bid, Quote::Create(0, 0, 0, "", 1, price, size, 0, key, refKey, 0, quoteType, 0, "", "") });
+	});
+	return result;
+}
+
+template <typename S>
+int64_t Run(const std::vector<Input> &input, int64_t &checksum)
+{
+	S bids { true };
+	S asks { false };
+	return BENCH::Measure([&]()
+	{
+		for (const auto &in: input)
+		{
+			(in.bid ? bids : asks).Apply(in.quote);
+			checksum += bids.Best() - asks.Best(); // read top of book after every update, as the mid price check does
+		}
+	});
+}
+
+void Report(const std::string &name, const BENCH::DepthStream &stream)
+{
+	const auto input { CreateInput(stream) };
+	int64_t checksumVector { 0 };
+	int64_t checksumLadder { 0 };
+	const int64_t nsVector { Run<VectorSide>(input, checksumVector) };
+	const int64_t nsLadder { Run<LadderSide>(input, checksumLadder) };
+	std::cout << std::left << std::setw(32) << name << std::right
+			  << std::setw(10) << input.size() << " updates"
+			  << std::setw(10) << std::fixed << std::setprecision(1) << double(nsVector) / double(input.size()) << " ns/update (vector)"
+			  << std::setw(10) << double(nsLadder) / double(input.size()) << " ns/update (ladder)"
+			  << std::setw(8) << std::setprecision(2) << double(nsVector) / double(nsLadder) << "x"
+			  << (checksumVector != checksumLadder ? "  CHECKSUM MISMATCH" : "") << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+	if (argc > 2)
+	{
+		const UTILS::CurrencyPair cp { argv[2] };
+		const auto stream { BENCH::LoadDepthStream(argv[1], cp) };
+		if (stream.empty())
+		{
+			std::cerr << "No depth events read from " << argv[1] << std::endl;
+			return 1;
+		}
+		Report(argv[1], stream);
+	}
+	else
+	{
+		for (int64_t depth: { 10, 100, 1000, 5000 })
+		{
+			Report("synthetic, depth " + std::to_string(depth), BENCH::GenerateDepthStream(200000, depth));
+		}
+	}
+	return 0;
+}
@@ -0,0 +1,183 @@
+//
+// Compares scans over the quotes of a price ladder (following a pointer to
+// every quote) with the kernels of LevelArrays at each instruction set, on
+// synthetic books of 10 to 5000 levels with several quotes per level.
+//
+// Usage: LevelArraysBenchmark
+//
+
+#include <iomanip>
+#include <random>
+
+#include "Utils/FixDefs.h"
+#include "OrderBook/LevelArrays.h"
+#include "OrderBook/PriceLadder.h"
+#include "DepthStream.h"
+
+using namespace CORE::BOOK;
+
+namespace {
+
+constexpr int ROUNDS { 2000 };
+
+/** @brief Results of one round of scans (compared between the implementations) */
+struct Result
+{
+	int64_t groups { 0 }; //!< Number of price levels
+	int64_t aggregates { 0 }; //!< Number of runs holding the aggregation volume
+	int64_t thresholdRow { 0 }; //!< Row at which the cumulative volume reaches the threshold
+	int64_t fillableRow { 0 }; //!< First row able to fill the quantity on its own
+	double notional { 0 };
+
+	bool operator==(const Result &other) const
+	{
+		return groups == other.groups && aggregates == other.aggregates && thresholdRow == other.thresholdRow
+			   && fillableRow == other.fillableRow && std::abs(notional - other.notional) <= 1e-9 * std::abs(notional);
+	}
+};
+
+struct Query
+{
+	int64_t aggregateVolume;
+	int64_t threshold;
+	int64_t fillQty;
+};
+
+PriceLadder CreateLadder(int64_t depth, unsigned seed = 42)
+{
+	std::mt19937 rng { seed };
+	PriceLadder ladder { true };
+	int64_t key { 0 };
+	for (int64_t level { 0 }; level < depth; ++level)
+	{
+		const int64_t quotes { 1 + int64_t(rng() % 4) };
+		for (int64_t i { 0 }; i < quotes; ++i)
+		{
+			ladder.Insert(Quote::Create(0, 0, 0, "", 1, 10000000 - level * 100, 1 + int64_t(rng() % 100000),
+										int64_t(rng() % 50000), ++key, 0, 0, QT_NEW, 0, "", ""));
+		}
+	}
+	return ladder;
+}
+
+/** @brief The scans as a walk over the quotes of the ladder */
+Result RunLadder(const PriceLadder &ladder, const Query &query)
+{
+	Result result;
+	int64_t row { 0 };
+	int64_t price { 0 };
+	int64_t runVolume { 0 };
+	int64_t cumulative { 0 };
+	result.thresholdRow = -1;
+	result.fillableRow = -1;
+	ladder.ForEachQuote([&](const Quote::Ptr &q, bool &)
+	{
+		if (row == 0 || q->Price() != price)
+		{
+			price = q->Price();
+			++result.groups;
+		}
+		if (runVolume == 0)
+		{
+			++result.aggregates;
+		}
+		runVolume += q->Volume();
+		if (runVolume >= query.aggregateVolume)
+		{
+			runVolume = 0;
+		}
+		cumulative += q->Volume();
+		if (result.thresholdRow < 0 && cumulative >= query.threshold)
+		{
+			result.thresholdRow = row;
+		}
+		if (result.fillableRow < 0 && q->Volume() >= query.fillQty && q->MinQty() <= query.fillQty && !q->Used() && q->Valid())
+		{
+			result.fillableRow = row;
+		}
+		result.notional += double(q->Price()) * double(q->Volume());
+		++row;
+	});
+	result.thresholdRow = result.thresholdRow < 0 ? row : result.thresholdRow;
+	result.fillableRow = result.fillableRow < 0 ? row : result.fillableRow;
+	return result;
+}
+
+/** @brief The scans with the kernels of the arrays */
+Result RunArrays(const LevelArrays &arrays, const Query &query)
+{
+	Result result;
+	arrays.ForEachGroup([&result](size_t, size_t, bool &) { ++result.groups; });
+	arrays.ForEachAggregate(query.aggregateVolume, [&result](size_t, size_t, bool &) { ++result.aggregates; });
+	result.thresholdRow = int64_t(arrays.FindCumulativeVolume(0, query.threshold));
+	result.fillableRow = int64_t(arrays.FindFirstFillable(query.fillQty));
+	result.notional = arrays.Notional(0, arrays.Size());
+	return result;
+}
+
+template <typename S, typename F>
+int64_t Run(const S &side, const Query &query, F scan, Result &result)
+{
+	return BENCH::Measure([&]()
+	{
+		for (int round { 0 }; round < ROUNDS; ++round)
+		{
+			result = scan(side, query);
+		}
+	});
+}
+
+const char *Name(SimdLevel level)
+{
+	switch (level)
+	{
+		case SimdLevel::AVX2:
+			return "avx2";
+		case SimdLevel::SSE4:
+			return "sse4";
+		default:
+			return "scalar";
+	}
+}
+
+void Report(int64_t depth)
+{
+	const PriceLadder ladder { CreateLadder(depth) };
+	LevelArrays arrays;
+	arrays.Assign(ladder);
+	// the threshold lies at about two thirds of the book, the fillable quote deep in it
+	const Query query { 200000, int64_t(arrays.Size()) * 50000 * 2 / 3, 99000 };
+
+	Result ladderResult;
+	const int64_t nsLadder { Run(ladder, query, RunLadder, ladderResult) };
+	std::cout << std::left << std::setw(26) << ("depth " + std::to_string(depth)) << std::right
+			  << std::setw(8) << arrays.Size() << " rows"
+			  << std::setw(12) << std::fixed << std::setprecision(1) << double(nsLadder) / ROUNDS << " ns (ladder)";
+	const SimdLevel supported { LevelArrays::SupportedSimdLevel() };
+	for (SimdLevel level: { SimdLevel::Scalar, SimdLevel::SSE4, SimdLevel::AVX2 })
+	{
+		if (level > supported)
+		{
+			continue;
+		}
+		LevelArrays::SetSimdLevel(level);
+		Result arraysResult;
+		const int64_t ns { Run(arrays, query, RunArrays, arraysResult) };
+		std::cout << std::setw(12) << double(ns) / ROUNDS << " ns (" << Name(level) << ")"
+				  << std::setw(7) << std::setprecision(2) << double(nsLadder) / double(ns) << "x" << std::setprecision(1)
+				  << (arraysResult == ladderResult ? "" : " RESULT MISMATCH");
+	}
+	LevelArrays::SetSimdLevel(supported);
+	std::cout << std::endl;
+}
+
+} // namespace
+
+int main(int, char **)
+{
+	for (int64_t depth: { 10, 100, 1000, 5000 })
+	{
+		Report(depth);
+	}
+	return 0;
+}
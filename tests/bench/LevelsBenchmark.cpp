@@ -0,0 +1,164 @@
+//
+// Compares filling the price levels of Binance depth messages the way the
+// handlers did (a shared Level owning a copy of the price and size strings
+// per level) with the flat LevelView arrays filled from the frame into the
+// arena of the message. Reports time and heap allocations per message.
+//
+// Usage: LevelsBenchmark
+//
+
+#include <atomic>
+#include <cstdlib>
+#include <iomanip>
+#include <random>
+
+#include "CryptoCommon.h"
+#include "DepthStream.h"
+
+using namespace CORE::CRYPTO;
+
+namespace {
+
+std::atomic<int64_t> s_allocations { 0 }; //!< Number of calls of operator new
+
+} // namespace
+
+void *operator new(std::size_t size)
+{
+	void *ptr { std::malloc(size ? size : 1) };
+	if (!ptr)
+	{
+		throw std::bad_alloc();
+	}
+	s_allocations.fetch_add(1, std::memory_order_relaxed);
+	return ptr;
+}
+
+void operator delete(void *ptr) noexcept
+{
+	std::free(ptr);
+}
+
+void operator delete(void *ptr, std::size_t) noexcept
+{
+	std::free(ptr);
+}
+
+namespace {
+
+/** @brief Level as the handlers kept it before the flat arrays */
+struct OwnedLevel
+{
+	std::string price;
+	std::string size;
+};
+
+struct OwnedMessage
+{
+	std::vector<std::shared_ptr<OwnedLevel>> Bids;
+	std::vector<std::shared_ptr<OwnedLevel>> Asks;
+};
+
+/** @brief Binance depth update with @a levels levels per side */
+std::string GenerateFrame(int levels, unsigned seed = 42)
+{
+	std::mt19937 rng { seed };
+	auto price = [](bool bid, int i) { return std::to_string(21921 + (bid ? -i : i + 1)) + ".73"; };
+	auto size = [&rng]() { return "0." + std::to_string(10000000 + rng() % 89999999); };
+	std::string frame { R"({"e":"depthUpdate","E":1672515782136,"s":"BTCUSDT","U":157,"u":160,"b":[)" };
+	for (int i = 0; i < levels; ++i)
+	{
+		frame += std::string(i ? "," : "") + "[\"" + price(true, i) + "\",\"" + size() + "\"]";
+	}
+	frame += "],\"a\":[";
+	for (int i = 0; i < levels; ++i)
+	{
+		frame += std::string(i ? "," : "") + "[\"" + price(false, i) + "\",\"" + size() + "\"]";
+	}
+	frame += "]}";
+	return frame;
+}
+
+size_t ReadOwned(const JSONDocument &document)
+{
+	OwnedMessage msg;
+	auto translate = [&document](const char *side, std::vector<std::shared_ptr<OwnedLevel>> &depth)
+	{
+		document.Get(side).ForEachElement([&depth](const UTILS::JsonValue &level, bool &)
+		{
+			depth.emplace_back(std::make_shared<OwnedLevel>());
+			depth.back()->price = level.At(0).String();
+			depth.back()->size = level.At(1).String();
+		});
+	};
+	translate("b", msg.Bids);
+	translate("a", msg.Asks);
+	size_t checksum { 0 };
+	for (const auto &level: msg.Bids)
+	{
+		checksum += level->price.size() + level->size.size();
+	}
+	for (const auto &level: msg.Asks)
+	{
+		checksum += level->price.size() + level->size.size();
+	}
+	return checksum;
+}
+
+size_t ReadViews(const JSONDocument &document)
+{
+	PriceMessage msg;
+	auto translate = [&document](const char *side, PriceMessage::Levels &depth)
+	{
+		document.Get(side).ForEachElement([&depth](const UTILS::JsonValue &level, bool &)
+		{
+			depth.push_back({ level.At(0).Raw(), level.At(1).Raw() });
+		});
+	};
+	translate("b", msg.Bids);
+	translate("a", msg.Asks);
+	size_t checksum { 0 };
+	for (const LevelView &level: msg.Bids)
+	{
+		checksum += level.price.size() + level.size.size();
+	}
+	for (const LevelView &level: msg.Asks)
+	{
+		checksum += level.price.size() + level.size.size();
+	}
+	return checksum;
+}
+
+template <typename F>
+void Run(const char *name, const JSONDocument &document, size_t rounds, F read, size_t &checksum)
+{
+	const int64_t allocationsBefore { s_allocations.load() };
+	const int64_t ns { BENCH::Measure([&]()
+	{
+		for (size_t round { 0 }; round < rounds; ++round)
+		{
+			checksum += read(document);
+		}
+	}) };
+	std::cout << std::setw(12) << std::fixed << std::setprecision(1) << double(ns) / double(rounds) << " ns/msg"
+			  << std::setw(10) << double(s_allocations.load() - allocationsBefore) / double(rounds) << " allocs/msg (" << name << ")";
+}
+
+} // namespace
+
+int main()
+{
+	for (int levels: { 1, 10, 100, 1000 })
+	{
+		const std::string frame { GenerateFrame(levels) };
+		const JSONDocument document { frame };
+		const size_t rounds { std::max<size_t>(1, 2000000 / size_t(levels)) };
+		size_t checksumOwned { 0 };
+		size_t checksumViews { 0 };
+		std::cout << "binance depthUpdate, " << std::setw(4) << levels << " levels/side";
+		Run("owned", document, rounds, ReadOwned, checksumOwned);
+		Run("views", document, rounds, ReadViews, checksumViews);
+		std::cout << (checksumOwned != checksumViews ? "  CHECKSUM MISMATCH" : "") << std::endl;
+	}
+	return 0;
+}
@@ -0,0 +1,141 @@
+//
+// Applies depth updates of several instruments to the book of a market data
+// session through ConnectionBaseMD::PublishQuotes, the messages being handled
+// by the session's message processor with 1, 2 and 4 worker threads (session
+// parameter 'worker_threads'). The messages are tagged by instrument, so the
+// updates of different instruments may be applied in parallel. Reports the
+// throughput in messages and price levels per second.
+//
+// Usage: PublishBenchmark [config.xml CurrencyConfig.xml logging.properties]
+//        (default: the configuration of the tests)
+//
+
+#include <iomanip>
+#include <random>
+
+#include "OKX/ConnectionMD.h"
+#include "ConnectionManager.h"
+#include "SchemaDefs.h"
+#include "DepthStream.h"
+
+using namespace CORE::CRYPTO;
+
+namespace {
+
+constexpr int MESSAGES { 20000 }; //!< Messages per instrument
+constexpr int LEVELS { 10 }; //!< Price levels per side of a message
+
+const std::vector<std::string> Instruments { "BTC-USDT", "BNB-USDT", "ETH-USDT", "LTC-USDT",
+											 "ADA-USDT", "DOGE-USDT", "SOL-USDT", "DOT-USDT" };
+
+/** @brief OKX market data session fed directly with book updates, without a websocket */
+class BenchConnectionMD : public CORE::OKX::ConnectionMD
+{
+public:
+	using CORE::OKX::ConnectionMD::ConnectionMD;
+
+	MessageProcessor &GetMessageProcessor()
+	{
+		return ConnectionMD::GetMessageProcessor();
+	}
+};
+
+/** @brief Price levels of a depth update around a mid price moving randomly */
+struct LevelStrings
+{
+	std::vector<std::string> bidPrices, bidSizes, askPrices, askSizes;
+};
+
+LevelStrings GenerateLevels(std::mt19937 &rng, int mid)
+{
+	LevelStrings result;
+	auto size = [&rng]() { return rng() % 8 ? "0." + std::to_string(1000 + rng() % 9000) : std::string("0"); };
+	for (int i = 0; i < LEVELS; ++i)
+	{
+		result.bidPrices.push_back(std::to_string(mid - 1 - i) + ".00");
+		result.bidSizes.push_back(size());
+		result.askPrices.push_back(std::to_string(mid + 1 + i) + ".00");
+		result.askSizes.push_back(size());
+	}
+	return result;
+}
+
+/** @brief Book updates of all instruments, interleaved as they arrive from the venue */
+std::vector<std::pair<std::string, UTILS::BookUpdate::Ptr>> GenerateUpdates(BenchConnectionMD &conn)
+{
+	std::mt19937 rng { 42 };
+	std::vector<int> mids(Instruments.size(), 20000);
+	std::vector<std::pair<std::string, UTILS::BookUpdate::Ptr>> updates;
+	updates.reserve(MESSAGES * Instruments.size());
+	for (int m = 0; m < MESSAGES; ++m)
+	{
+		for (size_t i = 0; i < Instruments.size(); ++i)
+		{
+			mids[i] += int(rng() % 3) - 1;
+			const LevelStrings levels { GenerateLevels(rng, mids[i]) };
+			PriceMessage msg;
+			for (int l = 0; l < LEVELS; ++l)
+			{
+				msg.Bids.push_back({ levels.bidPrices[l], levels.bidSizes[l] });
+				msg.Asks.push_back({ levels.askPrices[l], levels.askSizes[l] });
+			}
+			updates.emplace_back(Instruments[i], conn.ParseQuote(msg, Instruments[i]));
+		}
+	}
+	return updates;
+}
+
+void Run(size_t workerThreads, const std::string &configPath, const std::string &loggingProperties)
+{
+	CORE::ConnectionManager manager(configPath, loggingProperties, std::make_shared<CORE::BOOK::ConsolidatedBook>());
+	Settings settings;
+	settings.m_name = "OKX_MD_BENCH";
+	settings.m_schema = CORE::OKX::SCHEMAMD;
+	settings.m_parameters[PARAM_ATTR_WorkerThreads] = std::to_string(workerThreads);
+	BenchConnectionMD conn(settings, loggingProperties, manager);
+	auto updates { GenerateUpdates(conn) };
+	const auto document { std::make_shared<JSONDocument>(std::string("{}")) };
+	std::atomic<size_t> remaining { updates.size() };
+	UTILS::CEvent done;
+	conn.GetMessageProcessor().Start(conn.GetWorkerThreads());
+
+	const int64_t ns { BENCH::Measure([&]()
+	{
+		for (size_t u = 0; u < updates.size(); ++u)
+		{
+			conn.GetMessageProcessor().Enqueue(document, [&conn, &updates, &remaining, &done, u](const std::shared_ptr<JSONDocument>)
+			{
+				conn.PublishQuotes(std::move(updates[u].second));
+				if (--remaining == 0)
+				{
+					done.Set();
+				}
+			}, updates[u].first);
+		}
+		done.Wait();
+	}) };
+	conn.GetMessageProcessor().Stop();
+
+	const double seconds { double(ns) / 1e9 };
+	std::cout << std::setw(2) << workerThreads << " worker thread(s): " << std::setw(12) << std::fixed << std::setprecision(0)
+			  << double(updates.size()) / seconds << " msgs/s" << std::setw(14) << double(updates.size() * 2 * LEVELS) / seconds
+			  << " levels/s" << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+	const std::string configDir { std::string(PATH_BENCH_SOURCE_DIR) + "/tests/config/" };
+	const std::string configPath { argc > 3 ? argv[1] : configDir + "config.xml" };
+	const std::string currencyConfigPath { argc > 3 ? argv[2] : configDir + "CurrencyConfig.xml" };
+	const std::string loggingProperties { argc > 3 ? argv[3] : configDir + "logging.properties" };
+	UTILS::CurrencyPair::InitializeCurrencyConfigs(currencyConfigPath);
+
+	std::cout << Instruments.size() << " instruments, " << MESSAGES << " messages of " << 2 * LEVELS << " levels each" << std::endl;
+	for (size_t workerThreads: { 1, 2, 4 })
+	{
+		Run(workerThreads, configPath, loggingProperties);
+	}
+	return 0;
+}
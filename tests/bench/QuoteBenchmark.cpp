@@ -0,0 +1,175 @@
+//
+// Measures quote throughput with the different quote handles, replaying
+// recorded (or synthetic) L2 depth streams:
+//  - handles: creates a quote per update and keeps it in a key map until it is
+//    replaced, as the book does, once with std::shared_ptr, once with the
+//    intrusive Quote::Ptr (heap allocated and pooled)
+//  - book: quotes per second through OrderBook::AddEntry -> AddQuote, with
+//    locking and snapshot readers
+//
+// Usage: QuoteBenchmark [<depth stream file> <symbol>]
+//
+
+#include <iomanip>
+#include <thread>
+#include <unordered_map>
+
+#include "Utils/FixDefs.h"
+#include "OrderBook/OrderBook.h"
+#include "DepthStream.h"
+
+using namespace CORE::BOOK;
+
+namespace {
+
+struct Update
+{
+	bool bid;
+	int64_t price;
+	int64_t size;
+	int64_t key;
+	int64_t refKey;
+};
+
+std::vector<Update> CreateInput(const BENCH::DepthStream &stream)
+{
+	std::vector<Update> result;
+	BENCH::Replay(stream, [&result](bool bid, int64_t price, int64_t size, int64_t key, int64_t refKey)
+	{
+		result.push_back({ bid, price, size, key, refKey });
+	});
+	return result;
+}
+
+/** @brief Creates quotes as std::shared_ptr (one allocation, plus the control block sharing it) */
+struct SharedHandle
+{
+	using Ptr = std::shared_ptr<Quote>;
+
+	static Ptr Create(int64_t price, int64_t size, int64_t key, int64_t refKey)
+	{
+		return std::make_shared<Quote>(0, 0, 0, "", 1, price, size, 0, key, refKey, 0, refKey > 0 ? QT_UPDATE : QT_NEW, 0, "", "");
+	}
+};
+
+/** @brief Creates heap allocated quotes as intrusive handles */
+struct IntrusiveHandle
+{
+	using Ptr = Quote::Ptr;
+
+	static Ptr Create(int64_t price, int64_t size, int64_t key, int64_t refKey)
+	{
+		return Quote::Create(0, 0, 0, "", 1, price, size, 0, key, refKey, 0, refKey > 0 ? QT_UPDATE : QT_NEW, 0, "", "");
+	}
+};
+
+/** @brief Takes quotes from the quote pool as intrusive handles */
+struct PooledHandle
+{
+	using Ptr = Quote::Ptr;
+
+	static Ptr Create(int64_t price, int64_t size, int64_t key, int64_t refKey)
+	{
+		return QuotePool::getQuote(__PRETTY_FUNCTION__, false, std::this_thread::get_id(), 0, 0, 0, "", 1, price, size, 0, key, refKey, 0,
+								   refKey > 0 ? QT_UPDATE : QT_NEW, 0, "", "");
+	}
+};
+
+template <typename H>
+int64_t RunHandles(const std::vector<Update> &input, int64_t &checksum)
+{
+	std::unordered_map<int64_t, typename H::Ptr> quotes;
+	typename H::Ptr last;
+	quotes.reserve(input.size());
+	return BENCH::Measure([&]()
+	{
+		for (const auto &in: input)
+		{
+			if (in.refKey > 0)
+			{
+				quotes.erase(in.refKey);
+			}
+			if (in.size > 0)
+			{
+				typename H::Ptr quote { H::Create(in.price, in.size, in.key, in.refKey) };
+				quotes.emplace(in.key, quote);
+				last = std::move(quote);
+				checksum += last->Price();
+			}
+		}
+		quotes.clear();
+	});
+}
+
+int64_t RunBook(const std::vector<Update> &input, UTILS::CurrencyPair cp, OrderBook::ReadMode readMode)
+{
+	std::vector<UTILS::BookUpdate::Entry> entries;
+	for (const auto &in: input)
+	{
+		UTILS::BookUpdate::Entry entry;
+		entry.instrument = cp;
+		entry.entryType = in.bid ? UTILS::QuoteType::BID : UTILS::QuoteType::OFFER;
+		entry.price = in.price;
+		entry.volume = in.size;
+		entry.updateType = in.size == 0 ? QT_DELETE : (in.refKey > 0 ? QT_UPDATE : QT_NEW);
+		entry.endOfMessage = true;
+		entries.push_back(entry);
+	}
+	OrderBook book;
+	book.SetReadMode(readMode);
+	InstrumentBook &shard { *book.AddInstrument(cp) };
+	book.SetBookMode(cp, InstrumentBook::Mode::Quotes);
+	return BENCH::Measure([&]()
+	{
+		for (size_t i { 0 }; i < input.size(); ++i)
+		{
+			book.AddEntry(shard, input[i].key, input[i].refKey, 0, 0, entries[i]);
+		}
+	});
+}
+
+void Report(const std::string &name, const BENCH::DepthStream &stream, UTILS::CurrencyPair cp)
+{
+	const auto input { CreateInput(stream) };
+	const double updates { double(input.size()) };
+	auto rate { [updates](int64_t ns) { return updates * 1e3 / double(ns); } }; // million quotes per second
+	int64_t checksums[3] { 0, 0, 0 };
+	const int64_t nsShared { RunHandles<SharedHandle>(input, checksums[0]) };
+	const int64_t nsIntrusive { RunHandles<IntrusiveHandle>(input, checksums[1]) };
+	const int64_t nsPooled { RunHandles<PooledHandle>(input, checksums[2]) };
+	const int64_t nsLocking { RunBook(input, cp, OrderBook::ReadMode::Locking) };
+	const int64_t nsSnapshot { RunBook(input, cp, OrderBook::ReadMode::Snapshot) };
+	std::cout << std::left << std::setw(32) << name << std::right << std::fixed << std::setprecision(2)
+			  << std::setw(10) << input.size() << " updates, Mquotes/s:"
+			  << std::setw(7) << rate(nsShared) << " shared_ptr"
+			  << std::setw(7) << rate(nsIntrusive) << " intrusive"
+			  << std::setw(7) << rate(nsPooled) << " pooled"
+			  << std::setw(7) << rate(nsLocking) << " AddQuote (locking)"
+			  << std::setw(7) << rate(nsSnapshot) << " AddQuote (snapshot)"
+			  << (checksums[0] != checksums[1] || checksums[0] != checksums[2] ? "  CHECKSUM MISMATCH" : "") << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+	if (argc > 2)
+	{
+		const UTILS::CurrencyPair cp { argv[2] };
+		const auto stream { BENCH::LoadDepthStream(argv[1], cp) };
+		if (stream.empty())
+		{
+			std::cerr << "No depth events read from " << argv[1] << std::endl;
+			return 1;
+		}
+		Report(argv[1], stream, cp);
+	}
+	else
+	{
+		for (int64_t depth: { 10, 100, 1000 })
+		{
+			Report("synthetic, depth " + std::to_string(depth), BENCH::GenerateDepthStream(200000, depth), UTILS::CurrencyPair { "EUR/USD" });
+		}
+	}
+	return 0;
+}
@@ -0,0 +1,143 @@
+//
+// Measures the latency of the feed thread applying a depth stream to the
+// order book while N reader threads walk the book, once with readers taking
+// the side locks and once with readers iterating published snapshots (RCU).
+//
+// Usage: SnapshotBenchmark [<depth stream file> <symbol>]
+//
+
+#include <algorithm>
+#include <atomic>
+#include <iomanip>
+#include <thread>
+
+#include "Utils/FixDefs.h"
+#include "OrderBook/OrderBook.h"
+#include "DepthStream.h"
+
+using namespace CORE::BOOK;
+
+namespace {
+
+/** @brief Entries of a depth stream, one message per event */
+struct Input
+{
+	int64_t key;
+	int64_t refKey;
+	UTILS::BookUpdate::Entry entry;
+};
+
+std::vector<Input> CreateInput(const BENCH::DepthStream &stream, UTILS::CurrencyPair cp)
+{
+	std::vector<Input> result;
+	BENCH::Replay(stream, [&result, cp](bool bid, int64_t price, int64_t size, int64_t key, int64_t refKey)
+	{
+		Input in { key, refKey, { } };
+		in.entry.entryType = bid ? UTILS::QuoteType::BID : UTILS::QuoteType::OFFER;
+		in.entry.price = price;
+		in.entry.volume = size;
+		in.entry.updateType = size == 0 ? QT_DELETE : (refKey > 0 ? QT_UPDATE : QT_NEW);
+		in.entry.endOfMessage = true;
+		result.push_back(in);
+	});
+	return result;
+}
+
+int64_t Percentile(const std::vector<int64_t> &sorted, double p)
+{
+	return sorted.empty() ? 0 : sorted[std::min(sorted.size() - 1, size_t(p * double(sorted.size())))];
+}
+
+/** @brief Applies the input on the feed thread while @a readers threads iterate both sides
+ *
+ * @return Sorted latencies of the AddEntry calls in nanoseconds
+ */
+std::vector<int64_t> Run(const std::vector<Input> &input, UTILS::CurrencyPair cp, OrderBook::ReadMode mode, int readers, uint64_t &reads)
+{
+	OrderBook book;
+	book.Initialise([] { });
+	book.SetReadMode(mode);
+	const InstrumentBook::Ptr handle { book.AddInstrument(cp) };
+
+	std::atomic_bool done { false };
+	std::atomic<uint64_t> readCount { 0 };
+	std::vector<std::thread> threads;
+	for (int i = 0; i < readers; ++i)
+	{
+		threads.emplace_back([&book, &done, &readCount, cp]
+		{
+			uint64_t n { 0 };
+			int64_t volume { 0 };
+			while (!done.load(std::memory_order_relaxed))
+			{
+				for (bool bid: { true, false })
+				{
+					book.IterateQuoteGroups(cp, bid, [&volume](int, QuoteGroup::Ptr &qg, bool &) { volume += qg->TotalVolume(); });
+				}
+				++n;
+			}
+			readCount += n + (volume == -1 ? 1 : 0);
+		});
+	}
+
+	std::vector<int64_t> latencies;
+	latencies.reserve(input.size());
+	for (const auto &in: input)
+	{
+		latencies.push_back(BENCH::Measure([&book, &handle, &in] { book.AddEntry(*handle, in.key, in.refKey, 0, 0, in.entry); }));
+	}
+	done = true;
+	for (auto &thread: threads)
+	{
+		thread.join();
+	}
+	reads = readCount;
+	std::sort(latencies.begin(), latencies.end());
+	return latencies;
+}
+
+void Report(const std::string &name, const BENCH::DepthStream &stream, UTILS::CurrencyPair cp)
+{
+	const auto input { CreateInput(stream, cp) };
+	std::cout << name << " (" << input.size() << " messages)" << std::endl;
+	for (int readers: { 1, 2, 4, 8 })
+	{
+		for (auto mode: { OrderBook::ReadMode::Locking, OrderBook::ReadMode::Snapshot })
+		{
+			uint64_t reads { 0 };
+			const auto latencies { Run(input, cp, mode, readers, reads) };
+			std::cout << std::setw(4) << readers << " readers  " << std::left << std::setw(10)
+					  << (mode == OrderBook::ReadMode::Locking ? "locking" : "snapshot") << std::right
+					  << " writer p50 " << std::setw(8) << Percentile(latencies, 0.5) << " ns"
+					  << "  p99 " << std::setw(8) << Percentile(latencies, 0.99) << " ns"
+					  << "  p99.9 " << std::setw(9) << Percentile(latencies, 0.999) << " ns"
+					  << "  reads " << std::setw(10) << reads << std::endl;
+		}
+	}
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+	if (argc > 2)
+	{
+		const UTILS::CurrencyPair cp { argv[2] };
+		const auto stream { BENCH::LoadDepthStream(argv[1], cp) };
+		if (stream.empty())
+		{
+			std::cerr << "No depth events read from " << argv[1] << std::endl;
+			return 1;
+		}
+		Report(argv[1], stream, cp);
+	}
+	else
+	{
+		const UTILS::CurrencyPair cp { "BTC/USD" };
+		for (int64_t depth: { 20, 200 })
+		{
+			Report("synthetic, depth " + std::to_string(depth), BENCH::GenerateDepthStream(20000, depth), cp);
+		}
+	}
+	return 0;
+}
@@ -3,10 +3,13 @@
 //
 #include <gtest/gtest.h>
 
+#include "ActiveQuoteTable.h"
 #include "Tools.h"
 #include "Crypto.h"
 #include "JSONDocument.h"
 
+#include "TestHelpers.h"
+
 namespace TEST {
 //----------------------------------------------------------------------------
 TEST(COMMON, Test_CreateEmptyExecutionReportData)
@@ -110,4 +113,83 @@ TEST(COMMON, Test_ParseJSONMessageWithCode_BadJson_CodeMissing)
 	ASSERT_EQ(0, state.code);
 	ASSERT_EQ(std::string("yay"), state.msg);
 }
-} // ns
\ No newline at end of file
+
+//----------------------------------------------------------------------------
+TEST(COMMON, Test_ActiveQuoteTable_KeyedByInstrumentSideAndPrice)
+{
+	// Arrange
+	using CORE::ActiveQuoteTable;
+	const UTILS::CurrencyPair eur { "EUR/USD" };
+	const UTILS::CurrencyPair gbp { "GBP/USD" };
+	const UTILS::QuoteType bid { UTILS::QuoteType::BID };
+	const UTILS::QuoteType offer { UTILS::QuoteType::OFFER };
+	ActiveQuoteTable table;
+	ActiveQuoteTable::QuoteInfo info { };
+
+	// Act
+	const bool replacedNew { table.ReplaceQuoteInfo(eur, bid, 110250, { 1, eur, bid, 0, 0, 0 }, &info) };
+	table.ReplaceQuoteInfo(gbp, bid, 110250, { 2, gbp, bid, 0, 0, 0 });
+	table.ReplaceQuoteInfo(eur, offer, 110250, { 3, eur, offer, 0, 0, 0 });
+	const bool replacedOld { table.ReplaceQuoteInfo(eur, bid, 110250, { 4, eur, bid, 0, 0, 0 }, &info) };
+
+	// Check
+	ASSERT_FALSE(ActiveQuoteTable::CanIdentify(UTILS::CurrencyPair { }, bid, 110250));
+	ASSERT_FALSE(ActiveQuoteTable::CanIdentify(eur, UTILS::QuoteType { }, 110250));
+	ASSERT_FALSE(ActiveQuoteTable::CanIdentify(eur, bid, -1));
+	ASSERT_FALSE(ActiveQuoteTable::CanIdentify(eur, bid, int64_t(1) << ActiveQuoteTable::PRICE_BITS));
+	ASSERT_FALSE(table.ReplaceQuoteInfo(eur, bid, -1, { 5, eur, bid, 0, 0, 0 }));
+	ASSERT_FALSE(table.FindQuoteInfo(eur, bid, 110251, info));
+	ASSERT_FALSE(replacedNew);
+	ASSERT_TRUE(replacedOld);
+	ASSERT_EQ(1, info.key);
+	ASSERT_TRUE(table.FindQuoteInfo(eur, bid, 110250, info));
+	ASSERT_EQ(4, info.key);
+	ASSERT_EQ(4, info.oriKey);
+	ASSERT_EQ(eur, info.cp);
+	ASSERT_TRUE(info.entryType.Bid());
+
+	std::vector<int64_t> removedKeys;
+	table.RemoveOldQuoteInfos(3, [&removedKeys](const ActiveQuoteTable::QuoteInfo &quoteInfo) { removedKeys.push_back(quoteInfo.key); });
+	ASSERT_EQ(std::vector<int64_t> { 2 }, removedKeys);
+	ASSERT_TRUE(table.RemoveQuoteInfo(eur, bid, 110250, &info));
+	ASSERT_EQ(4, info.key);
+	ASSERT_FALSE(table.RemoveQuoteInfo(eur, bid, 110250));
+	ASSERT_FALSE(table.Empty());
+	ASSERT_TRUE(table.RemoveQuoteInfo(eur, offer, 110250));
+	ASSERT_TRUE(table.Empty());
+}
+
+//----------------------------------------------------------------------------
+TEST(COMMON, Test_ActiveQuoteTable_KeyedCryptoPairs)
+{
+	// Arrange
+	// (the crypto currencies of the config have ids from 1001 upward)
+	using CORE::ActiveQuoteTable;
+	RegisterTestCurrencies();
+	const UTILS::CurrencyPair btc { "BTC/USDT" };
+	const UTILS::CurrencyPair bnb { "BNB/USDT" };
+	const UTILS::QuoteType bid { UTILS::QuoteType::BID };
+	const int64_t price { btc.DblToCpip(21921.73) };
+	ActiveQuoteTable table;
+	ActiveQuoteTable::QuoteInfo info { };
+
+	// Act
+	const bool replacedNew { table.ReplaceQuoteInfo(btc, bid, price, { 1, btc, bid, 0, 0, 0 }) };
+	table.ReplaceQuoteInfo(bnb, bid, price, { 2, bnb, bid, 0, 0, 0 });
+	const bool replacedOld { table.ReplaceQuoteInfo(btc, bid, price, { 3, btc, bid, 0, 0, 0 }, &info) };
+
+	// Check
+	ASSERT_TRUE(btc.Valid());
+	ASSERT_GT(uint(btc.BaseCCY()), 0xFFu);
+	ASSERT_TRUE(ActiveQuoteTable::CanIdentify(btc, bid, price));
+	ASSERT_FALSE(replacedNew);
+	ASSERT_TRUE(replacedOld);
+	ASSERT_EQ(1, info.key);
+	ASSERT_TRUE(table.FindQuoteInfo(bnb, bid, price, info));
+	ASSERT_EQ(2, info.key);
+	ASSERT_TRUE(table.RemoveQuoteInfo(btc, bid, price, &info));
+	ASSERT_EQ(3, info.key);
+	ASSERT_TRUE(table.RemoveQuoteInfo(bnb, bid, price));
+	ASSERT_TRUE(table.Empty());
+}
+} // ns
@@ -1,3 +1,5 @@
+#include <map>
+#include <numeric>
 #include <gtest/gtest.h>
 #include "binance/ConnectionMD.h"
 #include "JSONDocument.h"
@@ -86,6 +88,36 @@ TEST(MessageProcessor, Test_Enqueue_HandlerCalledWhenEnqueued)
 }
 
 
+//--------------------------------------------------------------------------
+TEST(MessageProcessor, Test_Enqueue_SlabReturnedAfterHandling)
+{
+	// Arrange
+	MessageProcessor mp;
+	auto pool = UTILS::FrameSlabPool::Create(1, 1024);
+	auto slab = pool->Acquire();
+	std::copy(TestJSON.begin(), TestJSON.end(), slab->Data());
+	slab->SetSize(TestJSON.size());
+	const char *frame { slab->Data() };
+	UTILS::CEvent called;
+	mp.Start();
+	
+	// Act
+	auto jd = JSONDocument::FromSlab(std::move(slab));
+	ASSERT_TRUE(mp.Enqueue(jd, [frame, &called](const std::shared_ptr<JSONDocument> doc)
+	{
+		EXPECT_EQ(frame, doc->Text().data()); // the frame is not copied
+		EXPECT_EQ(100, doc->GetValue<int>("age"));
+		called.Set();
+	}));
+	jd.reset();
+	
+	// Check
+	ASSERT_TRUE(called.Wait(1000));
+	mp.Stop();
+	ASSERT_EQ(1u, pool->Available()); // the slab is back once the handler is done
+}
+
+
 //--------------------------------------------------------------------------
 TEST(MessageProcessor, Test_Enqueue_FailsWithNullMessage)
 {
@@ -198,4 +230,63 @@ TEST(MessageProcessor, Test_ProcessMessage_Fails_WithNullMessage)
 	ASSERT_EQ("NULL message", res.ErrorMessage());
 }
 
-} // ns TEST
\ No newline at end of file
+
+//--------------------------------------------------------------------------
+TEST(MessageProcessor, Test_Enqueue_SequenceTags_OrderedPerTagAndParallelAcrossTags)
+{
+	// Arrange
+	MessageProcessor mp;
+	auto jd = std::make_shared<JSONDocument>(TestJSON);
+	const int count { 100 };
+	std::mutex mutex;
+	std::map<std::string, std::vector<int>> handled; // order in which the messages of each tag were handled
+	UTILS::CEvent startedA;
+	UTILS::CEvent startedB;
+	std::atomic<bool> overlapped { true };
+	std::atomic<int> remaining { 2 * count };
+	UTILS::CEvent done;
+	mp.Start(4);
+	auto handler = [&](const std::string &tag, int i)
+	{
+		return [&, tag, i](const std::shared_ptr<JSONDocument>)
+		{
+			if (i == 0)
+			{
+				// the first message of each tag waits for the first one of the other tag,
+				// which only returns if the two tags are handled at the same time
+				(tag == "A" ? startedA : startedB).Set();
+				if (!(tag == "A" ? startedB : startedA).Wait(1000))
+				{
+					overlapped = false;
+				}
+			}
+			{
+				std::lock_guard lock { mutex };
+				handled[tag].push_back(i);
+			}
+			if (--remaining == 0)
+			{
+				done.Set();
+			}
+		};
+	};
+	
+	// Act
+	// (the messages of the two tags are interleaved)
+	for (int i { 0 }; i < count; ++i)
+	{
+		ASSERT_TRUE(mp.Enqueue(jd, handler("A", i), "A"));
+		ASSERT_TRUE(mp.Enqueue(jd, handler("B", i), "B"));
+	}
+	
+	// Check
+	ASSERT_TRUE(done.Wait(5000));
+	mp.Stop();
+	ASSERT_TRUE(overlapped); // different tags are handled in parallel
+	std::vector<int> expected(count);
+	std::iota(expected.begin(), expected.end(), 0);
+	ASSERT_EQ(expected, handled["A"]); // messages of one tag are handled in order
+	ASSERT_EQ(expected, handled["B"]);
+}
+
+} // ns TEST
@@ -0,0 +1,110 @@
+#include <thread>
+#include <gtest/gtest.h>
+#include <Utils/FixTypes.h>
+#include "OKX/ConnectionMD.h"
+#include "ConnectionManager.h"
+#include "SchemaDefs.h"
+
+#include "TestHelpers.h"
+
+namespace TEST::OKX {
+
+/*! \brief OKX market data connection receiving messages without a websocket */
+class TestConnectionMD : public CORE::OKX::ConnectionMD
+{
+public:
+	using CORE::OKX::ConnectionMD::ConnectionMD;
+
+	// Access to protected method for testing
+	CORE::CRYPTO::MessageProcessor &GetMessageProcessor()
+	{
+		return ConnectionMD::GetMessageProcessor();
+	}
+
+	/*! \brief Handles a message and waits until the handler of the instrument has finished */
+	bool Receive(const std::string &json)
+	{
+		if (!GetMessageProcessor().ProcessMessage(std::make_shared<CORE::CRYPTO::JSONDocument>(json)))
+		{
+			return false;
+		}
+		// the messages of one instrument are handled in order, so the marker runs after the message's handler
+		UTILS::CEvent handled;
+		GetMessageProcessor().Enqueue(std::make_shared<CORE::CRYPTO::JSONDocument>(std::string("{}")),
+									  [&handled](const std::shared_ptr<CORE::CRYPTO::JSONDocument>) { handled.Set(); }, "BTC-USDT");
+		return handled.Wait(1000);
+	}
+};
+
+std::string BooksMessage(const std::string &action, const std::string &bids, const std::string &asks)
+{
+	return R"({"arg":{"channel":"books","instId":"BTC-USDT"},"action":")" + action + R"(","data":[{"asks":[)" + asks
+		   + R"(],"bids":[)" + bids + R"(],"ts":"1597026383085","checksum":0}]})";
+}
+
+//--------------------------------------------------------------------------
+TEST(OKXConnection, Test_TwoSidedUpdate_NotifiesOnce)
+{
+	// Arrange
+	RegisterTestCurrencies();
+	CORE::ConnectionManager manager(ConfigPath, LoggingProperties, std::make_shared<CORE::BOOK::ConsolidatedBook>());
+	CORE::CRYPTO::Settings settings;
+	settings.m_name = "OKX_MD_TEST";
+	settings.m_schema = CORE::OKX::SCHEMAMD;
+	settings.m_instruments = "BTC-USDT";
+	TestConnectionMD conn(settings, LoggingProperties, manager);
+	std::atomic<int> midChanges { 0 };
+	conn.GetOrderBook()->Initialise([&midChanges]() { ++midChanges; });
+	conn.GetMessageProcessor().Start();
+	const UTILS::CurrencyPair cp { "BTC/USDT" };
+
+	ASSERT_TRUE(conn.Receive(BooksMessage("snapshot", R"(["100.0","1","0","1"],["99.0","2","0","1"])",
+										  R"(["101.0","1","0","1"],["102.0","2","0","1"])")));
+	const int afterSnapshot { midChanges };
+
+	// Act
+	// (the new best bid and the new best ask each move the mid price)
+	ASSERT_TRUE(conn.Receive(BooksMessage("update", R"(["100.5","1","0","1"])", R"(["100.8","1","0","1"])")));
+
+	// Check
+	const auto top { conn.GetOrderBook()->GetTopOfBook(cp).Read() };
+	ASSERT_EQ(cp.DblToCpip(100.5), top.bidPrice);
+	ASSERT_EQ(cp.DblToCpip(100.8), top.askPrice);
+	ASSERT_EQ(1, afterSnapshot);
+	ASSERT_EQ(afterSnapshot + 1, midChanges); // one notification for the whole message
+	conn.GetMessageProcessor().Stop();
+}
+
+//--------------------------------------------------------------------------
+TEST(OKXConnection, Test_StaleLevels_AgeOut)
+{
+	// Arrange
+	RegisterTestCurrencies();
+	CORE::ConnectionManager manager(ConfigPath, LoggingProperties, std::make_shared<CORE::BOOK::ConsolidatedBook>());
+	CORE::CRYPTO::Settings settings;
+	settings.m_name = "OKX_MD_TEST";
+	settings.m_schema = CORE::OKX::SCHEMAMD;
+	settings.m_instruments = "BTC-USDT";
+	settings.m_parameters[CORE::CRYPTO::PARAM_ATTR_MaxQuoteAge] = "50ms";
+	settings.m_parameters[CORE::CRYPTO::PARAM_ATTR_CleanupInterval] = "10ms";
+	TestConnectionMD conn(settings, LoggingProperties, manager);
+	conn.GetMessageProcessor().Start();
+	const UTILS::CurrencyPair cp { "BTC/USDT" };
+
+	// Act
+	// (the feed sends nothing after the snapshot)
+	ASSERT_TRUE(conn.Receive(BooksMessage("snapshot", R"(["100.0","1","0","1"])", R"(["101.0","1","0","1"])")));
+	const auto before { conn.GetOrderBook()->GetTopOfBook(cp).Read() };
+	std::this_thread::sleep_for(std::chrono::milliseconds(300));
+
+	// Check
+	const auto after { conn.GetOrderBook()->GetTopOfBook(cp).Read() };
+	ASSERT_EQ(cp.DblToCpip(100.0), before.bidPrice);
+	ASSERT_EQ(cp.DblToCpip(101.0), before.askPrice);
+	ASSERT_EQ(0u, conn.GetOrderBook()->GetQuoteCount(cp, true));
+	ASSERT_EQ(0u, conn.GetOrderBook()->GetQuoteCount(cp, false));
+	ASSERT_EQ(0, after.bidPrice);
+	conn.GetMessageProcessor().Stop();
+}
+
+} // ns TEST::OKX
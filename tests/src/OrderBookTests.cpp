@@ -0,0 +1,1367 @@
+#include <condition_variable>
+#include <filesystem>
+#include <map>
+#include <mutex>
+#include <random>
+#include <set>
+#include <thread>
+
+#include <gtest/gtest.h>
+
+#include "OrderBook/BookCheckpoint.h"
+#include "OrderBook/ConsolidatedBook.h"
+#include "OrderBook/DepthIndex.h"
+#include "OrderBook/ExpiryWheel.h"
+#include "OrderBook/FilterView.h"
+#include "OrderBook/L2Ladder.h"
+#include "OrderBook/LevelArrays.h"
+#include "OrderBook/OrderBook.h"
+#include "OrderBook/PriceLadder.h"
+#include "OrderBook/ShmBookReader.h"
+#include "OrderBook/ShmPublisher.h"
+#include "OrderBook/SortView.h"
+
+using namespace CORE::BOOK;
+
+namespace TEST {
+
+namespace {
+
+Quote::Ptr MakeQuote(int64_t price, int64_t volume, int64_t key, int64_t refKey = 0, int quoteType = QT_NEW)
+{
+	return Quote::Create(0, 0, 0, "", 1, price, volume, 0, key, refKey, 0, quoteType, 0, "", "");
+}
+
+UTILS::BookUpdate::Entry MakeEntry(bool bid, double price, double volume, int64_t updateType = QT_NEW)
+{
+	const UTILS::CurrencyPair cp { "EUR/USD" }; // scales of all instruments of the tests
+	UTILS::BookUpdate::Entry entry;
+	entry.entryType = bid ? UTILS::QuoteType::BID : UTILS::QuoteType::OFFER;
+	entry.price = cp.DblToCpip(price);
+	entry.volume = cp.DoubleToQty(volume);
+	entry.updateType = updateType;
+	return entry;
+}
+
+} // namespace
+
+//----------------------------------------------------------------------------
+TEST(PRICELADDER, Test_LevelsSortedBestFirst)
+{
+	// Arrange
+	PriceLadder bids { true };
+	PriceLadder asks { false };
+
+	// Act
+	for (int64_t price: { 100, 102, 101 })
+	{
+		bids.Insert(MakeQuote(price, 1, price));
+		asks.Insert(MakeQuote(price, 1, price));
+	}
+
+	// Check
+	std::vector<int64_t> bidPrices;
+	std::vector<int64_t> askPrices;
+	bids.ForEachLevel([&bidPrices](const PriceLadder::Level &level, bool &) { bidPrices.push_back(level.price); });
+	asks.ForEachLevel([&askPrices](const PriceLadder::Level &level, bool &) { askPrices.push_back(level.price); });
+	ASSERT_EQ(std::vector<int64_t>({ 102, 101, 100 }), bidPrices);
+	ASSERT_EQ(std::vector<int64_t>({ 100, 101, 102 }), askPrices);
+	ASSERT_EQ(102, bids.BestLevel()->price);
+	ASSERT_EQ(100, asks.BestLevel()->price);
+}
+
+//----------------------------------------------------------------------------
+TEST(PRICELADDER, Test_SamePriceGreaterVolumeFirst)
+{
+	// Arrange
+	PriceLadder ladder { true };
+
+	// Act
+	ladder.Insert(MakeQuote(100, 5, 1));
+	ladder.Insert(MakeQuote(100, 7, 2));
+	ladder.Insert(MakeQuote(100, 5, 3));
+
+	// Check
+	std::vector<int64_t> keys;
+	ladder.ForEachQuote([&keys](const Quote::Ptr &q, bool &) { keys.push_back(q->Key()); });
+	ASSERT_EQ(std::vector<int64_t>({ 2, 3, 1 }), keys);
+	ASSERT_EQ(1u, ladder.LevelCount());
+	ASSERT_EQ(3u, ladder.QuoteCount());
+}
+
+//----------------------------------------------------------------------------
+TEST(PRICELADDER, Test_RemoveByKey)
+{
+	// Arrange
+	PriceLadder ladder { false };
+	ladder.Insert(MakeQuote(100, 1, 1));
+	ladder.Insert(MakeQuote(101, 1, 2));
+
+	// Act
+	const Quote::Ptr removed { ladder.Remove(1) };
+
+	// Check
+	ASSERT_TRUE(removed);
+	ASSERT_EQ(1, removed->Key());
+	ASSERT_EQ(nullptr, ladder.Remove(1));
+	ASSERT_EQ(nullptr, ladder.Find(1));
+	ASSERT_EQ(1u, ladder.LevelCount());
+	ASSERT_EQ(101, ladder.BestLevel()->price);
+}
+
+//----------------------------------------------------------------------------
+TEST(PRICELADDER, Test_IndexConsistentUnderChurn)
+{
+	// Arrange
+	PriceLadder ladder { true };
+	std::map<int64_t, int64_t> live; // key -> price
+	std::mt19937_64 rng { 7 };
+	int64_t nextKey { 1 };
+
+	// Act / Check
+	for (int i = 0; i < 50000; ++i)
+	{
+		const auto action { rng() % 3 };
+		if (live.empty() || action == 0) // new
+		{
+			const int64_t price { 1000 + int64_t(rng() % 200) };
+			ladder.Insert(MakeQuote(price, int64_t(rng() % 10), nextKey));
+			live.emplace(nextKey++, price);
+		}
+		else
+		{
+			auto it { live.begin() };
+			std::advance(it, rng() % live.size());
+			const int64_t refKey { it->first };
+			const Quote::Ptr removed { ladder.Remove(refKey) };
+			ASSERT_TRUE(removed);
+			ASSERT_EQ(it->second, removed->Price());
+			live.erase(it);
+			if (action == 1) // update: replace referenced quote
+			{
+				const int64_t price { 1000 + int64_t(rng() % 200) };
+				ladder.Insert(MakeQuote(price, int64_t(rng() % 10), nextKey, refKey, QT_UPDATE));
+				live.emplace(nextKey++, price);
+			}
+		}
+		ASSERT_TRUE(ladder.CheckIndex()) << "iteration " << i;
+		ASSERT_EQ(live.size(), ladder.QuoteCount());
+	}
+	for (const auto &it: live)
+	{
+		const Quote::Ptr q { ladder.Find(it.first) };
+		ASSERT_TRUE(q);
+		ASSERT_EQ(it.second, q->Price());
+	}
+	ASSERT_EQ(nullptr, ladder.Find(nextKey));
+}
+
+//----------------------------------------------------------------------------
+TEST(ORDERBOOK, Test_UpdateAndDeleteByRefKey)
+{
+	// Arrange
+	OrderBook book;
+	book.Initialise([] { });
+	const UTILS::CurrencyPair cp { "EUR/USD" };
+	book.AddEntry(1, 0, 0, 0, cp, MakeEntry(true, 1.1, 1.0));
+	book.AddEntry(2, 0, 0, 0, cp, MakeEntry(true, 1.2, 1.0));
+	book.AddEntry(3, 0, 0, 0, cp, MakeEntry(false, 1.3, 1.0));
+
+	// Act
+	book.AddEntry(4, 2, 0, 0, cp, MakeEntry(true, 1.05, 2.0, QT_UPDATE));
+	book.AddEntry(5, 3, 0, 0, cp, MakeEntry(false, 1.3, 0.0, QT_DELETE));
+
+	// Check
+	ASSERT_EQ(2u, book.GetQuoteCount(cp, true));
+	ASSERT_EQ(0u, book.GetQuoteCount(cp, false));
+	ASSERT_EQ(cp.DblToCpip(1.1), book.GetBestPrice(cp, true));
+	ASSERT_EQ(0, book.GetBestPrice(cp, false));
+	const auto levels { book.GetLevels(cp, true, 0) };
+	ASSERT_EQ(2u, levels.size());
+	ASSERT_EQ(cp.DblToCpip(1.05), levels[1]->MinPrice());
+}
+
+//----------------------------------------------------------------------------
+TEST(ORDERBOOK, Test_GetLevelsGroupsQuotesByPrice)
+{
+	// Arrange
+	OrderBook book;
+	book.Initialise([] { });
+	const UTILS::CurrencyPair cp { "EUR/USD" };
+	book.AddEntry(1, 0, 0, 0, cp, MakeEntry(false, 1.3, 1.0));
+	book.AddEntry(2, 0, 0, 0, cp, MakeEntry(false, 1.3, 2.0));
+	book.AddEntry(3, 0, 0, 0, cp, MakeEntry(false, 1.4, 1.0));
+	book.AddEntry(4, 0, 0, 0, cp, MakeEntry(false, 1.5, 1.0));
+
+	// Act
+	const auto levels { book.GetLevels(cp, false, 2) };
+
+	// Check
+	ASSERT_EQ(2u, levels.size());
+	ASSERT_EQ(2u, levels[0]->QuoteCount());
+	ASSERT_EQ(cp.DblToCpip(1.3), levels[0]->MinPrice());
+	ASSERT_EQ(cp.DoubleToQty(3.0), levels[0]->TotalVolume());
+	ASSERT_EQ(cp.DblToCpip(1.4), levels[1]->MinPrice());
+}
+
+//----------------------------------------------------------------------------
+TEST(ORDERBOOK, Test_UpdateDeleteChurnKeepsBookConsistent)
+{
+	// Arrange
+	OrderBook book;
+	book.Initialise([] { });
+	const UTILS::CurrencyPair cp { "EUR/USD" };
+	std::map<int64_t, std::pair<bool, double>> live; // key -> side, price
+	std::mt19937_64 rng { 11 };
+	int64_t nextKey { 1 };
+
+	// Act
+	for (int i = 0; i < 20000; ++i)
+	{
+		const bool bid { (rng() & 1) != 0 };
+		const double price { bid ? 1.1 - double(rng() % 100) * 0.0001 : 1.2 + double(rng() % 100) * 0.0001 };
+		if (live.empty() || rng() % 3 == 0)
+		{
+			book.AddEntry(nextKey, 0, 0, 0, cp, MakeEntry(bid, price, 1.0));
+			live.emplace(nextKey++, std::make_pair(bid, price));
+			continue;
+		}
+		auto it { live.begin() };
+		std::advance(it, rng() % live.size());
+		const int64_t refKey { it->first };
+		const bool refBid { it->second.first };
+		live.erase(it);
+		if (rng() & 1)
+		{
+			book.AddEntry(nextKey, refKey, 0, 0, cp, MakeEntry(refBid, price, 2.0, QT_UPDATE));
+			live.emplace(nextKey++, std::make_pair(refBid, price));
+		}
+		else
+		{
+			book.AddEntry(nextKey++, refKey, 0, 0, cp, MakeEntry(refBid, 0.0, 0.0, QT_DELETE));
+		}
+	}
+
+	// Check
+	for (bool bid: { true, false })
+	{
+		std::multiset<int64_t> expected;
+		for (const auto &it: live)
+		{
+			if (it.second.first == bid)
+			{
+				expected.insert(cp.DblToCpip(it.second.second));
+			}
+		}
+		std::multiset<int64_t> actual;
+		int64_t prev { 0 };
+		bool sorted { true };
+		book.IterateQuotes(cp, bid, [&](const Quote::Ptr &q, bool &)
+		{
+			sorted = sorted && (prev == 0 || (bid ? q->Price() <= prev : q->Price() >= prev));
+			prev = q->Price();
+			actual.insert(q->Price());
+		});
+		ASSERT_TRUE(sorted);
+		ASSERT_EQ(expected, actual);
+		ASSERT_EQ(expected.size(), book.GetQuoteCount(cp, bid));
+	}
+}
+
+//----------------------------------------------------------------------------
+TEST(TOPOFBOOK, Test_PublishAndRead)
+{
+	// Arrange
+	TopOfBook top;
+
+	// Act
+	const auto before { top.Publish(true, 100, 5, 1) };
+	top.Publish(false, 104, 7, 2);
+	const auto snapshot { top.Read() };
+
+	// Check
+	ASSERT_EQ(0, before.MidPrice());
+	ASSERT_EQ(100, snapshot.bidPrice);
+	ASSERT_EQ(5, snapshot.bidSize);
+	ASSERT_EQ(104, snapshot.askPrice);
+	ASSERT_EQ(7, snapshot.askSize);
+	ASSERT_EQ(2u, snapshot.sequence);
+	ASSERT_EQ(2, snapshot.timestamp);
+	ASSERT_EQ(102, snapshot.MidPrice());
+	ASSERT_EQ(0u, alignof(TopOfBook) % 64);
+}
+
+//----------------------------------------------------------------------------
+TEST(TOPOFBOOK, Test_ReadersNeverSeeTornRecord)
+{
+	// Arrange
+	TopOfBook top;
+	std::atomic_bool done { false };
+	std::atomic_int torn { 0 };
+	std::vector<std::thread> readers;
+	for (int i = 0; i < 3; ++i)
+	{
+		readers.emplace_back([&top, &done, &torn]()
+		{
+			while (!done)
+			{
+				const auto snapshot { top.Read() };
+				if (snapshot.bidSize != snapshot.bidPrice * 2 || snapshot.askSize != snapshot.askPrice * 2)
+				{
+					++torn;
+				}
+			}
+		});
+	}
+
+	// Act
+	for (int64_t i = 1; i <= 200000; ++i)
+	{
+		top.Publish((i & 1) != 0, i, i * 2, i);
+	}
+	done = true;
+	for (auto &reader: readers)
+	{
+		reader.join();
+	}
+
+	// Check
+	ASSERT_EQ(0, torn);
+	ASSERT_EQ(200000u, top.Read().sequence);
+}
+
+//----------------------------------------------------------------------------
+TEST(ORDERBOOK, Test_TopOfBookFollowsBestLevels)
+{
+	// Arrange
+	OrderBook book;
+	int midChanges { 0 };
+	book.Initialise([&midChanges] { ++midChanges; });
+	const UTILS::CurrencyPair cp { "EUR/USD" };
+	const TopOfBook &top { book.GetTopOfBook(cp) };
+
+	// Act
+	book.AddEntry(1, 0, 0, 0, cp, MakeEntry(true, 1.1, 1.0));
+	book.AddEntry(2, 0, 0, 0, cp, MakeEntry(true, 1.1, 2.0));
+	book.AddEntry(3, 0, 0, 0, cp, MakeEntry(false, 1.3, 1.0));
+	book.AddEntry(4, 0, 0, 0, cp, MakeEntry(true, 1.0, 1.0));
+	const auto snapshot { top.Read() };
+	book.AddEntry(5, 1, 0, 0, cp, MakeEntry(true, 0.0, 0.0, QT_DELETE));
+	book.AddEntry(6, 2, 0, 0, cp, MakeEntry(true, 0.0, 0.0, QT_DELETE));
+
+	// Check
+	ASSERT_EQ(cp.DblToCpip(1.1), snapshot.bidPrice);
+	ASSERT_EQ(cp.DoubleToQty(3.0), snapshot.bidSize);
+	ASSERT_EQ(cp.DblToCpip(1.3), snapshot.askPrice);
+	ASSERT_EQ(cp.DblToCpip(1.0), top.Read().bidPrice);
+	ASSERT_EQ(book.GetMidPrice(cp), top.Read().MidPrice());
+	ASSERT_EQ(2, midChanges); // first two-sided mid, then bid level 1.1 removed
+	book.Clear();
+	ASSERT_EQ(0, top.Read().MidPrice());
+	ASSERT_EQ(0, book.GetBestPrice(cp, true));
+}
+
+//----------------------------------------------------------------------------
+TEST(ORDERBOOK, Test_TopOfBookPublishesSignals)
+{
+	// Arrange
+	OrderBook book;
+	const UTILS::CurrencyPair cp { "EUR/USD" };
+	book.SetBookMode(cp, InstrumentBook::Mode::Levels);
+	book.SetSignalDepth(cp, 2);
+	const TopOfBook &top { book.GetTopOfBook(cp) };
+
+	// Act
+	book.AddEntry(0, 0, 0, 0, cp, MakeEntry(true, 1.10, 1.0));
+	book.AddEntry(0, 0, 0, 0, cp, MakeEntry(true, 1.09, 2.0));
+	book.AddEntry(0, 0, 0, 0, cp, MakeEntry(true, 1.08, 4.0));
+	book.AddEntry(0, 0, 0, 0, cp, MakeEntry(false, 1.12, 3.0));
+	book.AddEntry(0, 0, 0, 0, cp, MakeEntry(false, 1.13, 1.0));
+	const TopOfBook::Snapshot signals { top.Read() };
+	book.SetSignalDepth(cp, 1);
+	const TopOfBook::Snapshot bestOnly { top.Read() };
+
+	// Check
+	ASSERT_EQ(cp.DblToCpip(1.12) - cp.DblToCpip(1.10), signals.Spread());
+	ASSERT_EQ(cp.DoubleToQty(3.0), signals.bidDepth);
+	ASSERT_EQ(cp.DoubleToQty(4.0), signals.askDepth);
+	ASSERT_DOUBLE_EQ(-1.0 / 7.0, signals.Imbalance());
+	ASSERT_EQ(cp.DblToCpip(1.105), signals.MicroPrice()); // (1.10 * 3 + 1.12 * 1) / 4
+	ASSERT_EQ(cp.DoubleToQty(1.0), bestOnly.bidDepth);
+	ASSERT_DOUBLE_EQ(-0.5, bestOnly.Imbalance());
+}
+
+//----------------------------------------------------------------------------
+TEST(ORDERBOOK, Test_InstrumentHandleIsStable)
+{
+	// Arrange
+	OrderBook book;
+	book.Initialise([] { });
+	const UTILS::CurrencyPair cp { "EUR/USD" };
+	const InstrumentBook::Ptr handle { book.AddInstrument(cp) };
+
+	// Act
+	book.AddEntry(*handle, 1, 0, 0, 0, MakeEntry(true, 1.1, 1.0));
+	book.AddEntry(*handle, 2, 0, 0, 0, MakeEntry(false, 1.2, 1.0));
+	book.AddEntry(3, 0, 0, 0, UTILS::CurrencyPair { "GBP/USD" }, MakeEntry(true, 1.3, 1.0));
+	book.Clear();
+	book.AddEntry(*handle, 4, 0, 0, 0, MakeEntry(true, 1.0, 1.0));
+
+	// Check
+	ASSERT_EQ(handle, book.AddInstrument(cp));
+	ASSERT_EQ(handle, book.FindInstrument(cp));
+	ASSERT_EQ(nullptr, book.FindInstrument(UTILS::CurrencyPair { "USD/JPY" }));
+	ASSERT_EQ(cp, handle->Instrument());
+	ASSERT_EQ(1u, book.GetQuoteCount(cp, true));
+	ASSERT_EQ(0u, book.GetQuoteCount(cp, false));
+	ASSERT_EQ(cp.DblToCpip(1.0), book.GetBestPrice(cp, true));
+	ASSERT_EQ(0u, book.GetQuoteCount(UTILS::CurrencyPair { "GBP/USD" }, true));
+}
+
+//----------------------------------------------------------------------------
+TEST(ORDERBOOK, Test_SnapshotReadersSeeCompleteMessages)
+{
+	// Arrange
+	OrderBook book;
+	book.Initialise([] { });
+	const UTILS::CurrencyPair cp { "EUR/USD" };
+	book.AddEntry(1, 0, 0, 0, cp, MakeEntry(true, 1.1, 1.0));
+	book.SetReadMode(OrderBook::ReadMode::Snapshot);
+	auto entry { MakeEntry(true, 1.2, 1.0) };
+
+	// Act
+	book.AddEntry(2, 0, 0, 0, cp, entry);
+	const size_t countBeforeEnd { book.GetQuoteCount(cp, true) };
+	entry.price = cp.DblToCpip(1.3);
+	entry.endOfMessage = true;
+	book.AddEntry(3, 0, 0, 0, cp, entry);
+
+	// Check
+	ASSERT_EQ(1u, countBeforeEnd);
+	ASSERT_EQ(3u, book.GetQuoteCount(cp, true));
+	std::vector<int64_t> prices;
+	book.IterateQuotes(cp, true, [&prices](const Quote::Ptr &q, bool &) { prices.push_back(q->Price()); });
+	ASSERT_EQ(std::vector<int64_t>({ cp.DblToCpip(1.3), cp.DblToCpip(1.2), cp.DblToCpip(1.1) }), prices);
+	ASSERT_EQ(3u, book.GetLevels(cp, true, 0).size());
+	book.Clear();
+	ASSERT_EQ(0u, book.GetQuoteCount(cp, true));
+}
+
+//----------------------------------------------------------------------------
+TEST(ORDERBOOK, Test_SnapshotReadersDuringFeed)
+{
+	// Arrange
+	OrderBook book;
+	book.Initialise([] { });
+	book.SetReadMode(OrderBook::ReadMode::Snapshot);
+	const UTILS::CurrencyPair cp { "EUR/USD" };
+	const InstrumentBook::Ptr handle { book.AddInstrument(cp) };
+	std::atomic_bool done { false };
+	std::atomic<int> unsorted { 0 };
+	std::vector<std::thread> readers;
+	for (int i = 0; i < 4; ++i)
+	{
+		readers.emplace_back([&book, &done, &unsorted, cp]
+		{
+			while (!done)
+			{
+				int64_t last { INT64_MAX };
+				book.IterateQuoteGroups(cp, true, [&last, &unsorted](int, QuoteGroup::Ptr &qg, bool &)
+				{
+					if (qg->MinPrice() >= last)
+					{
+						++unsorted;
+					}
+					last = qg->MinPrice();
+				});
+			}
+		});
+	}
+
+	// Act
+	for (int64_t key = 1; key <= 20000; ++key)
+	{
+		auto entry { MakeEntry(true, 1.0 + double(key % 50) / 1000.0, 1.0, key > 50 ? QT_UPDATE : QT_NEW) };
+		entry.endOfMessage = (key % 5) == 0;
+		book.AddEntry(*handle, key, key > 50 ? key - 50 : 0, 0, 0, entry);
+	}
+	done = true;
+	for (auto &reader: readers)
+	{
+		reader.join();
+	}
+
+	// Check
+	ASSERT_EQ(0, unsorted);
+	ASSERT_EQ(50u, book.GetQuoteCount(cp, true));
+}
+
+//----------------------------------------------------------------------------
+TEST(PRICELADDER, Test_LevelAggregatesFollowQuotes)
+{
+	// Arrange
+	PriceLadder ladder { false };
+	auto quote { [](int64_t volume, int64_t minQty, int64_t key)
+	{
+		return Quote::Create(0, 0, 0, "", 1, 100, volume, minQty, key, 0, 0, QT_NEW, 0, "", "");
+	} };
+
+	// Act
+	ladder.Insert(quote(5, 2, 1));
+	ladder.Insert(quote(7, 1, 2));
+	ladder.Insert(quote(3, 4, 3));
+	const PriceLadder::LevelSummary before { ladder.BestLevel()->Summary() };
+	ladder.Remove(2);
+
+	// Check
+	ASSERT_EQ(15, before.totalVolume);
+	ASSERT_EQ(1, before.minQty);
+	ASSERT_EQ(3u, before.quoteCount);
+	ASSERT_EQ(8, ladder.BestLevel()->totalVolume);
+	ASSERT_EQ(2, ladder.BestLevel()->minQty);
+	ladder.RemoveIf([](const Quote::Ptr &q) { return q->Key() == 1; });
+	ASSERT_EQ(3, ladder.BestLevel()->totalVolume);
+	ASSERT_EQ(4, ladder.BestLevel()->minQty);
+	ASSERT_TRUE(ladder.CheckIndex());
+}
+
+//----------------------------------------------------------------------------
+TEST(ORDERBOOK, Test_GetLevelsIntoBuffer)
+{
+	// Arrange
+	OrderBook book;
+	book.Initialise([] { });
+	const UTILS::CurrencyPair cp { "EUR/USD" };
+	book.AddEntry(1, 0, 0, 0, cp, MakeEntry(true, 1.1, 1.0));
+	book.AddEntry(2, 0, 0, 0, cp, MakeEntry(true, 1.1, 2.0));
+	book.AddEntry(3, 0, 0, 0, cp, MakeEntry(true, 1.0, 4.0));
+	book.AddEntry(4, 0, 0, 0, cp, MakeEntry(true, 0.9, 1.0));
+	PriceLadder::LevelSummary levels[2];
+
+	// Act
+	const size_t count { book.GetLevels(cp, true, levels, 2) };
+
+	// Check
+	ASSERT_EQ(2u, count);
+	ASSERT_EQ(cp.DblToCpip(1.1), levels[0].price);
+	ASSERT_EQ(cp.DoubleToQty(3.0), levels[0].totalVolume);
+	ASSERT_EQ(2u, levels[0].quoteCount);
+	ASSERT_EQ(cp.DblToCpip(1.0), levels[1].price);
+	ASSERT_EQ(cp.DoubleToQty(4.0), levels[1].totalVolume);
+	ASSERT_EQ(0u, book.GetLevels(cp, false, levels, 2));
+	book.SetReadMode(OrderBook::ReadMode::Snapshot);
+	ASSERT_EQ(2u, book.GetLevels(cp, true, levels, 2));
+	ASSERT_EQ(cp.DoubleToQty(3.0), levels[0].totalVolume);
+}
+
+//----------------------------------------------------------------------------
+TEST(DEPTHINDEX, Test_SweepMatchesLevelScan)
+{
+	// Arrange
+	std::mt19937 rng { 11 };
+	for (bool bid: { true, false })
+	{
+		DepthIndex index { bid };
+		std::map<int64_t, int64_t> levels; // price -> volume
+		auto scan { [&levels, bid](int64_t qty)
+		{
+			DepthIndex::FillEstimate result;
+			std::vector<std::pair<int64_t, int64_t>> sorted(levels.begin(), levels.end());
+			if (bid)
+			{
+				std::reverse(sorted.begin(), sorted.end());
+			}
+			for (const auto &level: sorted)
+			{
+				if (result.filledQty < qty && level.second > 0)
+				{
+					const int64_t fill { std::min(level.second, qty - result.filledQty) };
+					result.filledQty += fill;
+					result.notional += double(level.first) * double(fill);
+					result.worstPrice = level.first;
+				}
+			}
+			return result;
+		} };
+
+		// Act
+		for (int i = 0; i < 5000; ++i)
+		{
+			const int64_t price { 1000 + int64_t(rng() % 200) * 5 };
+			const int64_t current { levels[price] };
+			const int64_t volume { int64_t(rng() % 4) == 0 ? 0 : int64_t(rng() % 100) };
+			index.Add(price, volume - current);
+			levels[price] = volume;
+
+			// Check
+			const int64_t qty { int64_t(rng() % 3000) + 1 };
+			const auto expected { scan(qty) };
+			const auto actual { index.CostToFill(qty) };
+			ASSERT_EQ(expected.filledQty, actual.filledQty);
+			ASSERT_EQ(expected.worstPrice, actual.worstPrice);
+			ASSERT_NEAR(expected.notional, actual.notional, 1e-6 * expected.notional + 1e-6);
+			const int64_t limit { 1000 + int64_t(rng() % 200) * 5 };
+			int64_t upTo { 0 };
+			for (const auto &level: levels)
+			{
+				upTo += (bid ? level.first >= limit : level.first <= limit) ? level.second : 0;
+			}
+			ASSERT_EQ(upTo, index.QtyUpToPrice(limit));
+		}
+	}
+}
+
+//----------------------------------------------------------------------------
+TEST(ORDERBOOK, Test_SweepQueries)
+{
+	// Arrange
+	OrderBook book;
+	book.Initialise([] { });
+	const UTILS::CurrencyPair cp { "EUR/USD" };
+	book.AddEntry(1, 0, 0, 0, cp, MakeEntry(false, 1.2, 1.0));
+	book.AddEntry(2, 0, 0, 0, cp, MakeEntry(false, 1.3, 2.0));
+	book.AddEntry(3, 0, 0, 0, cp, MakeEntry(false, 1.4, 4.0));
+	book.AddEntry(4, 2, 0, 0, cp, MakeEntry(false, 0.0, 0.0, QT_DELETE));
+
+	// Act
+	const auto estimate { book.CostToFill(cp, false, cp.DoubleToQty(3.0)) };
+
+	// Check
+	ASSERT_EQ(cp.DoubleToQty(3.0), estimate.filledQty);
+	ASSERT_EQ(cp.DblToCpip(1.4), estimate.worstPrice);
+	ASSERT_EQ((cp.DblToCpip(1.2) + 2 * cp.DblToCpip(1.4)) / 3, estimate.vwap);
+	ASSERT_EQ(estimate.vwap, book.VwapForQty(cp, false, cp.DoubleToQty(3.0)));
+	ASSERT_EQ(0, book.VwapForQty(cp, false, cp.DoubleToQty(6.0)));
+	ASSERT_EQ(cp.DoubleToQty(1.0), book.QtyUpToPrice(cp, false, cp.DblToCpip(1.35)));
+	ASSERT_EQ(cp.DoubleToQty(5.0), book.QtyUpToPrice(cp, false, cp.DblToCpip(1.4)));
+	ASSERT_EQ(0, book.QtyUpToPrice(cp, true, cp.DblToCpip(1.4)));
+}
+
+//----------------------------------------------------------------------------
+TEST(ORDERBOOK, Test_ApplyBatchNotifiesOncePerMessage)
+{
+	// Arrange
+	OrderBook book;
+	int midChanges { 0 };
+	book.Initialise([&midChanges] { ++midChanges; });
+	const UTILS::CurrencyPair cp { "EUR/USD" };
+	auto entry { [cp](bool bid, double price, int64_t key, int64_t refKey, int64_t updateType)
+	{
+		auto result { MakeEntry(bid, price, 1.0, updateType) };
+		result.instrument = cp;
+		result.key = key;
+		result.refKey = refKey;
+		return result;
+	} };
+	UTILS::BookUpdate first;
+	first.entries = { entry(true, 1.1, 1, 0, QT_NEW), entry(false, 1.3, 2, 0, QT_NEW) };
+	UTILS::BookUpdate second;
+	second.entries = { entry(true, 1.2, 3, 1, QT_UPDATE), entry(false, 1.4, 4, 2, QT_UPDATE), entry(false, 1.5, 0, 0, QT_NEW) };
+
+	// Act
+	book.ApplyBatch(first);
+	book.ApplyBatch(*book.AddInstrument(cp), second);
+
+	// Check
+	ASSERT_EQ(2, midChanges);
+	ASSERT_EQ(1u, book.GetQuoteCount(cp, true));
+	ASSERT_EQ(1u, book.GetQuoteCount(cp, false)); // entry without key skipped
+	ASSERT_EQ(cp.DblToCpip(1.2), book.GetBestPrice(cp, true));
+	ASSERT_EQ(cp.DblToCpip(1.4), book.GetBestPrice(cp, false));
+	ASSERT_EQ(4, book.GetLastQuote()->Key());
+}
+
+//----------------------------------------------------------------------------
+TEST(ORDERBOOK, Test_NotifierConflatesWhileSubscriberIsBusy)
+{
+	// Arrange
+	OrderBook book;
+	const UTILS::CurrencyPair cp { "EUR/USD" };
+	std::mutex mutex;
+	std::condition_variable cv;
+	bool release { false };
+	std::vector<int64_t> delivered;
+	book.Notifier().Subscribe([&](UTILS::CurrencyPair, const TopOfBook::Snapshot &top)
+	{
+		std::unique_lock lock { mutex };
+		delivered.push_back(top.bidPrice);
+		cv.notify_all();
+		cv.wait(lock, [&release] { return release; }); // slow subscriber
+	});
+	book.Notifier().Start();
+	book.AddEntry(1, 0, 0, 0, cp, MakeEntry(false, 2.0, 1.0));
+
+	// Act
+	for (int64_t key = 2; key <= 100; ++key)
+	{
+		book.AddEntry(key, key > 2 ? key - 1 : 0, 0, 0, cp, MakeEntry(true, 1.0 + double(key) / 1000.0, 1.0, key > 2 ? QT_UPDATE : QT_NEW));
+	}
+	{
+		std::unique_lock lock { mutex };
+		release = true;
+		cv.notify_all();
+		cv.wait_for(lock, std::chrono::seconds(5), [&delivered, &book, cp]
+		{
+			return !delivered.empty() && delivered.back() == book.GetBestPrice(cp, true);
+		});
+	}
+	book.Notifier().Stop();
+
+	// Check
+	ASSERT_EQ(book.GetBestPrice(cp, true), delivered.back());
+	ASSERT_LT(delivered.size(), 99u);
+	ASSERT_GT(book.Notifier().Conflated(), 0u);
+	ASSERT_EQ(99u, book.Notifier().Queued() + book.Notifier().Conflated() + book.Notifier().Dropped());
+}
+
+//----------------------------------------------------------------------------
+TEST(EXPIRYWHEEL, Test_KeysExpireInOrderAcrossLevels)
+{
+	// Arrange
+	const int64_t tick { 1'000 };
+	ExpiryWheel wheel { tick, 0 };
+	std::map<int64_t, int64_t> expiries; // key -> expiry
+	std::mt19937 gen { 7 };
+	std::uniform_int_distribution<int64_t> dis { 0, tick * ExpiryWheel::SLOTS * ExpiryWheel::SLOTS * 3 };
+	for (int64_t key = 1; key <= 2'000; ++key)
+	{
+		expiries[key] = dis(gen);
+		wheel.Schedule(expiries[key], key);
+	}
+
+	// Act & Check
+	std::set<int64_t> expired;
+	for (int64_t now = 0; wheel.Size() > 0; now += tick * 37)
+	{
+		wheel.Advance(now, [&](int64_t key)
+		{
+			ASSERT_LE(expiries[key], now);
+			ASSERT_GT(expiries[key] + tick * 38, now); // not later than the advance after its expiry
+			expired.insert(key);
+		});
+	}
+	ASSERT_EQ(expiries.size(), expired.size());
+}
+
+//----------------------------------------------------------------------------
+TEST(ORDERBOOK, Test_EvictStaleQuotes)
+{
+	// Arrange
+	OrderBook book;
+	int midChanges { 0 };
+	book.Initialise([&midChanges] { ++midChanges; });
+	const UTILS::CurrencyPair cp { "EUR/USD" };
+	const int64_t maxAge { 1'000'000'000 };
+	book.AddEntry(1, 0, 0, 0, cp, MakeEntry(true, 1.1, 1.0));
+	book.SetQuoteExpiry(cp, maxAge, 0); // no timer: eviction driven by the test
+	book.AddEntry(2, 0, 0, 0, cp, MakeEntry(true, 1.2, 1.0));
+	book.AddEntry(3, 0, 0, 0, cp, MakeEntry(false, 1.3, 1.0));
+	book.AddEntry(4, 0, 0, 0, cp, MakeEntry(false, 1.4, 1.0));
+	book.AddEntry(5, 4, 0, 0, cp, MakeEntry(false, 1.4, 0.0, QT_DELETE));
+	const int64_t now { UTILS::CurrentTimestamp() };
+	midChanges = 0;
+
+	// Act
+	const size_t early { book.EvictStaleQuotes(cp, now) };
+	const size_t late { book.EvictStaleQuotes(cp, now + 2 * maxAge) };
+
+	// Check
+	ASSERT_EQ(0u, early);
+	ASSERT_EQ(3u, late); // the deleted quote is skipped
+	ASSERT_EQ(0u, book.GetQuoteCount(cp, true));
+	ASSERT_EQ(0u, book.GetQuoteCount(cp, false));
+	ASSERT_EQ(0, book.GetBestPrice(cp, true));
+	ASSERT_EQ(1, midChanges);
+}
+
+//----------------------------------------------------------------------------
+TEST(L2LADDER, Test_LevelsFollowReferenceUnderChurn)
+{
+	// Arrange
+	L2Ladder bids { true };
+	L2Ladder asks { false };
+	std::map<int64_t, int64_t> refBids; // price -> qty
+	std::map<int64_t, int64_t> refAsks;
+	std::mt19937 gen { 11 };
+	std::uniform_int_distribution<int64_t> price { 1, 200 };
+	std::uniform_int_distribution<int64_t> qty { 0, 5 };
+
+	// Act
+	for (int i = 0; i < 20'000; ++i)
+	{
+		const bool bid { (i & 1) != 0 };
+		const int64_t p { price(gen) };
+		const int64_t q { qty(gen) };
+		(bid ? bids : asks).Apply(p, q, i);
+		auto &ref { bid ? refBids : refAsks };
+		if (q == 0)
+		{
+			ref.erase(p);
+		}
+		else
+		{
+			ref[p] = q;
+		}
+	}
+
+	// Check
+	ASSERT_TRUE(bids.CheckOrder());
+	ASSERT_TRUE(asks.CheckOrder());
+	ASSERT_EQ(refBids.size(), bids.LevelCount());
+	ASSERT_EQ(refAsks.size(), asks.LevelCount());
+	ASSERT_EQ(refBids.rbegin()->first, bids.BestLevel()->price);
+	ASSERT_EQ(refAsks.begin()->first, asks.BestLevel()->price);
+	auto itRef { refBids.rbegin() };
+	bids.ForEachL2Level([&itRef](const L2Level &level, bool &)
+	{
+		ASSERT_EQ(itRef->first, level.price);
+		ASSERT_EQ(itRef->second, level.qty);
+		++itRef;
+	});
+	PriceLadder::LevelSummary summaries[3];
+	ASSERT_EQ(3u, asks.CopySummaries(summaries, 3));
+	ASSERT_EQ(std::next(refAsks.begin(), 2)->first, summaries[2].price);
+	ASSERT_EQ(nullptr, asks.Find(1000));
+	ASSERT_FALSE(asks.Apply(1000, 0, 0)); // deleting a missing level changes nothing
+}
+
+//----------------------------------------------------------------------------
+TEST(L2LADDER, Test_BoundedLadderKeepsBestLevels)
+{
+	// Arrange
+	L2Ladder asks { false };
+	for (int64_t price: { 105, 104, 103, 102, 101 })
+	{
+		asks.Apply(price, 1, 0);
+	}
+
+	// Act
+	asks.SetMaxLevels(3); // moves 104 and 105 to the overflow
+	const bool worse { asks.Apply(110, 1, 0) }; // outside the full window, into the overflow
+	const bool better { asks.Apply(100, 2, 0) }; // evicts 103 into the full overflow, which discards 110
+	asks.Apply(101, 0, 0);
+	asks.Apply(100, 0, 0); // the window is refilled with 103 and 104
+	const int64_t refilled { asks.Refilled() };
+	const bool beyond { asks.Apply(120, 5, 0) }; // beyond the discarded 110
+
+	// Check
+	ASSERT_FALSE(worse);
+	ASSERT_TRUE(better);
+	ASSERT_EQ(104, refilled);
+	ASSERT_FALSE(beyond);
+	ASSERT_EQ(2u, asks.Discarded());
+	ASSERT_EQ(1u, asks.OverflowCount());
+	ASSERT_FALSE(asks.Incomplete());
+	ASSERT_TRUE(asks.CheckOrder());
+	std::vector<int64_t> prices;
+	asks.ForEachL2Level([&prices](const L2Level &level, bool &) { prices.push_back(level.price); });
+	ASSERT_EQ(std::vector<int64_t>({ 102, 103, 104 }), prices);
+	ASSERT_EQ(3, asks.Depth().TotalVolume());
+	asks.Apply(102, 0, 0); // refilled with the last level of the overflow
+	ASSERT_EQ(105, asks.WorstLevel()->price);
+	ASSERT_FALSE(asks.Incomplete());
+	asks.Apply(103, 0, 0); // drained below the bound, 110 may still exist
+	ASSERT_TRUE(asks.Incomplete());
+	ASSERT_TRUE(asks.CheckOrder());
+	for (int64_t price { 200 }; price > 90; --price)
+	{
+		asks.Apply(price, 1, 0);
+	}
+	ASSERT_EQ(3u, asks.LevelCount());
+	ASSERT_EQ(91, asks.BestLevel()->price);
+	ASSERT_TRUE(asks.CheckOrder());
+	asks.Clear();
+	ASSERT_FALSE(asks.Incomplete());
+}
+
+//----------------------------------------------------------------------------
+TEST(ORDERBOOK, Test_BoundedL2BookRefillsFromOverflow)
+{
+	// Arrange
+	OrderBook book;
+	const UTILS::CurrencyPair cp { "EUR/USD" };
+	book.SetBookMode(cp, InstrumentBook::Mode::Levels);
+	book.SetMaxLevels(cp, 2);
+	UTILS::BookUpdate update;
+	for (int i { 0 }; i < 4; ++i)
+	{
+		update.entries.push_back(MakeEntry(true, 1.0 + i * 0.01, 1.0));
+		update.entries.back().instrument = cp;
+	}
+	book.ApplyBatch(update);
+
+	// Act
+	// (deletes drain the window, the deeper levels still exist at the venue)
+	update.entries.resize(2);
+	update.entries[0] = MakeEntry(true, 1.03, 1.0);
+	update.entries[1] = MakeEntry(true, 1.02, 1.0);
+	for (auto &entry: update.entries)
+	{
+		entry.instrument = cp;
+		entry.updateType = QT_DELETE;
+	}
+	book.ApplyBatch(update);
+
+	// Check
+	ASSERT_EQ(2u, book.GetQuoteCount(cp, true));
+	ASSERT_EQ(cp.DblToCpip(1.01), book.GetBestPrice(cp, true));
+	ASSERT_EQ(cp.DoubleToQty(2.0), book.CostToFill(cp, true, cp.DoubleToQty(100.0)).filledQty);
+	ASSERT_FALSE(book.IsDepthIncomplete(cp, true));
+}
+
+//----------------------------------------------------------------------------
+TEST(ORDERBOOK, Test_MaxLevelsBoundsL2Book)
+{
+	// Arrange
+	OrderBook book;
+	const UTILS::CurrencyPair cp { "EUR/USD" };
+	book.SetBookMode(cp, InstrumentBook::Mode::Levels);
+	UTILS::BookUpdate update;
+	for (int i { 0 }; i < 20; ++i)
+	{
+		update.entries.push_back(MakeEntry(true, 1.0 + i * 0.01, 1.0));
+		update.entries.back().instrument = cp;
+	}
+
+	// Act
+	book.SetMaxLevels(cp);
+	book.ApplyBatch(update);
+
+	// Check
+	ASSERT_EQ(size_t(DFLT_MAX_QUOTE_COUNT), book.GetMaxLevels(cp));
+	ASSERT_EQ(size_t(DFLT_MAX_QUOTE_COUNT), book.GetQuoteCount(cp, true));
+	ASSERT_EQ(cp.DblToCpip(1.19), book.GetBestPrice(cp, true));
+	ASSERT_EQ(cp.DoubleToQty(DFLT_MAX_QUOTE_COUNT), book.CostToFill(cp, true, cp.DoubleToQty(100.0)).filledQty);
+	book.SetMaxLevels(cp, 0);
+	book.ApplyBatch(update);
+	ASSERT_EQ(20u, book.GetQuoteCount(cp, true));
+}
+
+//----------------------------------------------------------------------------
+TEST(ORDERBOOK, Test_LevelsModeKeepsL2Book)
+{
+	// Arrange
+	OrderBook book;
+	int midChanges { 0 };
+	book.Initialise([&midChanges] { ++midChanges; });
+	const UTILS::CurrencyPair cp { "EUR/USD" };
+	book.AddEntry(1, 0, 0, 0, cp, MakeEntry(true, 1.0, 1.0));
+	book.SetBookMode(cp, InstrumentBook::Mode::Levels);
+	auto entry { [cp](bool bid, double price, double volume)
+	{
+		auto result { MakeEntry(bid, price, volume, volume == 0.0 ? QT_DELETE : QT_NEW) };
+		result.instrument = cp;
+		return result;
+	} };
+	UTILS::BookUpdate update;
+	update.entries = { entry(true, 1.1, 1.0), entry(true, 1.2, 2.0), entry(false, 1.3, 1.0), entry(false, 1.4, 4.0) };
+
+	// Act
+	book.ApplyBatch(update);
+	update.entries = { entry(true, 1.2, 0.0), entry(true, 1.1, 3.0), entry(false, 1.3, 2.0) }; // no book keys needed
+	book.ApplyBatch(*book.AddInstrument(cp), update);
+	book.AddEntry(0, 0, 0, 0, cp, entry(false, 1.25, 1.0));
+
+	// Check
+	ASSERT_EQ(InstrumentBook::Mode::Levels, book.GetBookMode(cp));
+	ASSERT_EQ(3, midChanges);
+	ASSERT_EQ(1u, book.GetQuoteCount(cp, true)); // the quote added before the switch is gone
+	ASSERT_EQ(3u, book.GetQuoteCount(cp, false));
+	ASSERT_EQ(cp.DblToCpip(1.1), book.GetBestPrice(cp, true));
+	ASSERT_EQ(cp.DblToCpip(1.25), book.GetBestPrice(cp, false));
+	ASSERT_EQ(cp.DoubleToQty(3.0), book.QtyUpToPrice(cp, true, cp.DblToCpip(1.0)));
+	PriceLadder::LevelSummary levels[4];
+	ASSERT_EQ(3u, book.GetLevels(cp, false, levels, 4));
+	ASSERT_EQ(cp.DoubleToQty(2.0), levels[1].totalVolume);
+	const auto groups { book.GetLevels(cp, false, 2) };
+	ASSERT_EQ(2u, groups.size());
+	ASSERT_EQ(cp.DblToCpip(1.3), groups[1]->MinPrice());
+	ASSERT_EQ(cp.DblToCpip(1.1), book.GetBestQuote(cp, true)->Price());
+	book.SetReadMode(OrderBook::ReadMode::Snapshot);
+	ASSERT_EQ(3u, book.GetQuoteCount(cp, false));
+	ASSERT_EQ(cp.DoubleToQty(7.0), book.CostToFill(cp, false, cp.DoubleToQty(100.0)).filledQty);
+}
+
+
+//----------------------------------------------------------------------------
+TEST(CONSOLIDATEDBOOK, Test_AddVenue_SetsReadModeOnCreation)
+{
+	// Arrange
+	ConsolidatedBook books;
+
+	// Act
+	const auto locking { books.AddVenue("A") };
+	const auto snapshot { books.AddVenue("B", OrderBook::ReadMode::Snapshot) };
+	const auto existing { books.AddVenue("B", OrderBook::ReadMode::Locking) };
+
+	// Check
+	ASSERT_EQ(OrderBook::ReadMode::Locking, locking->GetReadMode()); // default
+	ASSERT_EQ(OrderBook::ReadMode::Snapshot, snapshot->GetReadMode());
+	ASSERT_EQ(snapshot, existing);
+	ASSERT_EQ(OrderBook::ReadMode::Snapshot, existing->GetReadMode()); // the mode is set when the venue is created
+}
+
+
+//----------------------------------------------------------------------------
+TEST(CONSOLIDATEDBOOK, Test_LevelsMergedAcrossVenues)
+{
+	// Arrange
+	ConsolidatedBook books;
+	const UTILS::CurrencyPair cp { "EUR/USD" };
+	const auto venueA { books.AddVenue("A") };
+	const auto venueB { books.AddVenue("B") };
+	auto add { [cp](OrderBook &book, int64_t key, bool bid, double price, double volume)
+	{
+		book.AddEntry(key, 0, 0, 0, cp, MakeEntry(bid, price, volume));
+	} };
+
+	// Act
+	add(*venueA, 1, true, 1.10, 1.0);
+	add(*venueA, 2, true, 1.08, 1.0);
+	add(*venueA, 3, false, 1.14, 1.0);
+	add(*venueB, 1, true, 1.09, 2.0);
+	add(*venueB, 2, true, 1.08, 3.0);
+	add(*venueB, 3, false, 1.12, 1.0);
+	ConsolidatedBook::VenueLevel levels[8];
+	const size_t count { books.GetLevels(cp, true, levels, 8) };
+	const ConsolidatedBook::VenueLevel bestAsk { books.GetBestLevel(cp, false) };
+
+	// Check
+	ASSERT_EQ(venueA, books.AddVenue("A")); // venues are created once
+	ASSERT_EQ(nullptr, books.FindVenue("C"));
+	ASSERT_EQ(2u, books.VenueCount());
+	ASSERT_EQ(4u, count);
+	const size_t a { books.VenueIndex("A") };
+	const size_t b { books.VenueIndex("B") };
+	std::vector<std::pair<int64_t, size_t>> merged;
+	for (size_t i { 0 }; i < count; ++i)
+	{
+		merged.emplace_back(levels[i].level.price, levels[i].venue);
+	}
+	const std::vector<std::pair<int64_t, size_t>> expected { { cp.DblToCpip(1.10), a }, { cp.DblToCpip(1.09), b },
+															 { cp.DblToCpip(1.08), b }, { cp.DblToCpip(1.08), a } }; // greater volume first
+	ASSERT_EQ(expected, merged);
+	ASSERT_EQ(2u, books.GetLevels(cp, true, levels, 2));
+	ASSERT_EQ(b, levels[1].venue);
+	ASSERT_EQ(b, bestAsk.venue);
+	ASSERT_EQ("B", books.VenueName(bestAsk.venue));
+	ASSERT_EQ(cp.DblToCpip(1.12), bestAsk.level.price);
+	ASSERT_EQ((cp.DblToCpip(1.10) + cp.DblToCpip(1.12)) / 2, books.GetMidPrice(cp));
+	ASSERT_EQ(6u, books.GetQuoteCount(cp, true) + books.GetQuoteCount(cp, false));
+	ASSERT_EQ(ConsolidatedBook::NO_VENUE, books.GetBestLevel(UTILS::CurrencyPair { "GBP/USD" }, true).venue);
+}
+
+//----------------------------------------------------------------------------
+TEST(FILTERVIEW, Test_ViewsFollowBookDeltas)
+{
+	// Arrange
+	OrderBook book;
+	const UTILS::CurrencyPair cp { "EUR/USD" };
+	auto add { [&book, cp](int64_t key, int64_t refKey, double price, double volume, const std::string &venue, int64_t updateType = QT_NEW)
+	{
+		auto entry { MakeEntry(true, price, volume, updateType) };
+		entry.originators = venue;
+		book.AddEntry(key, refKey, 0, 0, cp, entry);
+	} };
+	auto prices { [](const BookView &view)
+	{
+		std::vector<int64_t> result;
+		for (const auto &qg: view.GetLevels())
+		{
+			result.push_back(qg->MaxPrice());
+		}
+		return result;
+	} };
+	const int64_t minQty { cp.DoubleToQty(2.0) };
+	add(1, 0, 1.10, 3.0, "A"); // in the book before the views are created
+	add(2, 0, 1.12, 1.0, "A");
+	const SortView::Ptr sortView { SortView::Create(book, cp, true) };
+	const FilterView::Ptr qtyView { FilterView::CreateMinQty(sortView, minQty) };
+	const FilterView::Ptr venueView { FilterView::CreateVenue(qtyView, "A") };
+
+	// Act
+	add(3, 0, 1.11, 2.0, "B");
+	add(4, 0, 1.09, 5.0, "A");
+	add(5, 0, 1.11, 4.0, "A");
+	add(6, 4, 1.09, 1.0, "A", QT_UPDATE); // falls below the minimum quantity
+	const std::vector<int64_t> qtyPrices { prices(*qtyView) };
+	const std::vector<int64_t> venuePrices { prices(*venueView) };
+	add(7, 5, 1.11, 0.0, "A", QT_DELETE);
+	const std::vector<int64_t> venuePricesAfterDelete { prices(*venueView) };
+
+	// Check
+	ASSERT_EQ(std::vector<int64_t>({ cp.DblToCpip(1.11), cp.DblToCpip(1.10) }), qtyPrices);
+	ASSERT_EQ(std::vector<int64_t>({ cp.DblToCpip(1.11), cp.DblToCpip(1.10) }), venuePrices);
+	ASSERT_EQ(std::vector<int64_t>({ cp.DblToCpip(1.10) }), venuePricesAfterDelete);
+	const auto expected { book.GetLevels(cp, true, 0, [minQty](const Quote &q) { return q.Volume() >= minQty; }) };
+	const auto levels { qtyView->GetLevels() };
+	ASSERT_EQ(expected.size(), levels.size());
+	for (size_t i { 0 }; i < levels.size(); ++i)
+	{
+		ASSERT_EQ(expected[i]->TotalVolume(), levels[i]->TotalVolume());
+		ASSERT_EQ(expected[i]->QuoteCount(), levels[i]->QuoteCount());
+	}
+	ASSERT_EQ(1u, qtyView->GetLevels(1).size());
+	ASSERT_EQ(sortView.get(), venueView->SortViewPtr());
+	ASSERT_EQ(&book, venueView->BookPtr());
+	ASSERT_EQ("EUR/USD bid -> qty >= " + std::to_string(minQty) + " -> venue == A", venueView->GetFilterSequence());
+	ASSERT_EQ("qty >= " + std::to_string(minQty) + " -> venue == A", venueView->GetFilterSequence(true));
+	book.Clear();
+	ASSERT_EQ(0u, qtyView->QuoteCount());
+	ASSERT_EQ(0u, venueView->LevelCount());
+}
+
+//----------------------------------------------------------------------------
+TEST(FILTERVIEW, Test_MaxAgeViewOfBoundedL2Book)
+{
+	// Arrange
+	OrderBook book;
+	const UTILS::CurrencyPair cp { "EUR/USD" };
+	const int64_t maxAge { 1'000'000'000 };
+	book.SetBookMode(cp, InstrumentBook::Mode::Levels);
+	book.SetMaxLevels(cp, 2);
+	const FilterView::Ptr ageView { FilterView::CreateMaxAge(SortView::Create(book, cp, false), maxAge) };
+	auto countLevels { [&ageView](int64_t now)
+	{
+		int count { 0 };
+		ageView->IterateQuoteGroups(now, [&count](int, QuoteGroup::Ptr &, bool &) { ++count; });
+		return count;
+	} };
+
+	// Act
+	book.AddEntry(0, 0, 0, 0, cp, MakeEntry(false, 1.12, 1.0));
+	book.AddEntry(0, 0, 0, 0, cp, MakeEntry(false, 1.13, 1.0));
+	book.AddEntry(0, 0, 0, 0, cp, MakeEntry(false, 1.11, 2.0)); // evicts 1.13
+	book.AddEntry(0, 0, 0, 0, cp, MakeEntry(false, 1.12, 3.0));
+	const int64_t now { UTILS::CurrentTimestamp() };
+
+	// Check
+	const auto levels { ageView->GetLevels() };
+	ASSERT_EQ(2u, levels.size());
+	ASSERT_EQ(cp.DblToCpip(1.11), levels[0]->MaxPrice());
+	ASSERT_EQ(cp.DoubleToQty(3.0), levels[1]->TotalVolume());
+	ASSERT_EQ(2, countLevels(now));
+	ASSERT_EQ(0, countLevels(now + 2 * maxAge)); // too old, still held until the book evicts them
+	ASSERT_EQ(2u, ageView->LevelCount());
+	ASSERT_EQ(maxAge, FilterView::CreateMinQty(ageView, 1)->MaxQuoteAge());
+}
+
+//----------------------------------------------------------------------------
+TEST(SHMRING, Test_ReaderRebuildsPublishedBooks)
+{
+	// Arrange
+	const std::string path { (std::filesystem::temp_directory_path() / "orderbook_test.ring").string() };
+	OrderBook book;
+	const UTILS::CurrencyPair l2 { "EUR/USD" };
+	const UTILS::CurrencyPair l3 { "GBP/USD" };
+	book.SetBookMode(l2, InstrumentBook::Mode::Levels);
+	book.AddEntry(0, 0, 0, 0, l2, MakeEntry(true, 1.10, 1.0));
+	book.AddEntry(0, 0, 0, 0, l2, MakeEntry(true, 1.09, 2.0));
+	book.AddEntry(0, 0, 0, 0, l2, MakeEntry(false, 1.12, 1.0));
+	ORDERBOOK::ShmPublisher publisher;
+	ASSERT_TRUE(publisher.Create(path, 1024, 0));
+	ORDERBOOK::ShmBookReader reader;
+	ASSERT_TRUE(reader.Open(path));
+
+	// Act
+	publisher.Attach(book, l2); // replays the levels set before
+	publisher.Attach(book, l3);
+	book.AddEntry(0, 0, 0, 0, l2, MakeEntry(true, 1.10, 3.0));
+	book.AddEntry(0, 0, 0, 0, l2, MakeEntry(false, 1.12, 0.0));
+	book.AddEntry(1, 0, 0, 0, l3, MakeEntry(true, 1.30, 1.0));
+	book.AddEntry(2, 0, 0, 0, l3, MakeEntry(true, 1.30, 2.0));
+	book.AddEntry(3, 1, 0, 0, l3, MakeEntry(true, 0.0, 0.0, QT_DELETE));
+	const size_t applied { reader.Poll() };
+	const L2Ladder *bids { reader.Ladder(l2, true) };
+	const L2Ladder *asks { reader.Ladder(l2, false) };
+	const L2Ladder *l3Bids { reader.Ladder(l3, true) };
+
+	// Check
+	ASSERT_EQ(publisher.LastSeq(), applied);
+	ASSERT_EQ(0u, reader.Lag());
+	ASSERT_TRUE(reader.WriterActive());
+	ASSERT_TRUE(bids && asks && l3Bids);
+	ASSERT_EQ(2u, bids->LevelCount());
+	ASSERT_EQ(l2.DblToCpip(1.10), bids->BestLevel()->price);
+	ASSERT_EQ(l2.DoubleToQty(3.0), bids->BestLevel()->qty);
+	ASSERT_TRUE(asks->Empty());
+	ASSERT_EQ(1u, l3Bids->LevelCount());
+	ASSERT_EQ(l3.DoubleToQty(2.0), l3Bids->BestLevel()->qty); // quotes aggregated by price
+
+	publisher.Detach(book, l3);
+	book.AddEntry(4, 0, 0, 0, l3, MakeEntry(true, 1.31, 1.0));
+	reader.Poll();
+	ASSERT_TRUE(reader.Ladder(l3, true)->Empty());
+	std::filesystem::remove(path);
+}
+
+//----------------------------------------------------------------------------
+TEST(SHMRING, Test_ReaderResyncsFromSnapshotAfterOverrun)
+{
+	// Arrange
+	const std::string path { (std::filesystem::temp_directory_path() / "orderbook_overrun_test.ring").string() };
+	const UTILS::CurrencyPair cp { "EUR/USD" };
+	ORDERBOOK::ShmPublisher publisher;
+	ASSERT_TRUE(publisher.Create(path, 64, 16));
+	ORDERBOOK::ShmBookReader reader;
+	ASSERT_TRUE(reader.Open(path));
+	std::map<int64_t, int64_t> expected; // price -> qty
+	std::mt19937 gen { 17 };
+	std::uniform_int_distribution<int64_t> price { 100, 109 };
+	std::uniform_int_distribution<int64_t> qty { 0, 3 };
+
+	// Act
+	for (int key = 1; key <= 1000; ++key)
+	{
+		const int64_t p { price(gen) };
+		const int64_t q { qty(gen) };
+		publisher.Publish(cp, 0, 0, MakeQuote(p, q, key), true);
+		if (q > 0)
+		{
+			expected[p] = q;
+		}
+		else
+		{
+			expected.erase(p);
+		}
+	}
+	reader.Poll();
+
+	// Check
+	ASSERT_GT(reader.Overruns(), 0u);
+	const L2Ladder *bids { reader.Ladder(cp, true) };
+	ASSERT_NE(nullptr, bids);
+	ASSERT_EQ(expected.size(), bids->LevelCount());
+	for (const auto &[p, q]: expected)
+	{
+		ASSERT_NE(nullptr, bids->Find(p));
+		ASSERT_EQ(q, bids->Find(p)->qty);
+	}
+	std::filesystem::remove(path);
+}
+
+//----------------------------------------------------------------------------
+TEST(CHECKPOINT, Test_RestoredBookIsProvisional)
+{
+	// Arrange
+	const std::string path { (std::filesystem::temp_directory_path() / "orderbook_test.ckpt").string() };
+	const UTILS::CurrencyPair l2 { "EUR/USD" };
+	const UTILS::CurrencyPair l3 { "GBP/USD" };
+	OrderBook source;
+	source.SetBookMode(l2, InstrumentBook::Mode::Levels);
+	source.AddEntry(0, 0, 0, 0, l2, MakeEntry(true, 1.10, 1.0));
+	source.AddEntry(0, 0, 0, 0, l2, MakeEntry(true, 1.09, 2.0));
+	source.AddEntry(0, 0, 0, 0, l2, MakeEntry(true, 1.08, 4.0));
+	source.AddEntry(0, 0, 0, 0, l2, MakeEntry(false, 1.12, 3.0));
+	source.AddInstrument(l2)->SetUpdateId(4711);
+	source.AddEntry(1, 0, 0, 0, l3, MakeEntry(true, 1.30, 1.0));
+	source.AddEntry(2, 0, 0, 0, l3, MakeEntry(true, 1.30, 2.0));
+	OrderBook target;
+	target.SetBookMode(l2, InstrumentBook::Mode::Levels);
+	target.SetMaxLevels(l2, 2);
+
+	// Act
+	ASSERT_TRUE(BookCheckpoint::Save(source, path));
+	BookCheckpoint checkpoint;
+	ASSERT_TRUE(checkpoint.Open(path));
+	const BookCheckpoint::Instrument *saved { checkpoint.Find(l2) };
+	const bool restored { checkpoint.Restore(target, l2) };
+	const bool restoredQuotes { checkpoint.Restore(target, l3) }; // target book of l3 in quotes mode
+
+	// Check
+	ASSERT_EQ(2u, checkpoint.Instruments().size());
+	ASSERT_NE(nullptr, saved);
+	ASSERT_EQ(4711, saved->updateId);
+	ASSERT_EQ(3u, saved->bidCount);
+	ASSERT_EQ(l2.DblToCpip(1.10), saved->bids[0].price);
+	ASSERT_EQ(1u, saved->askCount);
+	ASSERT_EQ(l3.DoubleToQty(3.0), checkpoint.Find(l3)->bids[0].qty); // quotes aggregated by price
+	ASSERT_TRUE(restored);
+	ASSERT_FALSE(restoredQuotes);
+	ASSERT_TRUE(target.IsProvisional(l2));
+	ASSERT_EQ(4711, target.FindInstrument(l2)->UpdateId());
+	ASSERT_EQ(2u, target.GetQuoteCount(l2, true)); // bounded to the best levels
+	const auto top { target.GetTopOfBook(l2).Read() };
+	ASSERT_EQ(l2.DblToCpip(1.10), top.bidPrice);
+	ASSERT_EQ(l2.DblToCpip(1.12), top.askPrice);
+
+	// a snapshot of the feed replaces the provisional levels
+	InstrumentBook &book { *target.FindInstrument(l2) };
+	ASSERT_TRUE(target.DiscardProvisional(book));
+	ASSERT_FALSE(target.IsProvisional(l2));
+	ASSERT_EQ(0u, target.GetQuoteCount(l2, true));
+	ASSERT_FALSE(target.DiscardProvisional(book));
+	std::filesystem::remove(path);
+}
+
+//----------------------------------------------------------------------------
+TEST(LEVELARRAYS, Test_KernelsMatchScalar)
+{
+	// Arrange
+	std::mt19937 rng { 42 };
+	LevelArrays arrays;
+	int64_t price { 1000000 };
+	for (int i = 0; i < 1003; ++i) // not a multiple of the vector width, to cover the tails
+	{
+		price -= rng() % 3 == 0 ? 0 : 1 + int64_t(rng() % 5); // bid side, several rows per price
+		arrays.Append(price, 1 + int64_t(rng() % 1000), int64_t(rng() % 600), uint8_t(rng() % 4 == 0 ? rng() % 4 : 0));
+	}
+	const SimdLevel supported { LevelArrays::SupportedSimdLevel() };
+
+	// Act
+	auto run = [&arrays](SimdLevel level)
+	{
+		LevelArrays::SetSimdLevel(level);
+		std::vector<double> results;
+		arrays.ForEachGroup([&results](size_t begin, size_t end, bool &) { results.push_back(double(end - begin)); });
+		arrays.ForEachAggregate(2500, [&results](size_t begin, size_t end, bool &) { results.push_back(double(end)); });
+		for (int64_t qty: { 1, 300, 700, 999, 1000, 1001 })
+		{
+			results.push_back(double(arrays.FindFirstFillable(qty)));
+			results.push_back(double(arrays.FindFirstFillable(qty, LevelArrays::FLAG_INVALID)));
+		}
+		results.push_back(double(arrays.FindCumulativeVolume(17, 1000000000)));
+		results.push_back(arrays.Notional(3, 1000));
+		return results;
+	};
+	const std::vector<double> scalar { run(SimdLevel::Scalar) };
+	const std::vector<double> sse4 { run(SimdLevel::SSE4) };
+	const std::vector<double> avx2 { run(SimdLevel::AVX2) };
+	LevelArrays::SetSimdLevel(supported);
+
+	// Check
+	ASSERT_EQ(scalar.size(), sse4.size());
+	ASSERT_EQ(scalar.size(), avx2.size());
+	for (size_t i = 0; i + 1 < scalar.size(); ++i)
+	{
+		ASSERT_EQ(scalar[i], sse4[i]) << "result " << i;
+		ASSERT_EQ(scalar[i], avx2[i]) << "result " << i;
+	}
+	ASSERT_EQ(double(arrays.Size()), scalar[scalar.size() - 2]); // threshold never reached
+	ASSERT_NEAR(scalar.back(), sse4.back(), scalar.back() * 1e-12);
+	ASSERT_NEAR(scalar.back(), avx2.back(), scalar.back() * 1e-12);
+}
+
+//----------------------------------------------------------------------------
+TEST(LEVELARRAYS, Test_BestPriceForQty)
+{
+	// Arrange
+	const UTILS::CurrencyPair cp { "EUR/USD" };
+	OrderBook book;
+	book.AddEntry(1, 0, 0, 0, cp, MakeEntry(true, 1.10, 1.0));
+	book.AddEntry(2, 0, 0, 0, cp, MakeEntry(true, 1.09, 5.0));
+	book.AddEntry(3, 0, 0, 0, cp, MakeEntry(true, 1.08, 10.0));
+
+	// Act
+	const int64_t locked { book.GetBestPriceForQty(cp, true, cp.DoubleToQty(2.0)) };
+	book.SetReadMode(OrderBook::ReadMode::Snapshot);
+	const int64_t snapshot { book.GetBestPriceForQty(cp, true, cp.DoubleToQty(6.0)) };
+	const int64_t none { book.GetBestPriceForQty(cp, true, cp.DoubleToQty(11.0)) };
+
+	// Check
+	ASSERT_EQ(cp.DblToCpip(1.09), locked);
+	ASSERT_EQ(cp.DblToCpip(1.08), snapshot);
+	ASSERT_EQ(0, none);
+}
+
+} // namespace TEST
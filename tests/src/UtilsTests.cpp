@@ -0,0 +1,325 @@
+#include <random>
+#include <unordered_map>
+
+#include <gtest/gtest.h>
+
+#include "Utils/Arena.h"
+#include "Utils/Decimal.h"
+#include "Utils/EpochDomain.h"
+#include "Utils/FlatHashMap.h"
+#include "Utils/FrameSlabPool.h"
+#include "Utils/JsonReader.h"
+
+namespace TEST {
+
+//----------------------------------------------------------------------------
+TEST(UTILS, Test_FlatHashMap_InsertFindErase)
+{
+	// Arrange
+	UTILS::FlatHashMap<int64_t, int> map;
+
+	// Act
+	const bool inserted { map.Insert(5, 50) };
+	const bool reinserted { map.Insert(5, 55) };
+
+	// Check
+	ASSERT_TRUE(inserted);
+	ASSERT_FALSE(reinserted);
+	ASSERT_EQ(1u, map.Size());
+	ASSERT_EQ(55, *map.Find(5));
+	ASSERT_EQ(nullptr, map.Find(6));
+	ASSERT_TRUE(map.Erase(5));
+	ASSERT_FALSE(map.Erase(5));
+	ASSERT_TRUE(map.Empty());
+}
+
+//----------------------------------------------------------------------------
+TEST(UTILS, Test_FlatHashMap_ChurnMatchesUnorderedMap)
+{
+	// Arrange
+	UTILS::FlatHashMap<int64_t, int64_t> map { 4 };
+	std::unordered_map<int64_t, int64_t> reference;
+	std::mt19937_64 rng { 3 };
+
+	// Act / Check
+	for (int i = 0; i < 100000; ++i)
+	{
+		const int64_t key { int64_t(rng() % 2000) };
+		if (rng() % 3 == 0)
+		{
+			ASSERT_EQ(reference.erase(key) == 1, map.Erase(key));
+		}
+		else
+		{
+			ASSERT_EQ(reference.insert_or_assign(key, i).second, map.Insert(key, i));
+		}
+		ASSERT_EQ(reference.size(), map.Size());
+	}
+	for (int64_t key = 0; key < 2000; ++key)
+	{
+		const auto it { reference.find(key) };
+		const int64_t *value { map.Find(key) };
+		ASSERT_EQ(it != reference.end(), value != nullptr);
+		if (value)
+		{
+			ASSERT_EQ(it->second, *value);
+		}
+	}
+}
+
+//----------------------------------------------------------------------------
+TEST(UTILS, Test_ParseDecimal_ScalesExactly)
+{
+	// Arrange
+	const std::vector<std::tuple<std::string, int, int64_t>> cases {
+			{ "21921.73", 6, 21921730000 }, { "0.00012345", 8, 12345 }, { "1.005", 2, 101 }, // 1.005 * 100 is 100.4999.. as a double
+			{ "-0.125", 2, -13 }, { "0.0049", 2, 0 }, { "0.005", 2, 1 }, { "12345678901234567.8", 1, 123456789012345678 },
+			{ "000.000", 8, 0 }, { "7", 0, 7 }, { ".5", 0, 1 }, { "1.5e-3", 8, 150000 }, { "2E2", 2, 20000 },
+			{ "0.0000000000000000000000123e20", 8, 123000 }, { "+3.14159265358979323846", 8, 314159265 } };
+	const std::vector<std::pair<std::string, int>> invalid { { "", 8 }, { "-", 8 }, { ".", 8 }, { "1.2.3", 8 }, { "1e", 2 },
+															 { "12a", 2 }, { " 1", 2 }, { "92233720368.54775808", 8 },
+															 { "1e30", 0 }, { "1", 19 } };
+
+	for (const auto &[text, decimals, expected]: cases)
+	{
+		// Act
+		int64_t value { -1 };
+		const bool parsed { UTILS::ParseDecimal(text, decimals, value) };
+
+		// Check
+		ASSERT_TRUE(parsed) << text;
+		ASSERT_EQ(expected, value) << text;
+	}
+	for (const auto &[text, decimals]: invalid)
+	{
+		int64_t value { -1 };
+		ASSERT_FALSE(UTILS::ParseDecimal(text, decimals, value)) << text;
+		ASSERT_EQ(-1, value) << text;
+	}
+	ASSERT_EQ(6, UTILS::FactorDecimals(1000000));
+	ASSERT_EQ(-1, UTILS::FactorDecimals(250));
+}
+
+//----------------------------------------------------------------------------
+TEST(UTILS, Test_ParseDecimal_RoundsRandomValuesHalfAwayFromZero)
+{
+	// Arrange
+	std::mt19937_64 rng { 42 };
+	for (int i { 0 }; i < 100000; ++i)
+	{
+		const int decimals { int(rng() % 11) };
+		const int64_t value { int64_t(rng() % 1000000000000000000ull) >> (rng() % 60) };
+		std::string text { std::to_string(value) };
+		if (decimals > 0)
+		{
+			text.insert(0, size_t(std::max(0, decimals + 1 - int(text.size()))), '0');
+			text.insert(text.size() - size_t(decimals), ".");
+		}
+		const int dropped { int(rng() % (decimals + 1)) };
+		int64_t divisor { 1 };
+		for (int d { 0 }; d < dropped; ++d)
+		{
+			divisor *= 10;
+		}
+
+		// Act
+		int64_t exact { 0 };
+		int64_t rounded { 0 };
+		int64_t negative { 0 };
+		const bool parsed { UTILS::ParseDecimal(text, decimals, exact) && UTILS::ParseDecimal(text, decimals - dropped, rounded)
+							&& UTILS::ParseDecimal("-" + text, decimals - dropped, negative) };
+
+		// Check
+		ASSERT_TRUE(parsed) << text;
+		ASSERT_EQ(value, exact) << text;
+		ASSERT_EQ(value / divisor + (value % divisor * 2 >= divisor ? 1 : 0), rounded) << text << " " << dropped;
+		ASSERT_EQ(-rounded, negative) << text;
+	}
+}
+
+//----------------------------------------------------------------------------
+TEST(UTILS, Test_EpochDomain_DefersReclaimWhilePinned)
+{
+	// Arrange
+	UTILS::EpochDomain domain;
+	int deleted { 0 };
+
+	// Act
+	{
+		const UTILS::EpochDomain::Guard guard { domain.Pin() };
+		domain.Retire([&deleted] { ++deleted; });
+		domain.Reclaim();
+
+		// Check
+		ASSERT_EQ(0, deleted);
+		ASSERT_EQ(1u, domain.RetiredCount());
+	}
+	domain.Reclaim();
+	ASSERT_EQ(1, deleted);
+	ASSERT_EQ(0u, domain.RetiredCount());
+}
+
+//----------------------------------------------------------------------------
+TEST(UTILS, Test_FrameSlabPool_ReturnsSlabWithLastReference)
+{
+	// Arrange
+	struct Frame
+	{
+		std::string_view text;
+	};
+	auto pool = UTILS::FrameSlabPool::Create(2, 64);
+	const std::string json { R"({"type":"l2update"})" };
+
+	// Act
+	auto slab = pool->Acquire();
+	ASSERT_TRUE(slab);
+	std::copy(json.begin(), json.end(), slab->Data());
+	slab->SetSize(json.size());
+	UTILS::FrameSlab *raw { slab.get() };
+	auto frame = std::allocate_shared<Frame>(UTILS::FrameSlabAllocator<Frame>(raw), Frame { raw->View() });
+	slab.release();
+	std::weak_ptr<Frame> weak { frame };
+	auto copy = frame;
+
+	// Check
+	ASSERT_TRUE(raw->InHeader(frame.get()));
+	ASSERT_EQ(json, frame->text);
+	ASSERT_EQ(1u, pool->Available());
+	auto second = pool->Acquire();
+	ASSERT_TRUE(second);
+	ASSERT_FALSE(pool->Acquire()); // all slabs are out
+	ASSERT_EQ(1u, pool->Misses());
+	second.reset();
+	frame.reset();
+	copy.reset();
+	ASSERT_EQ(1u, pool->Available()); // the weak reference still holds the control block
+	ASSERT_TRUE(weak.expired());
+	auto reacquired = pool->Acquire(); // the most recently released slab comes first
+	ASSERT_NE(raw, reacquired.get());
+	weak.reset();
+	ASSERT_EQ(1u, pool->Available());
+	pool.reset(); // the slab still out keeps the pool alive
+	reacquired.reset();
+}
+
+//----------------------------------------------------------------------------
+TEST(UTILS, Test_ArenaArray_GrowsInPlaceAndAcrossBlocks)
+{
+	// Arrange
+	struct Pair
+	{
+		int64_t first;
+		int64_t second;
+	};
+	alignas(std::max_align_t) char buffer[1024];
+	UTILS::Arena arena { buffer, sizeof(buffer), 4096 };
+	UTILS::ArenaArray<Pair> first { arena };
+	UTILS::ArenaArray<Pair> second { arena };
+
+	// Act
+	for (int64_t i = 0; i < 64; ++i) // 1024 bytes: the buffer only
+	{
+		first.push_back({ i, -i });
+	}
+	const Pair *inBuffer { first.data() };
+	first.emplace_back(Pair { 64, -64 }); // moves to a block
+	for (int64_t i = 0; i < 1000; ++i)
+	{
+		second.push_back({ i, 2 * i });
+	}
+
+	// Check
+	ASSERT_EQ(static_cast<const void *>(buffer), static_cast<const void *>(inBuffer));
+	ASSERT_EQ(65u, first.size());
+	ASSERT_EQ(1000u, second.size());
+	for (int64_t i = 0; i < 65; ++i)
+	{
+		ASSERT_EQ(i, first[size_t(i)].first);
+		ASSERT_EQ(-i, first[size_t(i)].second);
+	}
+	int64_t i { 0 };
+	for (const Pair &pair: second)
+	{
+		ASSERT_EQ(i, pair.first);
+		ASSERT_EQ(2 * i++, pair.second);
+	}
+	ASSERT_EQ(0u, reinterpret_cast<uintptr_t>(second.data()) % alignof(Pair));
+	// the first array takes a block for 128 pairs; the second one grows in place behind it up to 64
+	// pairs, then in a block of its own from 128 to 256 pairs, and takes larger blocks for 512 and 1024
+	ASSERT_EQ(4u, arena.BlockCount());
+}
+
+//----------------------------------------------------------------------------
+TEST(UTILS, Test_JsonValue_ReadsFieldsOnDemand)
+{
+	// Arrange
+	// long strings and nested values in front of the fields, so the SIMD scans cross several blocks
+	const std::string json { R"({"skip": {"a": [1, {"b": "x]}\"y"}], "c": "a long string holding } and ] and \\\" twice \\\""},)"
+							 R"( "channel" : "l2_data", "n": -42, "f": 1.5e2, "t": true, "z": null, "s": "123",)"
+							 R"( "esc": "café 😀\n", "events": [{"product_id": "BTC-USD", "updates": [)"
+							 R"({"side": "bid", "price_level": "21921.73"}, {"side": "offer", "price_level": "21921.74"}]}]})" };
+	const UTILS::JsonValue root { UTILS::JsonValue::Parse(json) };
+
+	// Act
+	const UTILS::JsonValue updates { root["events"].At(0)["updates"] };
+	std::vector<std::string> prices;
+	updates.ForEachElement([&prices](const UTILS::JsonValue &update, bool &)
+	{
+		prices.push_back(update["price_level"].String());
+	});
+	std::vector<std::string> names;
+	root.ForEachMember([&names](std::string_view name, const UTILS::JsonValue &, bool &cont)
+	{
+		names.emplace_back(name);
+		cont = names.size() < 3;
+	});
+
+	// Check
+	ASSERT_TRUE(root.IsObject());
+	ASSERT_EQ("l2_data", root["channel"].String());
+	ASSERT_EQ(-42, root["n"].Int64());
+	ASSERT_EQ(150.0, root["f"].Double());
+	ASSERT_EQ("1.5e2", root["f"].String()); // numbers as written
+	int64_t notInteger { 0 };
+	ASSERT_FALSE(root["f"].Get(notInteger));
+	bool flag { false };
+	ASSERT_TRUE(root["t"].Get(flag));
+	ASSERT_TRUE(flag);
+	ASSERT_TRUE(root["z"].IsNull());
+	ASSERT_EQ(123, root["s"].Int64()); // integer held by a string
+	ASSERT_EQ("caf\xc3\xa9 \xf0\x9f\x98\x80\n", root["esc"].String());
+	ASSERT_EQ("x]}\"y", root["skip"]["a"].At(1)["b"].String());
+	ASSERT_EQ(2u, root["skip"]["a"].Size());
+	ASSERT_FALSE(root["missing"].Valid());
+	ASSERT_FALSE(root["skip"]["a"].At(2).Valid());
+	ASSERT_EQ("BTC-USD", root["events"].At(0)["product_id"].String());
+	ASSERT_EQ((std::vector<std::string> { "21921.73", "21921.74" }), prices);
+	ASSERT_EQ("offer", updates.At(1)["side"].Raw());
+	ASSERT_EQ((std::vector<std::string> { "skip", "channel", "n" }), names);
+}
+
+//----------------------------------------------------------------------------
+TEST(UTILS, Test_JsonValue_MalformedDocumentsStayInBounds)
+{
+	// Arrange
+	const std::vector<std::string> documents { "", "{", "{\"a\"", "{\"a\":", "{\"a\": \"unterminated", "{\"a\": [1, 2",
+											   "{\"a\": \"x\\", "[1, 2,", "{\"a\" 1}", "xyz" };
+
+	for (const std::string &document: documents)
+	{
+		// Act (copies end exactly at the document, so a read past it is caught by sanitizers)
+		const std::unique_ptr<char[]> copy { new char[document.size()] };
+		std::copy(document.begin(), document.end(), copy.get());
+		const UTILS::JsonValue root { UTILS::JsonValue::Parse({ copy.get(), document.size() }) };
+
+		const size_t size { root["a"].Size() };
+		const std::string_view raw { root["a"].At(size).Raw() };
+
+		// Check
+		ASSERT_EQ("", raw) << document;
+		ASSERT_EQ("", root["a"].String()) << document;
+		ASSERT_EQ(0u, root["b"].Size()) << document;
+	}
+}
+
+} // namespace TEST